@@ -39,9 +39,13 @@
 #include <OpenMS/ANALYSIS/MAPMATCHING/FeatureDistance.h>
 #include <OpenMS/CONCEPT/ProgressLogger.h>
 
+#include <functional>
+
 namespace OpenMS
 {
 
+class MapAlignmentAlgorithmKD;
+
 ///
 /**
     @brief Proxy for a (potential) cluster.
@@ -171,6 +175,18 @@ private:
       The algorithm takes a number of feature or consensus maps and searches
       for corresponding (consensus) features across different maps.
 
+      The data is partitioned in m/z, and the partitions are linked concurrently
+      (OpenMP). Within a partition, the neighborhoods of all features (and their
+      distances to the features they could be linked to) are computed once, in
+      parallel, before the consensus features are selected greedily.
+
+      Since partitions are independent, cohorts that are too large to be kept
+      in memory can be linked with groupOutOfCore(), which loads only the
+      features of a batch of consecutive partitions at a time (once for the
+      RT transformation models, if warping is enabled, and once for linking)
+      and hands the consensus features of each batch to a consumer (e.g. a
+      ConsensusXMLWritingConsumer).
+
       @htmlinclude OpenMS_FeatureGroupingAlgorithmKD.parameters
 
       @ingroup FeatureGrouping
@@ -182,6 +198,16 @@ private:
 
 public:
 
+    /**
+        @brief Loads the features of all input maps with m/z in [@p mz_min, @p mz_max) into @p maps (one map per input, in input order)
+
+        Features outside of the range may be loaded as well, they are ignored.
+    */
+    typedef std::function<void(double mz_min, double mz_max, std::vector<FeatureMap>& maps)> MapRangeLoader;
+
+    /// Receives the consensus features of a batch of partitions
+    typedef std::function<void(ConsensusMap& batch)> ConsensusConsumer;
+
     /// Default constructor
     FeatureGroupingAlgorithmKD();
 
@@ -203,6 +229,35 @@ public:
     void group(const std::vector<ConsensusMap>& maps,
                        ConsensusMap& out) override;
 
+    /**
+        @brief Applies the algorithm to feature maps that are loaded batch by batch
+
+        The partitioning in m/z is the same as for group(), computed from the
+        m/z values of all features of all maps. Consecutive partitions are
+        combined into batches of at least @p batch_size features (0: a single
+        batch). For each batch, the features are requested from @p load_range
+        and the resulting consensus features are passed to @p consume, so only
+        the features of one batch are kept in memory at a time. If warping is
+        enabled, every batch is loaded twice (for the RT transformation models
+        and for linking).
+
+        Consensus features are sorted canonically within each batch. Unlike
+        group(), no column headers, protein identifications or unassigned
+        peptide identifications are set; this is left to the caller.
+
+        @param num_maps Number of input maps
+        @param mz_values m/z values of all features of all input maps
+        @param max_intensity Maximum intensity of all features (for the distance function)
+        @param batch_size Minimum number of features per batch
+        @param load_range Loads the features in an m/z range
+        @param consume Receives the consensus features of each batch (in increasing m/z order of the batches)
+
+        @exception IllegalArgument is thrown if less than two input maps are given.
+        @exception InvalidSize is thrown if @p load_range does not return @p num_maps maps.
+    */
+    void groupOutOfCore(Size num_maps, std::vector<double> mz_values, double max_intensity, Size batch_size,
+                        const MapRangeLoader& load_range, const ConsensusConsumer& consume);
+
     /// Creates a new instance of this class (for Factory)
     static FeatureGroupingAlgorithm* create()
     {
@@ -231,14 +286,50 @@ private:
     template <typename MapType>
     void group_(const std::vector<MapType>& input_maps, ConsensusMap& out);
 
+    /// Sets up parameters and distance functor, sorts @p mz_values and computes the m/z partition boundaries
+    void setUp_(std::vector<double>& mz_values, double max_intensity, std::vector<double>& partition_boundaries);
+
+    /// Copies the features of @p input_maps with m/z in [@p partition_start, @p partition_end) to @p partition_maps
+    template <typename MapType>
+    static void extractPartition_(const std::vector<MapType>& input_maps, double partition_start, double partition_end, std::vector<MapType>& partition_maps);
+
+    /// Adds the RT fit data of partitions [@p first_partition, @p last_partition) to @p aligner
+    template <typename MapType>
+    void addRTFitData_(const std::vector<MapType>& input_maps, const std::vector<double>& partition_boundaries, Size first_partition, Size last_partition, MapAlignmentAlgorithmKD& aligner, Size& progress);
+
+    /// Links the features of partitions [@p first_partition, @p last_partition) (in parallel) and appends the consensus features to @p out, in partition order
+    template <typename MapType>
+    void linkPartitions_(const std::vector<MapType>& input_maps, const std::vector<double>& partition_boundaries, Size first_partition, Size last_partition, const MapAlignmentAlgorithmKD* aligner, ConsensusMap& out, Size& progress);
+
+    /**
+        @brief Neighborhoods of all points of a partition (in compressed sparse row format)
+
+        The neighbors of point i are stored at positions @p offsets[i] to
+        @p offsets[i + 1] - 1 of @p neighbors (in the order returned by the
+        kd-tree). For each neighbor, @p distances holds its distance to i, or
+        -1 if it can never be part of a consensus feature with center i (same
+        map, or incompatible charge/adduct).
+    */
+    struct Neighborhoods_
+    {
+      std::vector<Size> offsets;
+      std::vector<Size> neighbors;
+      std::vector<double> distances;
+      /// Distance of each point to itself (as center of its consensus feature)
+      std::vector<double> center_distances;
+    };
+
+    /// Compute the neighborhoods of all points in @p kd_data (in parallel)
+    void computeNeighborhoods_(const KDTreeFeatureMaps& kd_data, Neighborhoods_& neighborhoods) const;
+
     /// Run the actual clustering algorithm
-    void runClustering_(const KDTreeFeatureMaps& kd_data, ConsensusMap& out);
+    void runClustering_(const KDTreeFeatureMaps& kd_data, ConsensusMap& out) const;
 
     /// Update maximum possible sizes of potential consensus features for indices specified in @p update_these
-    void updateClusterProxies_(std::set<ClusterProxyKD>& potential_clusters, std::vector<ClusterProxyKD>& cluster_for_idx, const std::set<Size>& update_these, const std::vector<Int>& assigned, const KDTreeFeatureMaps& kd_data);
+    void updateClusterProxies_(std::set<ClusterProxyKD>& potential_clusters, std::vector<ClusterProxyKD>& cluster_for_idx, const std::set<Size>& update_these, const std::vector<Int>& assigned, const KDTreeFeatureMaps& kd_data, const Neighborhoods_& neighborhoods) const;
 
     /// Compute the current best cluster with center index @p i (mutates @p proxy and @p cf_indices)
-    ClusterProxyKD computeBestClusterForCenter_(Size i, std::vector<Size>& cf_indices, const std::vector<Int>& assigned, const KDTreeFeatureMaps& kd_data) const;
+    ClusterProxyKD computeBestClusterForCenter_(Size i, std::vector<Size>& cf_indices, const std::vector<Int>& assigned, const KDTreeFeatureMaps& kd_data, const Neighborhoods_& neighborhoods) const;
 
     /// Construct consensus feature and add to out map
     void addConsensusFeature_(const std::vector<Size>& indices, const KDTreeFeatureMaps& kd_data, ConsensusMap& out) const;
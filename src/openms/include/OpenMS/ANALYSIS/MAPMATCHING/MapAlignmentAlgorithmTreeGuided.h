@@ -48,6 +48,7 @@ namespace OpenMS
     Only the best PSM per spectrum is considered as the correct identification.
 
     For each pair of maps, the similarity is determined based on the intersection of the contained identifications using Pearson correlation. For small intersections, the Pearson value is reduced by multiplying the ratio of the intersection size to the union size: \f$\texttt{PearsonValue(map1}\cap \texttt{map2)}*\Bigl(\frac{\texttt{N(map1 }\cap\texttt{ map2})}{\texttt{N(map1 }\cup\texttt{ map2})}\Bigr)\f$
+    The pairwise similarities are computed in parallel (OpenMP) on compact per-map arrays of (sequence index, median RT) pairs.
     Using hierarchical clustering together with average linkage a binary tree is produced.
     Following the tree, the maps are aligned, resulting in a transformed feature map that contains both the original and the transformed retention times.
     As long as there are at least two clusters, the alignment is done as follows:
@@ -57,6 +58,7 @@ namespace OpenMS
     Retention times in the second cluster are transformed to the reference scale by applying this function.
     Additionally, the original retention times are stored in the meta information of each feature.
     The reference is combined with the transformed cluster.
+    Pairs of clusters in disjoint subtrees do not depend on each other and are aligned concurrently (OpenMP).
 
     The resulting map is used to extract transformation descriptions for each input map.
     For each map cubic spline smoothing is used to convert the mapping to a smooth function.
@@ -129,6 +131,9 @@ protected:
     /// Type to store feature retention times given for individual peptide sequence
     typedef std::map<String, DoubleList> SeqAndRTList;
 
+    /// Type to store one (median) feature retention time per peptide sequence, as pairs of sequence index and RT sorted by sequence index
+    typedef std::vector<std::pair<Size, double>> SeqIndexAndRTList;
+
     // Update defaults model_type_, model_param_ and align_algorithm_
     void updateMembers_() override;
 
@@ -142,8 +147,8 @@ protected:
     MapAlignmentAlgorithmIdentification align_algorithm_;
 
     /**
-     * @brief Similarity functor that provides similarity calculations with the ()-operator for protected type SeqAndRTList.
-     * SeqAndRTList stores retention times given for individual peptide sequences of a feature map.
+     * @brief Similarity functor that provides similarity calculations with the ()-operator for protected type SeqIndexAndRTList.
+     * SeqIndexAndRTList stores the median retention time for each (indexed) peptide sequence of a feature map.
 
       Using pearson correlation, calculate the retention time similarity of two maps from their intersection of the peptide identifications.
       Small intersections are penalized by multiplication with the quotient of intersection to union.
@@ -171,6 +176,16 @@ protected:
     static void extractSeqAndRt_(const std::vector<FeatureMap>& feature_maps, std::vector<SeqAndRTList>& maps_seq_and_rt,
             std::vector<std::vector<double>>& maps_ranges);
 
+    /**
+     * @brief Convert the extracted sequences and RTs of each map into a compact array of (sequence index, median RT) pairs.
+     *
+     * Sequences are indexed in lexicographical order over all maps, so the arrays are sorted in the same order as the input.
+     *
+     * @param maps_seq_and_rt Feature RTs for individual peptide sequences for each feature map (see extractSeqAndRt_()).
+     * @param maps_seq_index_and_rt Vector to store the compact arrays for each feature map (output)
+     */
+    static void indexSeqAndRt_(std::vector<SeqAndRTList>& maps_seq_and_rt, std::vector<SeqIndexAndRTList>& maps_seq_index_and_rt);
+
 private:
     /// Copy constructor intentionally not implemented -> private
     MapAlignmentAlgorithmTreeGuided(const MapAlignmentAlgorithmTreeGuided&);
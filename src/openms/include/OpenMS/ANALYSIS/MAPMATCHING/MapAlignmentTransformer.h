@@ -84,20 +84,25 @@ namespace OpenMS
                                         bool store_original_rt = false);
 
   private:
-    /// Applies a transformation to a feature
-    static void applyToFeature_(Feature& feature,
-                                const TransformationDescription& trafo,
-                                bool store_original_rt = false);
-
-    /// Applies a transformation to a basic feature
-    static void applyToBaseFeature_(BaseFeature& feature,
-                                    const TransformationDescription& trafo,
-                                    bool store_original_rt = false);
-
-    /// Applies a transformation to a consensus feature
-    static void applyToConsensusFeature_(
-      ConsensusFeature& feature, const TransformationDescription& trafo,
-      bool store_original_rt = false);
+    /**
+       @brief Collects retention times and writes back the transformed values
+
+       The RTs of a map are visited twice in the same order: in the first pass they are collected, then the
+       transformation is applied to all of them at once, and the second pass writes back the results.
+    */
+    class RTBatch_;
+
+    /// Visits the retention times of a feature (position, peptide IDs, convex hulls, subordinates)
+    static void visitRTs_(Feature& feature, RTBatch_& batch);
+
+    /// Visits the retention times of a basic feature (position, peptide IDs)
+    static void visitRTs_(BaseFeature& feature, RTBatch_& batch);
+
+    /// Visits the retention times of a consensus feature (position, peptide IDs, feature handles)
+    static void visitRTs_(ConsensusFeature& feature, RTBatch_& batch);
+
+    /// Visits the retention times of peptide identifications
+    static void visitRTs_(std::vector<PeptideIdentification>& pep_ids, RTBatch_& batch);
 
     /**
        @brief Stores the original RT in a meta value
@@ -45,6 +45,7 @@
 #include <unordered_map>
 
 #include <list>
+#include <map>
 #include <vector>
 #include <unordered_set>
 #include <utility> // for pair<>
@@ -92,7 +93,10 @@ namespace OpenMS
    This algorithm includes a number of optimizations to reduce run-time:
    @li two-dimensional hashing of features,
    @li a look-up table for feature distances,
-   @li a variant of QT clustering that requires only one round of clustering.
+   @li a variant of QT clustering that requires only one round of clustering,
+   @li parallel processing of the m/z partitions (@p nr_partitions) and of the
+       neighbor search for the initial clustering (results do not depend on the
+       number of threads).
 
    @see FeatureGroupingAlgorithmQT
 
@@ -174,7 +178,6 @@ namespace OpenMS
      * @param cluster_heads the heap where the clusters are stored, must not be empty
      * @param[out] feature The resulting consensus feature which is constructed here
      * @param element_mapping the element mapping is used to update clusters when features are removed
-     * @param grid the grid is used to find new features for clusters that have to be updated
      * @param handles used to access clusters if we know their id from the element mapping
      * 
      * @return bool whether a consensus feature was made or not
@@ -182,11 +185,13 @@ namespace OpenMS
     bool makeConsensusFeature_(Heap& cluster_heads,
                                ConsensusFeature& feature,
                                ElementMapping& element_mapping,
-                               const Grid& grid,
                                const std::vector<Heap::handle_type>& handles);
 
     /**
      * @brief Computes an initial QT clustering of the points in the hash grid
+     *
+     * The neighbors of the cluster centers are searched in parallel, the clusters
+     * are then inserted in grid order (cluster ids do not depend on the number of threads).
      * 
      * @param grid the grid is used to find new features for clusters that have to be updated
      * @param cluster_heads the heap where the QTClusters are inserted
@@ -226,10 +231,14 @@ namespace OpenMS
      *
      * 1. remove current best cluster from the heap
      * 2. update all clusters accordingly by removing neighbors used by the current best
+     *    (replacements are selected from the stored potential elements of each cluster, see QTCluster::reselectNeighbors)
      * 3. invalidate clusters whose center has been used by the current best
+     *
+     * The quality of updated clusters changes, their position in the heap is updated lazily
+     * (boost::heap::fibonacci_heap::update_lazy). Clusters invalidated in step 3 stay in the
+     * heap until they reach the top and are discarded.
      * 
      * @param element_mapping the element mapping is used to update clusters and updated itself
-     * @param grid the grid is used to find new features for clusters that have to be updated
      * @param cluster_heads the heap is updated for changing clusters and popped in the end
      * @param elements the features that now have to be removed from other clusters than the current best
      * @param handles used to access clusters if we know their id from the element mapping
@@ -240,7 +249,6 @@ namespace OpenMS
      * therefore don't have to delete them.
      */
     void updateClustering_(ElementMapping& element_mapping,
-                           const Grid& grid, 
                            const QTCluster::Elements& elements,
                            Heap& cluster_heads,
                            const std::vector<Heap::handle_type>& handles,
@@ -40,6 +40,7 @@
 namespace OpenMS
 {
   class AASequence;
+  class FeatureDistance;
 
   /**
     @brief This class implements a pair finding algorithm for consensus features.
@@ -63,6 +64,11 @@ namespace OpenMS
     it increases the distance difference between the nearest and the second-nearest neighbor, so
     that the constraint imposed by @p second_nearest_gap may be fulfilled more often.
 
+    Nearest neighbors are looked up in a hash grid with cells of the size of the maximum allowed
+    RT and m/z differences (searching further out only as far as needed to find the exact
+    second-nearest neighbor), and computed in parallel for both maps. The result is the same as
+    comparing all pairs of features.
+
     <B> Quality calculation </B>
 
     The quality of a pairing is computed from the distance between the paired elements (nearest
@@ -168,6 +174,18 @@ protected:
     bool compatibleIDs_(const ConsensusFeature& feat1,
                         const ConsensusFeature& feat2) const;
 
+    /**
+      @brief Finds nearest and second-nearest neighbors of the elements of one input map in the other map.
+
+      For every element of map @p query_map, the index of its nearest neighbor (among the pairs
+      valid according to @p feature_distance) and the distances to the nearest and
+      second-nearest neighbors are stored in @p nn_index and @p nn_distance. The results are
+      identical to those of a sequential comparison with all elements of the other map.
+    */
+    void findNearestNeighbors_(const std::vector<ConsensusMap>& input_maps, UInt query_map,
+                               FeatureDistance& feature_distance, std::vector<UInt>& nn_index,
+                               std::vector<std::pair<double, double> >& nn_distance) const;
+
     /// The distance to the second nearest neighbors must be by this factor larger than the distance to the matched element itself.
     double second_nearest_gap_;
 
@@ -121,6 +121,14 @@ public:
     */
     double apply(double value) const;
 
+    /**
+      @brief Applies the transformation to all @p values
+
+      Faster than applying it to the values one by one, especially if they are sorted in ascending order.
+      @p values and @p result may be the same vector.
+    */
+    void apply(const std::vector<double>& values, std::vector<double>& result) const;
+
     /// Gets the type of the fitted model
     const String& getModelType() const;
 
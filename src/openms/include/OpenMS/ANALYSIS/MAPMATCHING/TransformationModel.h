@@ -102,6 +102,17 @@ namespace OpenMS
 
     /// Evaluates the model at the given value
     virtual double evaluate(double value) const;
+
+    /**
+      @brief Evaluates the model at the given values
+
+      Faster than evaluating the values one by one (especially if they are sorted in ascending order).
+      The default implementation evaluates the values one by one.
+
+      @param values Positions where the model should be evaluated
+      @param result Output, resized to the size of @p values (may be the same vector as @p values)
+    */
+    virtual void evaluate(const std::vector<double>& values, std::vector<double>& result) const;
     
     /**
     @brief Weight the data by the given weight function
@@ -94,6 +94,16 @@ public:
      */
     double evaluate(double value) const override;
 
+    /**
+     * @brief Evaluate the interpolation model at the given values
+     *
+     * If the values are sorted in ascending order, the interpolation walks along the data points instead of searching them for every value.
+     *
+     * @param values The positions where the interpolation should be evaluated.
+     * @param result The interpolated values (may be the same vector as @p values).
+     */
+    void evaluate(const std::vector<double>& values, std::vector<double>& result) const override;
+
     /// Gets the default parameters
     static void getDefaultParameters(Param& params);
 
@@ -125,6 +135,17 @@ public:
        */
       virtual double eval(const double& x) const = 0;
 
+      /**
+       * @brief Evaluate the underlying interpolation at positions sorted in ascending order.
+       *
+       * The default implementation evaluates the positions one by one.
+       *
+       * @param begin Start of the positions
+       * @param end End of the positions
+       * @param result Output, one value per position (may be the same as @p begin)
+       */
+      virtual void evalSorted(const double* begin, const double* end, double* result) const;
+
       /**
        * @brief d'tor.
        */
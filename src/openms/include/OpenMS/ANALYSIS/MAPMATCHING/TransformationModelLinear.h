@@ -72,6 +72,9 @@ public:
     /// Evaluates the model at the given value
     double evaluate(double value) const override;
 
+    /// Evaluates the model at the given values (vectorized if no weighting is used)
+    void evaluate(const std::vector<double>& values, std::vector<double>& result) const override;
+
     using TransformationModel::getParameters;
 
     /// Gets the "real" parameters
@@ -66,6 +66,12 @@ public:
       return model_->evaluate(value);
     }
 
+    /// Evaluates the model at the given values
+    void evaluate(const std::vector<double>& values, std::vector<double>& result) const override
+    {
+      model_->evaluate(values, result);
+    }
+
     using TransformationModel::getParameters;
 
     /// Gets the default parameters
@@ -12,6 +12,7 @@ SpectrumAccessOpenMSInMemory.h
 SpectrumAccessSqMass.h
 SpectrumAccessTransforming.h
 SpectrumAccessQuadMZTransforming.h
+SpectrumAccessStrided.h
 )
 
 ### add path to the filenames
@@ -42,6 +42,8 @@
 #include <OpenMS/OPENSWATHALGO/DATAACCESS/ITransition.h>
 #include <OpenMS/OPENSWATHALGO/DATAACCESS/TransitionExperiment.h>
 
+#include <unordered_map>
+
 namespace OpenMS
 {
   class TheoreticalSpectrumGenerator;
@@ -76,6 +78,13 @@ namespace OpenMS
     interface. Transitions are expected to be in the light transition format
     (defined in OPENSWATHALGO/DATAACCESS/TransitionExperiment.h).
 
+    The theoretical isotope patterns and b/y ion series only depend on the
+    assay, not on the peak group that is scored. They can be computed once for
+    a whole assay library using prepareAssayCache() and are then looked up
+    instead of being regenerated for every peak group (anything not in the
+    cache is still computed on the fly). The scoring functions only read the
+    cache, so a prepared object can be used from multiple threads.
+
   @htmlinclude OpenMS_DIAScoring.parameters
 
   */
@@ -92,6 +101,17 @@ namespace OpenMS
 
 public:
 
+    /// Precomputed theoretical data of a single assay, see prepareAssayCache()
+    struct AssayCacheEntry
+    {
+      /// b ion series (charge 1), empty if not a peptide
+      std::vector<double> bseries;
+      /// y ion series (charge 1), empty if not a peptide
+      std::vector<double> yseries;
+      /// theoretical precursor isotope pattern (scaled to a maximum of 1) from the sum formula, empty if the averagine model needs to be used
+      std::vector<double> precursor_isotopes;
+    };
+
     ///@name Constructors and Destructor
     //@{
     /// Default constructor
@@ -143,6 +163,15 @@ public:
     void dia_by_ion_score(SpectrumPtrType spectrum, AASequence& sequence,
                           int charge, double& bseries_score, double& yseries_score) const;
 
+    /// b/y ion scores using precomputed ion series (see getAssayCacheEntry())
+    void dia_by_ion_score(SpectrumPtrType spectrum, const std::vector<double>& bseries,
+                          const std::vector<double>& yseries, double& bseries_score, double& yseries_score) const;
+
+    /// Precursor isotope scores using a precomputed theoretical isotope pattern (see getAssayCacheEntry())
+    void dia_ms1_isotope_scores(double precursor_mz, SpectrumPtrType spectrum,
+                                double& isotope_corr, double& isotope_overlap, int charge_state,
+                                const std::vector<double>& theoretical_isotopes) const;
+
     /// Dotproduct / Manhattan score with theoretical spectrum
     void score_with_isotopes(SpectrumPtrType spectrum,
                              const std::vector<TransitionType>& transitions,
@@ -150,6 +179,29 @@ public:
                              double& manhattan) const;
     //@}
 
+    ///@name Assay cache
+    //@{
+    /**
+      @brief Precompute the theoretical patterns of all assays in @p assays
+
+      Computes the averagine isotope patterns of all product ions (and of
+      precursors without sequence), the sum formula based precursor isotope
+      patterns and the b/y ion series (charge 1) of all peptides. Replaces
+      the data of any previously prepared assays, so that entries never
+      belong to an earlier library with the same compound ids. Changing the
+      parameters clears the cache.
+
+      @note Not thread-safe, needs to be called before scoring starts.
+    */
+    void prepareAssayCache(const OpenSwath::LightTargetedExperiment& assays);
+
+    /// Remove all precomputed data
+    void clearAssayCache();
+
+    /// Precomputed data of the compound with id @p compound_id or nullptr if not cached
+    const AssayCacheEntry* getAssayCacheEntry(const std::string& compound_id) const;
+    //@}
+
 private:
 
     /// Copy constructor (algorithm class)
@@ -226,6 +278,17 @@ private:
     double scoreIsotopePattern_(const std::vector<double>& isotopes_int,
                                 const IsotopeDistribution& isotope_dist) const;
 
+    /// Pearson correlation of @p isotopes_int with an already normalized theoretical pattern (0 if undefined)
+    double scoreIsotopePattern_(const std::vector<double>& isotopes_int,
+                                const std::vector<double>& theoretical_isotopes) const;
+
+    /// Theoretical isotope intensities of @p isotope_dist scaled to a maximum of 1
+    void getTheoreticalIsotopeIntensities_(const IsotopeDistribution& isotope_dist,
+                                           std::vector<double>& theoretical_isotopes) const;
+
+    /// Theoretical averagine isotope intensities for a peptide of @p weight scaled to a maximum of 1
+    void getAveragineIsotopeIntensities_(double weight, std::vector<double>& theoretical_isotopes) const;
+
     /// Get the intensities of isotopes around @p precursor_mz in experimental @p spectrum
     /// and fill @p isotopes_int.
     void getIsotopeIntysFromExpSpec_(double precursor_mz, SpectrumPtrType spectrum,
@@ -243,6 +306,12 @@ private:
     bool dia_centroided_;
 
     TheoreticalSpectrumGenerator * generator;
+
+    /// averagine isotope patterns (scaled to a maximum of 1) keyed by the neutral weight used to estimate them
+    std::unordered_map<double, std::vector<double> > averagine_cache_;
+
+    /// precomputed data per compound id
+    std::unordered_map<std::string, AssayCacheEntry> assay_cache_;
   };
 }
 
@@ -158,6 +158,9 @@ public:
     /** @brief Prepares the internal mappings of peptides and proteins.
      *
      * Calling this method _is_ required before calling scorePeakgroups.
+     * If DIA scores are enabled, this also precomputes the theoretical
+     * isotope patterns and ion series of all assays (see
+     * DIAScoring::prepareAssayCache).
      *
      * @param transition_exp The transition list describing the experiment
      *
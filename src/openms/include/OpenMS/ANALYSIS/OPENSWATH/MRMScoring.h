@@ -115,9 +115,24 @@ namespace OpenSwath
         /// Initialize the scoring object and building the cross-correlation matrix
         void initializeXCorrMatrix(OpenSwath::IMRMFeature* mrmfeature, const std::vector<std::string>& native_ids);
 
+        /**
+          @brief Initialize only the apex statistics of the cross-correlation matrix
+
+          Computes the same delay and height of the cross-correlation apex as
+          initializeXCorrMatrix() for each pair of transitions, but standardizes
+          all traces once into a contiguous buffer and never stores the full
+          cross-correlation arrays (getXCorrMatrix() will be empty afterwards).
+          This is sufficient for all coelution and shape scores and considerably
+          faster for long chromatograms.
+        */
+        void initializeXCorrMaxPeakMatrix(OpenSwath::IMRMFeature* mrmfeature, const std::vector<std::string>& native_ids);
+
         /// Initialize the scoring object and building the cross-correlation matrix of chromatograms of set1 (e.g. identification transitions) vs set2 (e.g. detection transitions)
         void initializeXCorrContrastMatrix(OpenSwath::IMRMFeature* mrmfeature, const std::vector<std::string>& native_ids_set1, const std::vector<std::string>& native_ids_set2);
 
+        /// Initialize only the apex statistics of the cross-correlation matrix of set1 vs set2 (see initializeXCorrMaxPeakMatrix())
+        void initializeXCorrContrastMaxPeakMatrix(OpenSwath::IMRMFeature* mrmfeature, const std::vector<std::string>& native_ids_set1, const std::vector<std::string>& native_ids_set2);
+
         /// Initialize the scoring object and building the cross-correlation matrix
         void initializeXCorrPrecursorMatrix(OpenSwath::IMRMFeature* mrmfeature, const std::vector<std::string>& precursor_ids);
 
@@ -287,6 +302,7 @@ namespace OpenSwath
         //@}
 
         /// contains max Peaks from xcorr_contrast_matrix_
+        OpenMS::Matrix<int> xcorr_contrast_matrix_max_peak_;
         OpenMS::Matrix<double > xcorr_contrast_matrix_max_peak_sec_;
 
         /// the precomputed cross correlation matrix of the MS1 trace
@@ -47,10 +47,12 @@
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMS.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessTransforming.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMSInMemory.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessStrided.h>
 #include <OpenMS/OPENSWATHALGO/DATAACCESS/SwathMap.h>
 
 // Helpers
 #include <OpenMS/ANALYSIS/OPENSWATH/OpenSwathHelper.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/SwathWindowLibrary.h>
 // #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/DataAccessHelper.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SimpleOpenMSSpectraAccessFactory.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/OpenSwathTSVWriter.h>
@@ -120,13 +122,8 @@ protected:
     /** @brief Constructor
      *
      *  @param use_ms1_traces Whether to use MS1 data
-     *  @param threads_outer_loop How many threads should be used for the outer
-     *  loop (-1 will use all threads in the outer loop)
-     *
-     *  @note The total number of threads should be divisible by this number
-     *  (e.g. use 8 in outer loop if you have 24 threads in total and 3 will be
-     *  used for the inner loop).
-     *
+     *  @param threads_outer_loop How many SWATH windows may be processed (and
+     *  held in memory) at the same time (-1 will use the number of threads)
      *
      **/
     OpenSwathWorkflowBase(bool use_ms1_traces, bool use_ms1_ion_mobility, bool prm, bool pasef, int threads_outer_loop) :
@@ -250,6 +247,11 @@ protected:
    *   - Extract chromatograms across the whole RT range using simpleExtractChromatograms_()
    *   - Compute calibration functions for RT and m/z using doDataNormalization_()
    *
+   * Alternatively, if "sampling:spectra_stride" is set to a value larger than
+   * one in the iRT detection parameters, doIncrementalDataNormalization_()
+   * starts from every n-th spectrum and only adds further spectra until the
+   * RT calibration converges.
+   *
   */
   class OPENMS_DLLAPI OpenSwathCalibrationWorkflow :
     public OpenSwathWorkflowBase
@@ -275,6 +277,10 @@ protected:
      * raw data (swath_maps) are therefore not constant but may be changed in
      * this function.
      *
+     * If @p irt_detection_param contains a "sampling:spectra_stride" larger
+     * than one, the chromatograms are extracted incrementally from subsets of
+     * the spectra (see doIncrementalDataNormalization_()).
+     *
      * @param irt_transitions A set of transitions used for the RT normalization peptides
      * @param swath_maps The raw data (swath maps)
      * @param min_rsq Minimal R^2 value that is expected for the RT regression
@@ -345,6 +351,56 @@ protected:
       const Param& irt_detection_param,
       const Param& calibration_param);
 
+    /** @brief Perform retention time and m/z calibration on incrementally sampled spectra
+     *
+     * Instead of extracting the iRT chromatograms from all spectra, each SWATH
+     * map is split into @p spectra_stride interleaved subsets (see
+     * SpectrumAccessStrided). Subsets are extracted one at a time, spread out
+     * such that the sampled spectra stay evenly spaced, and merged into the
+     * chromatograms extracted so far. After each subset, the RT calibrants are
+     * selected and the RT transformation is fitted. Extraction stops once two
+     * consecutive fits differ by at most @p convergence_tolerance (as a
+     * fraction of the library RT range) at all calibrant positions. The m/z and
+     * ion mobility correction is performed once, on the final set of
+     * calibrants.
+     *
+     * If the calibration does not converge, all subsets are extracted, which
+     * yields the same chromatograms as simpleExtractChromatograms_() (see
+     * extractChromatogramSubset_()).
+     *
+     * @param irt_transitions A set of transitions used for the RT normalization peptides
+     * @param swath_maps The raw data (swath maps)
+     * @param chromatograms The extracted chromatograms (output)
+     * @param im_trafo Ion mobility transformation (output)
+     * @param min_rsq Minimal R^2 value that is expected for the RT regression
+     * @param min_coverage Minimal coverage of the chromatographic space that needs to be achieved
+     * @param default_ffparam Parameter set for the feature finding in chromatographic dimension
+     * @param cp_irt Parameter set for the chromatogram extraction
+     * @param irt_detection_param Parameter set for the detection of the iRTs (outlier detection, peptides per bin etc)
+     * @param calibration_param Parameter for the m/z and im calibration (see SwathMapMassCorrection)
+     * @param spectra_stride Number of interleaved subsets each map is split into
+     * @param convergence_tolerance Maximal change of the RT transformation between two rounds
+     * @param sonar Whether the data is SONAR data
+     * @param load_into_memory Whether to cache the current subset of the SWATH map in memory
+     *
+     * @throw Exception::IllegalArgument if no valid RT calibration could be found using all spectra
+     *
+    */
+    TransformationDescription doIncrementalDataNormalization_(const OpenSwath::LightTargetedExperiment& irt_transitions,
+      std::vector< OpenSwath::SwathMap > & swath_maps,
+      std::vector< OpenMS::MSChromatogram >& chromatograms,
+      TransformationDescription& im_trafo,
+      double min_rsq,
+      double min_coverage,
+      const Param& default_ffparam,
+      const ChromExtractParams& cp_irt,
+      const Param& irt_detection_param,
+      const Param& calibration_param,
+      Size spectra_stride,
+      double convergence_tolerance,
+      bool sonar,
+      bool load_into_memory);
+
     /** @brief Simple method to extract chromatograms (for the RT-normalization peptides)
      *
      * @param swath_maps The raw data (swath maps)
@@ -364,6 +420,52 @@ protected:
                                      bool sonar,
                                      bool load_into_memory);
 
+    /** @brief Extract chromatograms from a subset of the spectra and merge them with previously extracted subsets
+     *
+     * Extracts the chromatograms from every @p spectra_stride -th spectrum of
+     * each map, starting at @p offset (see SpectrumAccessStrided). The data
+     * points are merged by RT into the chromatograms of the same map and
+     * transition in @p chromatograms_per_map, which is empty before the first
+     * subset. Nothing is filtered at this stage, so once all subsets have been
+     * added, collectChromatograms_() yields the same chromatograms as
+     * simpleExtractChromatograms_() (also for transitions that are extracted
+     * from several overlapping windows).
+     *
+     * @param swath_maps The raw data (swath maps)
+     * @param irt_transitions A set of transitions used for the RT normalization peptides
+     * @param chromatograms_per_map The chromatograms of each map, in transition order (input/output)
+     * @param trafo Transformation description for RT normalization
+     * @param cp Parameter set for the chromatogram extraction
+     * @param spectra_stride Number of interleaved subsets each map is split into
+     * @param offset Index of the subset to extract (smaller than @p spectra_stride)
+     * @param load_into_memory Whether to cache the current subset of the SWATH map in memory
+     *
+    */
+    void extractChromatogramSubset_(const std::vector< OpenSwath::SwathMap > & swath_maps,
+                                    const OpenSwath::LightTargetedExperiment & irt_transitions,
+                                    std::vector< std::vector< OpenMS::MSChromatogram > > & chromatograms_per_map,
+                                    const TransformationDescription& trafo,
+                                    const ChromExtractParams & cp,
+                                    Size spectra_stride,
+                                    Size offset,
+                                    bool load_into_memory);
+
+    /** @brief Combine the chromatograms extracted per SWATH map
+     *
+     * Chromatograms without any intensity are skipped (this can happen if the
+     * extraction window is outside the acquisition window), the others are
+     * appended in map order. For SONAR data, the chromatograms of the same
+     * transition from different maps are added up.
+     *
+     * @param chromatograms_per_map The chromatograms of each map
+     * @param chromatograms The combined chromatograms (output)
+     * @param sonar Whether the data is SONAR data
+     *
+    */
+    static void collectChromatograms_(const std::vector< std::vector< OpenMS::MSChromatogram > > & chromatograms_per_map,
+                                      std::vector< OpenMS::MSChromatogram > & chromatograms,
+                                      bool sonar);
+
     /** @brief Add two chromatograms
      *
      * @param base_chrom The base chromatogram to which we will add intensity
@@ -372,6 +474,43 @@ protected:
     */
     static void addChromatograms(MSChromatogram& base_chrom, const MSChromatogram& newchrom);
 
+  protected:
+
+    /// Extract the chromatograms of each (non-MS1) map in transition order, without removing empty ones
+    void extractChromatogramsPerMap_(const std::vector< OpenSwath::SwathMap > & swath_maps,
+                                     const OpenSwath::LightTargetedExperiment & irt_transitions,
+                                     std::vector< std::vector< OpenMS::MSChromatogram > > & chromatograms_per_map,
+                                     const TransformationDescription& trafo,
+                                     const ChromExtractParams & cp,
+                                     bool load_into_memory);
+
+    /** @brief Pick the iRT features and select the RT calibrant pairs
+     *
+     * Performs steps 1-7 of doDataNormalization_(): features are picked in the
+     * chromatograms, outliers are removed and the binned coverage is checked.
+     *
+     * @param transition_group_map Picked transition groups (output, owns the
+     *        groups referenced by @p trgrmap_final)
+     * @param trgrmap_final Transition groups of the selected calibrants (output)
+     *
+     * @return The selected pairs of (experimental RT, library RT)
+     *
+     * @throw Exception::IllegalArgument if not enough calibrants are found
+     *
+    */
+    std::vector<std::pair<double, double> > selectRTCalibrants_(const OpenSwath::LightTargetedExperiment& targeted_exp,
+      const std::vector< OpenMS::MSChromatogram >& chromatograms,
+      double min_rsq,
+      double min_coverage,
+      const Param& default_ffparam,
+      const Param& irt_detection_param,
+      OpenMS::MRMFeatureFinderScoring::TransitionGroupMapType& transition_group_map,
+      std::map<String, OpenMS::MRMFeatureFinderScoring::MRMTransitionGroupType *>& trgrmap_final);
+
+    /// Fit the RT transformation selected in @p irt_detection_param to the calibrant pairs
+    static TransformationDescription fitRTTransformation_(const std::vector<std::pair<double, double> >& pairs,
+      const Param& irt_detection_param);
+
   };
 
   /**
@@ -391,7 +530,7 @@ protected:
    *    - Obtain precursor ion chromatograms (if enabled) through MS1Extraction_()
    *    - Perform scoring of precursor ion chromatograms if no MS2 is given
    *    - Iterate through each SWATH-MS window:
-   *      - Select which transitions to extract (proceed in batches) using OpenSwathHelper::selectSwathTransitions()
+   *      - Retrieve the transitions of the current window from the partitioned library (see SwathWindowLibrary)
    *      - Iterate through each batch of transitions:
    *        - Extract current batch of transitions from current SWATH window:
    *          - Select transitions for current batch (see selectCompoundsForBatch_())
@@ -401,6 +540,12 @@ protected:
    *        - Score extracted transitions (see scoreAllChromatograms_())
    *        - Write scored chromatograms and peak groups to disk (see writeOutFeaturesAndChroms_())
    *
+   * With OpenMP task support, each batch of each window is an independent
+   * task (see performWindowExtraction_()) so that all threads stay busy
+   * regardless of how unevenly the assays are distributed over the windows.
+   * The number of windows that are held in memory at the same time is
+   * bounded by the threads_outer_loop constructor argument.
+   *
    */
   class OPENMS_DLLAPI OpenSwathWorkflow :
     public OpenSwathWorkflowBase
@@ -414,15 +559,10 @@ protected:
      *
      *  @param use_ms1_traces Whether to use MS1 data
      *  @param use_ms1_ion_mobility Whether to use ion mobility extraction on MS1 traces
-     *  @param threads_outer_loop How many threads should be used for the outer
-     *  loop (-1 will use all threads in the outer loop)
+     *  @param threads_outer_loop How many SWATH windows may be processed (and
+     *  held in memory) at the same time (-1 will use the number of threads)
      *  @param prm Whether data is acquired in targeted DIA (e.g. PRM mode) with potentially overlapping windows
      *
-     *  @note The total number of threads should be divisible by this number
-     *  (e.g. use 8 in outer loop if you have 24 threads in total and 3 will be
-     *  used for the inner loop).
-     *
-     *
      **/
     OpenSwathWorkflow(bool use_ms1_traces, bool use_ms1_ion_mobility, bool prm, bool pasef, int threads_outer_loop) :
     OpenSwathWorkflowBase(use_ms1_traces, use_ms1_ion_mobility, prm, pasef, threads_outer_loop)
@@ -469,8 +609,62 @@ protected:
                            int ms1_isotopes,
                            bool load_into_memory);
 
+    /** @brief Execute OpenSWATH analysis on a set of SwathMaps using a library partitioned by SWATH window.
+     *
+     * Same as above, but the assays of each SWATH window are only retrieved
+     * from \p assay_library when the corresponding map is processed. With an
+     * on-disk library (see SwathWindowLibrary) the full library is never held
+     * in memory and peak memory scales with the largest window.
+     *
+     * @param assay_library The assays, already partitioned using the same \p swath_maps (see SwathWindowLibrary::partition())
+     *
+     * @throw Exception::IllegalArgument if \p assay_library was not partitioned by \p swath_maps
+     *
+    */
+    void performExtraction(const std::vector< OpenSwath::SwathMap > & swath_maps,
+                           const TransformationDescription trafo,
+                           const ChromExtractParams & chromatogram_extraction_params,
+                           const ChromExtractParams & ms1_chromatogram_extraction_params,
+                           const Param & feature_finder_param,
+                           const SwathWindowLibrary& assay_library,
+                           FeatureMap& result_featureFile,
+                           bool store_features_in_featureFile,
+                           OpenSwathTSVWriter & result_tsv,
+                           OpenSwathOSWWriter & result_osw,
+                           Interfaces::IMSDataConsumer * result_chromatograms,
+                           int batchSize,
+                           int ms1_isotopes,
+                           bool load_into_memory);
+
   protected:
 
+    /** @brief Extract and score all assays of a single SWATH window
+     *
+     * Retrieves the assays of window @p window_idx from @p assay_library,
+     * loads the window into memory if requested and processes the assays in
+     * batches of @p batchSize compounds. With OpenMP task support, each batch
+     * is spawned as a separate task and the function returns once all of
+     * them are done; otherwise the batches are processed sequentially.
+     *
+     * See performExtraction() for the remaining parameters.
+    */
+    void performWindowExtraction_(Size window_idx,
+                                  const std::vector< OpenSwath::SwathMap > & swath_maps,
+                                  const TransformationDescription& trafo,
+                                  const TransformationDescription& trafo_inverse,
+                                  const ChromExtractParams & cp,
+                                  const ChromExtractParams & ms1_cp,
+                                  const Param & feature_finder_param,
+                                  const SwathWindowLibrary& assay_library,
+                                  FeatureMap& out_featureFile,
+                                  bool store_features,
+                                  OpenSwathTSVWriter & tsv_writer,
+                                  OpenSwathOSWWriter & osw_writer,
+                                  Interfaces::IMSDataConsumer * chromConsumer,
+                                  int batchSize,
+                                  int ms1_isotopes,
+                                  bool ms1_only,
+                                  bool load_into_memory);
 
     /** @brief Write output features and chromatograms
      *
@@ -663,6 +857,52 @@ protected:
                                  std::vector< OpenSwath::ChromatogramPtr > & chrom_list,
                                  const ChromExtractParams & cp);
 
+    /** @brief Extract chromatograms from a subset of the spectra and merge them with previously extracted subsets
+     *
+     * Extracts the chromatograms from every @p spectra_stride -th spectrum of
+     * each map, starting at @p offset (see SpectrumAccessStrided). The data
+     * points are merged by RT into the chromatograms of the same map and
+     * transition in @p chromatograms_per_map, which is empty before the first
+     * subset. Nothing is filtered at this stage, so once all subsets have been
+     * added, collectChromatograms_() yields the same chromatograms as
+     * simpleExtractChromatograms_() (also for transitions that are extracted
+     * from several overlapping windows).
+     *
+     * @param swath_maps The raw data (swath maps)
+     * @param irt_transitions A set of transitions used for the RT normalization peptides
+     * @param chromatograms_per_map The chromatograms of each map, in transition order (input/output)
+     * @param trafo Transformation description for RT normalization
+     * @param cp Parameter set for the chromatogram extraction
+     * @param spectra_stride Number of interleaved subsets each map is split into
+     * @param offset Index of the subset to extract (smaller than @p spectra_stride)
+     * @param load_into_memory Whether to cache the current subset of the SWATH map in memory
+     *
+    */
+    void extractChromatogramSubset_(const std::vector< OpenSwath::SwathMap > & swath_maps,
+                                    const OpenSwath::LightTargetedExperiment & irt_transitions,
+                                    std::vector< std::vector< OpenMS::MSChromatogram > > & chromatograms_per_map,
+                                    const TransformationDescription& trafo,
+                                    const ChromExtractParams & cp,
+                                    Size spectra_stride,
+                                    Size offset,
+                                    bool load_into_memory);
+
+    /** @brief Combine the chromatograms extracted per SWATH map
+     *
+     * Chromatograms without any intensity are skipped (this can happen if the
+     * extraction window is outside the acquisition window), the others are
+     * appended in map order. For SONAR data, the chromatograms of the same
+     * transition from different maps are added up.
+     *
+     * @param chromatograms_per_map The chromatograms of each map
+     * @param chromatograms The combined chromatograms (output)
+     * @param sonar Whether the data is SONAR data
+     *
+    */
+    static void collectChromatograms_(const std::vector< std::vector< OpenMS::MSChromatogram > > & chromatograms_per_map,
+                                      std::vector< OpenMS::MSChromatogram > & chromatograms,
+                                      bool sonar);
+
     /** @brief Add two chromatograms
      *
      * @param base_chrom The base chromatogram to which we will add intensity
@@ -0,0 +1,178 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/ANALYSIS/MAPMATCHING/TransformationDescription.h>
+#include <OpenMS/DATASTRUCTURES/String.h>
+#include <OpenMS/OPENSWATHALGO/DATAACCESS/SwathMap.h>
+#include <OpenMS/OPENSWATHALGO/DATAACCESS/TransitionExperiment.h>
+
+#include <vector>
+
+namespace OpenMS
+{
+
+  /**
+   * @brief Assay library partitioned by SWATH (precursor isolation) window
+   *
+   * Provides the assays (transitions, compounds and proteins) that need to be
+   * extracted from a given SWATH window. The library is partitioned once (see
+   * partition()) and the assays of a window are only materialized when
+   * requested through getWindowAssays(), e.g. right before the corresponding
+   * SwathMap is processed.
+   *
+   * Two modes are supported:
+   *  - in-memory: the full library is provided as
+   *    OpenSwath::LightTargetedExperiment and partition() stores only the
+   *    transition / compound / protein indices of each window (the library
+   *    needs to outlive this object)
+   *  - on-disk: the library is a PQP file and the assays of each window are
+   *    read from disk on demand (see
+   *    TransitionPQPFile::convertPQPToTargetedExperiment()). Peak memory then
+   *    scales with the largest window and not with the full library.
+   *
+   * In both modes, getWindowAssays() produces the same assays that
+   * OpenSwathHelper::selectSwathTransitions() would select from the full
+   * library.
+   *
+   * @note getWindowAssays() is thread-safe and may be called concurrently for different windows.
+   *
+   */
+  class OPENMS_DLLAPI SwathWindowLibrary
+  {
+
+  public:
+
+    /** @brief Construct from an in-memory assay library
+     *
+     * @param library The full assay library (a reference is stored, it needs to outlive this object)
+     */
+    explicit SwathWindowLibrary(const OpenSwath::LightTargetedExperiment& library);
+
+    /** @brief Construct from an assay library stored as PQP file
+     *
+     * @param pqp_file Input PQP file (will be read per window)
+     * @param legacy_traml_id Should legacy TraML IDs be used (boolean)?
+     */
+    explicit SwathWindowLibrary(const String& pqp_file, bool legacy_traml_id = false);
+
+    /** @brief Assign assays to SWATH windows by precursor m/z
+     *
+     * A transition is assigned to window i if its precursor m/z lies within
+     * the isolation window of swath_maps[i] and is at least \p
+     * min_upper_edge_dist away from its upper edge (this allows a precursor to
+     * be assigned to multiple overlapping windows). MS1 maps receive no assays.
+     *
+     * @param swath_maps The SWATH maps (only isolation window bounds are used)
+     * @param min_upper_edge_dist Minimal distance (in Th) of the precursor to the upper window edge
+     */
+    void partition(const std::vector<OpenSwath::SwathMap>& swath_maps, double min_upper_edge_dist);
+
+    /** @brief Assign assays to SWATH windows using an explicit transition to window map
+     *
+     * Used for PRM and diaPASEF data where each transition is extracted from a
+     * single best-matching window only.
+     *
+     * @param tr_win_map Maps transition k of the library to window tr_win_map[k] (-1 for none)
+     * @param nr_windows Total number of windows
+     *
+     * @throw Exception::IllegalArgument if the library is stored on disk or \p tr_win_map does not match the library
+     */
+    void partition(const std::vector<int>& tr_win_map, Size nr_windows);
+
+    /** @brief Retrieve the assays of a single SWATH window
+     *
+     * @param window_idx Index of the SWATH window (as passed to partition())
+     * @param assays Output: transitions, compounds and proteins of this window
+     *
+     * @throw Exception::IndexOverflow if the window index is invalid (or partition() was not called)
+     */
+    void getWindowAssays(Size window_idx, OpenSwath::LightTargetedExperiment& assays) const;
+
+    /// Retrieve all assays (loads the full library when stored on disk)
+    void getAllAssays(OpenSwath::LightTargetedExperiment& assays) const;
+
+    /// Number of windows the library is partitioned into
+    Size getNrWindows() const;
+
+    /// Total number of transitions in the library (counted in the PQP file when stored on disk)
+    Size getNrTransitions() const;
+
+    /// Whether the assays are read from disk on demand
+    bool isOnDisk() const;
+
+    /** @brief Set a drift time transformation applied to all retrieved compounds (theoretical -> experimental)
+     *
+     * Only needed in on-disk mode, an in-memory library can be corrected directly.
+     */
+    void setDriftTimeTransformation(const TransformationDescription& im_trafo);
+
+  protected:
+
+    /// Apply the drift time transformation (if any) to the compounds
+    void applyDriftTimeTransformation_(OpenSwath::LightTargetedExperiment& assays) const;
+
+    /// Per-window indices into the in-memory library
+    struct WindowIndex
+    {
+      std::vector<Size> transitions;
+      std::vector<Size> compounds;
+      std::vector<Size> proteins;
+    };
+
+    /// Compute compound and protein indices of each window from its transition indices
+    void completeWindowIndices_();
+
+    /// In-memory library (nullptr in on-disk mode)
+    const OpenSwath::LightTargetedExperiment* library_;
+
+    /// PQP file (empty in in-memory mode)
+    String pqp_file_;
+
+    bool legacy_traml_id_;
+
+    /// Per-window indices (in-memory mode)
+    std::vector<WindowIndex> window_index_;
+
+    /// Per-window isolation bounds (on-disk mode)
+    std::vector<OpenSwath::SwathMap> windows_;
+
+    double min_upper_edge_dist_;
+
+    TransformationDescription im_trafo_;
+
+    bool has_im_trafo_;
+  };
+}
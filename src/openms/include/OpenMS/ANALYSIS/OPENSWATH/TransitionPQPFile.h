@@ -223,9 +223,12 @@ private:
      * @param filename The input file
      * @param transition_list The output list of transitions
      * @param legacy_traml_id Should legacy TraML IDs be used (boolean)?
+     * @param precursor_filter Optional SQL condition on the PRECURSOR table
+     *        (e.g. a precursor m/z range), only matching precursors are read
      *
     */
-    void readPQPInput_(const char* filename, std::vector<TSVTransition>& transition_list, bool legacy_traml_id = false);
+    void readPQPInput_(const char* filename, std::vector<TSVTransition>& transition_list, bool legacy_traml_id = false,
+                       const String& precursor_filter = "");
 
     /** @brief Write a TargetedExperiment to a file
      *
@@ -270,6 +273,23 @@ public:
     */
     void convertPQPToTargetedExperiment(const char* filename, OpenSwath::LightTargetedExperiment& targeted_exp, bool legacy_traml_id = false);
 
+    /** @brief Read the assays of a single precursor isolation window from a PQP file (Light transition structure)
+     *
+     * Only precursors with \p precursor_mz_lower < m/z < \p precursor_mz_upper
+     * (and their transitions, compounds and proteins) are read, the rest of
+     * the file is never loaded into memory. This allows processing very large
+     * libraries window by window (see SwathWindowLibrary).
+     *
+     * @param filename The input file
+     * @param targeted_exp The output targeted experiment
+     * @param precursor_mz_lower Lower precursor m/z bound (exclusive)
+     * @param precursor_mz_upper Upper precursor m/z bound (exclusive)
+     * @param legacy_traml_id Should legacy TraML IDs be used (boolean)?
+     *
+    */
+    void convertPQPToTargetedExperiment(const char* filename, OpenSwath::LightTargetedExperiment& targeted_exp,
+                                        double precursor_mz_lower, double precursor_mz_upper, bool legacy_traml_id = false);
+
   };
 }
 
@@ -33,6 +33,7 @@ set(sources_list_h
   PeakPickerMRM.h
   SONARScoring.h
   SwathMapMassCorrection.h
+  SwathWindowLibrary.h
   SwathWindowLoader.h
   SwathQC.h
   SpectrumAddition.h
@@ -39,8 +39,7 @@
 #include <OpenMS/KERNEL/Feature.h>
 #include <OpenMS/DATASTRUCTURES/DefaultParamHandler.h>
 #include <OpenMS/ANALYSIS/MAPMATCHING/TransformationModelLowess.h>
-#include <OpenMS/DATASTRUCTURES/KDTree.h>
-#include <OpenMS/ANALYSIS/QUANTITATION/KDTreeFeatureNode.h>
+#include <OpenMS/DATASTRUCTURES/StaticKDTree.h>
 
 namespace OpenMS
 {
@@ -51,8 +50,8 @@ class OPENMS_DLLAPI KDTreeFeatureMaps : public DefaultParamHandler
 
 public:
 
-  /// 2D tree on features
-  typedef KDTree::KDTree<2,KDTreeFeatureNode> FeatureKDTree;
+  /// 2D tree on features (RT, m/z)
+  typedef StaticKDTree<2> FeatureKDTree;
 
   /// Default constructor
   KDTreeFeatureMaps() :
@@ -82,6 +81,16 @@ public:
   {
     num_maps_ = maps.size();
 
+    Size n = size();
+    for (Size i = 0; i < num_maps_; ++i)
+    {
+      n += maps[i].size();
+    }
+    features_.reserve(n);
+    map_index_.reserve(n);
+    rt_.reserve(n);
+    kd_tree_.reserve(n);
+
     for (Size i = 0; i < num_maps_; ++i)
     {
       const MapType& m = maps[i];
@@ -93,7 +102,7 @@ public:
     optimizeTree();
   }
 
-  /// Add feature
+  /// Add feature (call optimizeTree() after adding features)
   void addFeature(Size mt_map_index, const BaseFeature* feature);
 
   /// Return pointer to feature i
@@ -126,16 +135,16 @@ public:
   /// Clear all data
   void clear();
 
-  /// Optimize the kD tree
+  /// (Re-)build the kD tree
   void optimizeTree();
 
   /// Fill @p result with indices of all features compatible (wrt. RT, m/z, map index) to the feature with @p index
   void getNeighborhood(Size index, std::vector<Size>& result_indices, double rt_tol, double mz_tol, bool mz_ppm, bool include_features_from_same_map = false, double max_pairwise_log_fc = -1.0) const;
 
-  /// Fill @p result with indices of all features within the specified boundaries
+  /// Fill @p result with indices (in ascending order) of all features within the specified boundaries
   void queryRegion(double rt_low, double rt_high, double mz_low, double mz_high, std::vector<Size>& result_indices, Size ignored_map_index = std::numeric_limits<Size>::max()) const;
 
-  /// Apply RT transformations
+  /// Apply RT transformations (call optimizeTree() afterwards)
   void applyTransformations(const std::vector<TransformationModelLowess*>& trafos);
 
 protected:
@@ -154,7 +163,7 @@ protected:
   /// Number of maps
   Size num_maps_;
 
-  /// 2D tree on features from all input maps.
+  /// 2D tree on (potentially transformed) RT and m/z of features from all input maps.
   FeatureKDTree kd_tree_;
 
 };
@@ -254,13 +254,13 @@ protected:
    *
    * @param chromatogramConsumer The consumer to process chromatograms
    * @param exp_meta meta data about experiment
-   * @param transition_exp The spectral library
+   * @param nr_transitions Number of transitions in the spectral library (expected number of chromatograms)
    * @param out_chrom The output file for the chromatograms
    * @param run_id Unique identifier which links the sqMass and OSW file
    */
   void prepareChromOutput(Interfaces::IMSDataConsumer ** chromatogramConsumer,
                           const boost::shared_ptr<ExperimentalSettings>& exp_meta,
-                          const OpenSwath::LightTargetedExperiment& transition_exp,
+                          const Size nr_transitions,
                           const String& out_chrom,
                           const UInt64 run_id)
   {
@@ -276,8 +276,7 @@ protected:
       else
       {
         PlainMSDataWritingConsumer * chromConsumer = new PlainMSDataWritingConsumer(out_chrom);
-        int expected_chromatograms = transition_exp.transitions.size();
-        chromConsumer->setExpectedSize(0, expected_chromatograms);
+        chromConsumer->setExpectedSize(0, nr_transitions);
         chromConsumer->setExperimentalSettings(*exp_meta);
         chromConsumer->getOptions().setWriteIndex(true);  // ensure that we write the index
         chromConsumer->addDataProcessing(getProcessingInfo_(DataProcessing::SMOOTHING));
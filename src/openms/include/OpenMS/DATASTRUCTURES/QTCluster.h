@@ -41,8 +41,8 @@
 #include <OpenMS/config.h>
 
 #include <unordered_map>
+#include <unordered_set>
 
-#include <map> // for multimap<>
 #include <vector> // for vector<>
 #include <set> // for set<>
 #include <utility> // for pair<>
@@ -78,6 +78,10 @@ namespace OpenMS
      finalized, its elements have to be removed from the remaining clusters,
      and affected clusters change their composition. (Note that clusters can
      also be invalidated by this, if the cluster center is being removed.)
+     All potential cluster elements are kept (in flat arrays sorted by input
+     map and distance), so that removed elements can be replaced and the
+     quality recomputed without searching the neighborhood of the cluster
+     center again (see reselectNeighbors).
 
      The quality of a cluster is the normalized average distance to the cluster
      center for present and missing cluster elements. The distance value for
@@ -108,10 +112,6 @@ namespace OpenMS
   {
 public:
 
-    // need to store more than one
-    typedef std::multimap<double, const GridFeature*> NeighborList;
-    typedef std::unordered_map<Size, NeighborList> NeighborMapMulti;
-
     struct Neighbor
     {
       double distance;
@@ -120,6 +120,27 @@ public:
 
     typedef std::unordered_map<Size, Neighbor> NeighborMap;
 
+    /// Potential cluster element (neighbor from another input map)
+    struct Candidate
+    {
+      Size map_index;
+      double distance;
+      const GridFeature* feature;
+      /// Position in the sorted candidate list (see BulkData::candidates_)
+      Size order;
+    };
+
+    /// Peptide annotation of a potential cluster element (unannotated elements use an empty sequence)
+    struct AnnotatedCandidate
+    {
+      const AASequence* sequence;
+      Size map_index;
+      double distance;
+      const GridFeature* feature;
+      /// Position of the element in the sorted candidate list
+      Size order;
+    };
+
     struct Element
     {
       Size map_index;
@@ -166,13 +187,25 @@ public:
         NeighborMap neighbors_;
 
         /**
-         * @brief Temporary map tracking *all* neighbors
+         * @brief All potential cluster elements
          *
-         * For each input run, a multimap which contains pointers to all
-         * neighboring elements and the respective distance.
+         * After finalizing the cluster, sorted by map index and distance (ties
+         * in the order in which the elements were added). Elements that were
+         * used by other clusters are removed in reselectNeighbors.
+         */
+        std::vector<Candidate> candidates_;
+
+        /**
+         * @brief Annotations of all potential cluster elements
          *
+         * Only used if the optimal annotation of the cluster has to be determined
+         * (see QTCluster::optimizeAnnotations_). Sorted by sequence, map index,
+         * distance and position in @p candidates_.
          */
-        NeighborMapMulti tmp_neighbors_;
+        std::vector<AnnotatedCandidate> annotated_candidates_;
+
+        /// Are @p candidates_ (and @p annotated_candidates_) sorted?
+        bool candidates_sorted_;
 
         /// Maximum distance of a point that can still belong to the cluster
         double max_distance_;
@@ -306,6 +339,19 @@ public:
     /// Get all current neighbors
     Elements getAllNeighbors() const;
 
+    /**
+     * @brief Re-selects the best neighbor per input map after elements were removed
+     *
+     * Instead of searching the neighborhood of the cluster center again, the
+     * stored potential cluster elements that are not in @p used are considered.
+     * The result is the same as re-initializing the cluster and adding all unused
+     * neighbors again, but the distances do not have to be recomputed.
+     * The quality (and the annotation, if ids are used) is updated.
+     *
+     * @param used Features that were already used by other clusters
+     */
+    void reselectNeighbors(const std::unordered_set<const GridFeature*>& used);
+
     private:
       /// Computes the quality of the cluster
       void computeQuality_();
@@ -322,17 +368,16 @@ public:
        * The function thus iterates through all possible peptide ids and selects
        * the one producing the best cluster.
        *
-       * This function needs access to all possible neighbors for this cluster
-       * and thus can only be run when tmp_neighbors_ is filled (which is during
-       * the filling of a cluster). The function thus cannot be called after
-       * finalizing the cluster.
+       * The annotations of all potential cluster elements are kept in a flat
+       * array sorted by sequence and input map, so the best distance per
+       * sequence and map is found in one pass over this array.
        *
        * @returns The total distance between cluster elements and the center.
        */
       double optimizeAnnotations_();
 
-      /// compute seq table, mapping: peptides -> best distance per input map
-      void makeSeqTable_(std::map<AASequence, std::map<Size,double>>& seq_table) const;
+      /// sort the potential cluster elements (and their annotations) if necessary
+      void sortCandidates_();
       
       /// report elements that are compatible with the optimal annotation
       void recomputeNeighbors_();
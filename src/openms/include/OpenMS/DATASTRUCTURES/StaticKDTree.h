@@ -0,0 +1,312 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/CONCEPT/Types.h>
+#include <OpenMS/config.h>
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace OpenMS
+{
+
+  /**
+    @brief A static, array-backed kd-tree for orthogonal range queries on points in @p D dimensions
+
+    Points are added with insert() and identified by their insertion index.
+    optimize() (re-)builds the tree over all points: the points are
+    recursively split at the median of the dimension with the largest
+    spread, until at most @p BucketSize points remain in a leaf. The tree
+    is stored implicitly (children of node @em k are @em 2k+1 and
+    @em 2k+2), only the split dimension and value of each inner node are
+    kept, and the coordinates are copied into contiguous per-dimension
+    arrays in tree order, so that leaf buckets can be scanned with
+    vectorized comparisons.
+
+    Points inserted after the last call to optimize() are not part of the
+    tree structure yet; they are still reported by queries (by a linear scan),
+    so the tree is always consistent, but should be re-optimized after
+    larger insertions.
+
+    Queries are const and can be run concurrently.
+
+    @ingroup Datastructures
+  */
+  template <UInt D, UInt BucketSize = 32>
+  class StaticKDTree
+  {
+public:
+
+    /// Point type
+    typedef std::array<double, D> PointType;
+
+    /// Default constructor
+    StaticKDTree() = default;
+
+    /// Number of points (including those not yet optimized)
+    Size size() const
+    {
+      return points_.size();
+    }
+
+    /// Returns if no points are stored
+    bool empty() const
+    {
+      return points_.empty();
+    }
+
+    /// Removes all points
+    void clear()
+    {
+      points_.clear();
+      reset_();
+    }
+
+    /// Reserves memory for @p n points
+    void reserve(Size n)
+    {
+      points_.reserve(n);
+    }
+
+    /// Adds a point (its index is the previous size()); call optimize() after adding points
+    void insert(const PointType& point)
+    {
+      points_.push_back(point);
+    }
+
+    /// Returns the point with index @p i
+    const PointType& point(Size i) const
+    {
+      return points_[i];
+    }
+
+    /// Sets the coordinates of point @p i; call optimize() after changing points
+    void setPoint(Size i, const PointType& point)
+    {
+      points_[i] = point;
+      if (i < tree_size_)
+      {
+        // the tree structure is invalid now, treat all points as not optimized
+        reset_();
+      }
+    }
+
+    /// (Re-)builds the tree over all points
+    void optimize()
+    {
+      reset_();
+      const Size n = points_.size();
+      index_.resize(n);
+      std::iota(index_.begin(), index_.end(), Size(0));
+      build_(0, 0, n);
+
+      // copy coordinates in tree order
+      for (UInt d = 0; d < D; ++d)
+      {
+        coords_[d].resize(n);
+        for (Size slot = 0; slot < n; ++slot)
+        {
+          coords_[d][slot] = points_[index_[slot]][d];
+        }
+      }
+      tree_size_ = n;
+    }
+
+    /**
+      @brief Appends the indices of all points within the (closed) box [@p low, @p high] to @p result
+
+      The indices are appended in no particular order.
+    */
+    void findWithinRange(const PointType& low, const PointType& high, std::vector<Size>& result) const
+    {
+      if (tree_size_ > 0)
+      {
+        // explicit stack of (node, first slot, end slot)
+        std::vector<std::array<Size, 3> > stack;
+        stack.push_back({0, 0, tree_size_});
+        while (!stack.empty())
+        {
+          const Size node = stack.back()[0], lo = stack.back()[1], hi = stack.back()[2];
+          stack.pop_back();
+          if (hi - lo <= BucketSize)
+          {
+            scanBucket_(lo, hi, low, high, result);
+            continue;
+          }
+          // elements left of the median are not greater than the split value, elements right of it are not smaller
+          const Size mid = lo + (hi - lo) / 2;
+          const UInt dim = split_dim_[node];
+          const double split = split_value_[node];
+          if (high[dim] >= split)
+          {
+            stack.push_back({2 * node + 2, mid, hi});
+          }
+          if (low[dim] <= split)
+          {
+            stack.push_back({2 * node + 1, lo, mid});
+          }
+        }
+      }
+
+      // points not yet in the tree
+      for (Size i = tree_size_; i < points_.size(); ++i)
+      {
+        if (contains_(low, high, points_[i]))
+        {
+          result.push_back(i);
+        }
+      }
+    }
+
+protected:
+
+    /// Drops the tree structure (but not the points)
+    void reset_()
+    {
+      tree_size_ = 0;
+      index_.clear();
+      split_dim_.clear();
+      split_value_.clear();
+      for (UInt d = 0; d < D; ++d)
+      {
+        coords_[d].clear();
+      }
+    }
+
+    /// Recursively builds the subtree rooted at @p node over slots [@p lo, @p hi)
+    void build_(Size node, Size lo, Size hi)
+    {
+      if (hi - lo <= BucketSize)
+      {
+        return;
+      }
+
+      // split the dimension with the largest spread
+      UInt dim = 0;
+      double max_spread = -1.0;
+      for (UInt d = 0; d < D; ++d)
+      {
+        double min_value = points_[index_[lo]][d], max_value = min_value;
+        for (Size slot = lo + 1; slot < hi; ++slot)
+        {
+          const double value = points_[index_[slot]][d];
+          min_value = std::min(min_value, value);
+          max_value = std::max(max_value, value);
+        }
+        if (max_value - min_value > max_spread)
+        {
+          max_spread = max_value - min_value;
+          dim = d;
+        }
+      }
+
+      const Size mid = lo + (hi - lo) / 2;
+      std::nth_element(index_.begin() + lo, index_.begin() + mid, index_.begin() + hi,
+                       [this, dim](Size a, Size b) { return points_[a][dim] < points_[b][dim]; });
+
+      if (split_dim_.size() <= node)
+      {
+        split_dim_.resize(node + 1);
+        split_value_.resize(node + 1);
+      }
+      split_dim_[node] = dim;
+      split_value_[node] = points_[index_[mid]][dim];
+
+      build_(2 * node + 1, lo, mid);
+      build_(2 * node + 2, mid, hi);
+    }
+
+    /// Appends the indices of points in leaf slots [@p lo, @p hi) that are within the box
+    void scanBucket_(Size lo, Size hi, const PointType& low, const PointType& high, std::vector<Size>& result) const
+    {
+      const Size n = hi - lo;
+      unsigned char inside[BucketSize];
+      std::fill(inside, inside + n, 1);
+      for (UInt d = 0; d < D; ++d)
+      {
+        const double* c = coords_[d].data() + lo;
+        const double l = low[d], h = high[d];
+#pragma omp simd
+        for (Size k = 0; k < n; ++k)
+        {
+          inside[k] &= (unsigned char)((c[k] >= l) & (c[k] <= h));
+        }
+      }
+      for (Size k = 0; k < n; ++k)
+      {
+        if (inside[k])
+        {
+          result.push_back(index_[lo + k]);
+        }
+      }
+    }
+
+    /// Is @p point within the (closed) box?
+    static bool contains_(const PointType& low, const PointType& high, const PointType& point)
+    {
+      for (UInt d = 0; d < D; ++d)
+      {
+        if (point[d] < low[d] || point[d] > high[d])
+        {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    /// Points in insertion order
+    std::vector<PointType> points_;
+
+    /// Number of points in the tree structure (the remaining ones are scanned linearly)
+    Size tree_size_ = 0;
+
+    /// Insertion index of the point at each slot (tree order)
+    std::vector<Size> index_;
+
+    /// Coordinates per dimension (tree order)
+    std::array<std::vector<double>, D> coords_;
+
+    /// Split dimension of inner nodes
+    std::vector<UInt> split_dim_;
+
+    /// Split value of inner nodes
+    std::vector<double> split_value_;
+  };
+
+} // namespace OpenMS
@@ -38,6 +38,7 @@ OSWData.h
 Param.h
 ParamValue.h
 QTCluster.h
+StaticKDTree.h
 String.h
 StringUtils.h
 StringUtilsSimple.h
@@ -40,7 +40,9 @@
 #include <OpenMS/CONCEPT/ProgressLogger.h>
 #include <OpenMS/KERNEL/MSChromatogram.h>
 #include <OpenMS/CHEMISTRY/Element.h>
+#include <OpenMS/CHEMISTRY/EmpiricalFormula.h>
 
+#include <map>
 #include <vector>
 
 struct svm_model;
@@ -303,6 +305,22 @@ private:
     */
     double computeAveragineSimScore_(const std::vector<double>& intensities, const double& molecular_weight) const;
 
+    /// Normalized averagine isotope intensities, keyed by number of isotopes and averagine sum formula
+    typedef std::map<std::pair<Size, EmpiricalFormula>, std::vector<double> > AveragineRatioCache;
+
+    /** @brief Perform intensity scoring using the averagine model, memoizing the averagine ratios
+     *
+     * Same as computeAveragineSimScore_(const std::vector<double>&, const double&) const,
+     * but the theoretical isotope ratios are looked up in (or added to) @p
+     * cache. The averagine model only depends on the (integer) sum formula
+     * estimated from the weight, so all weights within the same mass bin of a
+     * sum formula share one entry and the scores are identical to the
+     * uncached version.
+     *
+     * @note The cache is not synchronized, use one cache per thread.
+    */
+    double computeAveragineSimScore_(const std::vector<double>& intensities, const double& molecular_weight, AveragineRatioCache& cache) const;
+
     /** @brief Identify groupings of mass traces based on a set of reasonable candidates
      *
      * Takes a set of reasonable candidates for mass trace grouping and checks
@@ -310,8 +328,11 @@ private:
      * is assumed that candidates[0] is the monoisotopic trace.
      *
      * The resulting possible groupings are appended to output_hypotheses.
+     *
+     * @note Neither @p output_hypotheses nor @p averagine_cache are
+     * synchronized, each thread needs to use its own.
     */
-    void findLocalFeatures_(const std::vector<const MassTrace*>& candidates, double total_intensity, std::vector<FeatureHypothesis>& output_hypotheses) const;
+    void findLocalFeatures_(const std::vector<const MassTrace*>& candidates, double total_intensity, std::vector<FeatureHypothesis>& output_hypotheses, AveragineRatioCache& averagine_cache) const;
 
     /// SVM parameters
     svm_model* isotope_filt_svm_ = nullptr;
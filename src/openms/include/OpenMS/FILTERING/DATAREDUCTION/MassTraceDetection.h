@@ -35,11 +35,16 @@
 #pragma once
 
 #include <OpenMS/KERNEL/StandardTypes.h>
+#include <OpenMS/KERNEL/FlatPeakIndex.h>
 #include <OpenMS/KERNEL/MassTrace.h>
 #include <OpenMS/KERNEL/MSExperiment.h>
 #include <OpenMS/DATASTRUCTURES/DefaultParamHandler.h>
 #include <OpenMS/CONCEPT/ProgressLogger.h>
 
+#include <boost/dynamic_bitset_fwd.hpp>
+
+#include <list>
+
 namespace OpenMS
 {
 
@@ -65,6 +70,12 @@ namespace OpenMS
       length as well as having the minimal sample rate criterion fulfilled) get
       added to the result.
 
+      If OpenMP is enabled, the traces are extended speculatively in parallel
+      batches and accepted in the order of decreasing apex intensity. Traces
+      whose extension was affected by a trace accepted earlier in the same
+      batch are re-extended, so the result is identical to a single-threaded
+      run.
+
       @htmlinclude OpenMS_MassTraceDetection.parameters
 
       @ingroup Quantitation
@@ -118,6 +129,25 @@ namespace OpenMS
                   std::vector<MassTrace> & found_masstraces,
                   const Size max_traces = 0);
 
+        /**
+          @brief Extend a single apex into a mass trace in both RT directions
+
+          Peaks marked in @p peak_visited are skipped. If @p probed_idx is given,
+          the flat indices of all unvisited peaks whose visited state influenced
+          the extension are appended to it.
+
+          @return Whether the trace fulfills the length and sample rate criteria
+        */
+        bool extendTrace_(const Apex& apex,
+                          const PeakMap& work_exp,
+                          const FlatPeakIndex& peak_index,
+                          const boost::dynamic_bitset<>& peak_visited,
+                          const int fwhm_meta_idx,
+                          std::list<PeakType>& current_trace,
+                          std::vector<double>& fwhms_mz,
+                          std::vector<std::pair<Size, Size> >& gathered_idx,
+                          std::vector<Size>* probed_idx);
+
         // parameter stuff
         double mass_error_ppm_;
         double noise_threshold_int_;
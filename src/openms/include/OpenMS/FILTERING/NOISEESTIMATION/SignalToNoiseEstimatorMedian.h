@@ -42,6 +42,7 @@
 #include <OpenMS/DATASTRUCTURES/ListUtils.h>
 #include <vector>
 #include <algorithm> //for std::max_element
+#include <numeric>
 
 namespace OpenMS
 {
@@ -71,6 +72,15 @@ namespace OpenMS
     @note If more than 1 percent of median estimations had to rely on the last(=rightmost) bin (which gives an unreliable result), a warning is issued to <i>OPENMS_LOG_WARN</i>.  In this case you should increase <i>max_intensity</i> (and optionally the <i>bin_count</i>). 
     @note You can disable logging this error by setting <i>write_log_messages</i> and read out the values 
 
+    If <i>exact_median</i> is set, the histogram is replaced by an order
+    statistic (a Fenwick tree over the intensity ranks of the scan) which is
+    updated incrementally while the window slides across the scan. The noise
+    is then the exact (lower) median of the window in O(log n) per data point,
+    independent of <i>bin_count</i> and <i>max_intensity</i>.
+
+    Many scans (e.g. all spectra of an experiment) can be processed in parallel
+    using computeSTNBatch().
+
 
         @htmlinclude OpenMS_SignalToNoiseEstimatorMedian.parameters
 
@@ -133,6 +143,9 @@ public:
 
       defaults_.setValue("noise_for_empty_window", std::pow(10.0, 20), "noise value used for sparse windows", {"advanced"});
 
+      defaults_.setValue("exact_median", "false", "Use the exact median of each window instead of the histogram approximation (the histogram parameters are then ignored).", {"advanced"});
+      defaults_.setValidStrings("exact_median", {"true","false"});
+
       defaults_.setValue("write_log_messages", "true", "Write out log messages in case of sparse windows or median in rightmost histogram bin");
       defaults_.setValidStrings("write_log_messages", {"true","false"});
 
@@ -177,6 +190,45 @@ public:
       return histogram_oob_percent_;
     }
 
+    /**
+      @brief Computes the S/N values of all data points of several containers (e.g. all spectra of an experiment)
+
+      The containers are processed in parallel (OpenMP) if available, each
+      thread using its own copy of this estimator. The result is the same as
+      calling init() and getSignalToNoise() for each container in turn.
+
+      @param containers the data, usually the spectra of an MSExperiment
+      @param stn_values the S/N values, one vector (of the size of the container) per container
+
+      @exception Exception::InvalidValue is thrown if the histogram is used with 'auto_mode' MANUAL and a non-positive 'max_intensity'
+    */
+    void computeSTNBatch(const std::vector<Container>& containers, std::vector<std::vector<double> >& stn_values) const
+    {
+      if (!exact_median_ && auto_mode_ == MANUAL && max_intensity_ <= 0)
+      {
+        throw Exception::InvalidValue(__FILE__,
+                                      __LINE__,
+                                      OPENMS_PRETTY_FUNCTION,
+                                      "auto_mode is on MANUAL! max_intensity is <=0. Needs to be positive! Use setMaxIntensity(<value>) or enable auto_mode!",
+                                      String(max_intensity_));
+      }
+
+      stn_values.clear();
+      stn_values.resize(containers.size());
+#pragma omp parallel
+      {
+        // the estimates are stored in the estimator, so every thread needs its own
+        SignalToNoiseEstimatorMedian estimator(*this);
+        estimator.setLogType(ProgressLogger::NONE);
+#pragma omp for schedule(dynamic)
+        for (SignedSize i = 0; i < (SignedSize)containers.size(); ++i)
+        {
+          estimator.init(containers[i]);
+          stn_values[i].swap(estimator.stn_estimates_);
+        }
+      }
+    }
+
 protected:
 
 
@@ -187,6 +239,12 @@ protected:
     */
     void computeSTN_(const Container& c) override
     {
+      if (exact_median_)
+      {
+        computeSTNExact_(c);
+        return;
+      }
+
       //first element in the scan
       PeakIterator scan_first_ = c.begin();
       //last element in the scan
@@ -393,6 +451,115 @@ protected:
 
     } // end of shiftWindow_
 
+    /** Calculate signal-to-noise values for all data points given, using the exact median of each window
+
+        Same sliding window as computeSTN_(), but the intensities in the window are kept in a
+        Fenwick tree indexed by their rank in the scan, which yields the median in O(log n).
+
+        @param c Raw data, usually an MSSpectrum
+    */
+    void computeSTNExact_(const Container& c)
+    {
+      const Size n = c.size();
+
+      // reset counter for sparse windows
+      sparse_window_percent_ = 0;
+      // no histogram involved
+      histogram_oob_percent_ = 0;
+
+      // reset the results
+      stn_estimates_.clear();
+      stn_estimates_.resize(n);
+      if (n == 0) return;
+
+      // rank of each data point by intensity (ties broken by position)
+      std::vector<Size> by_intensity(n);
+      std::iota(by_intensity.begin(), by_intensity.end(), 0);
+      std::stable_sort(by_intensity.begin(), by_intensity.end(), [&c](Size a, Size b) { return c[a].getIntensity() < c[b].getIntensity(); });
+      std::vector<Size> rank(n);
+      std::vector<double> sorted_intensity(n);
+      for (Size r = 0; r < n; ++r)
+      {
+        rank[by_intensity[r]] = r;
+        sorted_intensity[r] = c[by_intensity[r]].getIntensity();
+      }
+
+      // Fenwick tree counting the ranks currently in the window
+      std::vector<int> tree(n + 1, 0);
+      auto update = [&tree, n](Size r, int delta)
+      {
+        for (Size i = r + 1; i <= n; i += i & (~i + 1)) tree[i] += delta;
+      };
+      Size top_step = 1;
+      while (top_step * 2 <= n) top_step *= 2;
+      // rank of the k-th smallest element (k >= 1) in the window
+      auto kth = [&tree, n, top_step](int k)
+      {
+        Size pos = 0;
+        for (Size step = top_step; step > 0; step /= 2)
+        {
+          if (pos + step <= n && tree[pos + step] < k)
+          {
+            pos += step;
+            k -= tree[pos];
+          }
+        }
+        return pos;
+      };
+
+      const double window_half_size = win_len_ / 2;
+      Size borderleft = 0;
+      Size borderright = 0;
+      int elements_in_window = 0;
+
+      SignalToNoiseEstimator<Container>::startProgress(0, n, "noise estimation of data");
+      for (Size center = 0; center < n; ++center)
+      {
+        // erase all elements that leave the window on the LEFT side
+        while (c[borderleft].getMZ() < c[center].getMZ() - window_half_size)
+        {
+          update(rank[borderleft], -1);
+          --elements_in_window;
+          ++borderleft;
+        }
+
+        // add all elements that enter the window on the RIGHT side
+        while (borderright != n && c[borderright].getMZ() <= c[center].getMZ() + window_half_size)
+        {
+          update(rank[borderright], 1);
+          ++elements_in_window;
+          ++borderright;
+        }
+
+        double noise;
+        if (elements_in_window < min_required_elements_)
+        {
+          noise = noise_for_empty_window_;
+          ++sparse_window_percent_;
+        }
+        else
+        {
+          // lower median, i.e. element ceil[elements_in_window/2]; avoid division by 0
+          noise = std::max(1.0, sorted_intensity[kth((elements_in_window + 1) / 2)]);
+        }
+
+        stn_estimates_[center] = c[center].getIntensity() / noise;
+        SignalToNoiseEstimator<Container>::setProgress(center + 1);
+      }
+      SignalToNoiseEstimator<Container>::endProgress();
+
+      sparse_window_percent_ = sparse_window_percent_ * 100 / n;
+
+      // warn if percentage of sparse windows is above 20%
+      if (sparse_window_percent_ > 20 && write_log_messages_)
+      {
+        OPENMS_LOG_WARN << "WARNING in SignalToNoiseEstimatorMedian: "
+                 << sparse_window_percent_
+                 << "% of all windows were sparse. You should consider increasing 'win_len' or decreasing 'min_required_elements'"
+                 << std::endl;
+      }
+    }
+
     /// overridden function from DefaultParamHandler to keep members up to date, when a parameter is changed
     void updateMembers_() override
     {
@@ -405,6 +572,7 @@ protected:
       min_required_elements_   = param_.getValue("min_required_elements");
       noise_for_empty_window_  = (double)param_.getValue("noise_for_empty_window");
       write_log_messages_      = (bool)param_.getValue("write_log_messages").toBool();
+      exact_median_            = param_.getValue("exact_median").toBool();
       stn_estimates_.clear();
     }
 
@@ -429,6 +597,9 @@ protected:
     // whether to write out log messages in the case of failure
     bool write_log_messages_;
 
+    /// use the exact median (order statistic) instead of the histogram
+    bool exact_median_;
+
     // counter for sparse windows
     double sparse_window_percent_;
     // counter for histogram overflow
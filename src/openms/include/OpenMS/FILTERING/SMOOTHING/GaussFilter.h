@@ -92,6 +92,8 @@ public:
     /**
       @brief Smoothes an MSExperiment containing profile data.
 
+      Spectra and chromatograms are smoothed in parallel (OpenMP) if available.
+
       @exception Exception::IllegalArgument is thrown, if the @em gaussian_width parameter is too small.
     */
     void filterExperiment(PeakMap & map);
@@ -38,6 +38,7 @@
 #include <OpenMS/CONCEPT/Constants.h>
 #include <OpenMS/INTERFACES/DataStructures.h>
 #include <cmath>
+#include <iterator>
 #include <vector>
 
 namespace OpenMS
@@ -78,7 +79,7 @@ public:
     /**
       @brief Smoothes an Spectrum containing profile data.
     */
-    bool filter(OpenMS::Interfaces::SpectrumPtr spectrum)
+    bool filter(OpenMS::Interfaces::SpectrumPtr spectrum) const
     {
       // create new arrays for mz / intensity data and set their size
       OpenMS::Interfaces::BinaryDataArrayPtr intensity_array(new OpenMS::Interfaces::BinaryDataArray);
@@ -102,7 +103,7 @@ public:
     /**
       @brief Smoothes an Chromatogram containing profile data.
     */
-    bool filter(OpenMS::Interfaces::ChromatogramPtr chromatogram)
+    bool filter(OpenMS::Interfaces::ChromatogramPtr chromatogram) const
     {
       // create new arrays for rt / intensity data and set their size
       OpenMS::Interfaces::BinaryDataArrayPtr intensity_array(new OpenMS::Interfaces::BinaryDataArray);
@@ -127,6 +128,12 @@ public:
       @brief Smoothes an two data arrays containing data.
 
       Convolutes the filter and the profile data and writes the results into the output iterators mz_out and int_out. 
+
+      Uniformly spaced data (e.g. chromatograms) is convolved with a kernel
+      which is tabulated once at the data spacing. Otherwise the kernel is
+      interpolated for each pair of data points; if the ppm tolerance is used,
+      the kernel coefficients for the current width are only evaluated where
+      needed.
     */
     template <typename ConstIterT, typename IterT>
     bool filter(
@@ -134,21 +141,57 @@ public:
         ConstIterT mz_in_end,
         ConstIterT int_in_start,
         IterT mz_out,
-        IterT int_out)
+        IterT int_out) const
     {
       bool found_signal = false;
 
+      // check the spacing on the input, only uniformly spaced data is copied into contiguous buffers
+      double spacing;
+      if (!use_ppm_tolerance_ && isUniformlySpaced_(mz_in_start, mz_in_end, spacing))
+      {
+        std::vector<double> mz(mz_in_start, mz_in_end);
+        std::vector<double> intensities(int_in_start, int_in_start + mz.size());
+        std::vector<double> smoothed;
+        filterUniform_(mz, intensities, spacing, smoothed);
+        for (Size i = 0; i < mz.size(); ++i)
+        {
+          *mz_out = mz[i];
+          *int_out = smoothed[i];
+          ++mz_out;
+          ++int_out;
+
+          if (fabs(smoothed[i]) > 0) found_signal = true;
+        }
+        return found_signal;
+      }
+
+      // coefficients of the kernel for the current m/z (ppm tolerance only), evaluated on demand
+      std::vector<double> ppm_coeffs;
+      double ppm_sigma = sigma_;
+
       ConstIterT mz_it = mz_in_start;
       ConstIterT int_it = int_in_start;
       for (; mz_it != mz_in_end; mz_it++, int_it++)
       {
+        double new_int;
         // if ppm tolerance is used, calculate a reasonable width value for this m/z
         if (use_ppm_tolerance_)
         {
-          initialize((*mz_it) * ppm_tolerance_ * 10e-6, spacing_, ppm_tolerance_, use_ppm_tolerance_ );
+          ppm_sigma = (*mz_it) * ppm_tolerance_ * 10e-6 / 8.0;
+          ppm_coeffs.assign(numberOfCoefficients_(ppm_sigma), -1.0);
+          auto coeff = [&](Size i)
+          {
+            double& c = ppm_coeffs[i];
+            if (c < 0) c = coefficient_(ppm_sigma, i);
+            return c;
+          };
+          new_int = integrate_(mz_it, int_it, mz_in_start, mz_in_end, coeff, ppm_coeffs.size());
+        }
+        else
+        {
+          auto coeff = [this](Size i) { return coeffs_[i]; };
+          new_int = integrate_(mz_it, int_it, mz_in_start, mz_in_end, coeff, coeffs_.size());
         }
-
-        double new_int = integrate_(mz_it, int_it, mz_in_start, mz_in_end);
         
         // store new intensity and m/z into output iterator
         *mz_out = *mz_it;
@@ -176,18 +219,113 @@ protected:
     bool use_ppm_tolerance_;
     double ppm_tolerance_;
 
-    /// Computes the convolution of the raw data at position x and the gaussian kernel
-    template <typename InputPeakIterator>
-    double integrate_(InputPeakIterator x /* mz */, InputPeakIterator y /* int */, InputPeakIterator first, InputPeakIterator last)
+    /// Number of kernel coefficients (from the center to 4 sigma) tabulated for standard deviation @p sigma
+    Size numberOfCoefficients_(double sigma) const
+    {
+      return (Size)(ceil(4 * sigma / spacing_)) + 1;
+    }
+
+    /// Kernel coefficient @p i (at distance i * spacing_ from the center) for standard deviation @p sigma
+    double coefficient_(double sigma, Size i) const
+    {
+      if (i == 0) return 1.0 / (sigma * sqrt(2.0 * Constants::PI));
+      return 1.0 / (sigma * sqrt(2.0 * Constants::PI)) * exp(-((i * spacing_) * (i * spacing_)) / (2 * sigma * sigma));
+    }
+
+    /**
+      @brief Checks whether the positions in [@p first, @p last) are uniformly spaced (and at least three).
+
+      @param spacing    the spacing of the positions (if uniform)
+    */
+    template <typename ConstIterT>
+    static bool isUniformlySpaced_(ConstIterT first, ConstIterT last, double& spacing)
+    {
+      const Size n = std::distance(first, last);
+      if (n < 3)
+      {
+        return false;
+      }
+      ConstIterT back = first;
+      std::advance(back, n - 1);
+      spacing = (*back - *first) / (n - 1);
+      if (!(spacing > 0))
+      {
+        return false;
+      }
+      // spacing has to be uniform up to rounding errors of the stored positions
+      double previous = *first;
+      for (++first; first != last; ++first)
+      {
+        if (fabs((*first - previous) - spacing) > 1e-8 * spacing)
+        {
+          return false;
+        }
+        previous = *first;
+      }
+      return true;
+    }
+
+    /**
+      @brief Smoothes uniformly spaced data with the pre-tabulated kernel.
+
+      The kernel is interpolated once at multiples of the data spacing @p h and
+      applied as a plain weighted sum. The integration window matches
+      integrate_(), only the distances are taken from the (uniform) grid.
+
+      @note @p x has to be uniformly spaced (see isUniformlySpaced_()).
+    */
+    void filterUniform_(const std::vector<double>& x, const std::vector<double>& y, double h, std::vector<double>& smoothed) const;
+
+    /// Linearly interpolates the kernel at @p distance_in_gaussian between the coefficients tabulated at multiples of spacing_
+    template <typename CoeffAccess>
+    double interpolateKernel_(double distance_in_gaussian, const CoeffAccess& coeff, Size middle) const
+    {
+      // search for the corresponding datapoint in the gaussian (take the left most adjacent point)
+      int left_position = (int)floor(distance_in_gaussian / spacing_);
+
+      // search for the true left adjacent data point (because of rounding errors)
+      for (int j = 0; j < 3; ++j)
+      {
+        if (((left_position - j) * spacing_ <= distance_in_gaussian) && ((left_position - j + 1) * spacing_ >= distance_in_gaussian))
+        {
+          left_position -= j;
+          break;
+        }
+
+        if (((left_position + j) * spacing_ < distance_in_gaussian) && ((left_position + j + 1) * spacing_ < distance_in_gaussian))
+        {
+          left_position += j;
+          break;
+        }
+      }
+
+      // interpolate between the left and right data points in the gaussian to get the true value at position distance_in_gaussian
+      Size right_position = left_position + 1;
+      double d = fabs((left_position * spacing_) - distance_in_gaussian) / spacing_;
+      // check if the right data point in the gaussian exists
+      return (right_position < middle) ? (1 - d) * coeff(left_position) + d * coeff(right_position)
+                                       : coeff(left_position);
+    }
+
+    /**
+      @brief Computes the convolution of the raw data at position x and the gaussian kernel
+
+      @p coeff returns the kernel coefficient at a multiple of spacing_, @p middle is the number of coefficients.
+    */
+    template <typename InputPeakIterator, typename CoeffAccess>
+    double integrate_(InputPeakIterator x /* mz */, InputPeakIterator y /* int */, InputPeakIterator first, InputPeakIterator last,
+                      const CoeffAccess& coeff, Size middle) const
     {
       double v = 0.;
       // norm the gaussian kernel area to one
       double norm = 0.;
-      Size middle = coeffs_.size();
 
       double start_pos = (( (*x) - (middle * spacing_)) > (*first)) ? ((*x) - (middle * spacing_)) : (*first);
       double end_pos = (( (*x) + (middle * spacing_)) < (*(last - 1))) ? ((*x) + (middle * spacing_)) : (*(last - 1));
 
+      // kernel value at the center; afterwards, the kernel value of the inner point of each trapezoid is known from the previous step
+      const double coeff_center = interpolateKernel_(0.0, coeff, middle);
+
       InputPeakIterator help_x = x;
       InputPeakIterator help_y = y;
 #ifdef DEBUG_FILTERING
@@ -196,87 +334,20 @@ protected:
 #endif
 
       //integrate from middle to start_pos
+      double coeffs_right = coeff_center;
       while ((help_x != first) && (*(help_x - 1) > start_pos))
       {
-        // search for the corresponding datapoint of help in the gaussian (take the left most adjacent point)
-        double distance_in_gaussian = fabs(*x - *help_x);
-        Size left_position = (Size)floor(distance_in_gaussian / spacing_);
-
-        // search for the true left adjacent data point (because of rounding errors)
-        for (int j = 0; ((j < 3) &&  (distance(first, help_x - j) >= 0)); ++j)
-        {
-          if (((left_position - j) * spacing_ <= distance_in_gaussian) && ((left_position - j + 1) * spacing_ >= distance_in_gaussian))
-          {
-            left_position -= j;
-            break;
-          }
-
-          if (((left_position + j) * spacing_ < distance_in_gaussian) && ((left_position + j + 1) * spacing_ < distance_in_gaussian))
-          {
-            left_position += j;
-            break;
-          }
-        }
-
-        // interpolate between the left and right data points in the gaussian to get the true value at position distance_in_gaussian
-        Size right_position = left_position + 1;
-        double d = fabs((left_position * spacing_) - distance_in_gaussian) / spacing_;
-        // check if the right data point in the gaussian exists
-        double coeffs_right = (right_position < middle) ? (1 - d) * coeffs_[left_position] + d * coeffs_[right_position]
-                                  : coeffs_[left_position];
-#ifdef DEBUG_FILTERING
-
-        std::cout << "distance_in_gaussian " << distance_in_gaussian << std::endl;
-        std::cout << " right_position " << right_position << std::endl;
-        std::cout << " left_position " << left_position << std::endl;
-        std::cout << "coeffs_ at left_position "  <<  coeffs_[left_position] << std::endl;
-        std::cout << "coeffs_ at right_position "  <<  coeffs_[right_position] << std::endl;
-        std::cout << "interpolated value left " << coeffs_right << std::endl;
-#endif
-
-
-        // search for the corresponding datapoint for (help-1) in the gaussian (take the left most adjacent point)
-        distance_in_gaussian = fabs((*x) - (*(help_x - 1)));
-        left_position = (Size)floor(distance_in_gaussian / spacing_);
-
-        // search for the true left adjacent data point (because of rounding errors)
-        for (UInt j = 0; ((j < 3) && (distance(first, help_x - j) >= 0)); ++j)
-        {
-          if (((left_position - j) * spacing_ <= distance_in_gaussian) && ((left_position - j + 1) * spacing_ >= distance_in_gaussian))
-          {
-            left_position -= j;
-            break;
-          }
-
-          if (((left_position + j) * spacing_ < distance_in_gaussian) && ((left_position + j + 1) * spacing_ < distance_in_gaussian))
-          {
-            left_position += j;
-            break;
-          }
-        }
-
-        // start the interpolation for the true value in the gaussian
-        right_position = left_position + 1;
-        d = fabs((left_position * spacing_) - distance_in_gaussian) / spacing_;
-        double coeffs_left = (right_position < middle) ? (1 - d) * coeffs_[left_position] + d * coeffs_[right_position]
-                                 : coeffs_[left_position];
+        double coeffs_left = interpolateKernel_(fabs((*x) - (*(help_x - 1))), coeff, middle);
 #ifdef DEBUG_FILTERING
 
-        std::cout << " help_x-1 " << *(help_x - 1) << " distance_in_gaussian " << distance_in_gaussian << std::endl;
-        std::cout << " right_position " << right_position << std::endl;
-        std::cout << " left_position " << left_position << std::endl;
-        std::cout << "coeffs_ at left_position " <<  coeffs_[left_position] << std::endl;
-        std::cout << "coeffs_ at right_position " <<   coeffs_[right_position] << std::endl;
-        std::cout << "interpolated value right " << coeffs_left << std::endl;
-
         std::cout << " intensity " << fabs(*(help_x - 1) - (*help_x)) / 2. << " * " << *(help_y - 1) << " * " << coeffs_left << " + " << *help_y << "* " << coeffs_right
                   << std::endl;
 #endif
 
-
         norm += fabs((*(help_x - 1)) - (*help_x)) / 2. * (coeffs_left + coeffs_right);
 
         v += fabs((*(help_x - 1)) - (*help_x)) / 2. * (*(help_y - 1) * coeffs_left + (*help_y) * coeffs_right);
+        coeffs_right = coeffs_left;
         --help_x;
         --help_y;
       }
@@ -290,75 +361,12 @@ protected:
       std::cout << "integrate from middle to endpos " << *help_x << " until " << end_pos << std::endl;
 #endif
 
+      double coeffs_left = coeff_center;
       while ((help_x != (last - 1)) && (*(help_x + 1) < end_pos))
       {
-        // search for the corresponding datapoint for help in the gaussian (take the left most adjacent point)
-        double distance_in_gaussian = fabs((*x) - (*help_x));
-        int left_position = (UInt)floor(distance_in_gaussian / spacing_);
-
-        // search for the true left adjacent data point (because of rounding errors)
-        for (int j = 0; ((j < 3) && (distance(help_x + j, last - 1) >= 0)); ++j)
-        {
-          if (((left_position - j) * spacing_ <= distance_in_gaussian) && ((left_position - j + 1) * spacing_ >= distance_in_gaussian))
-          {
-            left_position -= j;
-            break;
-          }
-
-          if (((left_position + j) * spacing_ < distance_in_gaussian) && ((left_position + j + 1) * spacing_ < distance_in_gaussian))
-          {
-            left_position += j;
-            break;
-          }
-        }
-        // start the interpolation for the true value in the gaussian
-        Size right_position = left_position + 1;
-        double d = fabs((left_position * spacing_) - distance_in_gaussian) / spacing_;
-        double coeffs_left = (right_position < middle) ? (1 - d) * coeffs_[left_position] + d * coeffs_[right_position]
-                                 : coeffs_[left_position];
-
+        double coeffs_right = interpolateKernel_(fabs((*x) - (*(help_x + 1))), coeff, middle);
 #ifdef DEBUG_FILTERING
 
-        std::cout << " help " << *help_x << " distance_in_gaussian " << distance_in_gaussian << std::endl;
-        std::cout << " left_position " << left_position << std::endl;
-        std::cout << "coeffs_ at right_position " <<  coeffs_[left_position] << std::endl;
-        std::cout << "coeffs_ at left_position " <<  coeffs_[right_position] << std::endl;
-        std::cout << "interpolated value left " << coeffs_left << std::endl;
-#endif
-
-        // search for the corresponding datapoint for (help+1) in the gaussian (take the left most adjacent point)
-        distance_in_gaussian = fabs((*x) - (*(help_x + 1)));
-        left_position = (UInt)floor(distance_in_gaussian / spacing_);
-
-        // search for the true left adjacent data point (because of rounding errors)
-        for (int j = 0; ((j < 3) && (distance(help_x + j, last - 1) >= 0)); ++j)
-        {
-          if (((left_position - j) * spacing_ <= distance_in_gaussian) && ((left_position - j + 1) * spacing_ >= distance_in_gaussian))
-          {
-            left_position -= j;
-            break;
-          }
-
-          if (((left_position + j) * spacing_ < distance_in_gaussian) && ((left_position + j + 1) * spacing_ < distance_in_gaussian))
-          {
-            left_position += j;
-            break;
-          }
-        }
-
-        // start the interpolation for the true value in the gaussian
-        right_position = left_position + 1;
-        d = fabs((left_position * spacing_) - distance_in_gaussian) / spacing_;
-        double coeffs_right = (right_position < middle) ? (1 - d) * coeffs_[left_position] + d * coeffs_[right_position]
-                                  : coeffs_[left_position];
-#ifdef DEBUG_FILTERING
-
-        std::cout << " (help + 1) " << *(help_x + 1) << " distance_in_gaussian " << distance_in_gaussian << std::endl;
-        std::cout << " left_position " << left_position << std::endl;
-        std::cout << "coeffs_ at right_position " <<   coeffs_[left_position] << std::endl;
-        std::cout << "coeffs_ at left_position " <<  coeffs_[right_position] << std::endl;
-        std::cout << "interpolated value right " << coeffs_right << std::endl;
-
         std::cout << " intensity " <<  fabs(*help_x - *(help_x + 1)) / 2.
                   << " * " << *help_y << " * " << coeffs_left << " + " << *(help_y + 1)
                   << "* " << coeffs_right
@@ -367,6 +375,7 @@ protected:
         norm += fabs((*help_x) - (*(help_x + 1)) ) / 2. * (coeffs_left + coeffs_right);
 
         v += fabs((*help_x) - (*(help_x + 1)) ) / 2. * ((*help_y) * coeffs_left + (*(help_y + 1)) * coeffs_right);
+        coeffs_left = coeffs_right;
         ++help_x;
         ++help_y;
       }
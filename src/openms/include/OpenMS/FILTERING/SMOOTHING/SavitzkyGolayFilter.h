@@ -118,68 +118,23 @@ public:
 
       if (frame_size_ > n) { return; }
 
-      int i;
-      UInt j;
-      int mid = (frame_size_ / 2);
-      double help;
-
-      // compute the transient on
-      OutputIt out_it = d_first;
-
-      for (i = 0; i <= mid; ++i)
+      // gather the intensities into a contiguous buffer for the convolution
+      std::vector<double> intensities(n);
+      InputIt it = first;
+      for (size_t i = 0; i < n; ++i, ++it)
       {
-        InputIt it_forward = (first - i);
-        help = 0;
-        for (j = 0; j < frame_size_; ++j)
-        {
-          help += it_forward->getIntensity() * coeffs_[(i + 1) * frame_size_ - 1 - j];
-          ++it_forward;
-        }
-
-        out_it->setPosition(first->getPosition());
-        out_it->setIntensity(std::max(0.0, help));
-        ++out_it;
-        ++first;
+        intensities[i] = it->getIntensity();
       }
 
-      // compute the steady state output
-      InputIt it_help = (last - mid);
-
-      while (first != it_help)
-      {
-        InputIt it_forward = (first - mid);
-        help = 0;
+      std::vector<double> smoothed;
+      smooth_(intensities, smoothed);
 
-        for (j = 0; j < frame_size_; ++j)
-        {
-          help += it_forward->getIntensity() * coeffs_[mid * frame_size_ + j];
-          ++it_forward;
-        }
-
-        out_it->setPosition(first->getPosition());
-        out_it->setIntensity(std::max(0.0, help));
-        ++out_it;
-        ++first;
-      }
-
-      // compute the transient off
-      for (i = (mid - 1); i >= 0; --i)
+      OutputIt out_it = d_first;
+      for (size_t i = 0; i < n; ++i, ++first, ++out_it)
       {
-        InputIt it_forward = (first - (frame_size_ - i - 1));
-        help = 0;
-
-        for (j = 0; j < frame_size_; ++j)
-        {
-          help += it_forward->getIntensity() * coeffs_[i * frame_size_ + j];
-          ++it_forward;
-        }
-
         out_it->setPosition(first->getPosition());
-        out_it->setIntensity(std::max(0.0, help));
-        ++out_it;
-        ++first;
+        out_it->setIntensity(std::max(0.0, smoothed[i]));
       }
-
     }
 
     /**
@@ -210,23 +165,10 @@ public:
 
     /**
       @brief Removed the noise from an MSExperiment containing profile data.
+
+      Spectra and chromatograms are filtered in parallel (OpenMP) if available.
     */
-    void filterExperiment(PeakMap & map)
-    {
-      Size progress = 0;
-      startProgress(0, map.size() + map.getChromatograms().size(), "smoothing data");
-      for (Size i = 0; i < map.size(); ++i)
-      {
-        filter(map[i]);
-        setProgress(++progress);
-      }
-      for (Size i = 0; i < map.getChromatograms().size(); ++i)
-      {
-        filter(map.getChromatogram(i));
-        setProgress(++progress);
-      }
-      endProgress();
-    }
+    void filterExperiment(PeakMap & map);
 
 protected:
     /// Coefficients
@@ -238,6 +180,14 @@ protected:
     /// The order of the smoothing polynomial.
     UInt order_;
 
+    /**
+      @brief Applies the filter coefficients to the (at least frame_size_) intensities @p in
+
+      The first and last frame_size_ / 2 points are smoothed with the asymmetric
+      coefficient rows, all other points with the symmetric one.
+    */
+    void smooth_(const std::vector<double>& in, std::vector<double>& out) const;
+
     // Docu in base class
     void updateMembers_() override;
   };
@@ -0,0 +1,135 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/FORMAT/HANDLERS/ConsensusXMLHandler.h>
+#include <OpenMS/KERNEL/ConsensusMap.h>
+
+#include <fstream>
+
+namespace OpenMS
+{
+    /**
+      @brief Consumer class that writes consensus features to disk using the consensusXML format.
+
+      Consensus features are written as soon as they are consumed, so a
+      consensusXML file can be created without holding all of its consensus
+      features in memory (e.g. when linking very large cohorts of feature
+      maps batch by batch).
+
+      The document header (column headers, protein identifications, unassigned
+      peptide identifications, data processing) is taken from the map passed to
+      setHeader(), which has to be called before the first consensus feature is
+      consumed. Features contained in the header map are ignored.
+
+      Example usage:
+
+      @code
+      ConsensusXMLWritingConsumer consumer(outfile);
+      consumer.setHeader(header); // column headers, identification runs, ...
+      [...]
+      // multiple times ...
+      consumer.consume(consensus_map_batch);
+      [...]
+      consumer.close(); // reports errors, unlike the destructor
+      @endcode
+
+      @note Peptide identifications of consumed features can only be written
+      if the corresponding protein identification run is part of the header.
+    */
+    class OPENMS_DLLAPI ConsensusXMLWritingConsumer :
+      public Internal::ConsensusXMLHandler
+    {
+
+    public:
+
+      /**
+        @brief Constructor
+
+        @param filename Filename for the output consensusXML
+
+        @exception Exception::UnableToCreateFile if the file cannot be opened for writing
+      */
+      explicit ConsensusXMLWritingConsumer(const String& filename);
+
+      /// Destructor (closes the file, if this was not done before; errors are only logged, call close() to handle them)
+      ~ConsensusXMLWritingConsumer() override;
+
+      /**
+        @brief Sets the document header
+
+        Only the meta data of @p header is used, its consensus features are ignored.
+
+        @exception Exception::IllegalArgument if writing has already started
+      */
+      void setHeader(const ConsensusMap& header);
+
+      /**
+        @brief Consumes a consensus feature
+
+        The header is written before the first feature.
+
+        @exception Exception::IllegalArgument if the file was already closed
+      */
+      void consume(const ConsensusFeature& feature);
+
+      /// Consumes all consensus features of @p map (in order); the meta data of @p map is ignored
+      void consume(const ConsensusMap& map);
+
+      /// Writes the remaining parts of the document (the header, if nothing was consumed) and closes the file
+      void close();
+
+      /// Returns the number of consensus features written
+      Size getNrFeaturesWritten() const;
+
+    protected:
+
+      /// File stream (to write consensusXML)
+      std::ofstream ofs_;
+
+      /// Meta data used for the document header
+      ConsensusMap header_;
+
+      /// Stores whether we have already started writing any data
+      bool started_writing_;
+
+      /// Stores whether the file was closed
+      bool closed_;
+
+      /// Number of consensus features written
+      Size features_written_;
+    };
+
+} //end namespace OpenMS
@@ -3,6 +3,7 @@ set(directory include/OpenMS/FORMAT/DATAACCESS)
 
 ### list all header files of the directory here
 set(sources_list_h
+  ConsensusXMLWritingConsumer.h
   CsiFingerIdMzTabWriter.h
   MSDataAggregatingConsumer.h
   MSDataCachedConsumer.h
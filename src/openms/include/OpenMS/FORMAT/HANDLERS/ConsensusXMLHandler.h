@@ -94,6 +94,20 @@ protected:
     // Docu in base class
     void characters(const XMLCh* const chars, const XMLSize_t length) override;
 
+    /**
+      @brief Writes everything up to (and including) the opening tag of the consensus element list
+
+      Protein identification runs are registered here, so peptide identifications
+      written afterwards can be linked to them.
+    */
+    void writeHeader_(std::ostream& os);
+
+    /// Writes a single consensus element (to be called between writeHeader_() and writeFooter_())
+    void writeConsensusElement_(std::ostream& os, const ConsensusFeature& elem);
+
+    /// Closes the consensus element list and the document and clears the identification run lookup tables
+    void writeFooter_(std::ostream& os);
+
     /// Writes a peptide identification to a stream (for assigned/unassigned peptide identifications)
     void writePeptideIdentification_(const String& filename, std::ostream& os, const PeptideIdentification& id, const String& tag_name, UInt indentation_level);
 
@@ -0,0 +1,216 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Timo Sachsenberg $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/CONCEPT/Types.h>
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/CONCEPT/Macros.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace OpenMS
+{
+  class MSExperiment;
+
+  /**
+    @brief Flat, m/z-sorted index of all peaks of an MSExperiment for fast nearest-peak queries
+
+    Stores the m/z and intensity values of all peaks of a map in two
+    contiguous arrays (compressed sparse row layout: peaks of spectrum @p s
+    occupy the range [offset(s), offset(s+1)) ). Optionally, each spectrum
+    gets a table of equally wide m/z buckets pointing to the first peak of
+    each bucket. A nearest-peak lookup then only needs a binary search
+    within a single bucket (usually containing one or two peaks) instead of
+    a binary search over the full spectrum.
+
+    Results of findNearest() are identical to MSSpectrum::findNearest().
+    Peak indices are local to the spectrum, global indices (e.g. for bit
+    sets over all peaks of the map) are obtained by adding getSpectrumOffset().
+
+    @note The spectra need to be sorted by m/z. The index is a snapshot:
+    it has to be rebuilt if the peaks of the map change.
+
+    @ingroup Kernel
+  */
+  class OPENMS_DLLAPI FlatPeakIndex
+  {
+public:
+    /// Default constructor, creates an empty index
+    FlatPeakIndex() = default;
+
+    /// Constructor, builds the index of @p exp (see build())
+    explicit FlatPeakIndex(const MSExperiment& exp, bool use_buckets = true);
+
+    /**
+      @brief Builds the index of all spectra of @p exp (replacing any previous content)
+
+      @param exp The map to index (spectra need to be sorted by m/z)
+      @param use_buckets Whether to create the m/z bucket tables (about one
+             bucket per peak), otherwise lookups use a binary search
+    */
+    void build(const MSExperiment& exp, bool use_buckets = true);
+
+    /// Removes all data
+    void clear();
+
+    /// Number of indexed spectra
+    inline Size getNrSpectra() const
+    {
+      return scan_offsets_.empty() ? 0 : scan_offsets_.size() - 1;
+    }
+
+    /// Total number of indexed peaks
+    inline Size size() const
+    {
+      return mz_.size();
+    }
+
+    /// Global index of the first peak of spectrum @p scan
+    inline Size getSpectrumOffset(Size scan) const
+    {
+      OPENMS_PRECONDITION(scan < getNrSpectra(), "Spectrum index exceeds index size");
+      return scan_offsets_[scan];
+    }
+
+    /// Number of peaks in spectrum @p scan
+    inline Size getSpectrumSize(Size scan) const
+    {
+      OPENMS_PRECONDITION(scan < getNrSpectra(), "Spectrum index exceeds index size");
+      return scan_offsets_[scan + 1] - scan_offsets_[scan];
+    }
+
+    /// m/z of peak @p peak in spectrum @p scan
+    inline double getMZ(Size scan, Size peak) const
+    {
+      OPENMS_PRECONDITION(peak < getSpectrumSize(scan), "Peak index exceeds spectrum size");
+      return mz_[scan_offsets_[scan] + peak];
+    }
+
+    /// Intensity of peak @p peak in spectrum @p scan
+    inline float getIntensity(Size scan, Size peak) const
+    {
+      OPENMS_PRECONDITION(peak < getSpectrumSize(scan), "Peak index exceeds spectrum size");
+      return intensity_[scan_offsets_[scan] + peak];
+    }
+
+    /**
+      @brief Index of the first peak in spectrum @p scan with an m/z not smaller than @p mz
+
+      @return The local peak index (equal to the spectrum size if all peaks are smaller)
+    */
+    inline Size lowerBound(Size scan, double mz) const
+    {
+      OPENMS_PRECONDITION(scan < getNrSpectra(), "Spectrum index exceeds index size");
+      const double* begin = mz_.data() + scan_offsets_[scan];
+      Size lo(0), hi(scan_offsets_[scan + 1] - scan_offsets_[scan]);
+      const Size nr_buckets = bucket_offsets_.empty() ? 0 : bucket_offsets_[scan + 1] - bucket_offsets_[scan] - 1;
+      if (nr_buckets > 0)
+      {
+        const UInt32* first = bucket_first_.data() + bucket_offsets_[scan];
+        Size b = bucketOf_(mz, bucket_min_mz_[scan], bucket_inv_width_[scan], nr_buckets);
+        lo = first[b];
+        hi = first[b + 1];
+      }
+      return std::lower_bound(begin + lo, begin + hi, mz) - begin;
+    }
+
+    /**
+      @brief Index of the peak in spectrum @p scan nearest to @p mz (see MSSpectrum::findNearest(CoordinateType))
+
+      @exception Exception::Precondition is thrown if the spectrum is empty (not only in debug mode)
+    */
+    inline Size findNearest(Size scan, double mz) const
+    {
+      const Size n = getSpectrumSize(scan);
+      if (n == 0)
+      {
+        throw Exception::Precondition(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "There must be at least one peak to determine the nearest peak!");
+      }
+      Size i = lowerBound(scan, mz);
+      // border cases
+      if (i == 0) return 0;
+      if (i == n) return n - 1;
+      // the peak before or the current peak are closest
+      const double* spec_mz = mz_.data() + scan_offsets_[scan];
+      return std::fabs(spec_mz[i] - mz) < std::fabs(spec_mz[i - 1] - mz) ? i : i - 1;
+    }
+
+    /**
+      @brief Index of the peak in spectrum @p scan nearest to @p mz within +/- @p tolerance (see MSSpectrum::findNearest(CoordinateType, CoordinateType))
+
+      @return The local peak index or -1 if no peak is within the tolerance or the spectrum is empty
+    */
+    inline Int findNearest(Size scan, double mz, double tolerance) const
+    {
+      if (getSpectrumSize(scan) == 0) return -1;
+      Size i = findNearest(scan, mz);
+      const double found_mz = getMZ(scan, i);
+      if (found_mz >= mz - tolerance && found_mz <= mz + tolerance)
+      {
+        return static_cast<Int>(i);
+      }
+      return -1;
+    }
+
+protected:
+    /// Bucket of @p mz in a table starting at @p min_mz (monotonic in @p mz, clamped to the table)
+    static inline Size bucketOf_(double mz, double min_mz, double inv_width, Size nr_buckets)
+    {
+      double pos = (mz - min_mz) * inv_width;
+      if (!(pos > 0.0)) return 0;
+      if (pos >= (double)(nr_buckets - 1)) return nr_buckets - 1;
+      return (Size)pos;
+    }
+
+    /// Start of the peaks of each spectrum in mz_ / intensity_ (one more entry than spectra)
+    std::vector<Size> scan_offsets_;
+    /// m/z of all peaks
+    std::vector<double> mz_;
+    /// intensity of all peaks
+    std::vector<float> intensity_;
+
+    /// Start of the bucket table of each spectrum in bucket_first_ (empty if no buckets are used)
+    std::vector<Size> bucket_offsets_;
+    /// First local peak index of each bucket (plus one sentinel entry per spectrum)
+    std::vector<UInt32> bucket_first_;
+    /// m/z at the start of the first bucket of each spectrum
+    std::vector<double> bucket_min_mz_;
+    /// Inverse bucket width of each spectrum
+    std::vector<double> bucket_inv_width_;
+  };
+
+} // namespace OpenMS
@@ -87,6 +87,18 @@ public:
      */
     double eval(double x) const;
 
+    /**
+     * @brief evaluates the spline at positions sorted in ascending order
+     *
+     * Faster than evaluating the positions one by one, since the spline
+     * intervals are found by walking along the knots.
+     *
+     * @param begin start of x-positions
+     * @param end end of x-positions
+     * @param result output, one value per position (may be the same as @p begin)
+     */
+    void eval(const double* begin, const double* end, double* result) const;
+
     /**
      * @brief evaluates first derivative of spline at position x
      *
@@ -67,6 +67,8 @@ namespace OpenMS
        - each subordinate has one convex hull
        - all convex hulls in one feature contain the same number (> 0) of points
        - the y coordinates of the hull points store the intensities
+
+       Features are fitted in parallel (if OpenMP is enabled); the results do not depend on the number of threads.
     */
     void fitElutionModels(FeatureMap& features);
 
@@ -83,6 +85,11 @@ namespace OpenMS
                               Feature& feature, double region_start,
                               double region_end, bool asymmetric,
                               double area_limit, double check_boundaries);
+
+    /// Helper function to assemble the mass traces of one feature and fit a model to them (thread-safe for distinct @p fitter objects)
+    void fitFeature_(TraceFitter* fitter, Feature& feature, double add_zeros,
+                     bool each_trace, bool asymmetric, double area_limit,
+                     double check_boundaries);
   };
 }
 
@@ -37,6 +37,7 @@
 #include <OpenMS/TRANSFORMATIONS/FEATUREFINDER/FeatureFinderAlgorithm.h>
 #include <OpenMS/TRANSFORMATIONS/FEATUREFINDER/FeatureFinderAlgorithmPickedHelperStructs.h>
 #include <OpenMS/TRANSFORMATIONS/FEATUREFINDER/TraceFitter.h>
+#include <OpenMS/KERNEL/FlatPeakIndex.h>
 
 #include <fstream>
 
@@ -97,6 +98,8 @@ public:
 protected:
     /// editable copy of the map
     MapType map_;
+    /// flat m/z index of the peaks of map_ (for nearest-peak lookups)
+    FlatPeakIndex mz_index_;
     /// Output stream for log/debug info
     mutable std::ofstream log_;
     /// debug flag
@@ -263,6 +263,12 @@ protected:
   /// @param clear_IDs set to false to keep IDs in internal charge maps (only needed for debugging purposes)
   void createAssayLibrary_(const PeptideMap::iterator& begin, const PeptideMap::iterator& end, PeptideRefRTMap& ref_rt_map, bool clear_IDs = true);
 
+  /// extracts chromatograms for the assays in @p library from @p ms1_map and detects/scores features in them (thread-safe)
+  void detectChunkFeatures_(const TargetedExperiment& library,
+                            const OpenSwath::SpectrumAccessPtr& ms1_map,
+                            const MSSpectrum& chrom_template,
+                            FeatureMap& chunk_features) const;
+
   /// CAUTION: This method stores a pointer to the given @p peptide reference in internals
   /// Make sure it stays valid until destruction of the class.
   /// @todo find better solution
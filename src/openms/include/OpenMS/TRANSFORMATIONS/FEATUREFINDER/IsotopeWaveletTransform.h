@@ -234,6 +234,16 @@ protected:
         * @param c The charge state minus 1 (e.g. c=2 means charge state 3) at which you want to compute the transform. */
     virtual void getTransformHighRes(MSSpectrum& c_trans, const MSSpectrum& c_ref, const UInt c);
 
+    /** @brief Computes the isotope wavelet transform of charge state @p c without relying on a preceding call of initializeScan().
+        *
+        * Yields the same result as initializeScan() followed by getTransform() (or getTransformHighRes() for high-resolution data),
+        * but derives the scan-dependent parameters locally and does not modify the object. Hence, transforms of different scans
+        * and charge states can be computed concurrently.
+        * @param c_trans The transform (must have the same size as @p c_ref).
+        * @param c_ref The reference spectrum (at least two data points).
+        * @param c The charge state minus 1 (e.g. c=2 means charge state 3) at which you want to compute the transform. */
+    void computeTransform(MSSpectrum& c_trans, const MSSpectrum& c_ref, const UInt c) const;
+
     /** @brief Given an isotope wavelet transformed spectrum @p candidates, this function assigns to every significant
         * pattern its corresponding charge state and a score indicating the reliability of the prediction. The result of this
         * process is stored internally. Important: Before calling this function, apply updateRanges() to the original map.
@@ -329,6 +339,17 @@ protected:
     IsotopeWaveletTransform();
 
 
+    /** @brief Implementation of getTransform() with explicitly given scan parameters (see initializeScan()). */
+    void getTransform_(MSSpectrum& c_trans, const MSSpectrum& c_ref, const UInt c,
+                       const Int from_max_to_left, const double min_spacing) const;
+
+    /** @brief Implementation of getTransformHighRes() with explicitly given scan parameters (see initializeScan()). */
+    void getTransformHighRes_(MSSpectrum& c_trans, const MSSpectrum& c_ref, const UInt c,
+                              const Int from_max_to_left) const;
+
+    /** @brief Returns the minimal m/z spacing of @p c_ref (see computeMinSpacing()). */
+    static double getMinSpacing_(const MSSpectrum& c_ref);
+
     inline void sampleTheCMarrWavelet_(const MSSpectrum& scan, const Int wavelet_length, const Int mz_index, const UInt charge);
 
 
@@ -563,6 +584,36 @@ protected:
 
   template <typename PeakType>
   void IsotopeWaveletTransform<PeakType>::getTransform(MSSpectrum& c_trans, const MSSpectrum& c_ref, const UInt c)
+  {
+    getTransform_(c_trans, c_ref, c, from_max_to_left_, min_spacing_);
+  }
+
+  template <typename PeakType>
+  void IsotopeWaveletTransform<PeakType>::getTransformHighRes(MSSpectrum& c_trans, const MSSpectrum& c_ref, const UInt c)
+  {
+    getTransformHighRes_(c_trans, c_ref, c, from_max_to_left_);
+  }
+
+  template <typename PeakType>
+  void IsotopeWaveletTransform<PeakType>::computeTransform(MSSpectrum& c_trans, const MSSpectrum& c_ref, const UInt c) const
+  {
+    // the same scan parameters as set by initializeScan() (the offset to the
+    // wavelet's maximum does not depend on the charge state or the data type):
+    double min_spacing = getMinSpacing_(c_ref);
+    Int from_max_to_left = (UInt) (Constants::IW_QUARTER_NEUTRON_MASS / min_spacing);
+    if (hr_data_)
+    {
+      getTransformHighRes_(c_trans, c_ref, c, from_max_to_left);
+    }
+    else
+    {
+      getTransform_(c_trans, c_ref, c, from_max_to_left, min_spacing);
+    }
+  }
+
+  template <typename PeakType>
+  void IsotopeWaveletTransform<PeakType>::getTransform_(MSSpectrum& c_trans, const MSSpectrum& c_ref, const UInt c,
+                                                        const Int from_max_to_left, const double min_spacing) const
   {
     Int spec_size((Int)c_ref.size());
     //in the very unlikely case that size_t will not fit to int anymore this will be a problem of course
@@ -573,16 +624,16 @@ protected:
     for (Int my_local_pos = 0; my_local_pos < spec_size; ++my_local_pos)
     {
       value = 0; T_boundary_left = 0; T_boundary_right = IsotopeWavelet::getMzPeakCutOffAtMonoPos(c_ref[my_local_pos].getMZ(), charge) / (double)charge;
-      old = 0; old_pos = (my_local_pos - from_max_to_left_ - 1 >= 0) ? c_ref[my_local_pos - from_max_to_left_ - 1].getMZ() : c_ref[0].getMZ() - min_spacing_;
+      old = 0; old_pos = (my_local_pos - from_max_to_left - 1 >= 0) ? c_ref[my_local_pos - from_max_to_left - 1].getMZ() : c_ref[0].getMZ() - min_spacing;
       my_local_MZ = c_ref[my_local_pos].getMZ(); my_local_lambda = IsotopeWavelet::getLambdaL(my_local_MZ * charge);
       c_diff = 0;
       origin = -my_local_MZ + Constants::IW_QUARTER_NEUTRON_MASS / (double)charge;
 
-      for (Int current_conv_pos =  std::max(0, my_local_pos - from_max_to_left_); c_diff < T_boundary_right; ++current_conv_pos)
+      for (Int current_conv_pos =  std::max(0, my_local_pos - from_max_to_left); c_diff < T_boundary_right; ++current_conv_pos)
       {
         if (current_conv_pos >= spec_size)
         {
-          value += 0.5 * old * min_spacing_;
+          value += 0.5 * old * min_spacing;
           break;
         }
 
@@ -605,7 +656,8 @@ protected:
   }
 
   template <typename PeakType>
-  void IsotopeWaveletTransform<PeakType>::getTransformHighRes(MSSpectrum& c_trans, const MSSpectrum& c_ref, const UInt c)
+  void IsotopeWaveletTransform<PeakType>::getTransformHighRes_(MSSpectrum& c_trans, const MSSpectrum& c_ref, const UInt c,
+                                                               const Int from_max_to_left) const
   {
     Int spec_size((Int)c_ref.size());
     //in the very unlikely case that size_t will not fit to int anymore this will be a problem of course
@@ -622,7 +674,7 @@ protected:
       c_diff = 0;
       origin = -my_local_MZ + Constants::IW_QUARTER_NEUTRON_MASS / (double)charge;
 
-      for (Int current_conv_pos =  std::max(0, my_local_pos - from_max_to_left_); c_diff < T_boundary_right; ++current_conv_pos)
+      for (Int current_conv_pos =  std::max(0, my_local_pos - from_max_to_left); c_diff < T_boundary_right; ++current_conv_pos)
       {
         if (current_conv_pos >= spec_size)
         {
@@ -687,11 +739,18 @@ protected:
   template <typename PeakType>
   void IsotopeWaveletTransform<PeakType>::computeMinSpacing(const MSSpectrum& c_ref)
   {
-    min_spacing_ = INT_MAX;
+    min_spacing_ = getMinSpacing_(c_ref);
+  }
+
+  template <typename PeakType>
+  double IsotopeWaveletTransform<PeakType>::getMinSpacing_(const MSSpectrum& c_ref)
+  {
+    double min_spacing = INT_MAX;
     for (UInt c_conv_pos = 1; c_conv_pos < c_ref.size(); ++c_conv_pos)
     {
-      min_spacing_ = std::min(min_spacing_, c_ref[c_conv_pos].getMZ() - c_ref[c_conv_pos - 1].getMZ());
+      min_spacing = std::min(min_spacing, c_ref[c_conv_pos].getMZ() - c_ref[c_conv_pos - 1].getMZ());
     }
+    return min_spacing;
   }
 
   template <typename PeakType>
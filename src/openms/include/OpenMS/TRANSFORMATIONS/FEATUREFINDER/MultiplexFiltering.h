@@ -37,6 +37,7 @@
 #include <OpenMS/KERNEL/BaseFeature.h>
 #include <OpenMS/KERNEL/StandardTypes.h>
 #include <OpenMS/KERNEL/MSExperiment.h>
+#include <OpenMS/CHEMISTRY/ISOTOPEDISTRIBUTION/IsotopeDistribution.h>
 #include <OpenMS/CONCEPT/ProgressLogger.h>
 #include <OpenMS/TRANSFORMATIONS/RAW2PEAK/PeakPickerHiRes.h>
 #include <OpenMS/TRANSFORMATIONS/FEATUREFINDER/MultiplexIsotopicPeakPattern.h>
@@ -83,9 +84,10 @@ public:
      * which blacklisted peaks are removed is called 'white'. White spectra
      * contain fewer peaks than their corresponding primary spectra. Consequently,
      * their indices are shifted. The type maps a peak index in a 'white'
-     * spectrum back to its original spectrum.
+     * spectrum back to its original spectrum (i.e. entry [i][j] is the index
+     * of the j-th white peak of spectrum i in the original spectrum).
      */
-    typedef std::vector<std::map<int, int> > White2Original;
+    typedef std::vector<std::vector<int> > White2Original;
 
     /**
      * @brief constructor
@@ -175,6 +177,30 @@ protected:
      */
     void blacklistPeak_(const MultiplexFilteredPeak& peak, unsigned pattern_idx);
     
+    /**
+     * @brief m/z range affected by a peak
+     *
+     * Any blacklist entry read by filterPeakPositions_() for a peak at @p mz, and any entry
+     * set by blacklistPeak_() for such a peak, belongs to a peak within this m/z range
+     * (in any spectrum). The filter() methods use it to evaluate the peaks of a spectrum
+     * concurrently, but with the same result as one after the other.
+     *
+     * @param mz    m/z of the primary peak
+     * @param pattern    m/z pattern to search for
+     *
+     * @return lower and upper m/z bound
+     */
+    std::pair<double, double> getBlacklistRange_(double mz, const MultiplexIsotopicPeakPattern& pattern) const;
+
+    /**
+     * @brief averagine isotope distribution (of type @em averagine_type_) for the given mass
+     *
+     * @param mass    mass of the peptide (or RNA, DNA)
+     *
+     * @throw Exception::InvalidParameter if @em averagine_type_ is unknown
+     */
+    IsotopeDistribution getAveragineDistribution_(double mass) const;
+
     /**
      * @brief check if the satellite peaks conform with the averagine model
      *
@@ -74,6 +74,11 @@ namespace OpenMS
 
     @htmlinclude OpenMS_PeakPickerHiRes.parameters
 
+    The map-based pickExperiment() methods process spectra and chromatograms
+    in parallel (OpenMP) if available. Each spectrum is picked independently,
+    therefore the results do not depend on the number of threads. For
+    streaming (low memory) processing see PeakPickerHiResConsumer.
+
     @note The peaks must be sorted according to ascending m/z!
 
     @ingroup PeakPicking
@@ -174,8 +179,42 @@ public:
     */
     void pickExperiment(/* const */ OnDiscMSExperiment& input, PeakMap& output, const bool check_spectrum_type = true) const;
 
+    /**
+      @brief Applies the peak-picking algorithm to a single spectrum of a map,
+      respecting the 'ms_levels' parameter.
+
+      Spectra which are not subject to peak picking (centroided spectra in
+      auto mode or spectra of MS levels not listed in 'ms_levels') are copied
+      to @p output unchanged. This is the per-spectrum step of pickExperiment().
+
+      @param input  input spectrum
+      @param output  output spectrum (picked or copied)
+      @param boundaries  boundaries of the picked peaks (cleared if the spectrum is only copied)
+      @param check_spectrum_type  if set, throws an exception if a centroided spectrum of a selected MS level is passed
+      @param query_data  if set, the spectrum type is inferred from the data if the meta data is inconclusive (see SpectrumSettings::getType())
+
+      @return true if the spectrum was picked, false if it was copied
+
+      @exception Exception::IllegalArgument is thrown if @p check_spectrum_type is set and a centroided spectrum should be picked
+    */
+    bool pickOrCopy(const MSSpectrum& input, MSSpectrum& output, std::vector<PeakBoundary>& boundaries, const bool check_spectrum_type = true, const bool query_data = true) const;
+
+    /**
+      @brief Like pickOrCopy(), but replaces @p spectrum by the picked spectrum.
+
+      Spectra which are not subject to peak picking are left untouched, i.e. no copy is made.
+
+      @return true if the spectrum was picked, false if it was left untouched
+
+      @exception Exception::IllegalArgument is thrown if @p check_spectrum_type is set and a centroided spectrum should be picked
+    */
+    bool pickInPlace(MSSpectrum& spectrum, std::vector<PeakBoundary>& boundaries, const bool check_spectrum_type = true, const bool query_data = true) const;
+
 protected:
 
+    /// Decides (as described for pickOrCopy()) whether @p input is subject to peak picking
+    bool isPickable_(const MSSpectrum& input, const bool check_spectrum_type, const bool query_data) const;
+
     template <typename ContainerType>
     void pick_(const ContainerType& input, ContainerType& output, std::vector<PeakBoundary>& boundaries, bool check_spacings = true, int im_index = -1) const;
 
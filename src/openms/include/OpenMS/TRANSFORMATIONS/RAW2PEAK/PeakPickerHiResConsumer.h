@@ -0,0 +1,130 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Timo Sachsenberg $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/INTERFACES/IMSDataConsumer.h>
+#include <OpenMS/TRANSFORMATIONS/RAW2PEAK/PeakPickerHiRes.h>
+
+#include <vector>
+
+namespace OpenMS
+{
+
+  /**
+    @brief Consumer stage which applies PeakPickerHiRes to streamed data
+
+    Spectra passed to this consumer are collected in batches, picked in
+    parallel (OpenMP) using PeakPickerHiRes::pickOrCopy() and then forwarded
+    in their original order to the next consumer (e.g. an
+    PlainMSDataWritingConsumer). Memory consumption is therefore bounded by the
+    batch size and does not depend on the size of the input file.
+
+    Chromatograms are picked one by one; all buffered spectra are forwarded
+    before the first chromatogram. Experimental settings and the expected
+    size are passed on to the next consumer.
+
+    Usage:
+
+    @code
+    PlainMSDataWritingConsumer writer(outfile);
+    PeakPickerHiResConsumer picker(pp, &writer);
+    MzMLFile().transform(infile, &picker);
+    picker.flush(); // forward the last (incomplete) batch
+    @endcode
+
+    @note Consumed spectra and chromatograms are moved into this stage and
+    should not be used by the caller afterwards. If used within an
+    MSDataChainingConsumer, this stage should therefore be the last element.
+
+    @note flush() should be called explicitly after the last spectrum has been
+    consumed. The destructor flushes remaining spectra as well but cannot
+    propagate errors.
+  */
+  class OPENMS_DLLAPI PeakPickerHiResConsumer :
+    public Interfaces::IMSDataConsumer
+  {
+  public:
+
+    /**
+      @brief Constructor
+
+      @param pp  the (configured) peak picker to apply
+      @param next  consumer which receives the processed data (ownership is not transferred)
+      @param check_spectrum_type  if set, throws an exception if a centroided spectrum of a selected MS level is passed (see PeakPickerHiRes::pickExperiment())
+      @param batch_size  number of spectra picked in parallel (0 selects 64 spectra per thread)
+
+      @exception Exception::MissingInformation is thrown if @p next is a null pointer
+    */
+    PeakPickerHiResConsumer(const PeakPickerHiRes& pp, Interfaces::IMSDataConsumer* next, bool check_spectrum_type = true, Size batch_size = 0);
+
+    /// Destructor (flushes remaining spectra)
+    ~PeakPickerHiResConsumer() override;
+
+    /// Forwards the experimental settings to the next consumer
+    void setExperimentalSettings(const ExperimentalSettings& settings) override;
+
+    /// Forwards the expected size to the next consumer
+    void setExpectedSize(Size expected_spectra, Size expected_chromatograms) override;
+
+    /// Buffers a spectrum; a full batch is picked and forwarded to the next consumer
+    void consumeSpectrum(SpectrumType& s) override;
+
+    /// Forwards all buffered spectra, then picks the chromatogram and forwards it
+    void consumeChromatogram(ChromatogramType& c) override;
+
+    /// Picks all buffered spectra and forwards them to the next consumer
+    void flush();
+
+    /// Returns the number of spectra which were picked (as opposed to copied) so far
+    Size getNrPickedSpectra() const;
+
+  protected:
+
+    PeakPickerHiRes pp_;
+
+    Interfaces::IMSDataConsumer* next_;
+
+    bool check_spectrum_type_;
+
+    Size batch_size_;
+
+    Size nr_picked_;
+
+    /// spectra waiting to be picked
+    std::vector<SpectrumType> buffer_;
+  };
+
+} // namespace OpenMS
+
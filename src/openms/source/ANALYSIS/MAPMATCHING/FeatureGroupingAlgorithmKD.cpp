@@ -42,6 +42,12 @@
 #include <OpenMS/METADATA/ProteinIdentification.h>
 #include <OpenMS/METADATA/PeptideIdentification.h>
 
+#include <exception>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using namespace std;
 
 namespace OpenMS
@@ -112,9 +118,7 @@ namespace OpenMS
   {
   }
 
-  template <typename MapType>
-  void FeatureGroupingAlgorithmKD::group_(const vector<MapType>& input_maps,
-                                          ConsensusMap& out)
+  void FeatureGroupingAlgorithmKD::setUp_(vector<double>& mz_values, double max_intensity, vector<double>& partition_boundaries)
   {
     // set parameters
     String mz_unit(param_.getValue("mz_unit").toString());
@@ -122,33 +126,6 @@ namespace OpenMS
     mz_tol_ = (double)(param_.getValue("link:mz_tol"));
     rt_tol_secs_ = (double)(param_.getValue("link:rt_tol"));
 
-    // check that the number of maps is ok:
-    if (input_maps.size() < 2)
-    {
-      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
-                                       "At least two maps must be given!");
-    }
-
-    out.clear(false);
-
-    // collect all m/z values for partitioning, find intensity maximum
-    vector<double> massrange;
-    double max_intensity(0.0);
-    for (typename vector<MapType>::const_iterator map_it = input_maps.begin();
-         map_it != input_maps.end(); ++map_it)
-    {
-      for (typename MapType::const_iterator feat_it = map_it->begin();
-          feat_it != map_it->end(); feat_it++)
-      {
-        massrange.push_back(feat_it->getMZ());
-        double inty = feat_it->getIntensity();
-        if (inty > max_intensity)
-        {
-          max_intensity = inty;
-        }
-      }
-    }
-
     // set up distance functor
     Param distance_params;
     distance_params.insert("", param_.copy("distance_RT:"));
@@ -163,66 +140,171 @@ namespace OpenMS
     // partition at boundaries -> this should be safe because there cannot be
     // any cluster reaching across boundaries
 
-    sort(massrange.begin(), massrange.end());
-    int pts_per_partition = massrange.size() / (int)(param_.getValue("nr_partitions"));
+    sort(mz_values.begin(), mz_values.end());
+    int pts_per_partition = mz_values.size() / (int)(param_.getValue("nr_partitions"));
 
     double warp_mz_tol = (double)(param_.getValue("warp:mz_tol"));
     double max_mz_tol = max(mz_tol_, warp_mz_tol);
 
     // compute partition boundaries
-    vector<double> partition_boundaries;
-    partition_boundaries.push_back(massrange.front());
-    for (size_t j = 0; j < massrange.size()-1; j++)
+    partition_boundaries.clear();
+    partition_boundaries.push_back(mz_values.front());
+    for (size_t j = 0; j < mz_values.size()-1; j++)
     {
       // minimal differences between two m/z values
-      double massrange_diff = mz_ppm_ ? max_mz_tol * 1e-6 * massrange[j+1] : max_mz_tol;
+      double massrange_diff = mz_ppm_ ? max_mz_tol * 1e-6 * mz_values[j+1] : max_mz_tol;
 
-      if (fabs(massrange[j] - massrange[j+1]) > massrange_diff)
+      if (fabs(mz_values[j] - mz_values[j+1]) > massrange_diff)
       {
         if (j >= (partition_boundaries.size() ) * pts_per_partition  )
         {
-          partition_boundaries.push_back((massrange[j] + massrange[j+1])/2.0);
+          partition_boundaries.push_back((mz_values[j] + mz_values[j+1])/2.0);
         }
       }
     }
     // add last partition (a bit more since we use "smaller than" below)
-    partition_boundaries.push_back(massrange.back() + 1.0);
-
-    // ------------ compute RT transformation models ------------
+    partition_boundaries.push_back(mz_values.back() + 1.0);
+  }
 
-    MapAlignmentAlgorithmKD aligner(input_maps.size(), param_);
-    bool align = param_.getValue("warp:enabled").toString() == "true";
-    if (align)
+  template <typename MapType>
+  void FeatureGroupingAlgorithmKD::extractPartition_(const vector<MapType>& input_maps, double partition_start, double partition_end, vector<MapType>& partition_maps)
+  {
+    partition_maps.assign(input_maps.size(), MapType());
+    for (size_t k = 0; k < input_maps.size(); k++)
     {
-      Size progress = 0;
-      startProgress(0, partition_boundaries.size(), "computing RT transformations");
-      for (size_t j = 0; j < partition_boundaries.size()-1; j++)
+      // iterate over all features in the current input map and append
+      // matching features (within the current partition) to the temporary
+      // map
+      for (size_t m = 0; m < input_maps[k].size(); m++)
       {
-        double partition_start = partition_boundaries[j];
-        double partition_end = partition_boundaries[j+1];
-
-        std::vector<MapType> tmp_input_maps(input_maps.size());
-        for (size_t k = 0; k < input_maps.size(); k++)
+        if (input_maps[k][m].getMZ() >= partition_start &&
+            input_maps[k][m].getMZ() < partition_end)
         {
-          // iterate over all features in the current input map and append
-          // matching features (within the current partition) to the temporary
-          // map
-          for (size_t m = 0; m < input_maps[k].size(); m++)
-          {
-            if (input_maps[k][m].getMZ() >= partition_start &&
-                input_maps[k][m].getMZ() < partition_end)
-            {
-              tmp_input_maps[k].push_back(input_maps[k][m]);
-            }
-          }
-          tmp_input_maps[k].updateRanges();
+          partition_maps[k].push_back(input_maps[k][m]);
         }
+      }
+      partition_maps[k].updateRanges();
+    }
+  }
+
+  template <typename MapType>
+  void FeatureGroupingAlgorithmKD::addRTFitData_(const vector<MapType>& input_maps, const vector<double>& partition_boundaries, Size first_partition, Size last_partition, MapAlignmentAlgorithmKD& aligner, Size& progress)
+  {
+    for (Size j = first_partition; j < last_partition; j++)
+    {
+      std::vector<MapType> tmp_input_maps;
+      extractPartition_(input_maps, partition_boundaries[j], partition_boundaries[j+1], tmp_input_maps);
+
+      // set up kd-tree
+      KDTreeFeatureMaps kd_data(tmp_input_maps, param_);
+      aligner.addRTFitData(kd_data);
+      setProgress(progress++);
+    }
+  }
+
+  template <typename MapType>
+  void FeatureGroupingAlgorithmKD::linkPartitions_(const vector<MapType>& input_maps, const vector<double>& partition_boundaries, Size first_partition, Size last_partition, const MapAlignmentAlgorithmKD* aligner, ConsensusMap& out, Size& progress)
+  {
+    // Partitions are independent and linked concurrently, if there are enough
+    // of them to keep all threads busy (otherwise, the neighborhoods within
+    // each partition are computed in parallel). Consensus features are added
+    // to the output in partition order.
+    const SignedSize nr_partitions = last_partition - first_partition;
+    vector<ConsensusMap> partition_results(nr_partitions);
+    vector<std::exception_ptr> errors(nr_partitions);
+#ifdef _OPENMP
+    const bool parallel_partitions = nr_partitions >= omp_get_max_threads();
+#else
+    const bool parallel_partitions = false;
+#endif
+#pragma omp parallel for schedule(dynamic, 1) if (parallel_partitions)
+    for (SignedSize j = 0; j < nr_partitions; j++)
+    {
+      try
+      {
+        const Size partition = first_partition + j;
+        std::vector<MapType> tmp_input_maps;
+        extractPartition_(input_maps, partition_boundaries[partition], partition_boundaries[partition+1], tmp_input_maps);
 
         // set up kd-tree
         KDTreeFeatureMaps kd_data(tmp_input_maps, param_);
-        aligner.addRTFitData(kd_data);
-        setProgress(progress++);
+
+        // alignment
+        if (aligner)
+        {
+          aligner->transform(kd_data);
+        }
+
+        // link features
+        runClustering_(kd_data, partition_results[j]);
+      }
+      catch (...)
+      {
+        errors[j] = std::current_exception();
       }
+#pragma omp atomic
+      ++progress;
+      IF_MASTERTHREAD setProgress(progress);
+    }
+
+    for (const std::exception_ptr& error : errors)
+    {
+      if (error) std::rethrow_exception(error);
+    }
+    for (ConsensusMap& partition_result : partition_results)
+    {
+      for (ConsensusFeature& cf : partition_result)
+      {
+        out.push_back(std::move(cf));
+      }
+      partition_result.clear();
+    }
+  }
+
+  template <typename MapType>
+  void FeatureGroupingAlgorithmKD::group_(const vector<MapType>& input_maps,
+                                          ConsensusMap& out)
+  {
+    // check that the number of maps is ok:
+    if (input_maps.size() < 2)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+                                       "At least two maps must be given!");
+    }
+
+    out.clear(false);
+
+    // collect all m/z values for partitioning, find intensity maximum
+    vector<double> massrange;
+    double max_intensity(0.0);
+    for (typename vector<MapType>::const_iterator map_it = input_maps.begin();
+         map_it != input_maps.end(); ++map_it)
+    {
+      for (typename MapType::const_iterator feat_it = map_it->begin();
+          feat_it != map_it->end(); feat_it++)
+      {
+        massrange.push_back(feat_it->getMZ());
+        double inty = feat_it->getIntensity();
+        if (inty > max_intensity)
+        {
+          max_intensity = inty;
+        }
+      }
+    }
+
+    vector<double> partition_boundaries;
+    setUp_(massrange, max_intensity, partition_boundaries);
+    const Size nr_partitions = partition_boundaries.size() - 1;
+
+    // ------------ compute RT transformation models ------------
+
+    MapAlignmentAlgorithmKD aligner(input_maps.size(), param_);
+    bool align = param_.getValue("warp:enabled").toString() == "true";
+    if (align)
+    {
+      Size progress = 0;
+      startProgress(0, partition_boundaries.size(), "computing RT transformations");
+      addRTFitData_(input_maps, partition_boundaries, 0, nr_partitions, aligner, progress);
 
       // fit LOWESS on RT fit data collected across all partitions
       try
@@ -241,44 +323,107 @@ namespace OpenMS
     // ------------ run alignment + feature linking on individual partitions ------------
     Size progress = 0;
     startProgress(0, partition_boundaries.size(), "linking features");
-    for (size_t j = 0; j < partition_boundaries.size()-1; j++)
+    linkPartitions_(input_maps, partition_boundaries, 0, nr_partitions, align ? &aligner : nullptr, out, progress);
+    endProgress();
+
+    postprocess_(input_maps, out);
+  }
+
+  void FeatureGroupingAlgorithmKD::groupOutOfCore(Size num_maps, vector<double> mz_values, double max_intensity, Size batch_size,
+                                                  const MapRangeLoader& load_range, const ConsensusConsumer& consume)
+  {
+    // check that the number of maps is ok:
+    if (num_maps < 2)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+                                       "At least two maps must be given!");
+    }
+    if (mz_values.empty())
+    {
+      return;
+    }
+
+    // same partitions as for the in-memory algorithm (sorts 'mz_values')
+    vector<double> partition_boundaries;
+    setUp_(mz_values, max_intensity, partition_boundaries);
+    const Size nr_partitions = partition_boundaries.size() - 1;
+
+    // combine consecutive partitions into batches of (at least) 'batch_size'
+    // features, the last one may be smaller
+    vector<Size> batch_starts(1, 0);
+    Size batch_features = 0;
+    for (Size j = 0; j < nr_partitions; ++j)
     {
-      double partition_start = partition_boundaries[j];
-      double partition_end = partition_boundaries[j+1];
+      batch_features += lower_bound(mz_values.begin(), mz_values.end(), partition_boundaries[j+1]) -
+                        lower_bound(mz_values.begin(), mz_values.end(), partition_boundaries[j]);
+      if (batch_size > 0 && batch_features >= batch_size && j + 1 < nr_partitions)
+      {
+        batch_starts.push_back(j + 1);
+        batch_features = 0;
+      }
+    }
+    batch_starts.push_back(nr_partitions);
+    const Size nr_batches = batch_starts.size() - 1;
+    OPENMS_LOG_INFO << "Linking " << mz_values.size() << " features in " << nr_partitions
+                    << " partitions (" << nr_batches << " batches)." << endl;
 
-      std::vector<MapType> tmp_input_maps(input_maps.size());
-      for (size_t k = 0; k < input_maps.size(); k++)
+    // loads the features of a batch
+    auto load_batch = [&](Size batch, vector<FeatureMap>& maps)
+    {
+      maps.clear();
+      load_range(partition_boundaries[batch_starts[batch]], partition_boundaries[batch_starts[batch+1]], maps);
+      if (maps.size() != num_maps)
       {
-        // iterate over all features in the current input map and append
-        // matching features (within the current partition) to the temporary
-        // map
-        for (size_t m = 0; m < input_maps[k].size(); m++)
-        {
-          if (input_maps[k][m].getMZ() >= partition_start &&
-              input_maps[k][m].getMZ() < partition_end)
-          {
-            tmp_input_maps[k].push_back(input_maps[k][m]);
-          }
-        }
-        tmp_input_maps[k].updateRanges();
+        throw Exception::InvalidSize(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, maps.size());
       }
+    };
 
-      // set up kd-tree
-      KDTreeFeatureMaps kd_data(tmp_input_maps, param_);
+    // ------------ compute RT transformation models (first pass over the data) ------------
 
-      // alignment
-      if (align)
+    MapAlignmentAlgorithmKD aligner(num_maps, param_);
+    bool align = param_.getValue("warp:enabled").toString() == "true";
+    vector<FeatureMap> maps;
+    if (align)
+    {
+      Size progress = 0;
+      startProgress(0, partition_boundaries.size(), "computing RT transformations");
+      for (Size batch = 0; batch < nr_batches; ++batch)
       {
-        aligner.transform(kd_data);
+        load_batch(batch, maps);
+        addRTFitData_(maps, partition_boundaries, batch_starts[batch], batch_starts[batch+1], aligner, progress);
       }
 
-      // link features
-      runClustering_(kd_data, out);
-      setProgress(progress++);
+      // fit LOWESS on RT fit data collected across all partitions
+      try
+      {
+        aligner.fitLOWESS();
+      }
+      catch (Exception::BaseException& e)
+      {
+        OPENMS_LOG_ERROR << "Error: " << e.what() << endl;
+        return;
+      }
+
+      endProgress();
+    }
+
+    // ------------ run alignment + feature linking batch by batch (second pass) ------------
+    Size progress = 0;
+    startProgress(0, partition_boundaries.size(), "linking features");
+    for (Size batch = 0; batch < nr_batches; ++batch)
+    {
+      load_batch(batch, maps);
+      ConsensusMap batch_out;
+      linkPartitions_(maps, partition_boundaries, batch_starts[batch], batch_starts[batch+1], align ? &aligner : nullptr, batch_out, progress);
+      maps.clear();
+
+      // canonical ordering (within the batch)
+      batch_out.sortByQuality();
+      batch_out.sortByMaps();
+      batch_out.sortBySize();
+      consume(batch_out);
     }
     endProgress();
-    
-    postprocess_(input_maps, out);
   }
 
   void FeatureGroupingAlgorithmKD::group(const std::vector<FeatureMap>& maps,
@@ -293,10 +438,146 @@ namespace OpenMS
     group_(maps, out);
   }
 
-  void FeatureGroupingAlgorithmKD::runClustering_(const KDTreeFeatureMaps& kd_data, ConsensusMap& out)
+  void FeatureGroupingAlgorithmKD::computeNeighborhoods_(const KDTreeFeatureMaps& kd_data, Neighborhoods_& neighborhoods) const
+  {
+    //Parameters how to use charge/adduct information
+    String merge_charge(param_.getValue("link:charge_merging").toString());
+    String merge_adduct(param_.getValue("link:adduct_merging").toString());
+
+    // can feature j be part of a consensus feature with center i?
+    auto compatible = [&](Size i, Size j)
+    {
+      Int charge_i = kd_data.charge(i);
+      const BaseFeature* f_i = kd_data.feature(i);
+
+      if (merge_charge == "Identical")
+      {
+        if (kd_data.charge(j) != charge_i)
+        {
+          return false;
+        }
+      }
+      // what to consider for linking with existing features _that have charge_. This ensures that we won't collect different non-zero charges.
+      else if (merge_charge == "With_charge_zero")
+      {
+        if ((kd_data.charge(j) != charge_i) && (kd_data.charge(j) != 0))
+        {
+          return false;
+        }
+      }
+      // else if (merge_charge == "Any")
+      //{
+      //  //we allow to merge all
+      //}
+
+      // analogous adduct block
+      if (merge_adduct == "Identical")
+      {
+        // subcase 1: one has adduct, other not
+        if (kd_data.feature(j)->metaValueExists(Constants::UserParam::DC_CHARGE_ADDUCTS) != f_i->metaValueExists(Constants::UserParam::DC_CHARGE_ADDUCTS))
+        {
+          return false;
+        }
+        // subcase 2: both have adduct, but is it the same?
+        if (kd_data.feature(j)->metaValueExists(Constants::UserParam::DC_CHARGE_ADDUCTS))
+        {
+          if (EmpiricalFormula(kd_data.feature(j)->getMetaValue(Constants::UserParam::DC_CHARGE_ADDUCTS)) != EmpiricalFormula(f_i->getMetaValue(Constants::UserParam::DC_CHARGE_ADDUCTS)))
+          {
+            return false;
+          }
+        }
+      }
+      // what to consider for linking with existing features _that have adduct_. If one has no adduct, it's fine
+      // anyway. If one has an adduct we have to compare.
+      else if (merge_adduct == "With_unknown_adducts")
+      {
+        // subcase1: j has adduct, but i not. don't want to collect potentially different adducts to previous without adduct
+        if ((kd_data.feature(j)->metaValueExists(Constants::UserParam::DC_CHARGE_ADDUCTS)) && (!f_i->metaValueExists(Constants::UserParam::DC_CHARGE_ADDUCTS)))
+        {
+          return false;
+        }
+        // subcase2: both have adduct
+        if ((kd_data.feature(j)->metaValueExists(Constants::UserParam::DC_CHARGE_ADDUCTS)) && (f_i->metaValueExists(Constants::UserParam::DC_CHARGE_ADDUCTS)))
+        {
+          // cheaper string check first, only check EF extensively if strings differ (might be just different element orders)
+          if ((kd_data.feature(j)->getMetaValue(Constants::UserParam::DC_CHARGE_ADDUCTS) != f_i->getMetaValue(Constants::UserParam::DC_CHARGE_ADDUCTS)) &&
+              (EmpiricalFormula(kd_data.feature(j)->getMetaValue(Constants::UserParam::DC_CHARGE_ADDUCTS)) != EmpiricalFormula(f_i->getMetaValue(Constants::UserParam::DC_CHARGE_ADDUCTS))))
+          {
+            return false;
+          }
+        }
+      }
+      // else if (merge_adduct == "Any")
+      //{
+      //  //we allow to merge all
+      //}
+
+      return true;
+    };
+
+    // FeatureDistance::operator() does not modify the functor
+    FeatureDistance& feature_distance = const_cast<FeatureDistance&>(feature_distance_);
+
+    const Size n = kd_data.size();
+    vector<vector<Size>> neighbors(n);
+    vector<vector<double>> distances(n);
+    neighborhoods.center_distances.resize(n);
+    vector<std::exception_ptr> errors(n);
+#pragma omp parallel for schedule(dynamic, 64)
+    for (SignedSize i = 0; i < (SignedSize) n; ++i)
+    {
+      try
+      {
+        kd_data.getNeighborhood(i, neighbors[i], rt_tol_secs_, mz_tol_, mz_ppm_, true);
+        distances[i].resize(neighbors[i].size(), -1.0);
+        for (Size k = 0; k < neighbors[i].size(); ++k)
+        {
+          Size j = neighbors[i][k];
+          // center i is always part of its CF, no other points from i's map can be contained
+          if (kd_data.mapIndex(j) != kd_data.mapIndex(i) && compatible(i, j))
+          {
+            distances[i][k] = feature_distance(*(kd_data.feature(j)), *(kd_data.feature(i))).second;
+          }
+        }
+        neighborhoods.center_distances[i] = feature_distance(*(kd_data.feature(i)), *(kd_data.feature(i))).second;
+      }
+      catch (...)
+      {
+        errors[i] = std::current_exception();
+      }
+    }
+    for (const std::exception_ptr& error : errors)
+    {
+      if (error) std::rethrow_exception(error);
+    }
+
+    // compress
+    neighborhoods.offsets.assign(1, 0);
+    for (Size i = 0; i < n; ++i)
+    {
+      neighborhoods.offsets.push_back(neighborhoods.offsets.back() + neighbors[i].size());
+    }
+    neighborhoods.neighbors.clear();
+    neighborhoods.neighbors.reserve(neighborhoods.offsets.back());
+    neighborhoods.distances.clear();
+    neighborhoods.distances.reserve(neighborhoods.offsets.back());
+    for (Size i = 0; i < n; ++i)
+    {
+      neighborhoods.neighbors.insert(neighborhoods.neighbors.end(), neighbors[i].begin(), neighbors[i].end());
+      vector<Size>().swap(neighbors[i]);
+      neighborhoods.distances.insert(neighborhoods.distances.end(), distances[i].begin(), distances[i].end());
+      vector<double>().swap(distances[i]);
+    }
+  }
+
+  void FeatureGroupingAlgorithmKD::runClustering_(const KDTreeFeatureMaps& kd_data, ConsensusMap& out) const
   {
     Size n = kd_data.size();
 
+    // neighborhoods don't change, only which points are still available
+    Neighborhoods_ neighborhoods;
+    computeNeighborhoods_(kd_data, neighborhoods);
+
     // pass 1: initialize best potential clusters for all possible cluster centers
     set<Size> update_these;
     for (Size i = 0; i < kd_data.size(); ++i)
@@ -306,7 +587,7 @@ namespace OpenMS
     set<ClusterProxyKD> potential_clusters;
     vector<ClusterProxyKD> cluster_for_idx(n);
     vector<Int> assigned(n, false);
-    updateClusterProxies_(potential_clusters, cluster_for_idx, update_these, assigned, kd_data);
+    updateClusterProxies_(potential_clusters, cluster_for_idx, update_these, assigned, kd_data, neighborhoods);
 
     // pass 2: construct consensus features until all points assigned.
     while (!potential_clusters.empty())
@@ -316,7 +597,7 @@ namespace OpenMS
 
       // compile the actual list of sub feature indices for cluster with center i
       vector<Size> cf_indices;
-      computeBestClusterForCenter_(i, cf_indices, assigned, kd_data);
+      computeBestClusterForCenter_(i, cf_indices, assigned, kd_data, neighborhoods);
 
       // add consensus feature
       addConsensusFeature_(cf_indices, kd_data, out);
@@ -332,19 +613,17 @@ namespace OpenMS
       update_these = set<Size>();
       for (vector<Size>::const_iterator f_it = cf_indices.begin(); f_it != cf_indices.end(); ++f_it)
       {
-        vector<Size> f_neighbors;
-        kd_data.getNeighborhood(*f_it, f_neighbors, rt_tol_secs_, mz_tol_, mz_ppm_, true);
-        for (vector<Size>::const_iterator it = f_neighbors.begin(); it != f_neighbors.end(); ++it)
+        for (Size k = neighborhoods.offsets[*f_it]; k < neighborhoods.offsets[*f_it + 1]; ++k)
         {
-          if (!assigned[*it])
+          if (!assigned[neighborhoods.neighbors[k]])
           {
-            update_these.insert(*it);
+            update_these.insert(neighborhoods.neighbors[k]);
           }
         }
       }
 
       // now that the points are marked assigned, update the neighborhoods of their neighbors
-      updateClusterProxies_(potential_clusters, cluster_for_idx, update_these, assigned, kd_data);
+      updateClusterProxies_(potential_clusters, cluster_for_idx, update_these, assigned, kd_data, neighborhoods);
     }
   }
 
@@ -354,14 +633,25 @@ namespace OpenMS
                                                          vector<ClusterProxyKD>& cluster_for_idx,
                                                          const set<Size>& update_these,
                                                          const vector<Int>& assigned,
-                                                         const KDTreeFeatureMaps& kd_data)
+                                                         const KDTreeFeatureMaps& kd_data,
+                                                         const Neighborhoods_& neighborhoods) const
   {
-    for (set<Size>::const_iterator it = update_these.begin(); it != update_these.end(); ++it)
+    // compute the new proxies (in parallel if there are many), then update the "priority queue";
+    // proxies of different centers never compare equal, so the order of updates doesn't matter
+    const vector<Size> indices(update_these.begin(), update_these.end());
+    vector<ClusterProxyKD> new_proxies(indices.size());
+#pragma omp parallel for schedule(dynamic, 64) if (indices.size() > 256)
+    for (SignedSize k = 0; k < (SignedSize) indices.size(); ++k)
     {
-      Size i = *it;
-      const ClusterProxyKD& old_proxy = cluster_for_idx[i];
       vector<Size> unused;
-      ClusterProxyKD new_proxy = computeBestClusterForCenter_(i, unused, assigned, kd_data);
+      new_proxies[k] = computeBestClusterForCenter_(indices[k], unused, assigned, kd_data, neighborhoods);
+    }
+
+    for (Size k = 0; k < indices.size(); ++k)
+    {
+      Size i = indices[k];
+      const ClusterProxyKD& old_proxy = cluster_for_idx[i];
+      const ClusterProxyKD& new_proxy = new_proxies[k];
 
       // only need to update if size and/or average distance have changed
       if (new_proxy != old_proxy)
@@ -373,119 +663,53 @@ namespace OpenMS
     }
   }
 
-  ClusterProxyKD FeatureGroupingAlgorithmKD::computeBestClusterForCenter_(Size i, vector<Size>& cf_indices, const vector<Int>& assigned, const KDTreeFeatureMaps& kd_data) const
+  ClusterProxyKD FeatureGroupingAlgorithmKD::computeBestClusterForCenter_(Size i, vector<Size>& cf_indices, const vector<Int>& assigned, const KDTreeFeatureMaps& kd_data, const Neighborhoods_& neighborhoods) const
   {
-    //Parameters how to use charge/adduct information
-    String merge_charge(param_.getValue("link:charge_merging").toString());
-    String merge_adduct(param_.getValue("link:adduct_merging").toString());
-
-    // compute i's neighborhood, together with a look-up table
-    // map index -> corresponding points
-    map<Size, vector<Size> > points_for_map_index;
-    vector<Size> neighbors;
-    kd_data.getNeighborhood(i, neighbors, rt_tol_secs_, mz_tol_, mz_ppm_, true);
-    Int charge_i = kd_data.charge(i);
-    const BaseFeature* f_i = kd_data.feature(i);
-    for (vector<Size>::const_iterator it = neighbors.begin(); it != neighbors.end(); ++it)
+    // collect (map index, neighborhood position) of all available points that can be linked with center i,
+    // plus center i, which is always part of its CF
+    vector<pair<Size, Size> > candidates;
+    for (Size k = neighborhoods.offsets[i]; k < neighborhoods.offsets[i + 1]; ++k)
     {
       // If the feature was already assigned, don't consider it at all!
-      if (assigned[*it])
+      if (neighborhoods.distances[k] < 0.0 || assigned[neighborhoods.neighbors[k]])
       {
         continue;
       }
-
-      if (merge_charge == "Identical")
-      {
-        if (kd_data.charge(*it) != charge_i)
-        {
-          continue;
-        }
-      }
-      // what to consider for linking with existing features _that have charge_. This ensures that we won't collect different non-zero charges.
-      else if (merge_charge == "With_charge_zero")
-      {
-        if ((kd_data.charge(*it) != charge_i) && (kd_data.charge(*it) != 0))
-        {
-          continue;
-        }
-      }
-      // else if (merge_charge == "Any")
-      //{
-      //  //we allow to merge all
-      //}
-
-      // analogous adduct block
-      if (merge_adduct == "Identical")
-      {
-        // subcase 1: one has adduct, other not
-        if (kd_data.feature(*it)->metaValueExists(Constants::UserParam::DC_CHARGE_ADDUCTS) != f_i->metaValueExists(Constants::UserParam::DC_CHARGE_ADDUCTS))
-        {
-          continue;
-        }
-        // subcase 2: both have adduct, but is it the same?
-        if (kd_data.feature(*it)->metaValueExists(Constants::UserParam::DC_CHARGE_ADDUCTS))
-        {
-          if (EmpiricalFormula(kd_data.feature(*it)->getMetaValue(Constants::UserParam::DC_CHARGE_ADDUCTS)) != EmpiricalFormula(f_i->getMetaValue(Constants::UserParam::DC_CHARGE_ADDUCTS)))
-          {
-            continue;
-          }  
-        }
-      }
-      // what to consider for linking with existing features _that have adduct_. If one has no adduct, it's fine
-      // anyway. If one has an adduct we have to compare.
-      else if (merge_adduct == "With_unknown_adducts")
-      {
-        // subcase1: *it has adduct, but i not. don't want to collect potentially different adducts to previous without adduct 
-        if ((kd_data.feature(*it)->metaValueExists(Constants::UserParam::DC_CHARGE_ADDUCTS)) && (!f_i->metaValueExists(Constants::UserParam::DC_CHARGE_ADDUCTS)))
-        {
-          continue;
-        }
-        // subcase2: both have adduct
-        if ((kd_data.feature(*it)->metaValueExists(Constants::UserParam::DC_CHARGE_ADDUCTS)) && (f_i->metaValueExists(Constants::UserParam::DC_CHARGE_ADDUCTS)))
-        {
-          // cheaper string check first, only check EF extensively if strings differ (might be just different element orders)
-          if ((kd_data.feature(*it)->getMetaValue(Constants::UserParam::DC_CHARGE_ADDUCTS) != f_i->getMetaValue(Constants::UserParam::DC_CHARGE_ADDUCTS)) &&
-              (EmpiricalFormula(kd_data.feature(*it)->getMetaValue(Constants::UserParam::DC_CHARGE_ADDUCTS)) != EmpiricalFormula(f_i->getMetaValue(Constants::UserParam::DC_CHARGE_ADDUCTS))))
-          {
-            continue;
-          }
-        }
-      }
-      // else if (merge_adduct == "Any")
-      //{
-      //  //we allow to merge all
-      //}
-
-      // if everything is OK, add feature
-      points_for_map_index[kd_data.mapIndex(*it)].push_back(*it);
+      candidates.emplace_back(kd_data.mapIndex(neighborhoods.neighbors[k]), k);
     }
-    // center i is always part of CF, no other points from i's map can be contained
-    points_for_map_index[kd_data.mapIndex(i)] = vector<Size>(1, i);
+    const Size center = numeric_limits<Size>::max(); // marks the center among the candidates
+    candidates.emplace_back(kd_data.mapIndex(i), center);
+    // group by map index (keeping the order within each map)
+    stable_sort(candidates.begin(), candidates.end(),
+                [](const pair<Size, Size>& a, const pair<Size, Size>& b) { return a.first < b.first; });
 
     // compile list of sub feature indices and corresponding average distance
     double avg_distance = 0.0;
-    for (map<Size, vector<Size> >::const_iterator it = points_for_map_index.begin();
-         it != points_for_map_index.end();
-         ++it)
+    for (vector<pair<Size, Size> >::const_iterator group_begin = candidates.begin(); group_begin != candidates.end(); )
     {
-      const vector<Size>& candidates = it->second;
+      vector<pair<Size, Size> >::const_iterator group_end = group_begin;
+      while (group_end != candidates.end() && group_end->first == group_begin->first)
+      {
+        ++group_end;
+      }
 
       // choose a point j with minimal distance to center i
       double min_dist = numeric_limits<double>::max();
       Size best_index = numeric_limits<Size>::max();
-      for (vector<Size>::const_iterator c_it = candidates.begin(); c_it != candidates.end(); ++c_it)
+      for (vector<pair<Size, Size> >::const_iterator c_it = group_begin; c_it != group_end; ++c_it)
       {
-        double dist = const_cast<FeatureDistance&>(feature_distance_)(*(kd_data.feature(*c_it)),
-                                                                      *(kd_data.feature(i))).second;
+        double dist = (c_it->second == center) ? neighborhoods.center_distances[i] : neighborhoods.distances[c_it->second];
+        Size index = (c_it->second == center) ? i : neighborhoods.neighbors[c_it->second];
 
         if (dist < min_dist)
         {
           min_dist = dist;
-          best_index = *c_it;
+          best_index = index;
         }
       }
       cf_indices.push_back(best_index);
       avg_distance += min_dist;
+      group_begin = group_end;
     }
     avg_distance /= cf_indices.size();
 
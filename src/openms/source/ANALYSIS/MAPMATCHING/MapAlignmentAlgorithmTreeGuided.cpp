@@ -48,6 +48,12 @@
 #include <OpenMS/CONCEPT/LogStream.h>
 #include <include/OpenMS/APPLICATIONS/MapAlignerBase.h>
 
+#include <exception>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using namespace std;
 
 namespace OpenMS
@@ -77,12 +83,12 @@ namespace OpenMS
     model_param_ = model_param_.copy(model_type_+":", true);
   }
 
-  // Similarity functor that provides similarity calculations with the ()-operator for protected type SeqAndRTList
-  // that stores retention times given for individual peptide sequences of a feature map
+  // Similarity functor that provides similarity calculations with the ()-operator for protected type SeqIndexAndRTList
+  // that stores the median retention time for each (indexed) peptide sequence of a feature map
   class MapAlignmentAlgorithmTreeGuided::PeptideIdentificationsPearsonDistance_
   {
   public:
-    float operator()(SeqAndRTList& map_first, SeqAndRTList& map_second) const
+    float operator()(const SeqIndexAndRTList& map_first, const SeqIndexAndRTList& map_second) const
     {
       // if both input maps have no peptide identifications with hits (sequence) they are not similar
       if (map_first.size()+map_second.size() == 0)
@@ -109,10 +115,8 @@ namespace OpenMS
         }
         else
         {
-          double med1 = Math::median(pep1_it->second.begin(), pep1_it->second.end(), true);
-          intercept_rts1.push_back(med1);
-          double med2 = Math::median(pep2_it->second.begin(), pep2_it->second.end(), true);
-          intercept_rts2.push_back(med2);
+          intercept_rts1.push_back(pep1_it->second);
+          intercept_rts2.push_back(pep2_it->second);
           ++pep1_it;
           ++pep2_it;
         }
@@ -163,18 +167,68 @@ namespace OpenMS
   }
 
 
+  // Convert the extracted sequences and RTs of each map into a compact array of (sequence index, median RT) pairs.
+  void MapAlignmentAlgorithmTreeGuided::indexSeqAndRt_(vector<SeqAndRTList>& maps_seq_and_rt,
+          vector<SeqIndexAndRTList>& maps_seq_index_and_rt)
+  {
+    // index all sequences in lexicographical order, so the order of the compact arrays matches the order of the maps
+    vector<String> sequences;
+    for (const SeqAndRTList& seq_and_rt : maps_seq_and_rt)
+    {
+      for (const auto& entry : seq_and_rt)
+      {
+        sequences.push_back(entry.first);
+      }
+    }
+    sort(sequences.begin(), sequences.end());
+    sequences.erase(unique(sequences.begin(), sequences.end()), sequences.end());
+
+    maps_seq_index_and_rt.clear();
+    maps_seq_index_and_rt.resize(maps_seq_and_rt.size());
+#pragma omp parallel for schedule(dynamic, 1)
+    for (SignedSize i = 0; i < (SignedSize) maps_seq_and_rt.size(); ++i)
+    {
+      SeqIndexAndRTList& seq_index_and_rt = maps_seq_index_and_rt[i];
+      seq_index_and_rt.reserve(maps_seq_and_rt[i].size());
+      auto seq_it = sequences.begin();
+      for (auto& entry : maps_seq_and_rt[i])
+      {
+        seq_it = lower_bound(seq_it, sequences.end(), entry.first);
+        double med = Math::median(entry.second.begin(), entry.second.end(), true);
+        seq_index_and_rt.emplace_back(seq_it - sequences.begin(), med);
+      }
+    }
+  }
+
   // Extract RTs given for individual features of each map, calculate distances for each pair of maps and cluster hierarchical using average linkage.
   void MapAlignmentAlgorithmTreeGuided::buildTree(std::vector<FeatureMap>& feature_maps, std::vector<BinaryTreeNode>& tree,
                                                   std::vector<std::vector<double>>& maps_ranges)
   {
-    vector<SeqAndRTList> maps_seq_and_rt(feature_maps.size());
-    extractSeqAndRt_(feature_maps, maps_seq_and_rt, maps_ranges);
+    vector<SeqIndexAndRTList> maps_seq_index_and_rt;
+    {
+      vector<SeqAndRTList> maps_seq_and_rt(feature_maps.size());
+      extractSeqAndRt_(feature_maps, maps_seq_and_rt, maps_ranges);
+      indexSeqAndRt_(maps_seq_and_rt, maps_seq_index_and_rt);
+    } // free sequence strings
+
     PeptideIdentificationsPearsonDistance_ pep_dist;
     AverageLinkage al;
-    DistanceMatrix<float> dist_matrix; // will be filled
     ClusterHierarchical ch;
 
-    ch.cluster<SeqAndRTList, PeptideIdentificationsPearsonDistance_>(maps_seq_and_rt, pep_dist, al, tree, dist_matrix);
+    // distance value is 1-similarity value (as in ClusterHierarchical), computed in parallel over the rows
+    const Size n = maps_seq_index_and_rt.size();
+    DistanceMatrix<float> dist_matrix(n, 1);
+#pragma omp parallel for schedule(dynamic, 1)
+    for (SignedSize i = (SignedSize) n - 1; i > 0; --i)
+    {
+      for (Size j = 0; j < Size(i); ++j)
+      {
+        dist_matrix.setValueQuick(i, j, 1 - pep_dist(maps_seq_index_and_rt[i], maps_seq_index_and_rt[j]));
+      }
+    }
+
+    // matrix has the right size, so it is used as is
+    ch.cluster<SeqIndexAndRTList, PeptideIdentificationsPearsonDistance_>(maps_seq_index_and_rt, pep_dist, al, tree, dist_matrix);
   }
 
   // Align feature maps tree guided using align() of MapAlignmentAlgorithmIdentification and use TreeNode with larger 10/90 percentile range as reference.
@@ -185,8 +239,6 @@ namespace OpenMS
                                                             std::vector<Size>& trafo_order)
   {
     Size last_trafo = 0;  // to get final transformation order from map_sets
-    vector<TransformationDescription> transformations_align;  // temporary for aligner output
-    vector<FeatureMap> to_align;
 
     // helper to memorize rt transformation order
     vector<vector<Size>> map_sets(feature_maps_transformed.size());
@@ -195,9 +247,6 @@ namespace OpenMS
       map_sets[i].push_back(i);
     }
 
-    Size ref;
-    Size to_transform;
-
     // check RT ranges of IDs
     for (size_t i = 0; i < maps_ranges.size(); ++i)
     {
@@ -206,65 +255,102 @@ namespace OpenMS
       if (maps_ranges[i].empty()) throw Exception::MissingInformation(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "FeatureMap originating from '" + ListUtils::concatenate(p, "', '") + "' contains no Peptide Identifications. Cannot align!");
     }
 
-    for (const auto& node : tree)
+    // group the tree nodes into levels: a node depends on the last nodes that combined its children,
+    // nodes of the same level combine disjoint clusters and can be aligned concurrently
+    vector<Size> map_level(feature_maps_transformed.size(), 0);
+    vector<vector<Size>> levels;
+    for (Size n = 0; n < tree.size(); ++n)
     {
-      // ----------------
-      // prepare alignment
-      // ----------------
-      //  determine the map with larger RT range for 10/90 percentile (->reference)
-      double left_range = maps_ranges[node.left_child][maps_ranges[node.left_child].size()*0.9] - maps_ranges[node.left_child][maps_ranges[node.left_child].size()*0.1];
-      double right_range = maps_ranges[node.right_child][maps_ranges[node.right_child].size()*0.9] - maps_ranges[node.right_child][maps_ranges[node.right_child].size()*0.1];
-
-      if (left_range > right_range)
-      {
-        ref = node.left_child;
-        to_transform = node.right_child;
-      }
-      else
-      {
-        ref = node.right_child;
-        to_transform = node.left_child;
-      }
-
-      vector<double> tmp;
-      std::merge(maps_ranges[node.right_child].begin(), maps_ranges[node.right_child].end(), maps_ranges[node.left_child].begin(), maps_ranges[node.left_child].end(), std::back_inserter(tmp));
-
-      to_align.push_back(feature_maps_transformed[to_transform]);
-      to_align.push_back(feature_maps_transformed[ref]);
-
-      // ----------------
-      // perform alignment
-      // ----------------
-      align_algorithm_.align(to_align, transformations_align, 1);
-
-      // transform retention times of non-identity for next iteration
-      transformations_align[0].fitModel(model_type_, model_param_);
-      MapAlignmentTransformer::transformRetentionTimes(feature_maps_transformed[to_transform],
-              transformations_align[0], true);
+      Size level = max(map_level[tree[n].left_child], map_level[tree[n].right_child]);
+      map_level[tree[n].left_child] = map_level[tree[n].right_child] = level + 1;
+      if (levels.size() <= level) levels.resize(level + 1);
+      levels[level].push_back(n);
+    }
 
-      // combine aligned maps, store at smaller index, because tree always calls smaller number
-      // clear feature map at larger index to save memory
-      feature_maps_transformed[ref] += feature_maps_transformed[to_transform];
-      feature_maps_transformed[ref].updateRanges();
-      if (ref < to_transform)
+    const Param align_param = align_algorithm_.getParameters();
+    for (const vector<Size>& level : levels)
+    {
+      vector<std::exception_ptr> errors(level.size());
+#pragma omp parallel for schedule(dynamic, 1)
+      for (SignedSize n = 0; n < (SignedSize) level.size(); ++n)
       {
-        feature_maps_transformed[to_transform].clear(true);
-        last_trafo = ref;
+        try
+        {
+          const BinaryTreeNode& node = tree[level[n]];
+          Size ref;
+          Size to_transform;
+
+          // ----------------
+          // prepare alignment
+          // ----------------
+          //  determine the map with larger RT range for 10/90 percentile (->reference)
+          double left_range = maps_ranges[node.left_child][maps_ranges[node.left_child].size()*0.9] - maps_ranges[node.left_child][maps_ranges[node.left_child].size()*0.1];
+          double right_range = maps_ranges[node.right_child][maps_ranges[node.right_child].size()*0.9] - maps_ranges[node.right_child][maps_ranges[node.right_child].size()*0.1];
+
+          if (left_range > right_range)
+          {
+            ref = node.left_child;
+            to_transform = node.right_child;
+          }
+          else
+          {
+            ref = node.right_child;
+            to_transform = node.left_child;
+          }
+
+          vector<FeatureMap> to_align;
+          to_align.push_back(feature_maps_transformed[to_transform]);
+          to_align.push_back(feature_maps_transformed[ref]);
+
+          // ----------------
+          // perform alignment
+          // ----------------
+          // the aligner stores the reference, so every alignment gets its own instance
+          MapAlignmentAlgorithmIdentification aligner;
+          aligner.setParameters(align_param);
+          vector<TransformationDescription> transformations_align;  // temporary for aligner output
+          aligner.align(to_align, transformations_align, 1);
+          to_align.clear();
+
+          // transform retention times of non-identity for next iteration
+          transformations_align[0].fitModel(model_type_, model_param_);
+          MapAlignmentTransformer::transformRetentionTimes(feature_maps_transformed[to_transform],
+                  transformations_align[0], true);
+
+          // combine aligned maps, store at smaller index, because tree always calls smaller number
+          // clear feature map at larger index to save memory
+          feature_maps_transformed[ref] += feature_maps_transformed[to_transform];
+          feature_maps_transformed[ref].updateRanges();
+          if (ref < to_transform)
+          {
+            feature_maps_transformed[to_transform].clear(true);
+          }
+          else
+          {
+            feature_maps_transformed[to_transform] = feature_maps_transformed[ref];
+            feature_maps_transformed[ref].clear(true);
+          }
+
+          // update order of alignment for both aligned maps
+          map_sets[ref].insert(map_sets[ref].end(), map_sets[to_transform].begin(), map_sets[to_transform].end());
+          map_sets[to_transform] = map_sets[ref];
+        }
+        catch (...)
+        {
+          errors[n] = std::current_exception();
+        }
       }
-      else
+      // rethrow the first error (in tree order)
+      for (const std::exception_ptr& error : errors)
       {
-        feature_maps_transformed[to_transform] = feature_maps_transformed[ref];
-        feature_maps_transformed[ref].clear(true);
-        last_trafo = to_transform;
+        if (error) std::rethrow_exception(error);
       }
-
-      // update order of alignment for both aligned maps
-      map_sets[ref].insert(map_sets[ref].end(), map_sets[to_transform].begin(), map_sets[to_transform].end());
-      map_sets[to_transform] = map_sets[ref];
-
-      transformations_align.clear();
-      to_align.clear();
     }
+    if (!tree.empty())
+    {
+      last_trafo = min(tree.back().left_child, tree.back().right_child);
+    }
+
     // copy last transformed FeatureMap for reference return
     map_transformed = feature_maps_transformed[last_trafo];
     trafo_order = map_sets[last_trafo];
@@ -53,19 +53,71 @@ namespace OpenMS
   }
 
 
+  class MapAlignmentTransformer::RTBatch_
+  {
+  public:
+    explicit RTBatch_(bool store_original_rt) :
+      store_original_rt_(store_original_rt)
+    {
+    }
+
+    /// Are RTs being collected (first pass)?
+    bool collecting() const
+    {
+      return collecting_;
+    }
+
+    /**
+       @brief Visits the next RT
+
+       In the first pass, @p rt is stored and returned unchanged. In the second pass, the transformed RT is returned
+       (and @p rt is stored as original RT in @p meta_info, if given and requested).
+    */
+    double next(double rt, MetaInfoInterface* meta_info = nullptr)
+    {
+      if (collecting_)
+      {
+        rts_.push_back(rt);
+        return rt;
+      }
+      if (store_original_rt_ && meta_info) storeOriginalRT_(*meta_info, rt);
+      return rts_[pos_++];
+    }
+
+    /// Transforms all collected RTs and starts the second pass
+    void apply(const TransformationDescription& trafo)
+    {
+      trafo.apply(rts_, rts_);
+      collecting_ = false;
+      pos_ = 0;
+    }
+
+  private:
+    bool store_original_rt_;
+    bool collecting_ = true;
+    vector<double> rts_;
+    Size pos_ = 0;
+  };
+
+
   void MapAlignmentTransformer::transformRetentionTimes(
     PeakMap& msexp, const TransformationDescription& trafo,
     bool store_original_rt)
   {
     msexp.clearRanges();
 
-    // Transform spectra
-    for (PeakMap::iterator mse_iter = msexp.begin();
-         mse_iter != msexp.end(); ++mse_iter)
+    // Transform spectra (sorted by RT, so the transformation can use its fast path)
+    vector<double> rts;
+    rts.reserve(msexp.size());
+    for (const MSSpectrum& spectrum : msexp)
+    {
+      rts.push_back(spectrum.getRT());
+    }
+    trafo.apply(rts, rts);
+    for (Size i = 0; i < msexp.size(); ++i)
     {
-      double rt = mse_iter->getRT();
-      if (store_original_rt) storeOriginalRT_(*mse_iter, rt);
-      mse_iter->setRT(trafo.apply(rt));
+      if (store_original_rt) storeOriginalRT_(msexp[i], msexp[i].getRT());
+      msexp[i].setRT(rts[i]);
     }
 
     // Also transform chromatograms
@@ -73,12 +125,15 @@ namespace OpenMS
     {
       MSChromatogram& chromatogram = msexp.getChromatogram(i);
       vector<double> original_rts;
-      if (store_original_rt) original_rts.reserve(chromatogram.size());
+      original_rts.reserve(chromatogram.size());
+      for (Size j = 0; j < chromatogram.size(); j++)
+      {
+        original_rts.push_back(chromatogram[j].getRT());
+      }
+      trafo.apply(original_rts, rts);
       for (Size j = 0; j < chromatogram.size(); j++)
       {
-        double rt = chromatogram[j].getRT();
-        if (store_original_rt) original_rts.push_back(rt);
-        chromatogram[j].setRT(trafo.apply(rt));
+        chromatogram[j].setRT(rts[j]);
       }
       if (store_original_rt && !chromatogram.metaValueExists("original_rt"))
       {
@@ -94,67 +149,61 @@ namespace OpenMS
     FeatureMap& fmap, const TransformationDescription& trafo,
     bool store_original_rt)
   {
-    for (vector<Feature>::iterator fmit = fmap.begin(); fmit != fmap.end();
-         ++fmit)
+    RTBatch_ batch(store_original_rt);
+    auto visitAll = [&]()
     {
-      applyToFeature_(*fmit, trafo, store_original_rt);
-    }
-
-    // adapt RT values of unassigned peptides:
-    if (!fmap.getUnassignedPeptideIdentifications().empty())
-    {
-      transformRetentionTimes(fmap.getUnassignedPeptideIdentifications(), trafo,
-                              store_original_rt);
-    }
+      for (Feature& feature : fmap)
+      {
+        visitRTs_(feature, batch);
+      }
+      // adapt RT values of unassigned peptides:
+      visitRTs_(fmap.getUnassignedPeptideIdentifications(), batch);
+    };
+    visitAll();
+    batch.apply(trafo);
+    visitAll();
   }
 
 
-  void MapAlignmentTransformer::applyToBaseFeature_(
-    BaseFeature& feature, const TransformationDescription& trafo,
-    bool store_original_rt)
+  void MapAlignmentTransformer::visitRTs_(BaseFeature& feature, RTBatch_& batch)
   {
     // transform feature position:
-    double rt = feature.getRT();
-    if (store_original_rt) storeOriginalRT_(feature, rt);
-    feature.setRT(trafo.apply(rt));
+    feature.setRT(batch.next(feature.getRT(), &feature));
 
     // adapt RT values of annotated peptides:
-    if (!feature.getPeptideIdentifications().empty())
-    {
-      transformRetentionTimes(feature.getPeptideIdentifications(), trafo,
-                              store_original_rt);
-    }
+    visitRTs_(feature.getPeptideIdentifications(), batch);
   }
 
 
-  void MapAlignmentTransformer::applyToFeature_(
-    Feature& feature, const TransformationDescription& trafo,
-    bool store_original_rt)
+  void MapAlignmentTransformer::visitRTs_(Feature& feature, RTBatch_& batch)
   {
-    applyToBaseFeature_(feature, trafo, store_original_rt);
+    visitRTs_(static_cast<BaseFeature&>(feature), batch);
 
     // loop over all convex hulls
-    vector<ConvexHull2D>& convex_hulls = feature.getConvexHulls();
-    for (vector<ConvexHull2D>::iterator chiter = convex_hulls.begin();
-         chiter != convex_hulls.end(); ++chiter)
+    for (ConvexHull2D& convex_hull : feature.getConvexHulls())
     {
+      if (batch.collecting())
+      {
+        for (const ConvexHull2D::PointType& point : convex_hull.getHullPoints())
+        {
+          batch.next(point[Feature::RT]);
+        }
+        continue;
+      }
       // transform all hull point positions within convex hull
-      ConvexHull2D::PointArrayType points = chiter->getHullPoints();
-      chiter->clear();
-      for (ConvexHull2D::PointArrayType::iterator points_iter = points.begin();
-           points_iter != points.end(); ++points_iter)
+      ConvexHull2D::PointArrayType points = convex_hull.getHullPoints();
+      convex_hull.clear();
+      for (ConvexHull2D::PointType& point : points)
       {
-        double rt = (*points_iter)[Feature::RT];
-        (*points_iter)[Feature::RT] = trafo.apply(rt);
+        point[Feature::RT] = batch.next(point[Feature::RT]);
       }
-      chiter->setHullPoints(points);
+      convex_hull.setHullPoints(points);
     }
 
     // recurse into subordinates
-    for (vector<Feature>::iterator subiter = feature.getSubordinates().begin();
-         subiter != feature.getSubordinates().end(); ++subiter)
+    for (Feature& subordinate : feature.getSubordinates())
     {
-      applyToFeature_(*subiter, trafo, store_original_rt);
+      visitRTs_(subordinate, batch);
     }
   }
 
@@ -163,33 +212,30 @@ namespace OpenMS
     ConsensusMap& cmap, const TransformationDescription& trafo,
     bool store_original_rt)
   {
-    for (ConsensusMap::Iterator cmit = cmap.begin(); cmit != cmap.end(); ++cmit)
-    {
-      applyToConsensusFeature_(*cmit, trafo, store_original_rt);
-    }
-
-    // adapt RT values of unassigned peptides:
-    if (!cmap.getUnassignedPeptideIdentifications().empty())
+    RTBatch_ batch(store_original_rt);
+    auto visitAll = [&]()
     {
-      transformRetentionTimes(cmap.getUnassignedPeptideIdentifications(), trafo,
-                              store_original_rt);
-    }
+      for (ConsensusFeature& feature : cmap)
+      {
+        visitRTs_(feature, batch);
+      }
+      // adapt RT values of unassigned peptides:
+      visitRTs_(cmap.getUnassignedPeptideIdentifications(), batch);
+    };
+    visitAll();
+    batch.apply(trafo);
+    visitAll();
   }
 
 
-  void MapAlignmentTransformer::applyToConsensusFeature_(
-    ConsensusFeature& feature, const TransformationDescription& trafo,
-    bool store_original_rt)
+  void MapAlignmentTransformer::visitRTs_(ConsensusFeature& feature, RTBatch_& batch)
   {
-    applyToBaseFeature_(feature, trafo, store_original_rt);
+    visitRTs_(static_cast<BaseFeature&>(feature), batch);
 
     // apply to grouped features (feature handles):
-    for (ConsensusFeature::HandleSetType::const_iterator it =
-           feature.getFeatures().begin(); it != feature.getFeatures().end();
-         ++it)
+    for (const FeatureHandle& handle : feature.getFeatures())
     {
-      double rt = it->getRT();
-      it->asMutable().setRT(trafo.apply(rt));
+      handle.asMutable().setRT(batch.next(handle.getRT()));
     }
   }
 
@@ -198,14 +244,20 @@ namespace OpenMS
     vector<PeptideIdentification>& pep_ids,
     const TransformationDescription& trafo, bool store_original_rt)
   {
-    for (vector<PeptideIdentification>::iterator pep_it = pep_ids.begin();
-         pep_it != pep_ids.end(); ++pep_it)
+    RTBatch_ batch(store_original_rt);
+    visitRTs_(pep_ids, batch);
+    batch.apply(trafo);
+    visitRTs_(pep_ids, batch);
+  }
+
+
+  void MapAlignmentTransformer::visitRTs_(vector<PeptideIdentification>& pep_ids, RTBatch_& batch)
+  {
+    for (PeptideIdentification& pep : pep_ids)
     {
-      if (pep_it->hasRT())
+      if (pep.hasRT())
       {
-        double rt = pep_it->getRT();
-        if (store_original_rt) storeOriginalRT_(*pep_it, rt);
-        pep_it->setRT(trafo.apply(rt));
+        pep.setRT(batch.next(pep.getRT(), &pep));
       }
     }
   }
@@ -215,9 +267,18 @@ namespace OpenMS
     IdentificationData& id_data, const TransformationDescription& trafo,
     bool store_original_rt)
   {
+    vector<double> rts;
+    rts.reserve(id_data.observations_.size());
+    for (const IdentificationData::Observation& obs : id_data.observations_)
+    {
+      rts.push_back(obs.rt);
+    }
+    trafo.apply(rts, rts);
+
     // update RTs in-place:
+    Size i = 0;
     for (IdentificationData::ObservationRef it = id_data.observations_.begin();
-         it != id_data.observations_.end(); ++it)
+         it != id_data.observations_.end(); ++it, ++i)
     {
       id_data.observations_.modify(it, [&](IdentificationData::Observation& obs)
                                    {
@@ -225,7 +286,7 @@ namespace OpenMS
                                      {
                                        storeOriginalRT_(obs, obs.rt);
                                      }
-                                     obs.rt = trafo.apply(obs.rt);
+                                     obs.rt = rts[i];
                                    });
     }
   }
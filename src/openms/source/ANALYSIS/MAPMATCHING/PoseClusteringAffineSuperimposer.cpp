@@ -34,11 +34,19 @@
 
 #include <OpenMS/ANALYSIS/MAPMATCHING/PoseClusteringAffineSuperimposer.h>
 #include <OpenMS/FILTERING/BASELINE/MorphologicalFilter.h>
+#include <OpenMS/CONCEPT/LogStream.h>
 #include <OpenMS/MATH/STATISTICS/BasicStatistics.h>
 #include <OpenMS/MATH/MISC/LinearInterpolation.h>
 
 #include <boost/math/special_functions/fpclassify.hpp> // isnan
 
+#include <algorithm>
+#include <limits>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 // #define Debug_PoseClusteringAffineSuperimposer
 
 namespace OpenMS
@@ -64,6 +72,13 @@ namespace OpenMS
                                                 "and to disregard weak signals during alignment.  For using all points, set this to -1.");
     defaults_.setMinInt("num_used_points", -1);
 
+    defaults_.setValue("min_votes", 0, "Minimal number of votes (pairs of point pairs) in the first round of hashing.  "
+                                       "If fewer votes are obtained from the 'num_used_points' most intense elements, "
+                                       "the number of used elements is doubled until this number is reached (or all elements are used).  "
+                                       "Use this together with a small 'num_used_points' to keep the running time low without "
+                                       "ending up with too few votes.  0 disables this.", {"advanced"});
+    defaults_.setMinInt("min_votes", 0);
+
     defaults_.setValue("scaling_bucket_size", 0.005, "The scaling of the retention time "
                                                      "interval is being hashed into buckets of this size during pose "
                                                      "clustering.  A good choice for this would be a bit smaller than the "
@@ -146,8 +161,16 @@ namespace OpenMS
     round, only consider quadruplets where the scaling factor matches the
     estimated bounds of (scale_low_1,scale_high_1), discard all other data.
 
+    The points i of the model map are split round-robin into a fixed number of
+    blocks, which are distributed over the threads. Each block votes into empty
+    copies of the histograms, which are added to the output histograms in block
+    order, so the result does not depend on the number of threads. If pairs are
+    dumped, this runs single-threaded.
+
+    Returns the number of votes (quadruplets hashed in this round).
+
   */
-  void affineTransformationHashing(const bool do_dump_pairs,
+  Size affineTransformationHashing(const bool do_dump_pairs,
                                    const std::vector<Peak2D> & model_map,
                                    const std::vector<Peak2D> & scene_map,
                                    Math::LinearInterpolation<double, double>& scaling_hash_1,
@@ -177,135 +200,201 @@ namespace OpenMS
       dump_pairs_file << "#" << ' ' << "i" << ' ' << "j" << ' ' << "k" << ' ' << "l" << ' ' << std::endl;
     }
 
-    // first point in model map (i)
-    for (Size i = 0, i_low = 0, i_high = 0, k_low = 0, k_high = 0; i < model_map_size - 1; ++i)
+    // empty histograms with the layout of the ones filled in this round (set up
+    // before the parallel region, each block starts from a copy of these)
+    typedef Math::LinearInterpolation<double, double> LinearInterpolationType_;
+    struct Hashes
+    {
+      LinearInterpolationType_ scaling_1, scaling_2, rt_low, rt_high;
+    };
+    auto emptyCopy = [](const LinearInterpolationType_& source)
+    {
+      LinearInterpolationType_ copy(source);
+      std::fill(copy.getData().begin(), copy.getData().end(), 0.);
+      return copy;
+    };
+    Hashes empty_hashes;
+    if (hashing_round == 1)
+    {
+      empty_hashes.scaling_1 = emptyCopy(scaling_hash_1);
+    }
+    else
+    {
+      empty_hashes.scaling_2 = emptyCopy(scaling_hash_2);
+      empty_hashes.rt_low = emptyCopy(rt_low_hash_);
+      empty_hashes.rt_high = emptyCopy(rt_high_hash_);
+    }
+    auto addHistogram = [](LinearInterpolationType_& target, LinearInterpolationType_& source)
     {
-      // Adjust window around i in model map (get all features in a m/z range of item i in the model map)
-      while (i_low < model_map_size && model_map[i_low].getMZ() < model_map[i].getMZ() - mz_pair_max_distance)
-        ++i_low;
-      while (i_high < model_map_size && model_map[i_high].getMZ() <= model_map[i].getMZ() + mz_pair_max_distance)
-        ++i_high;
-      // stop if there are too many features are in our window
-      double i_winlength_factor = 1. / (i_high - i_low);
-      i_winlength_factor -= winlength_factor_baseline;
-      if (i_winlength_factor <= 0)
-        continue;
-
-      // Adjust window around k in scene map (get all features in a m/z range of item i in the scene map)
-      while (k_low < scene_map_size && scene_map[k_low].getMZ() < model_map[i].getMZ() - mz_pair_max_distance)
-        ++k_low;
-      while (k_high < scene_map_size && scene_map[k_high].getMZ() <= model_map[i].getMZ() + mz_pair_max_distance)
-        ++k_high;
-
-      // Iterate through all matching features in the scene map that are
-      // within the m/z distance of item i from the model map.
-      // first point in scene map (k)
-      for (Size k = k_low; k < k_high; ++k)
+      for (Size b = 0; b < source.getData().size(); ++b)
       {
-        // stop if there are too many features are in our window
-        double k_winlength_factor = 1. / (k_high - k_low);
-        k_winlength_factor -= winlength_factor_baseline;
-        if (k_winlength_factor <= 0)
-          continue;
-
-        // compute similarity of intensities i k by taking the ratio of the two intensities
-        double similarity_ik;
-        {
-          const double int_i = model_map[i].getIntensity();
-          const double int_k = scene_map[k].getIntensity() * total_intensity_ratio;
-          similarity_ik = (int_i < int_k) ? int_i / int_k : int_k / int_i;
-          // weight is inverse proportional to number of elements with similar mz
-          similarity_ik *= i_winlength_factor;
-          similarity_ik *= k_winlength_factor;
-        }
+        target.getData()[b] += source.getData()[b];
+        source.getData()[b] = 0.;
+      }
+    };
+
+    // the number of blocks is fixed (not the number of threads), so that the
+    // order of the floating point additions does not depend on the thread count
+    const SignedSize nr_i = (SignedSize) model_map_size - 1;
+    const SignedSize nr_blocks = std::max(SignedSize(0), std::min(SignedSize(64), nr_i));
+#ifdef _OPENMP
+    const int nr_threads = do_dump_pairs ? 1 : omp_get_max_threads();
+#else
+    const int nr_threads = 1;
+#endif
 
-        // second point in model map (j)
-        for (Size j = i + 1, j_low = i_low, j_high = i_low, l_low = k_low, l_high = k_high; j < model_map_size; ++j)
-        {
-          // diff in model map -> skip features that are too far away in RT
-          double diff_model = model_map[j].getRT() - model_map[i].getRT();
-          if (fabs(diff_model) < rt_pair_min_distance)
-            continue;
+    // both maps are sorted by m/z
+    auto mz_less = [](const Peak2D& p, const double mz) { return p.getMZ() < mz; };
+    auto mz_greater = [](const double mz, const Peak2D& p) { return mz < p.getMZ(); };
 
-          // Adjust window around j in model map
-          while (j_low < model_map_size && model_map[j_low].getMZ() < model_map[i].getMZ() - mz_pair_max_distance)
-            ++j_low;
-          while (j_high < model_map_size && model_map[j_high].getMZ() <= model_map[i].getMZ() + mz_pair_max_distance)
-            ++j_high;
-          double j_winlength_factor = 1. / (j_high - j_low);
-          j_winlength_factor -= winlength_factor_baseline;
-          if (j_winlength_factor <= 0)
+    Size votes = 0;
+    #pragma omp parallel num_threads(nr_threads) reduction(+: votes)
+    {
+      Hashes hashes = empty_hashes;
+
+      #pragma omp for ordered schedule(static, 1)
+      for (SignedSize block = 0; block < nr_blocks; ++block)
+      {
+        // first point in model map (i)
+        for (SignedSize i = block; i < nr_i; i += nr_blocks)
+        {
+          // window around i in model map (get all features in a m/z range of item i in the model map)
+          const Size i_low = std::lower_bound(model_map.begin(), model_map.end(), model_map[i].getMZ() - mz_pair_max_distance, mz_less) - model_map.begin();
+          const Size i_high = std::upper_bound(model_map.begin(), model_map.end(), model_map[i].getMZ() + mz_pair_max_distance, mz_greater) - model_map.begin();
+          // stop if there are too many features are in our window
+          double i_winlength_factor = 1. / (i_high - i_low);
+          i_winlength_factor -= winlength_factor_baseline;
+          if (i_winlength_factor <= 0)
             continue;
 
-          // Adjust window around l in scene map
-          while (l_low < scene_map_size && scene_map[l_low].getMZ() < model_map[j].getMZ() - mz_pair_max_distance)
-            ++l_low;
-          while (l_high < scene_map_size && scene_map[l_high].getMZ() <= model_map[j].getMZ() + mz_pair_max_distance)
-            ++l_high;
+          // window around k in scene map (get all features in a m/z range of item i in the scene map)
+          const Size k_low = std::lower_bound(scene_map.begin(), scene_map.end(), model_map[i].getMZ() - mz_pair_max_distance, mz_less) - scene_map.begin();
+          const Size k_high = std::upper_bound(scene_map.begin(), scene_map.end(), model_map[i].getMZ() + mz_pair_max_distance, mz_greater) - scene_map.begin();
 
-          // second point in scene map (l)
-          for (Size l = l_low; l < l_high; ++l)
+          // Iterate through all matching features in the scene map that are
+          // within the m/z distance of item i from the model map.
+          // first point in scene map (k)
+          for (Size k = k_low; k < k_high; ++k)
           {
-            double l_winlength_factor = 1. / (l_high - l_low);
-            l_winlength_factor -= winlength_factor_baseline;
-            if (l_winlength_factor <= 0)
-              continue;
-
-            // diff in scene map -> skip features that are too far away in RT
-            double diff_scene = scene_map[l].getRT() - scene_map[k].getRT();
-
-            // avoid cross mappings (i,j) -> (k,l) (e.g. i_rt < j_rt and k_rt > l_rt)
-            // and point pairs with equal retention times (e.g. i_rt == j_rt)
-            if (fabs(diff_scene) < rt_pair_min_distance || ((diff_model > 0) != (diff_scene > 0)))
+            // stop if there are too many features are in our window
+            double k_winlength_factor = 1. / (k_high - k_low);
+            k_winlength_factor -= winlength_factor_baseline;
+            if (k_winlength_factor <= 0)
               continue;
 
-            // compute the transformation (i,j) -> (k,l)
-            double scaling = diff_model / diff_scene;
-            double shift = model_map[i].getRT() - scene_map[k].getRT() * scaling;
-
-            // compute similarity of intensities i k j l
-            double similarity_ik_jl;
+            // compute similarity of intensities i k by taking the ratio of the two intensities
+            double similarity_ik;
             {
-              // compute similarity of intensities j l
-              const double int_j = model_map[j].getIntensity();
-              const double int_l = scene_map[l].getIntensity() * total_intensity_ratio;
-              double similarity_jl = (int_j < int_l) ? int_j / int_l : int_l / int_j;
+              const double int_i = model_map[i].getIntensity();
+              const double int_k = scene_map[k].getIntensity() * total_intensity_ratio;
+              similarity_ik = (int_i < int_k) ? int_i / int_k : int_k / int_i;
               // weight is inverse proportional to number of elements with similar mz
-              similarity_jl *= j_winlength_factor;
-              similarity_jl *= l_winlength_factor;
-              similarity_ik_jl = similarity_ik * similarity_jl;
+              similarity_ik *= i_winlength_factor;
+              similarity_ik *= k_winlength_factor;
             }
 
-            // hash the images of scaling, rt_low and rt_high into their respective hash tables
-            // store the scaling parameter and the (estimated) transformation of start/end of the maps in hashes
-            //   -> in round 2, discard values outside of scale_low_1 and
-            //   scale_high_1 (estimated before in scalingEstimate)
-            if (hashing_round == 1)
-            {
-              // hashing round 1 (estimate the scaling only)
-              scaling_hash_1.addValue(log(scaling), similarity_ik_jl);
-            }
-            else if (scaling >= scale_low_1 && scaling <= scale_high_1)
+            // second point in model map (j)
+            for (Size j = i + 1, j_low = i_low, j_high = i_low, l_low = k_low, l_high = k_high; j < model_map_size; ++j)
             {
-              // hashing round 2 (estimate scaling and shift)
-              scaling_hash_2.addValue(log(scaling), similarity_ik_jl);
-
-              const double rt_low_image = shift + rt_low * scaling;
-              rt_low_hash_.addValue(rt_low_image, similarity_ik_jl);
-              const double rt_high_image = shift + rt_high * scaling;
-              rt_high_hash_.addValue(rt_high_image, similarity_ik_jl);
-
-              if (do_dump_pairs)
+              // diff in model map -> skip features that are too far away in RT
+              double diff_model = model_map[j].getRT() - model_map[i].getRT();
+              if (fabs(diff_model) < rt_pair_min_distance)
+                continue;
+
+              // Adjust window around j in model map
+              while (j_low < model_map_size && model_map[j_low].getMZ() < model_map[i].getMZ() - mz_pair_max_distance)
+                ++j_low;
+              while (j_high < model_map_size && model_map[j_high].getMZ() <= model_map[i].getMZ() + mz_pair_max_distance)
+                ++j_high;
+              double j_winlength_factor = 1. / (j_high - j_low);
+              j_winlength_factor -= winlength_factor_baseline;
+              if (j_winlength_factor <= 0)
+                continue;
+
+              // Adjust window around l in scene map
+              while (l_low < scene_map_size && scene_map[l_low].getMZ() < model_map[j].getMZ() - mz_pair_max_distance)
+                ++l_low;
+              while (l_high < scene_map_size && scene_map[l_high].getMZ() <= model_map[j].getMZ() + mz_pair_max_distance)
+                ++l_high;
+
+              // second point in scene map (l)
+              for (Size l = l_low; l < l_high; ++l)
               {
-                dump_pairs_file << i << ' ' << model_map[i].getRT() << ' ' << model_map[i].getMZ() << ' ' << j << ' ' << model_map[j].getRT() << ' '
-                                << model_map[j].getMZ() << ' ' << k << ' ' << scene_map[k].getRT() << ' ' << scene_map[k].getMZ() << ' ' << l << ' '
-                                << scene_map[l].getRT() << ' ' << scene_map[l].getMZ() << ' ' << similarity_ik_jl << ' ' << std::endl;
-              }
-            }
-          }   // l
-        }   // j
-      }   // k
-    }   // i
+                double l_winlength_factor = 1. / (l_high - l_low);
+                l_winlength_factor -= winlength_factor_baseline;
+                if (l_winlength_factor <= 0)
+                  continue;
+
+                // diff in scene map -> skip features that are too far away in RT
+                double diff_scene = scene_map[l].getRT() - scene_map[k].getRT();
+
+                // avoid cross mappings (i,j) -> (k,l) (e.g. i_rt < j_rt and k_rt > l_rt)
+                // and point pairs with equal retention times (e.g. i_rt == j_rt)
+                if (fabs(diff_scene) < rt_pair_min_distance || ((diff_model > 0) != (diff_scene > 0)))
+                  continue;
+
+                // compute the transformation (i,j) -> (k,l)
+                double scaling = diff_model / diff_scene;
+                double shift = model_map[i].getRT() - scene_map[k].getRT() * scaling;
+
+                // compute similarity of intensities i k j l
+                double similarity_ik_jl;
+                {
+                  // compute similarity of intensities j l
+                  const double int_j = model_map[j].getIntensity();
+                  const double int_l = scene_map[l].getIntensity() * total_intensity_ratio;
+                  double similarity_jl = (int_j < int_l) ? int_j / int_l : int_l / int_j;
+                  // weight is inverse proportional to number of elements with similar mz
+                  similarity_jl *= j_winlength_factor;
+                  similarity_jl *= l_winlength_factor;
+                  similarity_ik_jl = similarity_ik * similarity_jl;
+                }
+
+                // hash the images of scaling, rt_low and rt_high into their respective hash tables
+                // store the scaling parameter and the (estimated) transformation of start/end of the maps in hashes
+                //   -> in round 2, discard values outside of scale_low_1 and
+                //   scale_high_1 (estimated before in scalingEstimate)
+                if (hashing_round == 1)
+                {
+                  // hashing round 1 (estimate the scaling only)
+                  hashes.scaling_1.addValue(log(scaling), similarity_ik_jl);
+                  ++votes;
+                }
+                else if (scaling >= scale_low_1 && scaling <= scale_high_1)
+                {
+                  // hashing round 2 (estimate scaling and shift)
+                  hashes.scaling_2.addValue(log(scaling), similarity_ik_jl);
+
+                  const double rt_low_image = shift + rt_low * scaling;
+                  hashes.rt_low.addValue(rt_low_image, similarity_ik_jl);
+                  const double rt_high_image = shift + rt_high * scaling;
+                  hashes.rt_high.addValue(rt_high_image, similarity_ik_jl);
+                  ++votes;
+
+                  if (do_dump_pairs)
+                  {
+                    dump_pairs_file << i << ' ' << model_map[i].getRT() << ' ' << model_map[i].getMZ() << ' ' << j << ' ' << model_map[j].getRT() << ' '
+                                    << model_map[j].getMZ() << ' ' << k << ' ' << scene_map[k].getRT() << ' ' << scene_map[k].getMZ() << ' ' << l << ' '
+                                    << scene_map[l].getRT() << ' ' << scene_map[l].getMZ() << ' ' << similarity_ik_jl << ' ' << std::endl;
+                  }
+                }
+              }   // l
+            }   // j
+          }   // k
+        }   // i
+
+        // add the votes of this block to the output histograms (in block order)
+        #pragma omp ordered
+        {
+          addHistogram(scaling_hash_1, hashes.scaling_1);
+          addHistogram(scaling_hash_2, hashes.scaling_2);
+          addHistogram(rt_low_hash_, hashes.rt_low);
+          addHistogram(rt_high_hash_, hashes.rt_high);
+        }
+      }   // block
+    }
+
+    return votes;
   }
 
   /**
@@ -805,32 +894,34 @@ namespace OpenMS
     // Step 1: Select the most abundant data points only.
     //**************************************************************************
     // use copy to truncate
-    std::vector<Peak2D> model_map(map_model);
-    std::vector<Peak2D> scene_map(map_scene);
+    std::vector<Peak2D> model_map;
+    std::vector<Peak2D> scene_map;
+    // truncate the data as necessary (-1 means all points)
+    Size num_used_points = (Int) param_.getValue("num_used_points");
+    auto selectPoints = [&](const Size num_points)
     {
-      // truncate the data as necessary
-      const Size num_used_points = (Int) param_.getValue("num_used_points");
+      model_map = map_model;
+      scene_map = map_scene;
 
       // sort the last data points by ascending intensity (from the right, using reverse iterators)
       //  -> linear in complexity, should be faster than sorting and then taking cutoff
-      if (model_map.size() > num_used_points)
+      if (model_map.size() > num_points)
       {
-        std::nth_element(model_map.rbegin(), model_map.rbegin() + (model_map.size() - num_used_points),
+        std::nth_element(model_map.rbegin(), model_map.rbegin() + (model_map.size() - num_points),
             model_map.rend(), Peak2D::IntensityLess());
-        model_map.resize(num_used_points);
+        model_map.resize(num_points);
       }
-      setProgress(++actual_progress);
-      if (scene_map.size() > num_used_points)
+      if (scene_map.size() > num_points)
       {
-        std::nth_element(scene_map.rbegin(), scene_map.rbegin() + (scene_map.size() - num_used_points),
+        std::nth_element(scene_map.rbegin(), scene_map.rbegin() + (scene_map.size() - num_points),
             scene_map.rend(), Peak2D::IntensityLess());
-        scene_map.resize(num_used_points);
+        scene_map.resize(num_points);
       }
-      setProgress(++actual_progress);
-    }
-    // sort by ascending m/z
-    std::sort(model_map.begin(), model_map.end(), Peak2D::MZLess());
-    std::sort(scene_map.begin(), scene_map.end(), Peak2D::MZLess());
+      // sort by ascending m/z
+      std::sort(model_map.begin(), model_map.end(), Peak2D::MZLess());
+      std::sort(scene_map.begin(), scene_map.end(), Peak2D::MZLess());
+    };
+    selectPoints(num_used_points);
     setProgress((actual_progress = 10));
 
     //**************************************************************************
@@ -919,20 +1010,42 @@ namespace OpenMS
 
     ///////////////////////////////////////////////////////////////////
     // Step 4.1 First round of hashing: Estimate the scaling
-    affineTransformationHashing(
-      do_dump_pairs,
-      model_map, scene_map,
-      scaling_hash_1, scaling_hash_2, rt_low_hash_, rt_high_hash_,
-      1,
-      rt_pair_min_distance,
-      dump_pairs_basename,
-      dump_buckets_serial,
-      mz_pair_max_distance,
-      winlength_factor_baseline,
-      total_intensity_ratio,
-      -1, // only used in 2nd round of hashing
-      -1, // only used in 2nd round of hashing
-      rt_low, rt_high);
+    auto firstRound = [&]()
+    {
+      return affineTransformationHashing(
+        do_dump_pairs,
+        model_map, scene_map,
+        scaling_hash_1, scaling_hash_2, rt_low_hash_, rt_high_hash_,
+        1,
+        rt_pair_min_distance,
+        dump_pairs_basename,
+        dump_buckets_serial,
+        mz_pair_max_distance,
+        winlength_factor_baseline,
+        total_intensity_ratio,
+        -1, // only used in 2nd round of hashing
+        -1, // only used in 2nd round of hashing
+        rt_low, rt_high);
+    };
+    Size votes = firstRound();
+
+    // too few votes: use more of the (less intense) points
+    const Size min_votes = (Int) param_.getValue("min_votes");
+    while (votes < min_votes &&
+           (model_map.size() < map_model.size() || scene_map.size() < map_scene.size()))
+    {
+      num_used_points = (num_used_points > std::numeric_limits<Size>::max() / 2) ?
+                        std::numeric_limits<Size>::max() : 2 * std::max(num_used_points, Size(1));
+      selectPoints(num_used_points);
+      OPENMS_LOG_DEBUG << "PoseClusteringAffineSuperimposer: " << votes << " votes in first round of hashing, "
+                       << "increasing the number of used points to " << num_used_points << std::endl;
+      initializeHashTables(scaling_hash_1, scaling_hash_2, rt_low_hash_, rt_high_hash_,
+                           param_.getValue("max_scaling"), param_.getValue("max_shift"),
+                           param_.getValue("scaling_bucket_size"), param_.getValue("shift_bucket_size"),
+                           rt_low, rt_high);
+      total_intensity_ratio = computeIntensityRatio(model_map, scene_map);
+      votes = firstRound();
+    }
     setProgress((actual_progress = 30));
 
     ///////////////////////////////////////////////////////////////////
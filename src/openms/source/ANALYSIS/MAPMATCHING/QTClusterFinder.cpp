@@ -41,6 +41,13 @@
 #include <OpenMS/KERNEL/FeatureHandle.h>
 #include <OpenMS/MATH/MISC/MathFunctions.h>
 
+#include <exception>
+#include <memory>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 //#define DEBUG_QTCLUSTERFINDER_IDS
 
 using std::list;
@@ -329,38 +336,89 @@ namespace OpenMS
       // add last partition (a bit more since we use "smaller than" below)
       partition_boundaries.push_back(massrange.back() + 1.0);
 
+      // Partitions are independent, so they are clustered in parallel. Each thread works
+      // with its own copy of the algorithm (which keeps per-partition state), the results
+      // are collected per partition and merged in m/z order.
+      const SignedSize nr_partitions = (SignedSize) partition_boundaries.size() - 1;
+#ifdef _OPENMP
+      const Size nr_workers = omp_get_max_threads();
+#else
+      const Size nr_workers = 1;
+#endif
+      std::vector<std::unique_ptr<QTClusterFinder> > workers(nr_workers);
+      for (auto& worker : workers)
+      {
+        worker = std::make_unique<QTClusterFinder>();
+        worker->setParameters(param_);
+        worker->bin_tolerances_ = bin_tolerances_;
+      }
+      std::vector<ConsensusMap> partition_results(nr_partitions);
+      std::vector<std::exception_ptr> errors(nr_partitions);
+
       ProgressLogger logger;
       Size progress = 0;
       logger.setLogType(ProgressLogger::CMD);
       logger.startProgress(0, partition_boundaries.size(), "Linking features");
-      for (size_t j = 0; j < partition_boundaries.size()-1; j++)
+      #pragma omp parallel for schedule(dynamic, 1)
+      for (SignedSize j = 0; j < nr_partitions; j++)
       {
+#ifdef _OPENMP
+        QTClusterFinder& worker = *workers[omp_get_thread_num()];
+#else
+        QTClusterFinder& worker = *workers[0];
+#endif
         double partition_start = partition_boundaries[j];
         double partition_end = partition_boundaries[j+1];
 
-        std::vector<MapType> tmp_input_maps(input_maps.size());
-        for (size_t k = 0; k < input_maps.size(); k++)
+        try
         {
-          // iterate over all features in the current input map and append
-          // matching features (within the current partition) to the temporary
-          // map
-          for (size_t m = 0; m < input_maps[k].size(); m++)
+          std::vector<MapType> tmp_input_maps(input_maps.size());
+          for (size_t k = 0; k < input_maps.size(); k++)
           {
-            if (input_maps[k][m].getMZ() >= partition_start && 
-                input_maps[k][m].getMZ() < partition_end)
+            // iterate over all features in the current input map and append
+            // matching features (within the current partition) to the temporary
+            // map
+            for (size_t m = 0; m < input_maps[k].size(); m++)
             {
-              tmp_input_maps[k].push_back(input_maps[k][m]);
+              if (input_maps[k][m].getMZ() >= partition_start && 
+                  input_maps[k][m].getMZ() < partition_end)
+              {
+                tmp_input_maps[k].push_back(input_maps[k][m]);
+              }
             }
+            tmp_input_maps[k].updateRanges();
           }
-          tmp_input_maps[k].updateRanges();
+
+          // run algo on current partition
+          worker.run_internal_(tmp_input_maps, partition_results[j], false);
+        }
+        catch (...)
+        {
+          errors[j] = std::current_exception();
         }
 
-        // run algo on current partition
-        run_internal_(tmp_input_maps, result_map, false);
-        logger.setProgress(progress++);
+        #pragma omp atomic
+        ++progress;
+        IF_MASTERTHREAD
+        {
+          logger.setProgress(progress);
+        }
       }
 
       logger.endProgress();
+
+      for (SignedSize j = 0; j < nr_partitions; j++)
+      {
+        if (errors[j])
+        {
+          std::rethrow_exception(errors[j]);
+        }
+        for (ConsensusFeature& feature : partition_results[j])
+        {
+          result_map.push_back(std::move(feature));
+        }
+        partition_results[j].clear();
+      }
     }
   }
 
@@ -450,7 +508,7 @@ namespace OpenMS
       // pops heap until a valid best cluster or empty, makes a consensusFeature and updates
       // other clusters affected by the inclusion of this cluster
       bool made_feature = makeConsensusFeature_(cluster_heads, consensus_feature, 
-                                                element_mapping, grid, handles);
+                                                element_mapping, handles);
 
       if (made_feature)
       {
@@ -465,7 +523,6 @@ namespace OpenMS
   bool QTClusterFinder::makeConsensusFeature_(Heap& cluster_heads,
                                               ConsensusFeature& feature,
                                               ElementMapping& element_mapping,
-                                              const Grid& grid,
                                               const vector<Heap::handle_type>& handles)
   {
     // pop until the top is valid
@@ -498,7 +555,7 @@ namespace OpenMS
     }
 #endif
 
-    updateClustering_(element_mapping, grid, elements, cluster_heads, handles, best.getId());
+    updateClustering_(element_mapping, elements, cluster_heads, handles, best.getId());
 
     // made a consensus feature
     return true;
@@ -571,7 +628,6 @@ void QTClusterFinder::createConsensusFeature_(ConsensusFeature& feature,
   }
 
   void QTClusterFinder::updateClustering_(ElementMapping& element_mapping,
-                                          const Grid& grid, 
                                           const QTCluster::Elements& elements,
                                           Heap& cluster_heads,
                                           const vector<Heap::handle_type>& handles,
@@ -614,13 +670,12 @@ void QTClusterFinder::createConsensusFeature_(ConsensusFeature& feature,
 
             /*
             ////////////////////////////////////////
-            Step 1: Iterate through all neighboring grid features and try to
-            add elements to the current cluster to replace the ones we just
-            removed
+            Step 1: Select the best unused elements of the cluster to replace
+            the ones we just removed
 
             Before that we must delete this clusters id from the element mapping. (important!)
-            It is possible that addClusterElements_() removes features from the cluster 
-            we are updating. (Through finalizeCluster_ -> computeQuality_ -> optimizeAnnotations).
+            It is possible that reselectNeighbors() removes features from the cluster 
+            we are updating. (Through computeQuality_ -> optimizeAnnotations_).
             These are not to be confused with the features we removed
             because they are part of the current best cluster. Those are removed in 
             QTCluster::update (above).
@@ -633,13 +688,14 @@ void QTClusterFinder::createConsensusFeature_(ConsensusFeature& feature,
             deleted cluster, which will surely lead to a segfault when the feature is actually 
             used in another cluster later.
 
-            TODO Check guarantee that addClusterElements does not add a feature that was removed
-             earlier in the loop. Should not happen because they are in the already_used set by now.
+            The cluster keeps all its potential elements (with their distances), so no new
+            search of the grid is necessary: used features are skipped, and no new features
+            can become available.
             */
             removeFromElementMapping_(cluster, element_mapping);
 
             // re-add closest cluster elements that were not used yet.
-            addClusterElements_(grid, cluster);
+            cluster.reselectNeighbors(already_used_);
 
             // update the heap, because the quality has changed
             // compares with top_element to see if a different node needs to be popped now.
@@ -798,7 +854,9 @@ void QTClusterFinder::createConsensusFeature_(ConsensusFeature& feature,
     // FeatureDistance produces normalized distances (between 0 and 1 plus a possible noID penalty):
     const double max_distance = 1.0 + noID_penalty_;
 
-    // iterate over all grid cells:
+    // construct the data bodies and heads of all clusters (one per grid cell entry) first
+    vector<QTCluster> clusters;
+    clusters.reserve(grid.size());
     for (Grid::const_iterator it = grid.begin(); it != grid.end(); ++it)
     {
       const Grid::CellIndex& act_coords = it.index();
@@ -810,22 +868,49 @@ void QTClusterFinder::createConsensusFeature_(ConsensusFeature& feature,
       cluster_data.emplace_back(center_feature, num_maps_, 
                                 max_distance, x, y, id);
       
-      QTCluster cluster(&cluster_data.back(), use_IDs_);
+      clusters.emplace_back(&cluster_data.back(), use_IDs_);
+
+      // next cluster gets the next id
+      ++id;
+    }
 
-      addClusterElements_(grid, cluster);
+    // search the neighbors of all cluster centers in parallel
+    // (this only reads the grid, every cluster writes only to its own data body)
+    std::exception_ptr error;
+    SignedSize error_idx = clusters.size();
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (SignedSize i = 0; i < (SignedSize) clusters.size(); ++i)
+    {
+      try
+      {
+        addClusterElements_(grid, clusters[i]);
+      }
+      catch (...)
+      {
+        #pragma omp critical (QTClusterFinder_error)
+        if (i < error_idx)
+        {
+          error_idx = i;
+          error = std::current_exception();
+        }
+      }
+    }
+    if (error)
+    {
+      std::rethrow_exception(error);
+    }
 
+    for (const QTCluster& cluster : clusters)
+    {
       // push the cluster head of the new cluster into the heap
       // and the returned handle into our handle vector
       handles.push_back(cluster_heads.push(cluster));
 
       // register the new cluster for all its elements in the element mapping
-      for (const auto& element : (*handles.back()).getElements())
+      for (const auto& element : cluster.getElements())
       {
-        element_mapping[element.feature].insert(id);
+        element_mapping[element.feature].insert(cluster.getId());
       }
-
-      // next cluster gets the next id
-      ++id;
     }
   }
 
@@ -34,9 +34,12 @@
 
 #include <OpenMS/ANALYSIS/MAPMATCHING/StablePairFinder.h>
 #include <OpenMS/ANALYSIS/MAPMATCHING/FeatureDistance.h>
+#include <OpenMS/COMPARISON/CLUSTERING/HashGrid.h>
 #include <OpenMS/KERNEL/FeatureMap.h>
 #include <OpenMS/METADATA/PeptideIdentification.h>
 
+#include <exception>
+
 #ifdef Debug_StablePairFinder
 #define V_(bla) std::cout << __FILE__ ":" << __LINE__ << ": " << bla << std::endl;
 #else
@@ -103,76 +106,20 @@ namespace OpenMS
     is_singleton[1].resize(input_maps[1].size(), true);
 
     typedef pair<double, double> DoublePair;
-    DoublePair init = make_pair(FeatureDistance::infinity,
-                                FeatureDistance::infinity);
 
     // for every element in map 0:
     // - index of nearest neighbor in map 1:
-    vector<UInt> nn_index_0(input_maps[0].size(), UInt(-1));
+    vector<UInt> nn_index_0;
     // - distances to nearest and second-nearest neighbors in map 1:
-    vector<DoublePair> nn_distance_0(input_maps[0].size(), init);
+    vector<DoublePair> nn_distance_0;
+    findNearestNeighbors_(input_maps, 0, feature_distance, nn_index_0, nn_distance_0);
 
     // for every element in map 1:
     // - index of nearest neighbor in map 0:
-    vector<UInt> nn_index_1(input_maps[1].size(), UInt(-1));
+    vector<UInt> nn_index_1;
     // - distances to nearest and second-nearest neighbors in map 0:
-    vector<DoublePair> nn_distance_1(input_maps[1].size(), init);
-
-    // iterate over all feature pairs, find nearest neighbors:
-    // TODO: iterate over SENSIBLE RT (and m/z) window -- sort the maps beforehand
-    //       to save a lot of processing time...
-    //       Once done, remove the warning in the description of the 'use_identifications' parameter
-    for (UInt fi0 = 0; fi0 < input_maps[0].size(); ++fi0)
-    {
-      const ConsensusFeature& feat0 = input_maps[0][fi0];
-
-      for (UInt fi1 = 0; fi1 < input_maps[1].size(); ++fi1)
-      {
-        const ConsensusFeature& feat1 = input_maps[1][fi1];
-
-        if (use_IDs_ && !compatibleIDs_(feat0, feat1)) // check peptide IDs
-        {
-          continue; // mismatch
-        }
-
-        pair<bool, double> result = feature_distance(feat0, feat1);
-        double distance = result.second;
-        // we only care if distance constraints are satisfied for "best
-        // matches", not for second-best; this means that second-best distances
-        // can become smaller than best distances
-        // (e.g. the RT is larger than allowed (->invalid pair), but m/z is perfect and has the most weight --> better score!)
-        bool valid = result.first;
-
-        // update entries for map 0:
-        if (distance < nn_distance_0[fi0].second)
-        {
-          if (valid && (distance < nn_distance_0[fi0].first))
-          {
-            nn_distance_0[fi0].second = nn_distance_0[fi0].first;
-            nn_distance_0[fi0].first = distance;
-            nn_index_0[fi0] = fi1;
-          }
-          else
-          {
-            nn_distance_0[fi0].second = distance;
-          }
-        }
-        // update entries for map 1:
-        if (distance < nn_distance_1[fi1].second)
-        {
-          if (valid && (distance < nn_distance_1[fi1].first))
-          {
-            nn_distance_1[fi1].second = nn_distance_1[fi1].first;
-            nn_distance_1[fi1].first = distance;
-            nn_index_1[fi1] = fi0;
-          }
-          else
-          {
-            nn_distance_1[fi1].second = distance;
-          }
-        }
-      }
-    }
+    vector<DoublePair> nn_distance_1;
+    findNearestNeighbors_(input_maps, 1, feature_distance, nn_index_1, nn_distance_1);
 
     // if features from the two maps are nearest neighbors of each other, they
     // can become a pair:
@@ -247,6 +194,242 @@ namespace OpenMS
     // FeatureGroupingAlgorithm!
   }
 
+  void StablePairFinder::findNearestNeighbors_(const std::vector<ConsensusMap>& input_maps, UInt query_map,
+                                              FeatureDistance& feature_distance, vector<UInt>& nn_index,
+                                              vector<pair<double, double> >& nn_distance) const
+  {
+    const ConsensusMap& queries = input_maps[query_map];
+    const ConsensusMap& candidates = input_maps[1 - query_map];
+    nn_index.assign(queries.size(), UInt(-1));
+    nn_distance.assign(queries.size(), make_pair(FeatureDistance::infinity, FeatureDistance::infinity));
+    if (candidates.empty())
+    {
+      return;
+    }
+
+    // Candidates are put into grid cells of the size of the maximum allowed
+    // RT and m/z differences (for ppm tolerances: at the highest m/z), so all
+    // valid pairs are found in the neighboring cells. If the normalized
+    // difference of two features in a dimension exceeds R, their distance is
+    // at least "weight * R^exponent / total weight"; this bounds the distances
+    // outside of a block of cells around a query.
+    double max_diff[2] = {param_.getValue("distance_RT:max_difference"), param_.getValue("distance_MZ:max_difference")};
+    if (param_.getValue("distance_MZ:unit") == "ppm")
+    {
+      double max_mz = 0.0;
+      for (Size m = 0; m < 2; ++m)
+      {
+        for (ConsensusMap::const_iterator it = input_maps[m].begin(); it != input_maps[m].end(); ++it)
+        {
+          max_mz = max(max_mz, it->getMZ());
+        }
+      }
+      max_diff[1] *= max_mz * 1e-6;
+    }
+    // (weights as used by FeatureDistance, i.e. zero for components with exponent zero)
+    auto effectiveWeight = [this](const String& what)
+    {
+      double exponent = param_.getValue("distance_" + what + ":exponent");
+      return (exponent != 0.0) ? double(param_.getValue("distance_" + what + ":weight")) : 0.0;
+    };
+    const double weight[2] = {effectiveWeight("RT"), effectiveWeight("MZ")};
+    const double exponent[2] = {param_.getValue("distance_RT:exponent"), param_.getValue("distance_MZ:exponent")};
+    const double total_weight = weight[0] + weight[1] + effectiveWeight("intensity");
+    const bool use_grid = (max_diff[0] > 0.0) && (max_diff[1] > 0.0);
+
+    typedef HashGrid<UInt> Grid;
+    Grid grid(Grid::ClusterCenter(use_grid ? max_diff[0] : 1.0, use_grid ? max_diff[1] : 1.0));
+    // cell index range (as HashGrid computes the cell index):
+    Int64 cell_min[2] = {numeric_limits<Int64>::max(), numeric_limits<Int64>::max()};
+    Int64 cell_max[2] = {numeric_limits<Int64>::min(), numeric_limits<Int64>::min()};
+    auto cellIndex = [&grid](double value, Size dim)
+    {
+      return static_cast<Int64>(floor(value / grid.cell_dimension[dim]));
+    };
+    for (UInt index = 0; index < candidates.size(); ++index)
+    {
+      Grid::ClusterCenter pos(candidates[index].getRT(), candidates[index].getMZ());
+      grid.insert(make_pair(pos, index));
+      for (Size dim = 0; dim < 2; ++dim)
+      {
+        cell_min[dim] = min(cell_min[dim], cellIndex(pos[dim], dim));
+        cell_max[dim] = max(cell_max[dim], cellIndex(pos[dim], dim));
+      }
+    }
+    const Size num_cells = grid.grid_end() == grid.grid_begin() ? 0 : Size(distance(grid.grid_begin(), grid.grid_end()));
+
+    // smallest block radius (in cells), so that all distances outside are larger than @p threshold (-1: unlimited)
+    auto radiusFor = [&](double threshold, Size dim) -> Int64
+    {
+      if (!use_grid || (threshold == FeatureDistance::infinity) || (weight[dim] <= 0.0))
+      {
+        return -1;
+      }
+      double radius = max(floor(pow(threshold * total_weight / weight[dim], 1.0 / exponent[dim])) + 1.0, 1.0);
+      while (weight[dim] * pow(radius, exponent[dim]) / total_weight <= threshold)
+      {
+        radius += 1.0;
+      }
+      return (radius > double(cell_max[dim] - cell_min[dim] + 1)) ? -1 : Int64(radius);
+    };
+
+    vector<std::exception_ptr> errors(queries.size());
+#pragma omp parallel for schedule(dynamic, 100)
+    for (SignedSize q = 0; q < (SignedSize) queries.size(); ++q)
+    {
+      try
+      {
+        const ConsensusFeature& query = queries[q];
+        const Int64 center[2] = {use_grid ? cellIndex(query.getRT(), 0) : 0, use_grid ? cellIndex(query.getMZ(), 1) : 0};
+        // valid pairs have distances of at most one:
+        Int64 radius[2] = {radiusFor(1.0, 0), radiusFor(1.0, 1)};
+        vector<UInt> neighbors;
+        while (true)
+        {
+          // compile candidates in the block around the query (in original order):
+          Int64 low[2], high[2];
+          bool complete = true; // block covers all candidates?
+          for (Size dim = 0; dim < 2; ++dim)
+          {
+            low[dim] = (radius[dim] < 0) ? cell_min[dim] : max(cell_min[dim], center[dim] - radius[dim]);
+            high[dim] = (radius[dim] < 0) ? cell_max[dim] : min(cell_max[dim], center[dim] + radius[dim]);
+            complete = complete && (low[dim] == cell_min[dim]) && (high[dim] == cell_max[dim]);
+          }
+          neighbors.clear();
+          if (complete || !use_grid)
+          {
+            complete = true;
+            neighbors.resize(candidates.size());
+            for (UInt index = 0; index < candidates.size(); ++index)
+            {
+              neighbors[index] = index;
+            }
+          }
+          else if ((low[0] > high[0]) || (low[1] > high[1]))
+          {
+            // block is outside of the candidate range
+          }
+          else if (double(high[0] - low[0] + 1) * double(high[1] - low[1] + 1) > double(num_cells))
+          {
+            for (Grid::const_grid_iterator cell_it = grid.grid_begin(); cell_it != grid.grid_end(); ++cell_it)
+            {
+              const Grid::CellIndex& cell = cell_it->first;
+              if ((cell[0] >= low[0]) && (cell[0] <= high[0]) && (cell[1] >= low[1]) && (cell[1] <= high[1]))
+              {
+                for (Grid::const_cell_iterator it = cell_it->second.begin(); it != cell_it->second.end(); ++it)
+                {
+                  neighbors.push_back(it->second);
+                }
+              }
+            }
+          }
+          else
+          {
+            for (Int64 i = low[0]; i <= high[0]; ++i)
+            {
+              for (Int64 j = low[1]; j <= high[1]; ++j)
+              {
+                Grid::const_grid_iterator cell_it = grid.grid_find(Grid::CellIndex(i, j));
+                if (cell_it == grid.grid_end())
+                {
+                  continue;
+                }
+                for (Grid::const_cell_iterator it = cell_it->second.begin(); it != cell_it->second.end(); ++it)
+                {
+                  neighbors.push_back(it->second);
+                }
+              }
+            }
+          }
+          sort(neighbors.begin(), neighbors.end());
+
+          UInt& index = nn_index[q];
+          pair<double, double>& nn = nn_distance[q];
+          index = UInt(-1);
+          nn = make_pair(FeatureDistance::infinity, FeatureDistance::infinity);
+          for (vector<UInt>::const_iterator n_it = neighbors.begin(); n_it != neighbors.end(); ++n_it)
+          {
+            const ConsensusFeature& candidate = candidates[*n_it];
+            // distances are always computed from map 0 to map 1:
+            pair<bool, double> result = (query_map == 0) ? feature_distance(query, candidate) : feature_distance(candidate, query);
+            double distance = result.second;
+            // we only care if distance constraints are satisfied for "best
+            // matches", not for second-best; this means that second-best distances
+            // can become smaller than best distances
+            // (e.g. the RT is larger than allowed (->invalid pair), but m/z is perfect and has the most weight --> better score!)
+            bool valid = result.first;
+
+            if (distance < nn.second)
+            {
+              if (use_IDs_ && !compatibleIDs_(query, candidate)) // check peptide IDs
+              {
+                continue; // mismatch
+              }
+              if (valid && (distance < nn.first))
+              {
+                nn.second = nn.first;
+                nn.first = distance;
+                index = *n_it;
+              }
+              else
+              {
+                nn.second = distance;
+              }
+            }
+          }
+          if (complete)
+          {
+            break;
+          }
+
+          // Candidates outside of the block are invalid and have larger
+          // distances than "bound"; they can only change the result if they are
+          // closer than the second-nearest neighbor found so far. (Otherwise,
+          // each of them updates at most the second-nearest distance to a value
+          // above "bound", which the next closer candidate replaces again.)
+          double bound = FeatureDistance::infinity;
+          for (Size dim = 0; dim < 2; ++dim)
+          {
+            if (radius[dim] >= 0)
+            {
+              bound = min(bound, weight[dim] * pow(double(radius[dim]), exponent[dim]) / total_weight);
+            }
+          }
+          if (nn.second < bound)
+          {
+            break;
+          }
+          // extend the block (if no second-nearest neighbor was found yet,
+          // e.g. because the nearest one came last, double its size):
+          for (Size dim = 0; dim < 2; ++dim)
+          {
+            if (radius[dim] < 0)
+            {
+              continue;
+            }
+            Int64 new_radius = (nn.second == FeatureDistance::infinity) ? 2 * radius[dim] : radiusFor(nn.second, dim);
+            if ((new_radius < 0) || (new_radius > cell_max[dim] - cell_min[dim]))
+            {
+              radius[dim] = -1;
+            }
+            else
+            {
+              radius[dim] = max(radius[dim], new_radius);
+            }
+          }
+        }
+      }
+      catch (...)
+      {
+        errors[q] = std::current_exception();
+      }
+    }
+    for (const std::exception_ptr& error : errors)
+    {
+      if (error) std::rethrow_exception(error);
+    }
+  }
+
   bool StablePairFinder::compatibleIDs_(const ConsensusFeature& feat1, const ConsensusFeature& feat2) const
   {
     // a feature without identifications always matches:
@@ -134,6 +134,11 @@ namespace OpenMS
     return model_->evaluate(value);
   }
 
+  void TransformationDescription::apply(const std::vector<double>& values, std::vector<double>& result) const
+  {
+    model_->evaluate(values, result);
+  }
+
   const String& TransformationDescription::getModelType() const
   {
     return model_type_;
@@ -89,6 +89,15 @@ namespace OpenMS
     return value;
   }
 
+  void TransformationModel::evaluate(const std::vector<double>& values, std::vector<double>& result) const
+  {
+    result.resize(values.size());
+    for (Size i = 0; i < values.size(); ++i)
+    {
+      result[i] = evaluate(values[i]);
+    }
+  }
+
   const Param& TransformationModel::getParameters() const
   {
     return params_;
@@ -156,6 +156,15 @@ namespace OpenMS
     return spline_->eval(value);
   }
 
+  void TransformationModelBSpline::evaluate(const std::vector<double>& values, std::vector<double>& result) const
+  {
+    result.resize(values.size());
+    for (Size i = 0; i < values.size(); ++i)
+    {
+      result[i] = TransformationModelBSpline::evaluate(values[i]);
+    }
+  }
+
   void TransformationModelBSpline::getDefaultParameters(Param& params)
   {
     params.clear();
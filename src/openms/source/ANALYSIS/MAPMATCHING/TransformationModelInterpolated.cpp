@@ -41,6 +41,7 @@
 // Spline2dInterpolator
 #include <OpenMS/MATH/MISC/CubicSpline2d.h>
 
+#include <algorithm>
 #include <numeric>
 
 // AkimaInterpolator
@@ -49,6 +50,14 @@
 
 namespace OpenMS
 {
+  void TransformationModelInterpolated::Interpolator::evalSorted(const double* begin, const double* end, double* result) const
+  {
+    for (; begin != end; ++begin, ++result)
+    {
+      *result = eval(*begin);
+    }
+  }
+
   /**
    * @brief Spline2dInterpolator
    */
@@ -75,6 +84,11 @@ public:
       return spline_->eval(x);
     }
 
+    void evalSorted(const double* begin, const double* end, double* result) const override
+    {
+      spline_->eval(begin, end, result);
+    }
+
     ~Spline2dInterpolator() override
     {
       delete spline_;
@@ -167,6 +181,33 @@ public:
       }
     }
 
+    void evalSorted(const double* begin, const double* end, double* result) const override
+    {
+      // same as eval(), but positions are sorted: walk along the data instead of searching it
+      Size idx = 0; // index of first data point > x (as upper_bound in eval())
+      for (; begin != end; ++begin, ++result)
+      {
+        const double x = *begin;
+        while (idx < x_.size() && x_[idx] <= x)
+        {
+          ++idx;
+        }
+        if (idx == x_.size())
+        {
+          *result = y_.back();
+        }
+        else
+        {
+          const double x_0 = x_[idx - 1];
+          const double x_1 = x_[idx];
+          const double y_0 = y_[idx - 1];
+          const double y_1 = y_[idx];
+
+          *result = y_0 + (y_1 - y_0) * (x - x_0) / (x_1 - x_0);
+        }
+      }
+    }
+
     ~LinearInterpolator() override
     {
     }
@@ -422,6 +463,32 @@ private:
     return interp_->eval(value);
   }
 
+  void TransformationModelInterpolated::evaluate(const std::vector<double>& values, std::vector<double>& result) const
+  {
+    result.resize(values.size());
+    if (!std::is_sorted(values.begin(), values.end()))
+    {
+      for (Size i = 0; i < values.size(); ++i)
+      {
+        result[i] = TransformationModelInterpolated::evaluate(values[i]);
+      }
+      return;
+    }
+
+    // sorted: values to extrapolate are at the front and at the back
+    const Size front = std::lower_bound(values.begin(), values.end(), x_.front()) - values.begin();
+    const Size back = std::upper_bound(values.begin() + front, values.end(), x_.back()) - values.begin();
+    for (Size i = 0; i < front; ++i)
+    {
+      result[i] = lm_front_->evaluate(values[i]);
+    }
+    interp_->evalSorted(values.data() + front, values.data() + back, result.data() + front);
+    for (Size i = back; i < values.size(); ++i)
+    {
+      result[i] = lm_back_->evaluate(values[i]);
+    }
+  }
+
   void TransformationModelInterpolated::getDefaultParameters(Param& params)
   {
     params.clear();
@@ -121,6 +121,28 @@ namespace OpenMS
     return eval;
   }
 
+  void TransformationModelLinear::evaluate(const std::vector<double>& values, std::vector<double>& result) const
+  {
+    result.resize(values.size());
+    if (weighting_)
+    {
+      for (Size i = 0; i < values.size(); ++i)
+      {
+        result[i] = TransformationModelLinear::evaluate(values[i]);
+      }
+      return;
+    }
+
+    const double* in = values.data();
+    double* out = result.data();
+    const Size n = values.size();
+#pragma omp simd
+    for (Size i = 0; i < n; ++i)
+    {
+      out[i] = slope_ * in[i] + intercept_;
+    }
+  }
+
   void TransformationModelLinear::invert()
   {
     if (slope_ == 0)
@@ -0,0 +1,111 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessStrided.h>
+
+#include <OpenMS/CONCEPT/Exception.h>
+
+namespace OpenMS
+{
+
+  SpectrumAccessStrided::SpectrumAccessStrided(
+      OpenSwath::SpectrumAccessPtr sptr,
+      Size stride, Size offset) :
+        SpectrumAccessTransforming(sptr),
+        stride_(stride),
+        offset_(offset)
+    {
+      if (stride_ == 0 || offset_ >= stride_)
+      {
+        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+            "Offset needs to be smaller than the stride and the stride needs to be at least 1.");
+      }
+    }
+
+    SpectrumAccessStrided::~SpectrumAccessStrided() {}
+
+    boost::shared_ptr<OpenSwath::ISpectrumAccess> SpectrumAccessStrided::lightClone() const
+    {
+      return boost::shared_ptr<SpectrumAccessStrided>(
+          new SpectrumAccessStrided(sptr_->lightClone(), stride_, offset_));
+    }
+
+    OpenSwath::SpectrumPtr SpectrumAccessStrided::getSpectrumById(int id)
+    {
+      return sptr_->getSpectrumById(static_cast<int>(offset_ + id * stride_));
+    }
+
+    OpenSwath::SpectrumMeta SpectrumAccessStrided::getSpectrumMetaById(int id) const
+    {
+      return sptr_->getSpectrumMetaById(static_cast<int>(offset_ + id * stride_));
+    }
+
+    std::vector<std::size_t> SpectrumAccessStrided::getSpectraByRT(double RT, double deltaRT) const
+    {
+      // only report the spectra that are part of this view (in view coordinates)
+      std::vector<std::size_t> result;
+      const std::vector<std::size_t> all_spectra = sptr_->getSpectraByRT(RT, deltaRT);
+      if (all_spectra.empty())
+      {
+        return result;
+      }
+
+      // as for the underlying map, the first spectrum (of this view) at or after RT - deltaRT is always reported ...
+      const std::size_t first_hit = all_spectra.front();
+      const std::size_t first = first_hit <= offset_ ? 0 : (first_hit - offset_ + stride_ - 1) / stride_;
+      if (first >= getNrSpectra())
+      {
+        return result;
+      }
+      result.push_back(first);
+
+      // ... followed by all further spectra of this view up to RT + deltaRT
+      for (std::size_t idx : all_spectra)
+      {
+        if (idx > offset_ + first * stride_ && (idx - offset_) % stride_ == 0)
+        {
+          result.push_back((idx - offset_) / stride_);
+        }
+      }
+      return result;
+    }
+
+    size_t SpectrumAccessStrided::getNrSpectra() const
+    {
+      size_t n = sptr_->getNrSpectra();
+      if (n <= offset_) return 0;
+      return (n - offset_ + stride_ - 1) / stride_;
+    }
+
+}
@@ -44,6 +44,7 @@
 #include <OpenMS/ANALYSIS/OPENSWATH/DIAHelper.h>
 
 #include <OpenMS/ANALYSIS/OPENSWATH/DIAPrescoring.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/DataAccessHelper.h>
 
 #include <OpenMS/CHEMISTRY/TheoreticalSpectrumGenerator.h>
 #include <OpenMS/MATH/MISC/MathFunctions.h> // getPPM
@@ -119,6 +120,108 @@ namespace OpenMS
     dia_nr_isotopes_ = (int)param_.getValue("dia_nr_isotopes");
     dia_nr_charges_ = (int)param_.getValue("dia_nr_charges");
     peak_before_mono_max_ppm_diff_ = (double)param_.getValue("peak_before_mono_max_ppm_diff");
+
+    // cached patterns depend on the number of isotopes
+    clearAssayCache();
+  }
+
+  ///////////////////////////////////////////////////////////////////////////
+  // Assay cache
+
+  void DIAScoring::prepareAssayCache(const OpenSwath::LightTargetedExperiment& assays)
+  {
+    // the cache describes the current library only
+    clearAssayCache();
+
+    // averagine patterns of all product ions (used by dia_isotope_scores and the
+    // identification transition scores)
+    for (const auto& tr : assays.getTransitions())
+    {
+      int putative_fragment_charge = 1;
+      if (tr.fragment_charge != 0)
+      {
+        putative_fragment_charge = tr.fragment_charge;
+      }
+      double weight = std::fabs(tr.getProductMZ() * putative_fragment_charge);
+      if (averagine_cache_.find(weight) == averagine_cache_.end())
+      {
+        getAveragineIsotopeIntensities_(weight, averagine_cache_[weight]);
+      }
+    }
+
+    std::map<std::string, double> precursor_mz;
+    for (const auto& tr : assays.getTransitions())
+    {
+      precursor_mz.emplace(tr.getPeptideRef(), tr.getPrecursorMZ());
+    }
+
+    for (const auto& compound : assays.getCompounds())
+    {
+      int precursor_charge = 1;
+      if (compound.getChargeState() != 0)
+      {
+        precursor_charge = compound.getChargeState();
+      }
+
+      AssayCacheEntry entry;
+      if (compound.sequence.empty())
+      {
+        // precursor scores will use the averagine model at the library precursor m/z
+        auto mz_it = precursor_mz.find(compound.id);
+        if (mz_it != precursor_mz.end())
+        {
+          double weight = std::fabs(mz_it->second * precursor_charge);
+          if (averagine_cache_.find(weight) == averagine_cache_.end())
+          {
+            getAveragineIsotopeIntensities_(weight, averagine_cache_[weight]);
+          }
+        }
+      }
+      else
+      {
+        // sequences that cannot be parsed are skipped here and fail (as
+        // before) only if they are actually scored
+        try
+        {
+          if (compound.isPeptide())
+          {
+            EmpiricalFormula sum_formula = AASequence::fromString(compound.sequence).getFormula(Residue::Full, precursor_charge);
+            getTheoreticalIsotopeIntensities_(sum_formula.getIsotopeDistribution(CoarseIsotopePatternGenerator(dia_nr_isotopes_ + 1)), entry.precursor_isotopes);
+
+            AASequence aas;
+            OpenSwathDataAccessHelper::convertPeptideToAASequence(compound, aas);
+            DIAHelpers::getBYSeries(aas, entry.bseries, entry.yseries, generator, 1);
+          }
+          else
+          {
+            EmpiricalFormula sum_formula{compound.sequence};
+            sum_formula.setCharge(precursor_charge);
+            getTheoreticalIsotopeIntensities_(sum_formula.getIsotopeDistribution(CoarseIsotopePatternGenerator(dia_nr_isotopes_ + 1)), entry.precursor_isotopes);
+          }
+        }
+        catch (Exception::BaseException&)
+        {
+          continue;
+        }
+      }
+      assay_cache_[compound.id] = std::move(entry);
+    }
+  }
+
+  void DIAScoring::clearAssayCache()
+  {
+    averagine_cache_.clear();
+    assay_cache_.clear();
+  }
+
+  const DIAScoring::AssayCacheEntry* DIAScoring::getAssayCacheEntry(const std::string& compound_id) const
+  {
+    auto it = assay_cache_.find(compound_id);
+    if (it == assay_cache_.end())
+    {
+      return nullptr;
+    }
+    return &it->second;
   }
 
   ///////////////////////////////////////////////////////////////////////////
@@ -221,6 +324,23 @@ namespace OpenMS
     isotope_overlap = max_ratio;
   }
 
+  void DIAScoring::dia_ms1_isotope_scores(double precursor_mz, SpectrumPtrType spectrum,
+                                          double& isotope_corr, double& isotope_overlap, int charge_state,
+                                          const std::vector<double>& theoretical_isotopes) const
+  {
+    std::vector<double> isotopes_int;
+    getIsotopeIntysFromExpSpec_(precursor_mz, spectrum, isotopes_int, charge_state);
+
+    double max_ratio = 0;
+    int nr_occurrences = 0;
+
+    // calculate the scores:
+    // isotope correlation (forward) and the isotope overlap (backward) scores
+    isotope_corr = scoreIsotopePattern_(isotopes_int, theoretical_isotopes);
+    largePeaksBeforeFirstIsotope_(spectrum, precursor_mz, isotopes_int[0], nr_occurrences, max_ratio);
+    isotope_overlap = max_ratio;
+  }
+
   void DIAScoring::getIsotopeIntysFromExpSpec_(double precursor_mz, SpectrumPtrType spectrum,
                             std::vector<double>& isotopes_int,
                             int charge_state) const
@@ -243,15 +363,12 @@ namespace OpenMS
   {
     std::vector<double> exp_isotopes_int;
     getIsotopeIntysFromExpSpec_(precursor_mz, spectrum, exp_isotopes_int, charge_state);
-    CoarseIsotopePatternGenerator solver(dia_nr_isotopes_ + 1);
-    // NOTE: this is a rough estimate of the neutral mz value since we would not know the charge carrier for negative ions
-    IsotopeDistribution isotope_dist = solver.estimateFromPeptideWeight(std::fabs(precursor_mz * charge_state));
 
     double max_ratio;
     int nr_occurrences;
     // calculate the scores:
     // isotope correlation (forward) and the isotope overlap (backward) scores
-    isotope_corr = scoreIsotopePattern_(exp_isotopes_int, isotope_dist);
+    isotope_corr = scoreIsotopePattern_(exp_isotopes_int, precursor_mz, charge_state);
     largePeaksBeforeFirstIsotope_(spectrum, precursor_mz, exp_isotopes_int[0], nr_occurrences, max_ratio);
     isotope_overlap = max_ratio;
   }
@@ -260,13 +377,21 @@ namespace OpenMS
                                     AASequence& sequence, int charge, double& bseries_score,
                                     double& yseries_score) const
   {
-    bseries_score = 0;
-    yseries_score = 0;
     OPENMS_PRECONDITION(charge > 0, "Charge is a positive integer"); // for peptides, charge should be positive
 
-    double mz, intensity, left, right;
     std::vector<double> yseries, bseries;
     OpenMS::DIAHelpers::getBYSeries(sequence, bseries, yseries, generator, charge);
+    dia_by_ion_score(spectrum, bseries, yseries, bseries_score, yseries_score);
+  }
+
+  void DIAScoring::dia_by_ion_score(SpectrumPtrType spectrum,
+                                    const std::vector<double>& bseries, const std::vector<double>& yseries,
+                                    double& bseries_score, double& yseries_score) const
+  {
+    bseries_score = 0;
+    yseries_score = 0;
+
+    double mz, intensity, left, right;
     for (const auto& b_ion_mz : bseries)
     {
       left = b_ion_mz;
@@ -415,16 +540,26 @@ namespace OpenMS
   {
     OPENMS_PRECONDITION(putative_fragment_charge != 0, "Charge needs to be set to != 0"); // charge can be positive and negative
 
-    IsotopeDistribution isotope_dist;
-
-    // create the theoretical distribution from the peptide weight
-    CoarseIsotopePatternGenerator solver(dia_nr_isotopes_ + 1);
     // NOTE: this is a rough estimate of the neutral mz value since we would not know the charge carrier for negative ions
-    isotope_dist = solver.estimateFromPeptideWeight(std::fabs(product_mz * putative_fragment_charge));
+    double weight = std::fabs(product_mz * putative_fragment_charge);
+    auto it = averagine_cache_.find(weight);
+    if (it != averagine_cache_.end())
+    {
+      return scoreIsotopePattern_(isotopes_int, it->second);
+    }
 
-    return scoreIsotopePattern_(isotopes_int, isotope_dist);
+    // create the theoretical distribution from the peptide weight
+    std::vector<double> theoretical_isotopes;
+    getAveragineIsotopeIntensities_(weight, theoretical_isotopes);
+    return scoreIsotopePattern_(isotopes_int, theoretical_isotopes);
   } //end of dia_isotope_corr_sub
 
+  void DIAScoring::getAveragineIsotopeIntensities_(double weight, std::vector<double>& theoretical_isotopes) const
+  {
+    CoarseIsotopePatternGenerator solver(dia_nr_isotopes_ + 1);
+    getTheoreticalIsotopeIntensities_(solver.estimateFromPeptideWeight(weight), theoretical_isotopes);
+  }
+
   double DIAScoring::scoreIsotopePattern_(const std::vector<double>& isotopes_int,
                                           const EmpiricalFormula& empf) const
   {
@@ -435,37 +570,42 @@ namespace OpenMS
   double DIAScoring::scoreIsotopePattern_(const std::vector<double>& isotopes_int,
                                           const IsotopeDistribution& isotope_dist) const
   {
-    typedef OpenMS::FeatureFinderAlgorithmPickedHelperStructs::TheoreticalIsotopePattern TheoreticalIsotopePattern;
-
-    TheoreticalIsotopePattern isotopes;
+    std::vector<double> theoretical_isotopes;
+    getTheoreticalIsotopeIntensities_(isotope_dist, theoretical_isotopes);
+    return scoreIsotopePattern_(isotopes_int, theoretical_isotopes);
+  }
 
+  void DIAScoring::getTheoreticalIsotopeIntensities_(const IsotopeDistribution& isotope_dist,
+                                                     std::vector<double>& theoretical_isotopes) const
+  {
+    theoretical_isotopes.clear();
     for (IsotopeDistribution::ConstIterator it = isotope_dist.begin(); it != isotope_dist.end(); ++it)
     {
-      isotopes.intensity.push_back(it->getIntensity());
+      theoretical_isotopes.push_back(it->getIntensity());
     }
-    isotopes.optional_begin = 0;
-    isotopes.optional_end = dia_nr_isotopes_;
 
     // scale the distribution to a maximum of 1
     double max = 0.0;
-    for (Size i = 0; i < isotopes.intensity.size(); ++i)
+    for (Size i = 0; i < theoretical_isotopes.size(); ++i)
     {
-      if (isotopes.intensity[i] > max)
+      if (theoretical_isotopes[i] > max)
       {
-        max = isotopes.intensity[i];
+        max = theoretical_isotopes[i];
       }
     }
-    isotopes.max = max;
     if (max == 0.) max = 1.;
-    for (Size i = 0; i < isotopes.intensity.size(); ++i)
+    for (Size i = 0; i < theoretical_isotopes.size(); ++i)
     {
-      isotopes.intensity[i] /= max;
+      theoretical_isotopes[i] /= max;
     }
-    isotopes.trimmed_left = 0;
+  }
 
+  double DIAScoring::scoreIsotopePattern_(const std::vector<double>& isotopes_int,
+                                          const std::vector<double>& theoretical_isotopes) const
+  {
     // score the pattern against a theoretical one
-    OPENMS_POSTCONDITION(isotopes_int.size() == isotopes.intensity.size(), "Vectors for pearson correlation do not have the same size.");
-    double int_score = OpenSwath::cor_pearson(isotopes_int.begin(), isotopes_int.end(), isotopes.intensity.begin());
+    OPENMS_POSTCONDITION(isotopes_int.size() == theoretical_isotopes.size(), "Vectors for pearson correlation do not have the same size.");
+    double int_score = OpenSwath::cor_pearson(isotopes_int.begin(), isotopes_int.end(), theoretical_isotopes.begin());
     if (std::isnan(int_score))
     {
       int_score = 0;
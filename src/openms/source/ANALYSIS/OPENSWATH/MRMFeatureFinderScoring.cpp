@@ -273,6 +273,17 @@ namespace OpenMS
     {
       PeptideRefMap_[transition_exp.getCompounds()[i].id] = &transition_exp.getCompounds()[i];
     }
+
+    // theoretical isotope patterns and ion series only depend on the assay, compute them once here
+    // (and drop the patterns of any previous library)
+    if (su_.use_dia_scores_ || su_.use_ms1_fullscan)
+    {
+      diascoring_.prepareAssayCache(transition_exp);
+    }
+    else
+    {
+      diascoring_.clearAssayCache();
+    }
   }
 
   void MRMFeatureFinderScoring::splitTransitionGroupsDetection_(const MRMTransitionGroupType& transition_group,
@@ -135,6 +135,44 @@ namespace OpenSwath
       }
     }
 
+    /// Standardize all traces and copy them into the rows of the contiguous (row-major) buffer @p traces, returns the trace length
+    int standardizeIntoMatrix(std::vector<std::vector<double>>& intensity, std::vector<double>& traces)
+    {
+      const std::size_t datasize = intensity.empty() ? 0 : intensity[0].size();
+      traces.resize(intensity.size() * datasize);
+      for (std::size_t i = 0; i < intensity.size(); i++)
+      {
+        OPENSWATH_PRECONDITION(intensity[i].size() == datasize, "All traces need to have the same length");
+        Scoring::standardize_data(intensity[i]);
+        std::copy(intensity[i].begin(), intensity[i].end(), traces.begin() + i * datasize);
+      }
+      return static_cast<int>(datasize);
+    }
+
+    void MRMScoring::initializeXCorrMaxPeakMatrix(OpenSwath::IMRMFeature* mrmfeature, const std::vector<std::string>& native_ids)
+    {
+      std::vector<std::vector<double>> intensity;
+      fillIntensityFromFeature(mrmfeature, native_ids, intensity);
+      std::vector<double> traces;
+      const int datasize = standardizeIntoMatrix(intensity, traces);
+
+      xcorr_matrix_.resize(0, 0);
+      xcorr_matrix_max_peak_.resize(native_ids.size(), native_ids.size());
+      xcorr_matrix_max_peak_sec_.resize(native_ids.size(), native_ids.size());
+      std::vector<double> sxy; // scratch buffer shared by all pairs
+      for (std::size_t i = 0; i < native_ids.size(); i++)
+      {
+        const double* trace_i = traces.data() + i * datasize;
+        for (std::size_t j = i; j < native_ids.size(); j++)
+        {
+          // compute apex of normalized cross correlation
+          auto x = Scoring::normalizedCrossCorrelationMaxPeak(trace_i, traces.data() + j * datasize, datasize, datasize, 1, sxy);
+          xcorr_matrix_max_peak_.setValue(i, j, std::abs(x.first));
+          xcorr_matrix_max_peak_sec_.setValue(i, j, x.second);
+        }
+      }
+    }
+
     void MRMScoring::initializeXCorrContrastMatrix(OpenSwath::IMRMFeature* mrmfeature, const std::vector<std::string>& native_ids_set1, const std::vector<std::string>& native_ids_set2)
     {
       std::vector<std::vector<double>> intensityi, intensityj;
@@ -150,6 +188,7 @@ namespace OpenSwath
       }
 
       xcorr_contrast_matrix_.resize(native_ids_set1.size(), native_ids_set2.size());
+      xcorr_contrast_matrix_max_peak_.resize(native_ids_set1.size(), native_ids_set2.size());
       xcorr_contrast_matrix_max_peak_sec_.resize(native_ids_set1.size(), native_ids_set2.size());
       for (std::size_t i = 0; i < native_ids_set1.size(); i++)
       {
@@ -158,11 +197,39 @@ namespace OpenSwath
           // compute normalized cross correlation
           xcorr_contrast_matrix_.setValue(i, j, Scoring::normalizedCrossCorrelationPost(intensityi[i], intensityj[j], static_cast<int>(intensityi[i].size()), 1));
           auto x = Scoring::xcorrArrayGetMaxPeak(xcorr_contrast_matrix_.getValue(i, j));
+          xcorr_contrast_matrix_max_peak_.setValue(i, j, std::abs(x->first));
           xcorr_contrast_matrix_max_peak_sec_.setValue(i, j, x->second);
         }
       }
     }
 
+    void MRMScoring::initializeXCorrContrastMaxPeakMatrix(OpenSwath::IMRMFeature* mrmfeature, const std::vector<std::string>& native_ids_set1, const std::vector<std::string>& native_ids_set2)
+    {
+      std::vector<std::vector<double>> intensityi, intensityj;
+      fillIntensityFromFeature(mrmfeature, native_ids_set1, intensityi);
+      fillIntensityFromFeature(mrmfeature, native_ids_set2, intensityj);
+      std::vector<double> tracesi, tracesj;
+      const int datasize = standardizeIntoMatrix(intensityi, tracesi);
+      OPENSWATH_PRECONDITION(intensityj.empty() || static_cast<int>(intensityj[0].size()) == datasize, "All traces need to have the same length");
+      standardizeIntoMatrix(intensityj, tracesj);
+
+      xcorr_contrast_matrix_.resize(0, 0);
+      xcorr_contrast_matrix_max_peak_.resize(native_ids_set1.size(), native_ids_set2.size());
+      xcorr_contrast_matrix_max_peak_sec_.resize(native_ids_set1.size(), native_ids_set2.size());
+      std::vector<double> sxy; // scratch buffer shared by all pairs
+      for (std::size_t i = 0; i < native_ids_set1.size(); i++)
+      {
+        const double* trace_i = tracesi.data() + i * datasize;
+        for (std::size_t j = 0; j < native_ids_set2.size(); j++)
+        {
+          // compute apex of normalized cross correlation
+          auto x = Scoring::normalizedCrossCorrelationMaxPeak(trace_i, tracesj.data() + j * datasize, datasize, datasize, 1, sxy);
+          xcorr_contrast_matrix_max_peak_.setValue(i, j, std::abs(x.first));
+          xcorr_contrast_matrix_max_peak_sec_.setValue(i, j, x.second);
+        }
+      }
+    }
+
     void MRMScoring::initializeXCorrPrecursorMatrix(OpenSwath::IMRMFeature* mrmfeature, const std::vector<std::string>& precursor_ids)
     {
       std::vector<std::vector<double>> intensity;
@@ -339,13 +406,13 @@ namespace OpenSwath
 
     double MRMScoring::calcXcorrContrastCoelutionScore()
     {
-      OPENSWATH_PRECONDITION(xcorr_contrast_matrix_.rows() > 0 && xcorr_contrast_matrix_.cols() > 1, "Expect cross-correlation matrix of at least 1x2");
+      OPENSWATH_PRECONDITION(xcorr_contrast_matrix_max_peak_.rows() > 0 && xcorr_contrast_matrix_max_peak_.cols() > 1, "Expect cross-correlation matrix of at least 1x2");
 
       OpenSwath::mean_and_stddev msc;
-      for (auto e : xcorr_contrast_matrix_)
+      for (auto e : xcorr_contrast_matrix_max_peak_)
       {
         // first is the X value (RT), should be an int
-        msc(std::abs(Scoring::xcorrArrayGetMaxPeak(e)->first));  
+        msc(e);
 #ifdef MRMSCORING_TESTING
         std::cout << "&&_xcoel append " << std::abs(Scoring::xcorrArrayGetMaxPeak(xcorr_contrast_matrix_[i][j])->first) << std::endl;
 #endif
@@ -360,22 +427,21 @@ namespace OpenSwath
 
     std::vector<double> MRMScoring::calcSeparateXcorrContrastCoelutionScore()
     {
-      OPENSWATH_PRECONDITION(xcorr_contrast_matrix_.rows() > 0 && xcorr_contrast_matrix_.cols() > 1, "Expect cross-correlation matrix of at least 1x2");
+      OPENSWATH_PRECONDITION(xcorr_contrast_matrix_max_peak_.rows() > 0 && xcorr_contrast_matrix_max_peak_.cols() > 1, "Expect cross-correlation matrix of at least 1x2");
 
       std::vector<double > deltas;
-      for (std::size_t i = 0; i < xcorr_contrast_matrix_.rows(); i++)
+      for (std::size_t i = 0; i < xcorr_contrast_matrix_max_peak_.rows(); i++)
       {
         double deltas_id = 0;
-        for (std::size_t  j = 0; j < xcorr_contrast_matrix_.cols(); j++)
+        for (std::size_t  j = 0; j < xcorr_contrast_matrix_max_peak_.cols(); j++)
         {
           // first is the X value (RT), should be an int
-          auto x = Scoring::xcorrArrayGetMaxPeak(xcorr_contrast_matrix_.getValue(i, j));
-          deltas_id += std::abs(x->first);
+          deltas_id += xcorr_contrast_matrix_max_peak_.getValue(i, j);
 #ifdef MRMSCORING_TESTING
-          std::cout << "&&_xcoel append " << xcorr_contrast_matrix_max_peak_getValue(i, j) << std::endl;
+          std::cout << "&&_xcoel append " << xcorr_contrast_matrix_max_peak_.getValue(i, j) << std::endl;
 #endif
         }
-        deltas.push_back(deltas_id / xcorr_contrast_matrix_.cols());
+        deltas.push_back(deltas_id / xcorr_contrast_matrix_max_peak_.cols());
       }
 
       return deltas;
@@ -207,10 +207,18 @@ namespace OpenMS
     if (compound.isPeptide() && !compound.sequence.empty() && su_.use_ionseries_scores)
     {
       // Presence of b/y series score
-      OpenMS::AASequence aas;
-      int by_charge_state = 1; // for which charge states should we check b/y series
-      OpenSwathDataAccessHelper::convertPeptideToAASequence(compound, aas);
-      diascoring.dia_by_ion_score(spectrum, aas, by_charge_state, scores.bseries_score, scores.yseries_score);
+      const DIAScoring::AssayCacheEntry* cached = diascoring.getAssayCacheEntry(compound.id);
+      if (cached != nullptr)
+      {
+        diascoring.dia_by_ion_score(spectrum, cached->bseries, cached->yseries, scores.bseries_score, scores.yseries_score);
+      }
+      else
+      {
+        OpenMS::AASequence aas;
+        int by_charge_state = 1; // for which charge states should we check b/y series
+        OpenSwathDataAccessHelper::convertPeptideToAASequence(compound, aas);
+        diascoring.dia_by_ion_score(spectrum, aas, by_charge_state, scores.bseries_score, scores.yseries_score);
+      }
     }
 
     if (ms1_map && ms1_map->getNrSpectra() > 0) 
@@ -259,7 +267,14 @@ namespace OpenMS
         precursor_charge = compound.getChargeState();
       }
 
-      if (compound.isPeptide())
+      // use the precomputed theoretical isotope pattern if available
+      const DIAScoring::AssayCacheEntry* cached = diascoring.getAssayCacheEntry(compound.id);
+      if (cached != nullptr && !cached->precursor_isotopes.empty())
+      {
+        diascoring.dia_ms1_isotope_scores(precursor_mz, ms1_spectrum, scores.ms1_isotope_correlation,
+                                          scores.ms1_isotope_overlap, precursor_charge, cached->precursor_isotopes);
+      }
+      else if (compound.isPeptide())
       {
         if (!compound.sequence.empty())
         {
@@ -360,7 +375,7 @@ namespace OpenMS
     OPENMS_PRECONDITION(imrmfeature != nullptr, "Feature to be scored cannot be null");
     OpenSwath::MRMScoring mrmscore_;
     if (su_.use_coelution_score_ || su_.use_shape_score_ || (!imrmfeature->getPrecursorIDs().empty() && su_.use_ms1_correlation))
-      mrmscore_.initializeXCorrMatrix(imrmfeature, native_ids);
+      mrmscore_.initializeXCorrMaxPeakMatrix(imrmfeature, native_ids);
 
     // XCorr score (coelution)
     if (su_.use_coelution_score_)
@@ -452,7 +467,7 @@ namespace OpenMS
   {
     OPENMS_PRECONDITION(imrmfeature != nullptr, "Feature to be scored cannot be null");
     OpenSwath::MRMScoring mrmscore_;
-    mrmscore_.initializeXCorrContrastMatrix(imrmfeature, native_ids_identification, native_ids_detection);
+    mrmscore_.initializeXCorrContrastMaxPeakMatrix(imrmfeature, native_ids_identification, native_ids_detection);
 
     if (su_.use_coelution_score_)
     {
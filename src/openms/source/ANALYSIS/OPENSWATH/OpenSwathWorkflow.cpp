@@ -76,17 +76,17 @@ namespace OpenMS
     bool load_into_memory)
   {
     OPENMS_LOG_DEBUG << "performRTNormalization method starting" << std::endl;
-    std::vector< OpenMS::MSChromatogram > irt_chromatograms;
-    TransformationDescription trafo; // dummy
-    this->simpleExtractChromatograms_(swath_maps, irt_transitions, irt_chromatograms, trafo, cp_irt, sonar, load_into_memory);
+    Size spectra_stride = 1;
+    double convergence_tolerance = 0.0;
+    if (irt_detection_param.exists("sampling:spectra_stride"))
+    {
+      spectra_stride = (int)irt_detection_param.getValue("sampling:spectra_stride");
+      convergence_tolerance = irt_detection_param.getValue("sampling:convergence_tolerance");
+    }
 
-    // debug output of the iRT chromatograms
-    if (irt_mzml_out.empty() && debug_level > 1)
-      {
-        String irt_mzml_out = "debug_irts.mzML";
-      }
-    if (!irt_mzml_out.empty())
+    auto store_irt_chromatograms = [&irt_mzml_out](const std::vector< OpenMS::MSChromatogram >& irt_chromatograms)
     {
+      if (irt_mzml_out.empty()) return;
       try
       {
         PeakMap exp;
@@ -101,7 +101,30 @@ namespace OpenMS
       {
         OPENMS_LOG_DEBUG << "Error writing to file " + irt_mzml_out + ", not writing out iRT chromatogram file"  << std::endl;
       }
+    };
+
+    // debug output of the iRT chromatograms
+    if (irt_mzml_out.empty() && debug_level > 1)
+      {
+        String irt_mzml_out = "debug_irts.mzML";
+      }
+
+    std::vector< OpenMS::MSChromatogram > irt_chromatograms;
+    if (spectra_stride > 1)
+    {
+      // extract and calibrate on a growing subset of the spectra
+      TransformationDescription tr = doIncrementalDataNormalization_(irt_transitions,
+          swath_maps, irt_chromatograms, im_trafo,
+          min_rsq, min_coverage, feature_finder_param, cp_irt,
+          irt_detection_param, calibration_param,
+          spectra_stride, convergence_tolerance, sonar, load_into_memory);
+      store_irt_chromatograms(irt_chromatograms);
+      return tr;
     }
+
+    TransformationDescription trafo; // dummy
+    this->simpleExtractChromatograms_(swath_maps, irt_transitions, irt_chromatograms, trafo, cp_irt, sonar, load_into_memory);
+    store_irt_chromatograms(irt_chromatograms);
     OPENMS_LOG_DEBUG << "Extracted number of chromatograms from iRT files: " << irt_chromatograms.size() <<  std::endl;
 
     // perform RT and m/z correction on the data
@@ -112,6 +135,133 @@ namespace OpenMS
     return tr;
   }
 
+  namespace
+  {
+    /// Order in which the interleaved subsets of a strided extraction are
+    /// visited (bit-reversed, so the sampled spectra stay evenly spaced)
+    std::vector<Size> stridedSamplingOrder(Size stride)
+    {
+      Size nbits = 0;
+      while ((Size(1) << nbits) < stride) ++nbits;
+
+      std::vector<Size> order;
+      for (Size i = 0; i < (Size(1) << nbits); ++i)
+      {
+        Size rev = 0;
+        for (Size b = 0; b < nbits; ++b)
+        {
+          if (i & (Size(1) << b)) rev |= Size(1) << (nbits - 1 - b);
+        }
+        if (rev < stride) order.push_back(rev);
+      }
+      return order;
+    }
+  }
+
+  TransformationDescription OpenSwathCalibrationWorkflow::doIncrementalDataNormalization_(
+    const OpenSwath::LightTargetedExperiment& irt_transitions,
+    std::vector< OpenSwath::SwathMap > & swath_maps,
+    std::vector< OpenMS::MSChromatogram >& chromatograms,
+    TransformationDescription& im_trafo,
+    double min_rsq,
+    double min_coverage,
+    const Param& default_ffparam,
+    const ChromExtractParams& cp_irt,
+    const Param& irt_detection_param,
+    const Param& calibration_param,
+    Size spectra_stride,
+    double convergence_tolerance,
+    bool sonar,
+    bool load_into_memory)
+  {
+    if (spectra_stride < 1)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "The spectra stride needs to be at least 1.");
+    }
+
+    std::pair<double,double> RTRange = OpenSwathHelper::estimateRTRange(irt_transitions);
+    const double max_deviation = convergence_tolerance * (RTRange.second - RTRange.first);
+
+    chromatograms.clear();
+    const std::vector<Size> order = stridedSamplingOrder(spectra_stride);
+    TransformationDescription dummy_trafo;
+    TransformationDescription previous_trafo;
+    std::vector<std::pair<double, double> > previous_pairs;
+    bool have_previous = false;
+
+    OpenMS::MRMFeatureFinderScoring::TransitionGroupMapType transition_group_map;
+    std::map<String, OpenMS::MRMFeatureFinderScoring::MRMTransitionGroupType *> trgrmap_final;
+    std::vector<std::pair<double, double> > pairs_corrected;
+    TransformationDescription trafo_out;
+
+    std::vector< std::vector< OpenMS::MSChromatogram > > chromatograms_per_map;
+    for (Size round = 0; round < order.size(); ++round)
+    {
+      // 1. Extract the next subset of spectra from every map and merge it
+      // into the chromatograms extracted so far
+      extractChromatogramSubset_(swath_maps, irt_transitions, chromatograms_per_map, dummy_trafo, cp_irt,
+          spectra_stride, order[round], load_into_memory);
+      collectChromatograms_(chromatograms_per_map, chromatograms, sonar);
+
+      // 2. Select calibrants and fit the RT transformation on the current data
+      const bool last_round = (round + 1 == order.size());
+      try
+      {
+        pairs_corrected = selectRTCalibrants_(irt_transitions, chromatograms,
+            min_rsq, min_coverage, default_ffparam, irt_detection_param, transition_group_map, trgrmap_final);
+        trafo_out = fitRTTransformation_(pairs_corrected, irt_detection_param);
+      }
+      catch (Exception::BaseException& e)
+      {
+        // not enough data yet, only fail once all spectra have been used
+        if (last_round) throw;
+        OPENMS_LOG_DEBUG << "Calibration with " << round + 1 << " of " << spectra_stride
+          << " spectra subsets failed: " << e.what() << std::endl;
+        have_previous = false;
+        continue;
+      }
+
+      // 3. Check whether the RT transformation changed since the last round
+      if (have_previous)
+      {
+        double deviation = 0.0;
+        for (const auto* pairs : {&pairs_corrected, &previous_pairs})
+        {
+          for (const auto& p : *pairs)
+          {
+            deviation = std::max(deviation, std::fabs(trafo_out.apply(p.first) - previous_trafo.apply(p.first)));
+          }
+        }
+        OPENMS_LOG_DEBUG << "Calibration with " << round + 1 << " of " << spectra_stride
+          << " spectra subsets changed by " << deviation << std::endl;
+        if (deviation <= max_deviation)
+        {
+          OPENMS_LOG_INFO << "RT calibration converged after extracting " << round + 1 << " of "
+            << spectra_stride << " spectra subsets." << std::endl;
+          break;
+        }
+      }
+      previous_trafo = trafo_out;
+      previous_pairs = pairs_corrected;
+      have_previous = true;
+    }
+    OPENMS_LOG_DEBUG << "Extracted number of chromatograms from iRT files: " << chromatograms.size() <<  std::endl;
+
+    // 4. Correct m/z deviations using the calibrants of the final round
+    SwathMapMassCorrection mc;
+    mc.setParameters(calibration_param);
+    mc.correctMZ(trgrmap_final, irt_transitions, swath_maps);
+    mc.correctIM(trgrmap_final, irt_transitions, swath_maps, im_trafo);
+
+    OPENMS_LOG_DEBUG << "Final RT mapping:" << std::endl;
+    for (Size i = 0; i < pairs_corrected.size(); i++)
+    {
+      OPENMS_LOG_DEBUG << pairs_corrected[i].first << " " <<  pairs_corrected[i].second << std::endl;
+    }
+    return trafo_out;
+  }
+
   TransformationDescription OpenSwathCalibrationWorkflow::doDataNormalization_(
     const OpenSwath::LightTargetedExperiment& targeted_exp,
     const std::vector< OpenMS::MSChromatogram >& chromatograms,
@@ -126,6 +276,44 @@ namespace OpenMS
     OPENMS_LOG_DEBUG << "Start of doDataNormalization_ method" << std::endl;
     this->startProgress(0, 1, "Retention time normalization");
 
+    OpenMS::MRMFeatureFinderScoring::TransitionGroupMapType transition_group_map; // for results
+    std::map<String, OpenMS::MRMFeatureFinderScoring::MRMTransitionGroupType *> trgrmap_final; // store all peaks above cutoff
+    std::vector<std::pair<double, double> > pairs_corrected = selectRTCalibrants_(targeted_exp, chromatograms,
+        min_rsq, min_coverage, default_ffparam, irt_detection_param, transition_group_map, trgrmap_final);
+
+    // 8. Correct m/z deviations using SwathMapMassCorrection
+    SwathMapMassCorrection mc;
+    mc.setParameters(calibration_param);
+    mc.correctMZ(trgrmap_final, targeted_exp, swath_maps);
+    mc.correctIM(trgrmap_final, targeted_exp, swath_maps, im_trafo);
+
+    // 9. store RT transformation, using the selected model
+    TransformationDescription trafo_out = fitRTTransformation_(pairs_corrected, irt_detection_param);
+
+    OPENMS_LOG_DEBUG << "Final RT mapping:" << std::endl;
+    for (Size i = 0; i < pairs_corrected.size(); i++)
+    {
+      OPENMS_LOG_DEBUG << pairs_corrected[i].first << " " <<  pairs_corrected[i].second << std::endl;
+    }
+    OPENMS_LOG_DEBUG << "End of doDataNormalization_ method" << std::endl;
+
+    this->endProgress();
+    return trafo_out;
+  }
+
+  std::vector<std::pair<double, double> > OpenSwathCalibrationWorkflow::selectRTCalibrants_(
+    const OpenSwath::LightTargetedExperiment& targeted_exp,
+    const std::vector< OpenMS::MSChromatogram >& chromatograms,
+    double min_rsq,
+    double min_coverage,
+    const Param& default_ffparam,
+    const Param& irt_detection_param,
+    OpenMS::MRMFeatureFinderScoring::TransitionGroupMapType& transition_group_map,
+    std::map<String, OpenMS::MRMFeatureFinderScoring::MRMTransitionGroupType *>& trgrmap_final)
+  {
+    transition_group_map.clear();
+    trgrmap_final.clear();
+
     bool estimateBestPeptides = irt_detection_param.getValue("estimateBestPeptides").toBool();
     if (estimateBestPeptides)
     {
@@ -168,7 +356,6 @@ namespace OpenMS
     featureFinder.setParameters(feature_finder_param);
 
     FeatureMap featureFile; // for results
-    OpenMS::MRMFeatureFinderScoring::TransitionGroupMapType transition_group_map; // for results
     std::vector<OpenSwath::SwathMap> empty_swath_maps;
     TransformationDescription empty_trafo; // empty transformation
 
@@ -256,7 +443,6 @@ namespace OpenMS
 
     // 7. Select the "correct" peaks for m/z correction (e.g. remove those not
     // part of the linear regression)
-    std::map<String, OpenMS::MRMFeatureFinderScoring::MRMTransitionGroupType *> trgrmap_final; // store all peaks above cutoff
     for (const auto& it : trgrmap_allpeaks)
     {
       if (it.second->getFeatures().empty() ) {continue;}
@@ -276,30 +462,21 @@ namespace OpenMS
       }
     }
 
-    // 8. Correct m/z deviations using SwathMapMassCorrection
-    SwathMapMassCorrection mc;
-    mc.setParameters(calibration_param);
-    mc.correctMZ(trgrmap_final, targeted_exp, swath_maps);
-    mc.correctIM(trgrmap_final, targeted_exp, swath_maps, im_trafo);
+    return pairs_corrected;
+  }
 
-    // 9. store RT transformation, using the selected model
+  TransformationDescription OpenSwathCalibrationWorkflow::fitRTTransformation_(
+    const std::vector<std::pair<double, double> >& pairs,
+    const Param& irt_detection_param)
+  {
     TransformationDescription trafo_out;
-    trafo_out.setDataPoints(pairs_corrected);
+    trafo_out.setDataPoints(pairs);
     Param model_params;
     model_params.setValue("symmetric_regression", "false");
     model_params.setValue("span", irt_detection_param.getValue("lowess:span"));
     model_params.setValue("num_nodes", irt_detection_param.getValue("b_spline:num_nodes"));
     String model_type = irt_detection_param.getValue("alignmentMethod").toString();
     trafo_out.fitModel(model_type, model_params);
-
-    OPENMS_LOG_DEBUG << "Final RT mapping:" << std::endl;
-    for (Size i = 0; i < pairs_corrected.size(); i++)
-    {
-      OPENMS_LOG_DEBUG << pairs_corrected[i].first << " " <<  pairs_corrected[i].second << std::endl;
-    }
-    OPENMS_LOG_DEBUG << "End of doDataNormalization_ method" << std::endl;
-
-    this->endProgress();
     return trafo_out;
   }
 
@@ -311,85 +488,156 @@ namespace OpenMS
     const ChromExtractParams & cp,
     bool sonar,
     bool load_into_memory)
+  {
+    std::vector< std::vector< OpenMS::MSChromatogram > > chromatograms_per_map;
+    extractChromatogramsPerMap_(swath_maps, irt_transitions, chromatograms_per_map, trafo, cp, load_into_memory);
+    collectChromatograms_(chromatograms_per_map, chromatograms, sonar);
+  }
+
+  void OpenSwathCalibrationWorkflow::extractChromatogramSubset_(
+    const std::vector< OpenSwath::SwathMap > & swath_maps,
+    const OpenSwath::LightTargetedExperiment & irt_transitions,
+    std::vector< std::vector< OpenMS::MSChromatogram > > & chromatograms_per_map,
+    const TransformationDescription& trafo,
+    const ChromExtractParams & cp,
+    Size spectra_stride,
+    Size offset,
+    bool load_into_memory)
+  {
+    std::vector< OpenSwath::SwathMap > sampled_maps = swath_maps;
+    for (auto& m : sampled_maps)
+    {
+      m.sptr = OpenSwath::SpectrumAccessPtr(new SpectrumAccessStrided(m.sptr, spectra_stride, offset));
+    }
+    std::vector< std::vector< OpenMS::MSChromatogram > > new_chromatograms;
+    extractChromatogramsPerMap_(sampled_maps, irt_transitions, new_chromatograms, trafo, cp, load_into_memory);
+
+    if (chromatograms_per_map.empty())
+    {
+      chromatograms_per_map.swap(new_chromatograms);
+      return;
+    }
+    if (chromatograms_per_map.size() != new_chromatograms.size())
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Chromatograms of the previous subsets were extracted from a different number of SWATH maps.");
+    }
+
+    // each map yields one chromatogram per selected transition, in the same
+    // order for every subset: merge the data points by RT
+    for (Size map_idx = 0; map_idx < chromatograms_per_map.size(); ++map_idx)
+    {
+      std::vector< OpenMS::MSChromatogram >& base = chromatograms_per_map[map_idx];
+      const std::vector< OpenMS::MSChromatogram >& added = new_chromatograms[map_idx];
+      if (base.size() != added.size())
+      {
+        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+          "Chromatograms of the previous subsets were extracted with a different set of transitions.");
+      }
+      for (Size chrom_idx = 0; chrom_idx < base.size(); ++chrom_idx)
+      {
+        MSChromatogram& chrom = base[chrom_idx];
+        const Size mid = chrom.size();
+        chrom.insert(chrom.end(), added[chrom_idx].begin(), added[chrom_idx].end());
+        std::inplace_merge(chrom.begin(), chrom.begin() + mid, chrom.end(), ChromatogramPeak::PositionLess());
+      }
+    }
+  }
+
+  void OpenSwathCalibrationWorkflow::extractChromatogramsPerMap_(
+    const std::vector< OpenSwath::SwathMap > & swath_maps,
+    const OpenSwath::LightTargetedExperiment& irt_transitions,
+    std::vector< std::vector< OpenMS::MSChromatogram > > & chromatograms_per_map,
+    const TransformationDescription& trafo,
+    const ChromExtractParams & cp,
+    bool load_into_memory)
   {
     TransformationDescription trafo_inverse = trafo;
     trafo_inverse.invert();
 
+    chromatograms_per_map.clear();
+    chromatograms_per_map.resize(swath_maps.size());
+
     this->startProgress(0, 1, "Extract iRT chromatograms");
 #ifdef _OPENMP
 #pragma omp parallel for schedule(dynamic,1)
 #endif
     for (SignedSize map_idx = 0; map_idx < boost::numeric_cast<SignedSize>(swath_maps.size()); ++map_idx)
     {
-      std::vector< OpenMS::MSChromatogram > tmp_chromatograms;
-      if (!swath_maps[map_idx].ms1) // skip MS1
-      {
+      if (swath_maps[map_idx].ms1) continue; // skip MS1
 
-        OpenSwath::LightTargetedExperiment transition_exp_used;
-        OpenSwathHelper::selectSwathTransitions(irt_transitions, transition_exp_used,
-            cp.min_upper_edge_dist, swath_maps[map_idx].lower, swath_maps[map_idx].upper);
-        if (!transition_exp_used.getTransitions().empty()) // skip if no transitions found
-        {
+      OpenSwath::LightTargetedExperiment transition_exp_used;
+      OpenSwathHelper::selectSwathTransitions(irt_transitions, transition_exp_used,
+          cp.min_upper_edge_dist, swath_maps[map_idx].lower, swath_maps[map_idx].upper);
+      if (transition_exp_used.getTransitions().empty()) // skip if no transitions found
+      {
+        OPENMS_LOG_DEBUG << "Extracted no transitions from SWATH map " << map_idx << " with m/z " <<
+            swath_maps[map_idx].lower << " to " << swath_maps[map_idx].upper << std::endl;
+        continue;
+      }
 
-          std::vector< OpenSwath::ChromatogramPtr > tmp_out;
-          std::vector< ChromatogramExtractor::ExtractionCoordinates > coordinates;
-          ChromatogramExtractor extractor;
+      std::vector< OpenSwath::ChromatogramPtr > tmp_out;
+      std::vector< ChromatogramExtractor::ExtractionCoordinates > coordinates;
+      ChromatogramExtractor extractor;
 
-          OpenSwath::SpectrumAccessPtr current_swath_map = swath_maps[map_idx].sptr;
-          if (load_into_memory)
-          {
-            // This creates an InMemory object that keeps all data in memory
-            current_swath_map = boost::shared_ptr<SpectrumAccessOpenMSInMemory>( new SpectrumAccessOpenMSInMemory(*current_swath_map) );
-          }
+      OpenSwath::SpectrumAccessPtr current_swath_map = swath_maps[map_idx].sptr;
+      if (load_into_memory)
+      {
+        // This creates an InMemory object that keeps all data in memory
+        current_swath_map = boost::shared_ptr<SpectrumAccessOpenMSInMemory>( new SpectrumAccessOpenMSInMemory(*current_swath_map) );
+      }
 
-          prepareExtractionCoordinates_(tmp_out, coordinates, transition_exp_used, trafo_inverse, cp);
-          extractor.extractChromatograms(current_swath_map, tmp_out, coordinates, cp.mz_extraction_window,
-                cp.ppm, cp.im_extraction_window, cp.extraction_function);
-          extractor.return_chromatogram(tmp_out, coordinates,
-              transition_exp_used, SpectrumSettings(), tmp_chromatograms, false, cp.im_extraction_window);
+      prepareExtractionCoordinates_(tmp_out, coordinates, transition_exp_used, trafo_inverse, cp);
+      extractor.extractChromatograms(current_swath_map, tmp_out, coordinates, cp.mz_extraction_window,
+            cp.ppm, cp.im_extraction_window, cp.extraction_function);
+      // each map writes its own slot only
+      extractor.return_chromatogram(tmp_out, coordinates,
+          transition_exp_used, SpectrumSettings(), chromatograms_per_map[map_idx], false, cp.im_extraction_window);
 
-#ifdef _OPENMP
-#pragma omp critical (osw_write_chroms)
-#endif
-          {
-            int nr_empty_chromatograms = 0;
-            OPENMS_LOG_DEBUG << "[simple] Extracted "  << tmp_chromatograms.size() << " chromatograms from SWATH map " <<
-              map_idx << " with m/z " << swath_maps[map_idx].lower << " to " << swath_maps[map_idx].upper << ":" << std::endl;
-            for (Size chrom_idx = 0; chrom_idx < tmp_chromatograms.size(); chrom_idx++)
-            {
-              // Check TIC and remove empty chromatograms (can happen if the
-              // extraction window is outside the mass spectrometric acquisition
-              // window).
-              double tic = std::accumulate(tmp_out[chrom_idx]->getIntensityArray()->data.begin(),
-                                           tmp_out[chrom_idx]->getIntensityArray()->data.end(),0.0);
-              OPENMS_LOG_DEBUG << "Chromatogram "  << coordinates[chrom_idx].id << " with size "
-                << tmp_out[chrom_idx]->getIntensityArray()->data.size() << " and TIC " << tic  << std::endl;
-              if (tic > 0.0)
-              {
-                // add the chromatogram to the output
-                chromatograms.push_back(tmp_chromatograms[chrom_idx]);
-              }
-              else
-              {
-                OPENMS_LOG_DEBUG << " - Warning: Empty chromatogram " << coordinates[chrom_idx].id <<
-                  " detected. Will skip it!" << std::endl;
-                nr_empty_chromatograms++;
-              }
-            }
+      OPENMS_LOG_DEBUG << "[simple] Extracted "  << chromatograms_per_map[map_idx].size() << " chromatograms from SWATH map " <<
+        map_idx << " with m/z " << swath_maps[map_idx].lower << " to " << swath_maps[map_idx].upper << std::endl;
+    }
+    this->endProgress();
+  }
 
-            if (nr_empty_chromatograms > 0)
-            {
-              std::cerr << " - Warning: Detected " << nr_empty_chromatograms << " empty chromatograms. Will skip them!" << std::endl;
-            }
-          }
+  void OpenSwathCalibrationWorkflow::collectChromatograms_(
+    const std::vector< std::vector< OpenMS::MSChromatogram > > & chromatograms_per_map,
+    std::vector< OpenMS::MSChromatogram > & chromatograms,
+    bool sonar)
+  {
+    chromatograms.clear();
+    int nr_empty_chromatograms = 0;
+    for (const auto& map_chromatograms : chromatograms_per_map)
+    {
+      for (const auto& chrom : map_chromatograms)
+      {
+        // Check TIC and remove empty chromatograms (can happen if the
+        // extraction window is outside the mass spectrometric acquisition
+        // window).
+        double tic = 0.0;
+        for (const auto& peak : chrom)
+        {
+          tic += peak.getIntensity();
+        }
+        OPENMS_LOG_DEBUG << "Chromatogram "  << chrom.getNativeID() << " with size "
+          << chrom.size() << " and TIC " << tic  << std::endl;
+        if (tic > 0.0)
+        {
+          // add the chromatogram to the output
+          chromatograms.push_back(chrom);
         }
         else
         {
-          OPENMS_LOG_DEBUG << "Extracted no transitions from SWATH map " << map_idx << " with m/z " <<
-              swath_maps[map_idx].lower << " to " << swath_maps[map_idx].upper << std::endl;
+          OPENMS_LOG_DEBUG << " - Warning: Empty chromatogram " << chrom.getNativeID() <<
+            " detected. Will skip it!" << std::endl;
+          nr_empty_chromatograms++;
         }
       }
     }
+    if (nr_empty_chromatograms > 0)
+    {
+      std::cerr << " - Warning: Detected " << nr_empty_chromatograms << " empty chromatograms. Will skip them!" << std::endl;
+    }
 
     if (sonar)
     {
@@ -417,8 +665,6 @@ namespace OpenMS
 
       OPENMS_LOG_DEBUG << " got a total of " << chromatograms.size() << " chromatograms after SONAR addition " << std::endl;
     }
-
-    this->endProgress();
   }
 
   void OpenSwathCalibrationWorkflow::addChromatograms(MSChromatogram& base_chrom, const MSChromatogram& newchrom)
@@ -454,55 +700,9 @@ namespace OpenMS
     int ms1_isotopes,
     bool load_into_memory)
   {
-    tsv_writer.writeHeader();
-    osw_writer.writeHeader();
-
-    bool ms1_only = (swath_maps.size() == 1 && swath_maps[0].ms1);
-
-    // Compute inversion of the transformation
-    TransformationDescription trafo_inverse = trafo;
-    trafo_inverse.invert();
-
     std::cout << "Will analyze " << transition_exp.transitions.size() << " transitions in total." << std::endl;
-    int progress = 0;
-    this->startProgress(0, swath_maps.size(), "Extracting and scoring transitions");
-
-    // (i) Obtain precursor chromatograms (MS1) if precursor extraction is enabled
-    ChromExtractParams ms1_cp(cp_ms1);
-    if (!use_ms1_ion_mobility_)
-    {
-      ms1_cp.im_extraction_window = -1;
-    }
-
-    if (ms1_only && !use_ms1_traces_)
-    {
-      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
-          "Error, you need to enable use_ms1_traces when run in MS1 mode." );
-    }
-
-    if (use_ms1_traces_) ms1_map_ = loadMS1Map(swath_maps, load_into_memory);
-
-    // (ii) Precursor extraction only
-    if (ms1_only)
-    {
-      std::vector< MSChromatogram > ms1_chromatograms;
-      MS1Extraction_(ms1_map_, swath_maps, ms1_chromatograms, chromConsumer, ms1_cp,
-                     transition_exp, trafo_inverse, ms1_only, ms1_isotopes);
 
-      FeatureMap featureFile;
-      boost::shared_ptr<MSExperiment> empty_exp = boost::shared_ptr<MSExperiment>(new MSExperiment);
-
-      OpenSwath::LightTargetedExperiment transition_exp_used = transition_exp;
-      scoreAllChromatograms_(std::vector<MSChromatogram>(), ms1_chromatograms, swath_maps, transition_exp_used,
-                            feature_finder_param, trafo,
-                            cp.rt_extraction_window, featureFile, tsv_writer, osw_writer, ms1_isotopes, true);
-
-      // write features to output if so desired
-      std::vector< OpenMS::MSChromatogram > chromatograms;
-      writeOutFeaturesAndChroms_(chromatograms, featureFile, out_featureFile, store_features, chromConsumer);
-    }
-
-    // (iii) map transitions to individual DIA windows for cases where this is
+    // map transitions to individual DIA windows for cases where this is
     // non-trivial (e.g. when there is m/z overlap and a transition could be
     // extracted from more than one window
     std::vector<int> tr_win_map; // maps transition k to dia map i from which it should be extracted
@@ -582,210 +782,266 @@ namespace OpenMS
         }
       }
     }
-    else {
-    };
 
-    // (iv) Perform extraction and scoring of fragment ion chromatograms (MS2)
-    // We set dynamic scheduling such that the maps are worked on in the order
-    // in which they were given to the program / acquired. This gives much
-    // better load balancing than static allocation.
-#ifdef _OPENMP
-#ifdef MT_ENABLE_NESTED_OPENMP
-    int total_nr_threads = omp_get_max_threads(); // store total number of threads we are allowed to use
-    if (threads_outer_loop_ > -1)
+    // Partition the library by DIA window (only indices are stored, the
+    // assays of each window are copied when the window is processed)
+    SwathWindowLibrary assay_library(transition_exp);
+    if (prm_ || pasef_)
     {
-      std::cout << "Setting up nested loop with " << std::min(threads_outer_loop_, omp_get_max_threads()) << " threads out of "<< omp_get_max_threads() << std::endl;
-      omp_set_nested(1);
-      omp_set_dynamic(0);
-      omp_set_num_threads(std::min(threads_outer_loop_, omp_get_max_threads()) ); // use at most threads_outer_loop_ threads here
+      assay_library.partition(tr_win_map, swath_maps.size());
     }
     else
     {
-      std::cout << "Use non-nested loop with " << total_nr_threads << " threads." << std::endl;
+      assay_library.partition(swath_maps, cp.min_upper_edge_dist);
     }
-#endif
-#pragma omp parallel for schedule(dynamic,1)
-#endif
+
+    performExtraction(swath_maps, trafo, cp, cp_ms1, feature_finder_param, assay_library,
+                      out_featureFile, store_features, tsv_writer, osw_writer, chromConsumer,
+                      batchSize, ms1_isotopes, load_into_memory);
+  }
+
+  void OpenSwathWorkflow::performExtraction(
+    const std::vector< OpenSwath::SwathMap > & swath_maps,
+    const TransformationDescription trafo,
+    const ChromExtractParams & cp,
+    const ChromExtractParams & cp_ms1,
+    const Param & feature_finder_param,
+    const SwathWindowLibrary& assay_library,
+    FeatureMap& out_featureFile,
+    bool store_features,
+    OpenSwathTSVWriter & tsv_writer,
+    OpenSwathOSWWriter & osw_writer,
+    Interfaces::IMSDataConsumer * chromConsumer,
+    int batchSize,
+    int ms1_isotopes,
+    bool load_into_memory)
+  {
+    tsv_writer.writeHeader();
+    osw_writer.writeHeader();
+
+    bool ms1_only = (swath_maps.size() == 1 && swath_maps[0].ms1);
+
+    // Compute inversion of the transformation
+    TransformationDescription trafo_inverse = trafo;
+    trafo_inverse.invert();
+
+    if (assay_library.getNrWindows() != swath_maps.size())
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+          "Assay library needs to be partitioned by the provided SWATH maps.");
+    }
+
+    int progress = 0;
+    this->startProgress(0, swath_maps.size(), "Extracting and scoring transitions");
+
+    // (i) Obtain precursor chromatograms (MS1) if precursor extraction is enabled
+    ChromExtractParams ms1_cp(cp_ms1);
+    if (!use_ms1_ion_mobility_)
+    {
+      ms1_cp.im_extraction_window = -1;
+    }
+
+    if (ms1_only && !use_ms1_traces_)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+          "Error, you need to enable use_ms1_traces when run in MS1 mode." );
+    }
+
+    if (use_ms1_traces_) ms1_map_ = loadMS1Map(swath_maps, load_into_memory);
+
+    // (ii) Precursor extraction only
+    if (ms1_only)
+    {
+      OpenSwath::LightTargetedExperiment transition_exp;
+      assay_library.getAllAssays(transition_exp);
+      std::vector< MSChromatogram > ms1_chromatograms;
+      MS1Extraction_(ms1_map_, swath_maps, ms1_chromatograms, chromConsumer, ms1_cp,
+                     transition_exp, trafo_inverse, ms1_only, ms1_isotopes);
+
+      FeatureMap featureFile;
+      boost::shared_ptr<MSExperiment> empty_exp = boost::shared_ptr<MSExperiment>(new MSExperiment);
+
+      OpenSwath::LightTargetedExperiment transition_exp_used = transition_exp;
+      scoreAllChromatograms_(std::vector<MSChromatogram>(), ms1_chromatograms, swath_maps, transition_exp_used,
+                            feature_finder_param, trafo,
+                            cp.rt_extraction_window, featureFile, tsv_writer, osw_writer, ms1_isotopes, true);
+
+      // write features to output if so desired
+      std::vector< OpenMS::MSChromatogram > chromatograms;
+      writeOutFeaturesAndChroms_(chromatograms, featureFile, out_featureFile, store_features, chromConsumer);
+    }
+
+    // (iii) Perform extraction and scoring of fragment ion chromatograms (MS2)
+#if defined(_OPENMP) && _OPENMP >= 201307
+    // Every (window, batch) pair is scheduled as an OpenMP task so that idle
+    // threads pick up work from any window instead of waiting for the
+    // slowest window of a statically divided thread team. Windows are started
+    // in the order in which they were given to the program / acquired; while
+    // the batches of one window are processed, the next window can already
+    // be loaded by another thread. At most max_windows_in_flight windows are
+    // held at the same time: window i depends on the completion of window
+    // i - max_windows_in_flight.
+    const SignedSize max_windows_in_flight = (threads_outer_loop_ > 0) ? threads_outer_loop_ : omp_get_max_threads();
+    std::vector<char> window_tokens(swath_maps.size() + max_windows_in_flight);
+    char* tokens = window_tokens.data();
+#pragma omp parallel
+#pragma omp single
     for (SignedSize i = 0; i < boost::numeric_cast<SignedSize>(swath_maps.size()); ++i)
     {
-      if (!swath_maps[i].ms1) // skip MS1
+#pragma omp task default(shared) firstprivate(i) depend(in: tokens[i]) depend(out: tokens[i + max_windows_in_flight])
       {
-
-        // Step 1: select which transitions to extract (proceed in batches)
-        OpenSwath::LightTargetedExperiment transition_exp_used_all;
-        if (!(prm_ || pasef_))
+        if (!swath_maps[i].ms1) // skip MS1
         {
-          // Step 1.1: select transitions matching the window
-          OpenSwathHelper::selectSwathTransitions(transition_exp, transition_exp_used_all,
-              cp.min_upper_edge_dist, swath_maps[i].lower, swath_maps[i].upper);
+          performWindowExtraction_(i, swath_maps, trafo, trafo_inverse, cp, ms1_cp, feature_finder_param, assay_library,
+                                   out_featureFile, store_features, tsv_writer, osw_writer, chromConsumer,
+                                   batchSize, ms1_isotopes, ms1_only, load_into_memory);
         }
-        else
-        {
-          // Step 1.2: select transitions based on matching PRM/PASEF window (best window)
-          std::set<std::string> matching_compounds;
-          for (Size k = 0; k < tr_win_map.size(); k++)
-          {
-            if (tr_win_map[k] == i)
-            {
-               const OpenSwath::LightTransition& tr = transition_exp.transitions[k];
-               transition_exp_used_all.transitions.push_back(tr);
-               matching_compounds.insert(tr.getPeptideRef());
-               OPENMS_LOG_DEBUG << "Adding Precursor with m/z " << tr.getPrecursorMZ() << " and IM of " << tr.getPrecursorIM() <<  " to swath with mz upper of " << swath_maps[i].upper << " im lower of " << swath_maps[i].imLower << " and im upper of " << swath_maps[i].imUpper << std::endl;
-            }
-          }
+        #pragma omp critical (progress)
+        this->setProgress(++progress);
+      }
+    }
+#else
+    // Without task support, windows are distributed dynamically over the
+    // threads (in the order in which they were given to the program /
+    // acquired) and the batches of each window are processed sequentially.
+#pragma omp parallel for schedule(dynamic,1)
+    for (SignedSize i = 0; i < boost::numeric_cast<SignedSize>(swath_maps.size()); ++i)
+    {
+      if (!swath_maps[i].ms1) // skip MS1
+      {
+        performWindowExtraction_(i, swath_maps, trafo, trafo_inverse, cp, ms1_cp, feature_finder_param, assay_library,
+                                 out_featureFile, store_features, tsv_writer, osw_writer, chromConsumer,
+                                 batchSize, ms1_isotopes, ms1_only, load_into_memory);
+      }
+      #pragma omp critical (progress)
+      this->setProgress(++progress);
+    }
+#endif
+    this->endProgress();
+  }
 
-          std::set<std::string> matching_proteins;
-          for (Size i = 0; i < transition_exp.compounds.size(); i++)
-          {
-            if (matching_compounds.find(transition_exp.compounds[i].id) != matching_compounds.end())
-            {
-              transition_exp_used_all.compounds.push_back( transition_exp.compounds[i] );
-              for (Size j = 0; j < transition_exp.compounds[i].protein_refs.size(); j++)
-              {
-                matching_proteins.insert(transition_exp.compounds[i].protein_refs[j]);
-              }
-            }
-          }
-          for (Size i = 0; i < transition_exp.proteins.size(); i++)
-          {
-            if (matching_proteins.find(transition_exp.proteins[i].id) != matching_proteins.end())
-            {
-              transition_exp_used_all.proteins.push_back( transition_exp.proteins[i] );
-            }
-          }
-        }
+  void OpenSwathWorkflow::performWindowExtraction_(
+    Size window_idx,
+    const std::vector< OpenSwath::SwathMap > & swath_maps,
+    const TransformationDescription& trafo,
+    const TransformationDescription& trafo_inverse,
+    const ChromExtractParams & cp,
+    const ChromExtractParams & ms1_cp,
+    const Param & feature_finder_param,
+    const SwathWindowLibrary& assay_library,
+    FeatureMap& out_featureFile,
+    bool store_features,
+    OpenSwathTSVWriter & tsv_writer,
+    OpenSwathOSWWriter & osw_writer,
+    Interfaces::IMSDataConsumer * chromConsumer,
+    int batchSize,
+    int ms1_isotopes,
+    bool ms1_only,
+    bool load_into_memory)
+  {
+    // Step 1: retrieve the transitions of the current window (proceed in batches)
+    OpenSwath::LightTargetedExperiment transition_exp_used_all;
+    assay_library.getWindowAssays(window_idx, transition_exp_used_all);
 
-        if (!transition_exp_used_all.getTransitions().empty()) // skip if no transitions found
-        {
+    if (transition_exp_used_all.getTransitions().empty()) // skip if no transitions found
+    {
+      return;
+    }
 
-          OpenSwath::SpectrumAccessPtr current_swath_map = swath_maps[i].sptr;
-          if (load_into_memory)
-          {
-            // This creates an InMemory object that keeps all data in memory
-            current_swath_map = boost::shared_ptr<SpectrumAccessOpenMSInMemory>( new SpectrumAccessOpenMSInMemory(*current_swath_map) );
-          }
+    OpenSwath::SpectrumAccessPtr current_swath_map = swath_maps[window_idx].sptr;
+    if (load_into_memory)
+    {
+      // This creates an InMemory object that keeps all data in memory
+      current_swath_map = boost::shared_ptr<SpectrumAccessOpenMSInMemory>( new SpectrumAccessOpenMSInMemory(*current_swath_map) );
+    }
 
-          int batch_size;
-          if (batchSize <= 0 || batchSize >= (int)transition_exp_used_all.getCompounds().size())
-          {
-            batch_size = transition_exp_used_all.getCompounds().size();
-          }
-          else
-          {
-            batch_size = batchSize;
-          }
+    int batch_size;
+    if (batchSize <= 0 || batchSize >= (int)transition_exp_used_all.getCompounds().size())
+    {
+      batch_size = transition_exp_used_all.getCompounds().size();
+    }
+    else
+    {
+      batch_size = batchSize;
+    }
 
-          SignedSize nr_batches = (transition_exp_used_all.getCompounds().size() / batch_size);
+    SignedSize nr_batches = (transition_exp_used_all.getCompounds().size() / batch_size);
 
-#ifdef _OPENMP
-#ifdef MT_ENABLE_NESTED_OPENMP
-          // If we have a multiple of threads_outer_loop_ here, then use nested
-          // parallelization here. E.g. if we use 8 threads for the outer loop,
-          // but we have a total of 24 cores available, each of the 8 threads
-          // will then create a team of 3 threads to work on the batches
-          // individually.
-          //
-          // We should avoid oversubscribing the CPUs, therefore we use integer division.
-          // -- see https://docs.oracle.com/cd/E19059-01/stud.10/819-0501/2_nested.html
-          int outer_thread_nr = omp_get_thread_num();
-          omp_set_num_threads(std::max(1, total_nr_threads / threads_outer_loop_) );
-#pragma omp parallel for schedule(dynamic, 1)
-#endif
+    for (SignedSize pep_idx = 0; pep_idx <= nr_batches; pep_idx++)
+    {
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp task default(shared) firstprivate(pep_idx)
 #endif
-          for (SignedSize pep_idx = 0; pep_idx <= nr_batches; pep_idx++)
-          {
-            OpenSwath::SpectrumAccessPtr current_swath_map_inner = current_swath_map;
+      {
+        // To ensure multi-threading safe access to the individual spectra, we
+        // need to use a light clone of the spectrum access (if multiple threads
+        // share a single filestream and call seek on it, chaos will ensue).
+        OpenSwath::SpectrumAccessPtr current_swath_map_inner = current_swath_map->lightClone();
 
 #ifdef _OPENMP
-#ifdef MT_ENABLE_NESTED_OPENMP
-            // To ensure multi-threading safe access to the individual spectra, we
-            // need to use a light clone of the spectrum access (if multiple threads
-            // share a single filestream and call seek on it, chaos will ensue).
-            if (total_nr_threads / threads_outer_loop_ > 1)
-            {
-              current_swath_map_inner = current_swath_map->lightClone();
-            }
-#endif
 #pragma omp critical (osw_write_stdout)
 #endif
-            {
-              std::cout << "Thread " <<
+        {
+          std::cout << "Thread " <<
 #ifdef _OPENMP
-#ifdef MT_ENABLE_NESTED_OPENMP
-              outer_thread_nr << "_" << omp_get_thread_num() << " " <<
-#else
-              omp_get_thread_num() << "_0 " <<
-#endif
+          omp_get_thread_num() << "_0 " <<
 #else
-              "0" <<
+          "0" <<
 #endif
-              "will analyze " << transition_exp_used_all.getCompounds().size() <<  " compounds and "
-              << transition_exp_used_all.getTransitions().size() <<  " transitions "
-              "from SWATH " << i << " (batch " << pep_idx << " out of " << nr_batches << ")" << std::endl;
-            }
-
-            // Create the new, batch-size transition experiment
-            OpenSwath::LightTargetedExperiment transition_exp_used;
-            selectCompoundsForBatch_(transition_exp_used_all, transition_exp_used, batch_size, pep_idx);
-
-            // Extract MS1 chromatograms for this batch
-            std::vector< MSChromatogram > ms1_chromatograms;
-            if (ms1_map_ != nullptr)
-            {
-              OpenSwath::SpectrumAccessPtr threadsafe_ms1 = ms1_map_->lightClone();
-              MS1Extraction_(threadsafe_ms1, swath_maps, ms1_chromatograms, chromConsumer, ms1_cp,
-                  transition_exp_used, trafo_inverse, ms1_only, ms1_isotopes);
-            }
-
-            // Step 2.1: extract these transitions
-            ChromatogramExtractor extractor;
-            std::vector< OpenSwath::ChromatogramPtr > chrom_list;
-            std::vector< ChromatogramExtractor::ExtractionCoordinates > coordinates;
-
-            // Step 2.2: prepare the extraction coordinates and extract chromatograms
-            // chrom_list contains one entry for each fragment ion (transition) in transition_exp_used
-            prepareExtractionCoordinates_(chrom_list, coordinates, transition_exp_used, trafo_inverse, cp);
-            extractor.extractChromatograms(current_swath_map_inner, chrom_list, coordinates, cp.mz_extraction_window,
-                cp.ppm, cp.im_extraction_window, cp.extraction_function);
-
-            // Step 2.3: convert chromatograms back to OpenMS::MSChromatogram and write to output
-            PeakMap chrom_exp;
-            extractor.return_chromatogram(chrom_list, coordinates, transition_exp_used,  SpectrumSettings(),
-                                          chrom_exp.getChromatograms(), false, cp.im_extraction_window);
-
-
-            // Step 3: score these extracted transitions
-            FeatureMap featureFile;
-            std::vector< OpenSwath::SwathMap > tmp = {swath_maps[i]};
-            tmp.back().sptr = current_swath_map_inner;
-            scoreAllChromatograms_(chrom_exp.getChromatograms(), ms1_chromatograms, tmp, transition_exp_used,
-                feature_finder_param, trafo, cp.rt_extraction_window, featureFile, tsv_writer, osw_writer, ms1_isotopes);
-
-            // Step 4: write all chromatograms and features out into an output object / file
-            // (this needs to be done in a critical section since we only have one
-            // output file and one output map).
-            #pragma omp critical (osw_write_out)
-            {
-              writeOutFeaturesAndChroms_(chrom_exp.getChromatograms(), featureFile, out_featureFile, store_features, chromConsumer);
-            }
-          }
-
-        } // continue 2 (no continue due to OpenMP)
-      } // continue 1 (no continue due to OpenMP)
+          "will analyze " << transition_exp_used_all.getCompounds().size() <<  " compounds and "
+          << transition_exp_used_all.getTransitions().size() <<  " transitions "
+          "from SWATH " << window_idx << " (batch " << pep_idx << " out of " << nr_batches << ")" << std::endl;
+        }
 
-      #pragma omp critical (progress)
-      this->setProgress(++progress);
+        // Create the new, batch-size transition experiment
+        OpenSwath::LightTargetedExperiment transition_exp_used;
+        selectCompoundsForBatch_(transition_exp_used_all, transition_exp_used, batch_size, pep_idx);
 
-    }
-    this->endProgress();
+        // Extract MS1 chromatograms for this batch
+        std::vector< MSChromatogram > ms1_chromatograms;
+        if (ms1_map_ != nullptr)
+        {
+          OpenSwath::SpectrumAccessPtr threadsafe_ms1 = ms1_map_->lightClone();
+          MS1Extraction_(threadsafe_ms1, swath_maps, ms1_chromatograms, chromConsumer, ms1_cp,
+              transition_exp_used, trafo_inverse, ms1_only, ms1_isotopes);
+        }
 
-#ifdef _OPENMP
-#ifdef MT_ENABLE_NESTED_OPENMP
-    if (threads_outer_loop_ > -1)
-    {
-      omp_set_num_threads(total_nr_threads); // set number of available threads back to initial value
+        // Step 2.1: extract these transitions
+        ChromatogramExtractor extractor;
+        std::vector< OpenSwath::ChromatogramPtr > chrom_list;
+        std::vector< ChromatogramExtractor::ExtractionCoordinates > coordinates;
+
+        // Step 2.2: prepare the extraction coordinates and extract chromatograms
+        // chrom_list contains one entry for each fragment ion (transition) in transition_exp_used
+        prepareExtractionCoordinates_(chrom_list, coordinates, transition_exp_used, trafo_inverse, cp);
+        extractor.extractChromatograms(current_swath_map_inner, chrom_list, coordinates, cp.mz_extraction_window,
+            cp.ppm, cp.im_extraction_window, cp.extraction_function);
+
+        // Step 2.3: convert chromatograms back to OpenMS::MSChromatogram and write to output
+        PeakMap chrom_exp;
+        extractor.return_chromatogram(chrom_list, coordinates, transition_exp_used,  SpectrumSettings(),
+                                      chrom_exp.getChromatograms(), false, cp.im_extraction_window);
+
+
+        // Step 3: score these extracted transitions
+        FeatureMap featureFile;
+        std::vector< OpenSwath::SwathMap > tmp = {swath_maps[window_idx]};
+        tmp.back().sptr = current_swath_map_inner;
+        scoreAllChromatograms_(chrom_exp.getChromatograms(), ms1_chromatograms, tmp, transition_exp_used,
+            feature_finder_param, trafo, cp.rt_extraction_window, featureFile, tsv_writer, osw_writer, ms1_isotopes);
+
+        // Step 4: write all chromatograms and features out into an output object / file
+        // (this needs to be done in a critical section since we only have one
+        // output file and one output map).
+        #pragma omp critical (osw_write_out)
+        {
+          writeOutFeaturesAndChroms_(chrom_exp.getChromatograms(), featureFile, out_featureFile, store_features, chromConsumer);
+        }
+      }
     }
-#endif
+#if defined(_OPENMP) && _OPENMP >= 201307
+    // the batches reference the data of this window
+#pragma omp taskwait
 #endif
   }
 
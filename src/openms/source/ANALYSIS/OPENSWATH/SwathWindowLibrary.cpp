@@ -0,0 +1,253 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/ANALYSIS/OPENSWATH/SwathWindowLibrary.h>
+
+#include <OpenMS/ANALYSIS/OPENSWATH/OpenSwathHelper.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/TransitionPQPFile.h>
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/FORMAT/SqliteConnector.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <unordered_map>
+
+namespace OpenMS
+{
+
+  SwathWindowLibrary::SwathWindowLibrary(const OpenSwath::LightTargetedExperiment& library) :
+    library_(&library),
+    pqp_file_(),
+    legacy_traml_id_(false),
+    min_upper_edge_dist_(0.0),
+    has_im_trafo_(false)
+  {
+  }
+
+  SwathWindowLibrary::SwathWindowLibrary(const String& pqp_file, bool legacy_traml_id) :
+    library_(nullptr),
+    pqp_file_(pqp_file),
+    legacy_traml_id_(legacy_traml_id),
+    min_upper_edge_dist_(0.0),
+    has_im_trafo_(false)
+  {
+  }
+
+  void SwathWindowLibrary::partition(const std::vector<OpenSwath::SwathMap>& swath_maps, double min_upper_edge_dist)
+  {
+    min_upper_edge_dist_ = min_upper_edge_dist;
+    windows_ = swath_maps;
+    for (auto& w : windows_) w.sptr.reset(); // only the bounds are needed
+    window_index_.clear();
+
+    if (isOnDisk()) return; // windows are read on demand
+
+    // sort transitions by precursor m/z once, each window is then a contiguous range
+    const std::vector<OpenSwath::LightTransition>& transitions = library_->transitions;
+    std::vector<Size> by_mz(transitions.size());
+    std::iota(by_mz.begin(), by_mz.end(), 0);
+    std::sort(by_mz.begin(), by_mz.end(), [&transitions](Size a, Size b)
+        { return transitions[a].precursor_mz < transitions[b].precursor_mz; });
+
+    window_index_.resize(windows_.size());
+    for (Size i = 0; i < windows_.size(); ++i)
+    {
+      if (windows_[i].ms1) continue;
+      const double lower = windows_[i].lower;
+      const double upper = windows_[i].upper;
+      auto first = std::upper_bound(by_mz.begin(), by_mz.end(), lower, [&transitions](double mz, Size k)
+          { return mz < transitions[k].precursor_mz; });
+      auto last = std::lower_bound(first, by_mz.end(), upper, [&transitions](Size k, double mz)
+          { return transitions[k].precursor_mz < mz; });
+
+      std::vector<Size>& tr_idx = window_index_[i].transitions;
+      for (auto it = first; it != last; ++it)
+      {
+        // same criterion as OpenSwathHelper::selectSwathTransitions
+        if (std::fabs(upper - transitions[*it].precursor_mz) >= min_upper_edge_dist_)
+        {
+          tr_idx.push_back(*it);
+        }
+      }
+      std::sort(tr_idx.begin(), tr_idx.end()); // keep library order
+    }
+    completeWindowIndices_();
+  }
+
+  void SwathWindowLibrary::partition(const std::vector<int>& tr_win_map, Size nr_windows)
+  {
+    if (isOnDisk())
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+          "Partitioning by explicit transition to window map requires an in-memory library.");
+    }
+    if (tr_win_map.size() != library_->transitions.size())
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+          "Transition to window map does not match the number of transitions in the library.");
+    }
+
+    windows_.clear();
+    window_index_.clear();
+    window_index_.resize(nr_windows);
+    for (Size k = 0; k < tr_win_map.size(); ++k)
+    {
+      if (tr_win_map[k] >= 0 && (Size)tr_win_map[k] < nr_windows)
+      {
+        window_index_[tr_win_map[k]].transitions.push_back(k);
+      }
+    }
+    completeWindowIndices_();
+  }
+
+  void SwathWindowLibrary::completeWindowIndices_()
+  {
+    std::unordered_map<std::string, Size> compound_idx;
+    for (Size i = 0; i < library_->compounds.size(); ++i)
+    {
+      compound_idx[library_->compounds[i].id] = i;
+    }
+    std::unordered_map<std::string, Size> protein_idx;
+    for (Size i = 0; i < library_->proteins.size(); ++i)
+    {
+      protein_idx[library_->proteins[i].id] = i;
+    }
+
+    for (WindowIndex& w : window_index_)
+    {
+      for (Size k : w.transitions)
+      {
+        auto c = compound_idx.find(library_->transitions[k].peptide_ref);
+        if (c != compound_idx.end()) w.compounds.push_back(c->second);
+      }
+      std::sort(w.compounds.begin(), w.compounds.end());
+      w.compounds.erase(std::unique(w.compounds.begin(), w.compounds.end()), w.compounds.end());
+
+      for (Size c : w.compounds)
+      {
+        for (const auto& prot : library_->compounds[c].protein_refs)
+        {
+          auto p = protein_idx.find(prot);
+          if (p != protein_idx.end()) w.proteins.push_back(p->second);
+        }
+      }
+      std::sort(w.proteins.begin(), w.proteins.end());
+      w.proteins.erase(std::unique(w.proteins.begin(), w.proteins.end()), w.proteins.end());
+    }
+  }
+
+  void SwathWindowLibrary::getWindowAssays(Size window_idx, OpenSwath::LightTargetedExperiment& assays) const
+  {
+    if (window_idx >= getNrWindows())
+    {
+      throw Exception::IndexOverflow(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, window_idx, getNrWindows());
+    }
+
+    assays = OpenSwath::LightTargetedExperiment();
+    if (isOnDisk())
+    {
+      const OpenSwath::SwathMap& w = windows_[window_idx];
+      if (w.ms1) return;
+
+      // read only the precursors of this window, then apply the exact selection criterion
+      OpenSwath::LightTargetedExperiment window_lib;
+      TransitionPQPFile pqp_reader;
+      pqp_reader.convertPQPToTargetedExperiment(pqp_file_.c_str(), window_lib, w.lower, w.upper, legacy_traml_id_);
+      OpenSwathHelper::selectSwathTransitions(window_lib, assays, min_upper_edge_dist_, w.lower, w.upper);
+    }
+    else
+    {
+      const WindowIndex& w = window_index_[window_idx];
+      assays.transitions.reserve(w.transitions.size());
+      for (Size k : w.transitions) assays.transitions.push_back(library_->transitions[k]);
+      assays.compounds.reserve(w.compounds.size());
+      for (Size c : w.compounds) assays.compounds.push_back(library_->compounds[c]);
+      assays.proteins.reserve(w.proteins.size());
+      for (Size p : w.proteins) assays.proteins.push_back(library_->proteins[p]);
+    }
+    applyDriftTimeTransformation_(assays);
+  }
+
+  void SwathWindowLibrary::getAllAssays(OpenSwath::LightTargetedExperiment& assays) const
+  {
+    if (isOnDisk())
+    {
+      assays = OpenSwath::LightTargetedExperiment();
+      TransitionPQPFile pqp_reader;
+      pqp_reader.convertPQPToTargetedExperiment(pqp_file_.c_str(), assays, legacy_traml_id_);
+    }
+    else
+    {
+      assays = *library_;
+    }
+    applyDriftTimeTransformation_(assays);
+  }
+
+  Size SwathWindowLibrary::getNrWindows() const
+  {
+    return isOnDisk() ? windows_.size() : window_index_.size();
+  }
+
+  Size SwathWindowLibrary::getNrTransitions() const
+  {
+    if (!isOnDisk())
+    {
+      return library_->transitions.size();
+    }
+    SqliteConnector conn(pqp_file_, SqliteConnector::SqlOpenMode::READONLY);
+    return conn.countTableRows("TRANSITION");
+  }
+
+  bool SwathWindowLibrary::isOnDisk() const
+  {
+    return library_ == nullptr;
+  }
+
+  void SwathWindowLibrary::setDriftTimeTransformation(const TransformationDescription& im_trafo)
+  {
+    im_trafo_ = im_trafo;
+    has_im_trafo_ = true;
+  }
+
+  void SwathWindowLibrary::applyDriftTimeTransformation_(OpenSwath::LightTargetedExperiment& assays) const
+  {
+    if (!has_im_trafo_) return;
+    for (auto& c : assays.compounds)
+    {
+      c.drift_time = im_trafo_.apply(c.drift_time);
+    }
+  }
+
+}
@@ -41,6 +41,7 @@
 #include <boost/range/algorithm_ext/erase.hpp>
 
 #include <sstream>
+#include <limits>
 #include <unordered_map>
 #include <iostream>
 
@@ -58,7 +59,8 @@ namespace OpenMS
   {
   }
 
-  void TransitionPQPFile::readPQPInput_(const char* filename, std::vector<TSVTransition>& transition_list, bool legacy_traml_id)
+  void TransitionPQPFile::readPQPInput_(const char* filename, std::vector<TSVTransition>& transition_list, bool legacy_traml_id,
+                                        const String& precursor_filter)
   {
     sqlite3 *db;
     sqlite3_stmt * cntstmt;
@@ -78,8 +80,24 @@ namespace OpenMS
     SqliteConnector conn(filename);
     db = conn.getDB();
 
+    // Restrict the selected precursors (applies to both peptide and compound queries)
+    String where_precursor = "";
+    if (!precursor_filter.empty())
+    {
+      where_precursor = "WHERE " + precursor_filter + " ";
+    }
+
     // Count transitions
-    SqliteConnector::prepareStatement(db, &cntstmt, "SELECT COUNT(*) FROM TRANSITION;");
+    if (precursor_filter.empty())
+    {
+      SqliteConnector::prepareStatement(db, &cntstmt, "SELECT COUNT(*) FROM TRANSITION;");
+    }
+    else
+    {
+      SqliteConnector::prepareStatement(db, &cntstmt, "SELECT COUNT(*) FROM PRECURSOR " \
+          "INNER JOIN TRANSITION_PRECURSOR_MAPPING ON PRECURSOR.ID = TRANSITION_PRECURSOR_MAPPING.PRECURSOR_ID " +
+          where_precursor + ";");
+    }
     sqlite3_step( cntstmt );
     int num_transitions = sqlite3_column_int(cntstmt, 0);
     sqlite3_finalize(cntstmt);
@@ -161,7 +179,8 @@ namespace OpenMS
                     "FROM TRANSITION_PEPTIDE_MAPPING "\
                     "INNER JOIN PEPTIDE ON TRANSITION_PEPTIDE_MAPPING.PEPTIDE_ID = PEPTIDE.ID "\
                     "GROUP BY TRANSITION_ID) "\
-                    "AS PEPTIDE_AGGREGATED ON TRANSITION.ID = PEPTIDE_AGGREGATED.TRANSITION_ID ";
+                    "AS PEPTIDE_AGGREGATED ON TRANSITION.ID = PEPTIDE_AGGREGATED.TRANSITION_ID " +
+                  where_precursor;
 
     // Get compounds
     select_sql += "UNION SELECT " \
@@ -200,7 +219,8 @@ namespace OpenMS
                   "INNER JOIN TRANSITION_PRECURSOR_MAPPING ON PRECURSOR.ID = TRANSITION_PRECURSOR_MAPPING.PRECURSOR_ID " \
                   "INNER JOIN TRANSITION ON TRANSITION_PRECURSOR_MAPPING.TRANSITION_ID = TRANSITION.ID " \
                   "INNER JOIN PRECURSOR_COMPOUND_MAPPING ON PRECURSOR.ID = PRECURSOR_COMPOUND_MAPPING.PRECURSOR_ID " \
-                  "INNER JOIN COMPOUND ON PRECURSOR_COMPOUND_MAPPING.COMPOUND_ID = COMPOUND.ID; ";
+                  "INNER JOIN COMPOUND ON PRECURSOR_COMPOUND_MAPPING.COMPOUND_ID = COMPOUND.ID " +
+                  where_precursor + "; ";
 
 
     // Execute SQL select statement
@@ -721,4 +741,20 @@ namespace OpenMS
     TSVToTargetedExperiment_(transition_list, targeted_exp);
   }
 
+  void TransitionPQPFile::convertPQPToTargetedExperiment(const char* filename,
+                                                         OpenSwath::LightTargetedExperiment& targeted_exp,
+                                                         double precursor_mz_lower,
+                                                         double precursor_mz_upper,
+                                                         bool legacy_traml_id)
+  {
+    std::stringstream precursor_filter;
+    precursor_filter.precision(std::numeric_limits<double>::max_digits10);
+    precursor_filter << "PRECURSOR.PRECURSOR_MZ > " << precursor_mz_lower
+                     << " AND PRECURSOR.PRECURSOR_MZ < " << precursor_mz_upper;
+
+    std::vector<TSVTransition> transition_list;
+    readPQPInput_(filename, transition_list, legacy_traml_id, precursor_filter.str());
+    TSVToTargetedExperiment_(transition_list, targeted_exp);
+  }
+
 }
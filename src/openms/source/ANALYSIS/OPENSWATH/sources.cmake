@@ -33,6 +33,7 @@ set(sources_list
   PeakPickerMRM.cpp
   SONARScoring.cpp
   SwathMapMassCorrection.cpp
+  SwathWindowLibrary.cpp
   SwathWindowLoader.cpp
   SwathQC.cpp
   SpectrumAddition.cpp
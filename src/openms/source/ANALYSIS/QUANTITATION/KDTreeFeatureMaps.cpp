@@ -35,6 +35,8 @@
 #include <OpenMS/ANALYSIS/QUANTITATION/KDTreeFeatureMaps.h>
 #include <OpenMS/MATH/MISC/MathFunctions.h>
 
+#include <algorithm>
+
 using namespace std;
 
 namespace OpenMS
@@ -46,8 +48,7 @@ void KDTreeFeatureMaps::addFeature(Size mt_map_index, const BaseFeature* feature
   features_.push_back(feature);
   rt_.push_back(feature->getRT());
 
-  KDTreeFeatureNode mt_node(this, size() - 1);
-  kd_tree_.insert(mt_node);
+  kd_tree_.insert({feature->getRT(), feature->getMZ()});
 }
 
 const BaseFeature* KDTreeFeatureMaps::feature(Size i) const
@@ -99,6 +100,7 @@ void KDTreeFeatureMaps::clear()
 {
   features_.clear();
   map_index_.clear();
+  rt_.clear();
   kd_tree_.clear();
 }
 
@@ -143,34 +145,49 @@ void KDTreeFeatureMaps::getNeighborhood(Size index, vector<Size>& result_indices
 
 void KDTreeFeatureMaps::queryRegion(double rt_low, double rt_high, double mz_low, double mz_high, vector<Size>& result_indices, Size ignored_map_index) const
 {
-  // set up tolerance window as region for the 2D tree
-  FeatureKDTree::_Region_ region;
-  region._M_low_bounds[0] = rt_low;
-  region._M_high_bounds[0] = rt_high;
-  region._M_low_bounds[1] = mz_low;
-  region._M_high_bounds[1] = mz_high;
-
   // range-query tolerance window
-  vector<KDTreeFeatureNode> tmp_result;
-  kd_tree_.find_within_range(region, back_insert_iterator<vector<KDTreeFeatureNode> >(tmp_result));
-
-  // add indices to result
   result_indices.clear();
-  for (vector<KDTreeFeatureNode>::const_iterator it = tmp_result.begin(); it != tmp_result.end(); ++it)
+  kd_tree_.findWithinRange({rt_low, mz_low}, {rt_high, mz_high}, result_indices);
+
+  // remove features from the ignored map
+  if (ignored_map_index != numeric_limits<Size>::max())
   {
-    Size found_index = it->getIndex();
-    if (ignored_map_index == numeric_limits<Size>::max() || map_index_[found_index] != ignored_map_index)
-    {
-      result_indices.push_back(found_index);
-    }
+    result_indices.erase(remove_if(result_indices.begin(), result_indices.end(),
+                                   [&](Size found_index) { return map_index_[found_index] == ignored_map_index; }),
+                         result_indices.end());
   }
+  // the tree reports features in tree (median-split) order, which changes whenever the tree is rebuilt;
+  // return them sorted so that downstream results do not depend on the tree layout
+  sort(result_indices.begin(), result_indices.end());
 }
 
 void KDTreeFeatureMaps::applyTransformations(const vector<TransformationModelLowess*>& trafos)
 {
+  // evaluate the transformation of each map on all its RTs at once
+  vector<vector<Size>> map_features(trafos.size());
+  for (Size i = 0; i < size(); ++i)
+  {
+    map_features[map_index_[i]].push_back(i);
+  }
+  vector<double> rts;
+  for (Size m = 0; m < map_features.size(); ++m)
+  {
+    rts.resize(map_features[m].size());
+    for (Size j = 0; j < map_features[m].size(); ++j)
+    {
+      rts[j] = features_[map_features[m][j]]->getRT();
+    }
+    trafos[m]->evaluate(rts, rts);
+    for (Size j = 0; j < map_features[m].size(); ++j)
+    {
+      rt_[map_features[m][j]] = rts[j];
+    }
+  }
+
+  // move the points to the transformed RTs (queries stay correct, but are slow until optimizeTree() is called)
   for (Size i = 0; i < size(); ++i)
   {
-    rt_[i] = trafos[map_index_[i]]->evaluate(features_[i]->getRT());
+    kd_tree_.setPoint(i, {rt_[i], mz(i)});
   }
 }
 
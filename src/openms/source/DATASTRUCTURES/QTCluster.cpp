@@ -41,8 +41,8 @@
 #include <numeric> // for make_pair
 #include <algorithm> // for set_intersection
 #include <iterator> // for inserter
+#include <limits>
 
-using std::map;
 using std::vector;
 using std::make_pair;
 using std::min;
@@ -57,7 +57,9 @@ namespace OpenMS
     center_point_(center_point),
     id_(id),
     neighbors_(),
-    tmp_neighbors_(),
+    candidates_(),
+    annotated_candidates_(),
+    candidates_sorted_(true),
     max_distance_(max_distance),
     num_maps_(num_maps),
     x_coord_(x_coord),
@@ -120,6 +122,8 @@ namespace OpenMS
     // algorithm. This means we can clean up a bit and save some memory.
     valid_ = false;
     data_->annotations_.clear();
+    std::vector<Candidate>().swap(data_->candidates_);
+    std::vector<AnnotatedCandidate>().swap(data_->annotated_candidates_);
   }
 
   Size QTCluster::size() const
@@ -139,9 +143,6 @@ namespace OpenMS
 
   void QTCluster::add(const OpenMS::GridFeature* const element, double distance)
   {
-    // get reference on member that is used in this function
-    NeighborMapMulti& tmp_neighbors_ = data_->tmp_neighbors_;
-
     OPENMS_PRECONDITION(!finalized_,
         "Cannot perform operation on cluster that is not initialized")
     // ensure we only add compatible peptide annotations
@@ -171,12 +172,16 @@ namespace OpenMS
       }
     }
 
-    // We have to store annotations in a temporary map first if we collect all
-    // annotations
-    if (collect_annotations_ && map_index != center_point.getMapIndex())
+    // Store all potential elements (they are needed to select the optimal
+    // annotation and to replace elements that are used by other clusters)
+    if (map_index != center_point.getMapIndex())
     {
-      tmp_neighbors_[map_index].insert(make_pair(distance, element));
-      changed_ = true;
+      data_->candidates_.push_back(Candidate{map_index, distance, element, 0});
+      data_->candidates_sorted_ = false;
+      if (collect_annotations_)
+      {
+        changed_ = true;
+      }
     }
 
     // Store best (closest) element:
@@ -335,68 +340,213 @@ namespace OpenMS
     return data_->annotations_;
   }
 
+  void QTCluster::sortCandidates_()
+  {
+    if (data_->candidates_sorted_)
+    {
+      return;
+    }
+
+    std::vector<Candidate>& candidates = data_->candidates_;
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [](const Candidate& a, const Candidate& b)
+                     {
+                       return (a.map_index < b.map_index) ||
+                         ((a.map_index == b.map_index) && (a.distance < b.distance));
+                     });
+    for (Size i = 0; i < candidates.size(); ++i)
+    {
+      candidates[i].order = i;
+    }
+
+    std::vector<AnnotatedCandidate>& annotated = data_->annotated_candidates_;
+    annotated.clear();
+    if (collect_annotations_)
+    {
+      static const AASequence unannotated;
+      for (const Candidate& candidate : candidates)
+      {
+        const std::set<AASequence>& current = candidate.feature->getAnnotations();
+        for (const AASequence& seq : current)
+        {
+          annotated.push_back(AnnotatedCandidate{&seq, candidate.map_index, candidate.distance, candidate.feature, candidate.order});
+        }
+        if (current.empty())
+        {
+          annotated.push_back(AnnotatedCandidate{&unannotated, candidate.map_index, candidate.distance, candidate.feature, candidate.order});
+        }
+      }
+      std::sort(annotated.begin(), annotated.end(),
+                [](const AnnotatedCandidate& a, const AnnotatedCandidate& b)
+                {
+                  if (*a.sequence < *b.sequence) return true;
+                  if (*b.sequence < *a.sequence) return false;
+                  if (a.map_index != b.map_index) return a.map_index < b.map_index;
+                  return a.order < b.order; // sorted by distance within the map
+                });
+    }
+
+    data_->candidates_sorted_ = true;
+  }
+
+  void QTCluster::reselectNeighbors(const std::unordered_set<const GridFeature*>& used)
+  {
+    OPENMS_PRECONDITION(finalized_,
+        "Cannot perform operation on cluster that is not finalized")
+
+    sortCandidates_();
+
+    // drop elements that were used by other clusters (keeps the sort order)
+    auto is_used = [&used](const GridFeature* feature) { return used.find(feature) != used.end(); };
+    std::vector<Candidate>& candidates = data_->candidates_;
+    candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+                                    [&](const Candidate& c) { return is_used(c.feature); }),
+                     candidates.end());
+    std::vector<AnnotatedCandidate>& annotated = data_->annotated_candidates_;
+    annotated.erase(std::remove_if(annotated.begin(), annotated.end(),
+                                   [&](const AnnotatedCandidate& c) { return is_used(c.feature); }),
+                    annotated.end());
+
+    // the closest remaining element per map (first in sort order) becomes the neighbor
+    NeighborMap& neighbors_ = data_->neighbors_;
+    neighbors_.clear();
+    for (const Candidate& candidate : candidates)
+    {
+      neighbors_.emplace(candidate.map_index, Neighbor{candidate.distance, candidate.feature});
+    }
+
+    // recompute the quality (and the annotation)
+    finalized_ = false;
+    changed_ = true;
+    getQuality();
+    finalized_ = true;
+  }
+
   double QTCluster::optimizeAnnotations_()
   {
     OPENMS_PRECONDITION(collect_annotations_,
         "QTCluster::optimizeAnnotations_ should only be called if we use collect_annotations_")
-    OPENMS_PRECONDITION(!data_->tmp_neighbors_.empty(),
-        "QTCluster::optimizeAnnotations_ needs to have working tmp_neighbors_")
-    OPENMS_PRECONDITION(!finalized_,
-        "QTCluster::optimizeAnnotations_ cannot work on finalized cluster")
-
-    // mapping: peptides -> best distance per input map
-    map<AASequence, map<Size,double> > seq_table;
+    OPENMS_PRECONDITION(!data_->candidates_.empty(),
+        "QTCluster::optimizeAnnotations_ needs to have potential cluster elements")
 
-    makeSeqTable_(seq_table);
+    sortCandidates_();
 
     // get copies of members that are used in this function
     Size num_maps_ = data_->num_maps_;
     double max_distance_ = data_->max_distance_;
-    
-    // combine annotation-specific and unspecific distances 
-    // (all unspecific ones are grouped as empty AASequence):
-    auto unspecific = seq_table.find(AASequence());
-    if (unspecific != seq_table.end())
+
+    const std::vector<Candidate>& candidates = data_->candidates_;
+    const std::vector<AnnotatedCandidate>& annotated = data_->annotated_candidates_;
+
+    // Per map, only elements up to (and including) the closest unannotated one are considered:
+    // all annotation-specific distances after it are worse than this unspecific one (distances
+    // are already corrected with the noID_penalty).
+    // (pairs of map index and position of the closest unannotated element, sorted by map index)
+    vector<std::pair<Size, Size> > cutoffs;
+    for (const Candidate& candidate : candidates)
+    {
+      if ((cutoffs.empty() || cutoffs.back().first != candidate.map_index) &&
+          candidate.feature->getAnnotations().empty())
+      {
+        cutoffs.emplace_back(candidate.map_index, candidate.order);
+      }
+    }
+    auto considered = [&cutoffs](const AnnotatedCandidate& annotated_candidate)
+    {
+      auto pos = std::lower_bound(cutoffs.begin(), cutoffs.end(),
+                                  std::make_pair(annotated_candidate.map_index, Size(0)));
+      return (pos == cutoffs.end()) || (pos->first != annotated_candidate.map_index) ||
+        (annotated_candidate.order <= pos->second);
+    };
+
+    // best (first) considered distance per map for the annotations in [begin, end),
+    // which are sorted by map index and distance
+    auto bestDistances = [&](vector<std::pair<Size, double> >& result,
+                             vector<AnnotatedCandidate>::const_iterator begin,
+                             vector<AnnotatedCandidate>::const_iterator end)
+    {
+      result.clear();
+      for (auto it = begin; it != end; ++it)
+      {
+        if ((result.empty() || (result.back().first != it->map_index)) && considered(*it))
+        {
+          result.emplace_back(it->map_index, it->distance);
+        }
+      }
+    };
+
+    // unspecific distances (all unannotated elements are grouped as empty AASequence):
+    static const AASequence unannotated;
+    vector<std::pair<Size, double> > unspecific;
+    auto unspecific_begin = std::lower_bound(annotated.begin(), annotated.end(), unannotated,
+      [](const AnnotatedCandidate& a, const AASequence& seq) { return *a.sequence < seq; });
+    auto unspecific_end = std::upper_bound(unspecific_begin, annotated.end(), unannotated,
+      [](const AASequence& seq, const AnnotatedCandidate& a) { return seq < *a.sequence; });
+    bestDistances(unspecific, unspecific_begin, unspecific_end);
+
+    // compute distance totals per annotation -> best annotation set has smallest value:
+    const AASequence* best_seq = nullptr;
+    double best_total = num_maps_ * max_distance_;
+    vector<std::pair<Size, double> > specific, combined;
+    for (auto group_begin = annotated.begin(); group_begin != annotated.end(); )
     {
-      for (auto it = seq_table.begin(); it != seq_table.end(); ++it) //OMS_CODING_TEST_EXCLUDE
+      auto group_end = group_begin + 1;
+      while (group_end != annotated.end() && !(*group_begin->sequence < *group_end->sequence))
       {
-        if (it == unspecific)
-          continue;
-        // for all the maps for the "real" sequences, overwrite the distance, if an unspecific one is better or
-        // add a new entry, so we can just "sum up" the distances for each seq later.
-        for (const auto& mapidx_unspecdist : unspecific->second)
+        ++group_end;
+      }
+
+      const vector<std::pair<Size, double> >* distances = &unspecific;
+      if ((group_begin != unspecific_begin) || (unspecific_begin == unspecific_end))
+      {
+        // combine annotation-specific and unspecific distances: for all maps, take the
+        // better one of both (maps are sorted in both lists)
+        bestDistances(specific, group_begin, group_end);
+        combined.clear();
+        if (!specific.empty())
         {
-          // try to add new entry
-          auto mapidx_inserted = it->second.emplace(mapidx_unspecdist.first, mapidx_unspecdist.second);
-          if (!mapidx_inserted.second) //an entry for that map idx already existed for the sequence, check minimum of both
+          auto spec_it = specific.begin(), unspec_it = unspecific.begin();
+          while (spec_it != specific.end() || unspec_it != unspecific.end())
           {
-            mapidx_inserted.first->second = min(mapidx_inserted.first->second, mapidx_unspecdist.second);
+            if (unspec_it == unspecific.end() || (spec_it != specific.end() && spec_it->first < unspec_it->first))
+            {
+              combined.push_back(*spec_it++);
+            }
+            else if (spec_it == specific.end() || unspec_it->first < spec_it->first)
+            {
+              combined.push_back(*unspec_it++);
+            }
+            else
+            {
+              combined.emplace_back(spec_it->first, min(spec_it->second, unspec_it->second));
+              ++spec_it;
+              ++unspec_it;
+            }
           }
         }
+        distances = &combined;
       }
-    }
 
-    // compute distance totals -> best annotation set has smallest value:
-    auto best_pos = seq_table.begin();
-    double best_total = num_maps_ * max_distance_;
-    for (auto it = seq_table.begin(); it != seq_table.end(); ++it) //OMS_CODING_TEST_EXCLUDE
-    {
-      OPENMS_PRECONDITION(num_maps_ - 1 >= it->second.size(), "num_maps bigger than map size -1 (center)");
-      // init value is #missing maps times max_distance
-      // above, unspecific distances were incorporated into the rest already.
-      double total = std::accumulate(it->second.begin(), it->second.end(),
-                                     double(num_maps_ - 1 - it->second.size()) * max_distance_,
-                                    [] (double val, const std::map<Size, double>::value_type& p)
-                                              { return val + p.second; }
-                                    );
-      if (total < best_total)
+      if (!distances->empty())
       {
-        best_pos = it;
-        best_total = total;
+        OPENMS_PRECONDITION(num_maps_ - 1 >= distances->size(), "num_maps bigger than map size -1 (center)");
+        // init value is #missing maps times max_distance
+        double total = double(num_maps_ - 1 - distances->size()) * max_distance_;
+        for (const auto& map_dist : *distances)
+        {
+          total += map_dist.second;
+        }
+        if (total < best_total)
+        {
+          best_seq = group_begin->sequence;
+          best_total = total;
+        }
       }
+
+      group_begin = group_end;
     }
 
-    if (best_pos != seq_table.end())
+    if (best_seq != nullptr)
     {
       //TODO can we accumulate the union of possible annotations and set the best as "representative"?
       // Probably in another member and function though (e.g. after finalize),
@@ -407,7 +557,7 @@ namespace OpenMS
       // Then it would make sense to save the "best" annotation "distance-wise" from this algorithm, to be used during
       // IDConflictResolution (which is based on only ID scores).
       // OR already consider the ID scores here and make a more elaborate scoring.
-      data_->annotations_ = {best_pos->first};
+      data_->annotations_ = {*best_seq};
     }
 
     // only keep neighbors that fit with the best annotation!
@@ -420,88 +570,27 @@ namespace OpenMS
   {
     // get references on members that are used in this function
     NeighborMap& neighbors_ = data_->neighbors_;
-    NeighborMapMulti& tmp_neighbors_ = data_->tmp_neighbors_;
-    std::set<AASequence>& annotations_ = data_->annotations_;
+    const std::set<AASequence>& annotations_ = data_->annotations_;
 
     neighbors_.clear();
-    for (NeighborMapMulti::const_iterator n_it = tmp_neighbors_.begin();
-         n_it != tmp_neighbors_.end(); ++n_it)
+    // candidates are sorted by map and distance, so the first match per map is the best element
+    for (const Candidate& candidate : data_->candidates_)
     {
-      for (std::multimap<double, const GridFeature*>::const_iterator df_it =
-             n_it->second.begin(); df_it != n_it->second.end(); ++df_it)
+      if (neighbors_.find(candidate.map_index) != neighbors_.end())
       {
-        std::set<AASequence> intersect;
-        const std::set<AASequence>& current = df_it->second->getAnnotations();
-        std::set_intersection(current.begin(), current.end(), annotations_.begin(), annotations_.end(), std::inserter(intersect, intersect.begin()));
-        // if no overlap with the re-calculated IDs in the center, do not re-add neighbor to the updated neighbors anymore.
-        if (!intersect.empty() || current.empty())
-        {
-          neighbors_[n_it->first] = Neighbor{df_it->first, df_it->second};
-          break; // found the best element for this input map
-        }
+        continue; // found the best element for this input map already
       }
-    }
-  }
-
-  void QTCluster::makeSeqTable_(map<AASequence, map<Size,double>>& seq_table) const
-  {
-    // get reference on member that is used in this function
-    NeighborMapMulti& tmp_neighbors_ = data_->tmp_neighbors_;
-
-    // for all maps contributing to this cluster
-    for (NeighborMapMulti::iterator n_it = tmp_neighbors_.begin();
-         n_it != tmp_neighbors_.end(); ++n_it)
-    {
-      //for all neighbors relevant for this cluster in this map
-      Size map_index = n_it->first;
-      for (NeighborList::iterator df_it = n_it->second.begin();
-          df_it != n_it->second.end(); ++df_it)
+      const std::set<AASequence>& current = candidate.feature->getAnnotations();
+      // if no overlap with the re-calculated IDs in the center, do not re-add neighbor to the updated neighbors anymore.
+      bool overlap = current.empty();
+      for (const AASequence& seq : annotations_)
       {
-        double dist = df_it->first;
-        // for all IDs/annotations of the neighboring feature (skipped if empty)
-        for (const auto& current : df_it->second->getAnnotations())
-        {
-          auto seqit_inserted = seq_table.emplace(current, map<Size,double>{{map_index, dist}});
-          // check if a minimum distance was already set for this ID
-          if (!seqit_inserted.second)
-          {
-            // if so, check if a dist was annotated for that map_index already.
-            auto distit_inserted = seqit_inserted.first->second.emplace(map_index, dist);
-
-            // if so:
-            // new dist. value for this input map
-            // compare with old and set minimum
-            if (!distit_inserted.second)
-            {
-              distit_inserted.first->second = min(dist, distit_inserted.first->second);
-            }
-          }
-        }
-
-        if (df_it->second->getAnnotations().empty()) // unannotated feature
-        {
-          auto seqit_inserted = seq_table.emplace(AASequence(), map<Size,double>{{map_index, dist}});
-          // check if a minimum distance was already set for empty ID = unannotated
-          if (!seqit_inserted.second)
-          {
-            // if so, check if a dist was annotated for that map_index already.
-            auto distit_inserted = seqit_inserted.first->second.emplace(map_index, dist);
-
-            // if so:
-            // new dist. value for this input map
-            // compare with old and set minimum
-            if (!distit_inserted.second)
-            {
-              distit_inserted.first->second = min(dist, distit_inserted.first->second);
-            }
-          }
-          // As opposed to above IDed features (which could lead to new additional annotations),
-          // no need to check further here: all following (also annotation-specific) distances are worse
-          // than this unspecific one, since multimap is sorted & dists are already corrected
-          // with noID_penalty. If you don't want this to happen, set the penalty to one and unIDed ones
-          // will always be added at the end):
-          break;
-        }
+        if (overlap) break;
+        overlap = (current.find(seq) != current.end());
+      }
+      if (overlap)
+      {
+        neighbors_[candidate.map_index] = Neighbor{candidate.distance, candidate.feature};
       }
     }
   }
@@ -514,23 +603,18 @@ namespace OpenMS
     // calls computeQuality_ if something changed since initialization. In
     // turn, computeQuality_ calls optimizeAnnotations_ if necessary which
     // ensures that the neighbors_ hash is populated correctly.
+    sortCandidates_();
     getQuality();
 
     finalized_ = true;
-
-    data_->tmp_neighbors_.clear();
   }
 
   void QTCluster::initializeCluster()
   {
-    OPENMS_PRECONDITION(data_->tmp_neighbors_.empty(),
-        "Try to initialize QTCluster that was not finalized")
     OPENMS_PRECONDITION(finalized_,
         "Try to initialize QTCluster that was not finalized")
 
     finalized_ = false;
-
-    data_->tmp_neighbors_.clear();
   }
 
 } // namespace OpenMS
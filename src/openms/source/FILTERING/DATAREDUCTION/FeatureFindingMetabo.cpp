@@ -47,6 +47,10 @@
 
 #include "svm.h"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 // #define FFM_DEBUG
 
 namespace OpenMS
@@ -389,6 +393,53 @@ namespace OpenMS
     return iso_score;
   }
 
+  double FeatureFindingMetabo::computeAveragineSimScore_(const std::vector<double>& hypo_ints, const double& mol_weight, AveragineRatioCache& cache) const
+  {
+    // same sum formula as CoarseIsotopePatternGenerator::estimateFromPeptideWeight (Senko's averagine)
+    EmpiricalFormula averagine;
+    averagine.estimateFromWeightAndComp(mol_weight, 4.9384, 7.7583, 1.3577, 1.4773, 0.0417, 0);
+
+    auto key = std::make_pair(hypo_ints.size(), averagine);
+    auto it = cache.find(key);
+    if (it == cache.end())
+    {
+      CoarseIsotopePatternGenerator solver(hypo_ints.size());
+      IsotopeDistribution::ContainerType averagine_dist = solver.run(averagine).getContainer();
+      double theo_max_int(0.0);
+      for (Size i = 0; i < hypo_ints.size(); ++i)
+      {
+        if (averagine_dist[i].getIntensity() > theo_max_int)
+        {
+          theo_max_int = averagine_dist[i].getIntensity();
+        }
+      }
+      std::vector<double> averagine_ratios;
+      for (Size i = 0; i < hypo_ints.size(); ++i)
+      {
+        averagine_ratios.push_back(averagine_dist[i].getIntensity() / theo_max_int);
+      }
+      it = cache.emplace(std::move(key), std::move(averagine_ratios)).first;
+    }
+
+    // compute normalized intensities
+    double max_int(0.0);
+    for (Size i = 0; i < hypo_ints.size(); ++i)
+    {
+      if (hypo_ints[i] > max_int)
+      {
+        max_int = hypo_ints[i];
+      }
+    }
+    std::vector<double> hypo_isos;
+    hypo_isos.reserve(hypo_ints.size());
+    for (Size i = 0; i < hypo_ints.size(); ++i)
+    {
+      hypo_isos.push_back(hypo_ints[i] / max_int);
+    }
+
+    return computeCosineSim_(it->second, hypo_isos);
+  }
+
   int FeatureFindingMetabo::isLegalIsotopePattern_(const FeatureHypothesis& feat_hypo) const
   {
     if (feat_hypo.getSize() == 1)
@@ -750,20 +801,13 @@ namespace OpenMS
   }
 
 
-  void FeatureFindingMetabo::findLocalFeatures_(const std::vector<const MassTrace*>& candidates, const double total_intensity, std::vector<FeatureHypothesis>& output_hypotheses) const
+  void FeatureFindingMetabo::findLocalFeatures_(const std::vector<const MassTrace*>& candidates, const double total_intensity, std::vector<FeatureHypothesis>& output_hypotheses, AveragineRatioCache& averagine_cache) const
   {
     // single Mass trace hypothesis
     FeatureHypothesis tmp_hypo;
     tmp_hypo.addMassTrace(*candidates[0]);
     tmp_hypo.setScore((candidates[0]->getIntensity(use_smoothed_intensities_)) / total_intensity);
-
-#ifdef _OPENMP
-#pragma omp critical (OPENMS_FFMetabo_output_hypos)
-#endif
-    {
-      // pushing back to shared vector needs to be synchronized
-      output_hypotheses.push_back(tmp_hypo);
-    }
+    output_hypotheses.push_back(tmp_hypo);
 
     for (Size charge = charge_lower_bound_; charge <= charge_upper_bound_; ++charge)
     {
@@ -808,7 +852,7 @@ namespace OpenMS
           {
             std::vector<double> tmp_ints(fh_tmp.getAllIntensities());
             tmp_ints.push_back(candidates[mt_idx]->getIntensity(use_smoothed_intensities_));
-            int_score = computeAveragineSimScore_(tmp_ints, candidates[mt_idx]->getCentroidMZ() * charge);
+            int_score = computeAveragineSimScore_(tmp_ints, candidates[mt_idx]->getCentroidMZ() * charge, averagine_cache);
           }
 
 #ifdef FFM_DEBUG
@@ -839,14 +883,7 @@ namespace OpenMS
           fh_tmp.setScore(fh_tmp.getScore() + weighted_score);
           fh_tmp.setCharge(charge);
           last_iso_idx = best_idx;
-
-#ifdef _OPENMP
-#pragma omp critical (OPENMS_FFMetabo_output_hypos)
-#endif
-          {
-            // pushing back to shared vector needs to be synchronized
-            output_hypotheses.push_back(fh_tmp);
-          }
+          output_hypotheses.push_back(fh_tmp);
         }
         else
         {
@@ -909,44 +946,79 @@ namespace OpenMS
     // and generate isotopic / charge hypotheses
     // *********************************************************** //
 
-    std::vector<FeatureHypothesis> feat_hypos;
+    // Hypotheses are collected in one buffer per block of consecutive mass
+    // traces (no synchronization needed) and concatenated in block order
+    // afterwards, which keeps the order of the hypotheses independent of
+    // the number of threads.
+    const SignedSize block_size = 256;
+    const SignedSize nr_blocks = ((SignedSize)input_mtraces.size() + block_size - 1) / block_size;
+    std::vector<std::vector<FeatureHypothesis> > block_hypos(nr_blocks);
+#ifdef _OPENMP
+    std::vector<AveragineRatioCache> averagine_caches(omp_get_max_threads());
+#else
+    std::vector<AveragineRatioCache> averagine_caches(1);
+#endif
     Size progress(0);
 #ifdef _OPENMP
-#pragma omp parallel for
+#pragma omp parallel for schedule(dynamic, 1)
 #endif
-    for (SignedSize i = 0; i < (SignedSize)input_mtraces.size(); ++i)
+    for (SignedSize block = 0; block < nr_blocks; ++block)
     {
-      IF_MASTERTHREAD this->setProgress(progress);
+#ifdef _OPENMP
+      AveragineRatioCache& averagine_cache = averagine_caches[omp_get_thread_num()];
+#else
+      AveragineRatioCache& averagine_cache = averagine_caches[0];
+#endif
+      const SignedSize block_end = std::min(block * block_size + block_size, (SignedSize)input_mtraces.size());
+      for (SignedSize i = block * block_size; i < block_end; ++i)
+      {
+        IF_MASTERTHREAD this->setProgress(progress);
 #ifdef _OPENMP
 #pragma omp atomic
 #endif
-      ++progress;
+        ++progress;
 
-      std::vector<const MassTrace*> local_traces;
-      double ref_trace_mz(input_mtraces[i].getCentroidMZ());
-      double ref_trace_rt(input_mtraces[i].getCentroidRT());
+        std::vector<const MassTrace*> local_traces;
+        double ref_trace_mz(input_mtraces[i].getCentroidMZ());
+        double ref_trace_rt(input_mtraces[i].getCentroidRT());
 
-      local_traces.push_back(&input_mtraces[i]);
+        local_traces.push_back(&input_mtraces[i]);
 
-      for (Size ext_idx = i + 1; ext_idx < input_mtraces.size(); ++ext_idx)
-      {
-        // traces are sorted by m/z, so we can break when we leave the allowed window
-        double diff_mz = std::fabs(input_mtraces[ext_idx].getCentroidMZ() - ref_trace_mz);
-        if (diff_mz > local_mz_range_)
+        for (Size ext_idx = i + 1; ext_idx < input_mtraces.size(); ++ext_idx)
         {
-          break;
-        }
-        double diff_rt = std::fabs(input_mtraces[ext_idx].getCentroidRT() - ref_trace_rt);
-        if (diff_rt <= local_rt_range_)
-        {
-          // std::cout << " accepted!" << std::endl;
-          local_traces.push_back(&input_mtraces[ext_idx]);
+          // traces are sorted by m/z, so we can break when we leave the allowed window
+          double diff_mz = std::fabs(input_mtraces[ext_idx].getCentroidMZ() - ref_trace_mz);
+          if (diff_mz > local_mz_range_)
+          {
+            break;
+          }
+          double diff_rt = std::fabs(input_mtraces[ext_idx].getCentroidRT() - ref_trace_rt);
+          if (diff_rt <= local_rt_range_)
+          {
+            // std::cout << " accepted!" << std::endl;
+            local_traces.push_back(&input_mtraces[ext_idx]);
+          }
         }
+        findLocalFeatures_(local_traces, total_intensity, block_hypos[block], averagine_cache);
       }
-      findLocalFeatures_(local_traces, total_intensity, feat_hypos);
     }
     this->endProgress();
 
+    std::vector<FeatureHypothesis> feat_hypos;
+    {
+      Size nr_hypos(0);
+      for (const auto& hypos : block_hypos)
+      {
+        nr_hypos += hypos.size();
+      }
+      feat_hypos.reserve(nr_hypos);
+      for (auto& hypos : block_hypos)
+      {
+        feat_hypos.insert(feat_hypos.end(), hypos.begin(), hypos.end());
+        std::vector<FeatureHypothesis>().swap(hypos);
+      }
+    }
+
     // sort feature candidates by their score
     std::sort(feat_hypos.begin(), feat_hypos.end(), CmpHypothesesByScore());
 
@@ -38,6 +38,10 @@
 
 #include <boost/dynamic_bitset.hpp>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace OpenMS
 {
     MassTraceDetection::MassTraceDetection() :
@@ -237,8 +241,8 @@ namespace OpenMS
         }
         PeakMap::SpectrumType tmp_spec(it);
         tmp_spec.select(indices_passing);
-        work_exp.addSpectrum(tmp_spec);
         spec_offsets.push_back(spec_offsets.back() + tmp_spec.size());
+        work_exp.addSpectrum(std::move(tmp_spec));
         ++spectra_count;
       }
 
@@ -300,274 +304,396 @@ namespace OpenMS
       }
 
 
+      // flat m/z index of all peaks for the nearest-peak lookups during extension
+      const FlatPeakIndex peak_index(work_exp);
+
       this->startProgress(0, total_peak_count, "mass trace detection");
       Size peaks_detected(0);
 
-      for (auto m_it = chrom_apices.crbegin(); m_it != chrom_apices.crend(); ++m_it)
+      std::list<PeakType> current_trace;
+      std::vector<double> fwhms_mz; // peak-FWHM meta values of collected peaks
+      std::vector<std::pair<Size, Size> > gathered_idx;
+
+      // accept a trace: mark all its peaks as visited and store it, returns
+      // false once the (optional) maximum number of traces is reached
+      auto add_trace = [&](const std::list<PeakType>& trace_peaks,
+                           std::vector<double>& trace_fwhms_mz,
+                           const std::vector<std::pair<Size, Size> >& trace_idx) -> bool
       {
-        Size apex_scan_idx(m_it->scan_idx);
-        Size apex_peak_idx(m_it->peak_idx);
+        // mark all peaks as visited
+        for (Size i = 0; i < trace_idx.size(); ++i)
+        {
+          peak_visited[spec_offsets[trace_idx[i].first] +  trace_idx[i].second] = true;
+        }
 
-        if (peak_visited[spec_offsets[apex_scan_idx] + apex_peak_idx])
+        // create new MassTrace object and store collected peaks from list current_trace
+        MassTrace new_trace(trace_peaks);
+        new_trace.updateWeightedMeanRT();
+        new_trace.updateWeightedMeanMZ();
+        if (!trace_fwhms_mz.empty())
         {
-          continue;
+          new_trace.fwhm_mz_avg = Math::median(trace_fwhms_mz.begin(), trace_fwhms_mz.end());
         }
+        new_trace.setQuantMethod(quant_method_);
+        //new_trace.setCentroidSD(ftl_sd);
+        new_trace.updateWeightedMZsd();
+        new_trace.setLabel("T" + String(trace_number));
+        ++trace_number;
 
-        Peak2D apex_peak;
-        apex_peak.setRT(work_exp[apex_scan_idx].getRT());
-        apex_peak.setMZ(work_exp[apex_scan_idx][apex_peak_idx].getMZ());
-        apex_peak.setIntensity(work_exp[apex_scan_idx][apex_peak_idx].getIntensity());
+        found_masstraces.push_back(new_trace);
 
-        Size trace_up_idx(apex_scan_idx);
-        Size trace_down_idx(apex_scan_idx);
+        peaks_detected += new_trace.getSize();
+        this->setProgress(peaks_detected);
 
-        std::list<PeakType> current_trace;
-        current_trace.push_back(apex_peak);
-        std::vector<double> fwhms_mz; // peak-FWHM meta values of collected peaks
+        // check if we already reached the (optional) maximum number of traces
+        return !(max_traces > 0 && found_masstraces.size() == max_traces);
+      };
 
-        // Initialization for the iterative version of weighted m/z mean calculation
-        double centroid_mz(apex_peak.getMZ());
-        double prev_counter(apex_peak.getIntensity() * apex_peak.getMZ());
-        double prev_denom(apex_peak.getIntensity());
+#ifdef _OPENMP
+      const Size nr_threads = omp_in_parallel() ? 1 : (Size)omp_get_max_threads();
+#else
+      const Size nr_threads = 1;
+#endif
 
-        updateIterativeWeightedMeanMZ(apex_peak.getMZ(), apex_peak.getIntensity(), centroid_mz, prev_counter, prev_denom);
+      if (nr_threads <= 1)
+      {
+        for (auto m_it = chrom_apices.crbegin(); m_it != chrom_apices.crend(); ++m_it)
+        {
+          if (peak_visited[spec_offsets[m_it->scan_idx] + m_it->peak_idx])
+          {
+            continue;
+          }
+
+          if (extendTrace_(*m_it, work_exp, peak_index, peak_visited, fwhm_meta_idx,
+                           current_trace, fwhms_mz, gathered_idx, nullptr) &&
+              !add_trace(current_trace, fwhms_mz, gathered_idx))
+          {
+            break;
+          }
+        }
+        this->endProgress();
+        return;
+      }
 
+      // Parallel version: the apices are processed in batches (in order of
+      // decreasing intensity). All traces of a batch are extended in parallel
+      // against the visited state at the start of the batch, recording every
+      // peak whose visited state was tested. The traces are then accepted in
+      // the serial order; a trace is only re-extended if one of its tested
+      // peaks was claimed by a trace accepted earlier in the same batch (which
+      // only happens for traces close in m/z and RT). The result is therefore
+      // identical to the serial run, independent of the number of threads.
+      struct Candidate
+      {
+        const Apex* apex;
+        bool valid;
+        std::list<PeakType> trace;
+        std::vector<double> fwhms_mz;
         std::vector<std::pair<Size, Size> > gathered_idx;
-        gathered_idx.emplace_back(apex_scan_idx, apex_peak_idx);
-        if (fwhm_meta_idx != -1)
+        std::vector<Size> probed_idx;
+      };
+
+      const Size batch_size = 64 * nr_threads;
+      std::vector<Candidate> batch;
+      batch.reserve(batch_size);
+
+      auto m_it = chrom_apices.crbegin();
+      bool reached_max_traces = false;
+      while (m_it != chrom_apices.crend() && !reached_max_traces)
+      {
+        batch.clear();
+        for (; m_it != chrom_apices.crend() && batch.size() < batch_size; ++m_it)
         {
-          fwhms_mz.push_back(work_exp[apex_scan_idx].getFloatDataArrays()[fwhm_meta_idx][apex_peak_idx]);
+          if (!peak_visited[spec_offsets[m_it->scan_idx] + m_it->peak_idx])
+          {
+            batch.push_back(Candidate{&(*m_it), false, {}, {}, {}, {}});
+          }
         }
 
-        Size up_hitting_peak(0), down_hitting_peak(0);
-        Size up_scan_counter(0), down_scan_counter(0);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+        for (SignedSize i = 0; i < (SignedSize)batch.size(); ++i)
+        {
+          Candidate& c = batch[i];
+          c.valid = extendTrace_(*c.apex, work_exp, peak_index, peak_visited, fwhm_meta_idx,
+                                 c.trace, c.fwhms_mz, c.gathered_idx, &c.probed_idx);
+        }
 
-        bool toggle_up = true, toggle_down = true;
+        for (Candidate& c : batch)
+        {
+          if (peak_visited[spec_offsets[c.apex->scan_idx] + c.apex->peak_idx])
+          {
+            continue;
+          }
 
-        Size conseq_missed_peak_up(0), conseq_missed_peak_down(0);
-        Size max_consecutive_missing(trace_termination_outliers_);
+          bool conflict = false;
+          for (Size idx : c.probed_idx)
+          {
+            if (peak_visited[idx])
+            {
+              conflict = true;
+              break;
+            }
+          }
+          if (conflict)
+          {
+            c.valid = extendTrace_(*c.apex, work_exp, peak_index, peak_visited, fwhm_meta_idx,
+                                   c.trace, c.fwhms_mz, c.gathered_idx, nullptr);
+          }
+
+          if (c.valid && !add_trace(c.trace, c.fwhms_mz, c.gathered_idx))
+          {
+            reached_max_traces = true;
+            break;
+          }
+        }
+      }
+
+      this->endProgress();
+
+    }
+
+    bool MassTraceDetection::extendTrace_(const Apex& apex,
+                                          const PeakMap& work_exp,
+                                          const FlatPeakIndex& peak_index,
+                                          const boost::dynamic_bitset<>& peak_visited,
+                                          const int fwhm_meta_idx,
+                                          std::list<PeakType>& current_trace,
+                                          std::vector<double>& fwhms_mz,
+                                          std::vector<std::pair<Size, Size> >& gathered_idx,
+                                          std::vector<Size>* probed_idx)
+    {
+      // the outcome of the extension only depends on the visited state of the
+      // peaks tested here; optionally record those that were not visited yet
+      // (peaks never become unvisited again)
+      auto is_visited = [&peak_visited, probed_idx](Size idx) -> bool
+      {
+        bool visited = peak_visited[idx];
+        if (!visited && probed_idx != nullptr)
+        {
+          probed_idx->push_back(idx);
+        }
+        return visited;
+      };
 
-        double current_sample_rate(1.0);
-        // Size min_scans_to_consider(std::floor((min_sample_rate_ /2)*10));
-        Size min_scans_to_consider(5);
+      Peak2D apex_peak;
+      apex_peak.setRT(work_exp[apex.scan_idx].getRT());
+      apex_peak.setMZ(work_exp[apex.scan_idx][apex.peak_idx].getMZ());
+      apex_peak.setIntensity(work_exp[apex.scan_idx][apex.peak_idx].getIntensity());
 
-        // double outlier_ratio(0.3);
+      Size trace_up_idx(apex.scan_idx);
+      Size trace_down_idx(apex.scan_idx);
 
-        // double ftl_mean(centroid_mz);
-        double ftl_sd((centroid_mz / 1e6) * mass_error_ppm_);
-        double intensity_so_far(apex_peak.getIntensity());
+      current_trace.clear();
+      current_trace.push_back(apex_peak);
+      fwhms_mz.clear();
 
-        while (((trace_down_idx > 0) && toggle_down) ||
-               ((trace_up_idx < work_exp.size() - 1) && toggle_up)
-                )
+      // Initialization for the iterative version of weighted m/z mean calculation
+      double centroid_mz(apex_peak.getMZ());
+      double prev_counter(apex_peak.getIntensity() * apex_peak.getMZ());
+      double prev_denom(apex_peak.getIntensity());
+
+      updateIterativeWeightedMeanMZ(apex_peak.getMZ(), apex_peak.getIntensity(), centroid_mz, prev_counter, prev_denom);
+
+      gathered_idx.clear();
+      gathered_idx.emplace_back(apex.scan_idx, apex.peak_idx);
+      if (fwhm_meta_idx != -1)
+      {
+        fwhms_mz.push_back(work_exp[apex.scan_idx].getFloatDataArrays()[fwhm_meta_idx][apex.peak_idx]);
+      }
+
+      Size up_hitting_peak(0), down_hitting_peak(0);
+      Size up_scan_counter(0), down_scan_counter(0);
+
+      bool toggle_up = true, toggle_down = true;
+
+      Size conseq_missed_peak_up(0), conseq_missed_peak_down(0);
+      Size max_consecutive_missing(trace_termination_outliers_);
+
+      double current_sample_rate(1.0);
+      // Size min_scans_to_consider(std::floor((min_sample_rate_ /2)*10));
+      Size min_scans_to_consider(5);
+
+      // double outlier_ratio(0.3);
+
+      // double ftl_mean(centroid_mz);
+      double ftl_sd((centroid_mz / 1e6) * mass_error_ppm_);
+      double intensity_so_far(apex_peak.getIntensity());
+
+      while (((trace_down_idx > 0) && toggle_down) ||
+             ((trace_up_idx < work_exp.size() - 1) && toggle_up)
+              )
+      {
+        // *********************************************************** //
+        // Step 2.1 MOVE DOWN in RT dim
+        // *********************************************************** //
+        if ((trace_down_idx > 0) && toggle_down)
         {
-          // *********************************************************** //
-          // Step 2.1 MOVE DOWN in RT dim
-          // *********************************************************** //
-          if ((trace_down_idx > 0) && toggle_down)
+          const MSSpectrum& spec_trace_down = work_exp[trace_down_idx - 1];
+          if (!spec_trace_down.empty())
           {
-            const MSSpectrum& spec_trace_down = work_exp[trace_down_idx - 1];
-            if (!spec_trace_down.empty())
-            {
-              Size next_down_peak_idx = spec_trace_down.findNearest(centroid_mz);
-              double next_down_peak_mz = spec_trace_down[next_down_peak_idx].getMZ();
-              double next_down_peak_int = spec_trace_down[next_down_peak_idx].getIntensity();
+            Size next_down_peak_idx = peak_index.findNearest(trace_down_idx - 1, centroid_mz);
+            double next_down_peak_mz = peak_index.getMZ(trace_down_idx - 1, next_down_peak_idx);
+            double next_down_peak_int = peak_index.getIntensity(trace_down_idx - 1, next_down_peak_idx);
 
-              double right_bound = centroid_mz + 3 * ftl_sd;
-              double left_bound = centroid_mz - 3 * ftl_sd;
+            double right_bound = centroid_mz + 3 * ftl_sd;
+            double left_bound = centroid_mz - 3 * ftl_sd;
 
-              if ((next_down_peak_mz <= right_bound) &&
-                  (next_down_peak_mz >= left_bound) &&
-                  !peak_visited[spec_offsets[trace_down_idx - 1] + next_down_peak_idx]
-                      )
+            if ((next_down_peak_mz <= right_bound) &&
+                (next_down_peak_mz >= left_bound) &&
+                !is_visited(peak_index.getSpectrumOffset(trace_down_idx - 1) + next_down_peak_idx)
+                    )
+            {
+              Peak2D next_peak;
+              next_peak.setRT(spec_trace_down.getRT());
+              next_peak.setMZ(next_down_peak_mz);
+              next_peak.setIntensity(next_down_peak_int);
+
+              current_trace.push_front(next_peak);
+              // FWHM average
+              if (fwhm_meta_idx != -1)
               {
-                Peak2D next_peak;
-                next_peak.setRT(spec_trace_down.getRT());
-                next_peak.setMZ(next_down_peak_mz);
-                next_peak.setIntensity(next_down_peak_int);
-
-                current_trace.push_front(next_peak);
-                // FWHM average
-                if (fwhm_meta_idx != -1)
-                {
-                  fwhms_mz.push_back(spec_trace_down.getFloatDataArrays()[fwhm_meta_idx][next_down_peak_idx]);
-                }
-                // Update the m/z mean of the current trace as we added a new peak
-                updateIterativeWeightedMeanMZ(next_down_peak_mz, next_down_peak_int, centroid_mz, prev_counter, prev_denom);
-                gathered_idx.emplace_back(trace_down_idx - 1, next_down_peak_idx);
+                fwhms_mz.push_back(spec_trace_down.getFloatDataArrays()[fwhm_meta_idx][next_down_peak_idx]);
+              }
+              // Update the m/z mean of the current trace as we added a new peak
+              updateIterativeWeightedMeanMZ(next_down_peak_mz, next_down_peak_int, centroid_mz, prev_counter, prev_denom);
+              gathered_idx.emplace_back(trace_down_idx - 1, next_down_peak_idx);
 
-                // Update the m/z variance dynamically
-                if (reestimate_mt_sd_)           //  && (down_hitting_peak+1 > min_flank_scans))
+              // Update the m/z variance dynamically
+              if (reestimate_mt_sd_)           //  && (down_hitting_peak+1 > min_flank_scans))
+              {
+                // if (ftl_t > min_fwhm_scans)
                 {
-                  // if (ftl_t > min_fwhm_scans)
-                  {
-                    updateWeightedSDEstimateRobust(next_peak, centroid_mz, ftl_sd, intensity_so_far);
-                  }
+                  updateWeightedSDEstimateRobust(next_peak, centroid_mz, ftl_sd, intensity_so_far);
                 }
-
-                ++down_hitting_peak;
-                conseq_missed_peak_down = 0;
-              }
-              else
-              {
-                ++conseq_missed_peak_down;
               }
 
+              ++down_hitting_peak;
+              conseq_missed_peak_down = 0;
+            }
+            else
+            {
+              ++conseq_missed_peak_down;
             }
-            --trace_down_idx;
-            ++down_scan_counter;
 
-            // trace termination criterion: max allowed number of
-            // consecutive outliers reached OR cancel extension if
-            // sampling_rate falls below min_sample_rate_
-            if (trace_termination_criterion_ == "outlier")
+          }
+          --trace_down_idx;
+          ++down_scan_counter;
+
+          // trace termination criterion: max allowed number of
+          // consecutive outliers reached OR cancel extension if
+          // sampling_rate falls below min_sample_rate_
+          if (trace_termination_criterion_ == "outlier")
+          {
+            if (conseq_missed_peak_down > max_consecutive_missing)
             {
-              if (conseq_missed_peak_down > max_consecutive_missing)
-              {
-                toggle_down = false;
-              }
+              toggle_down = false;
             }
-            else if (trace_termination_criterion_ == "sample_rate")
+          }
+          else if (trace_termination_criterion_ == "sample_rate")
+          {
+            current_sample_rate = (double)(down_hitting_peak + up_hitting_peak + 1) /
+                                  (double)(down_scan_counter + up_scan_counter + 1);
+            if (down_scan_counter > min_scans_to_consider && current_sample_rate < min_sample_rate_)
             {
-              current_sample_rate = (double)(down_hitting_peak + up_hitting_peak + 1) /
-                                    (double)(down_scan_counter + up_scan_counter + 1);
-              if (down_scan_counter > min_scans_to_consider && current_sample_rate < min_sample_rate_)
-              {
-                // std::cout << "stopping down..." << std::endl;
-                toggle_down = false;
-              }
+              // std::cout << "stopping down..." << std::endl;
+              toggle_down = false;
             }
           }
+        }
 
-          // *********************************************************** //
-          // Step 2.2 MOVE UP in RT dim
-          // *********************************************************** //
-          if ((trace_up_idx < work_exp.size() - 1) && toggle_up)
+        // *********************************************************** //
+        // Step 2.2 MOVE UP in RT dim
+        // *********************************************************** //
+        if ((trace_up_idx < work_exp.size() - 1) && toggle_up)
+        {
+          const MSSpectrum& spec_trace_up = work_exp[trace_up_idx + 1];
+          if (!spec_trace_up.empty())
           {
-            const MSSpectrum& spec_trace_up = work_exp[trace_up_idx + 1];
-            if (!spec_trace_up.empty())
-            {
-              Size next_up_peak_idx = spec_trace_up.findNearest(centroid_mz);
-              double next_up_peak_mz = spec_trace_up[next_up_peak_idx].getMZ();
-              double next_up_peak_int = spec_trace_up[next_up_peak_idx].getIntensity();
+            Size next_up_peak_idx = peak_index.findNearest(trace_up_idx + 1, centroid_mz);
+            double next_up_peak_mz = peak_index.getMZ(trace_up_idx + 1, next_up_peak_idx);
+            double next_up_peak_int = peak_index.getIntensity(trace_up_idx + 1, next_up_peak_idx);
 
-              double right_bound = centroid_mz + 3 * ftl_sd;
-              double left_bound = centroid_mz - 3 * ftl_sd;
+            double right_bound = centroid_mz + 3 * ftl_sd;
+            double left_bound = centroid_mz - 3 * ftl_sd;
 
-              if ((next_up_peak_mz <= right_bound) &&
-                  (next_up_peak_mz >= left_bound) &&
-                  !peak_visited[spec_offsets[trace_up_idx + 1] + next_up_peak_idx])
-              {
-                Peak2D next_peak;
-                next_peak.setRT(spec_trace_up.getRT());
-                next_peak.setMZ(next_up_peak_mz);
-                next_peak.setIntensity(next_up_peak_int);
+            if ((next_up_peak_mz <= right_bound) &&
+                (next_up_peak_mz >= left_bound) &&
+                !is_visited(peak_index.getSpectrumOffset(trace_up_idx + 1) + next_up_peak_idx))
+            {
+              Peak2D next_peak;
+              next_peak.setRT(spec_trace_up.getRT());
+              next_peak.setMZ(next_up_peak_mz);
+              next_peak.setIntensity(next_up_peak_int);
 
-                current_trace.push_back(next_peak);
-                if (fwhm_meta_idx != -1)
-                {
-                  fwhms_mz.push_back(spec_trace_up.getFloatDataArrays()[fwhm_meta_idx][next_up_peak_idx]);
-                }
-                // Update the m/z mean of the current trace as we added a new peak
-                updateIterativeWeightedMeanMZ(next_up_peak_mz, next_up_peak_int, centroid_mz, prev_counter, prev_denom);
-                gathered_idx.emplace_back(trace_up_idx + 1, next_up_peak_idx);
+              current_trace.push_back(next_peak);
+              if (fwhm_meta_idx != -1)
+              {
+                fwhms_mz.push_back(spec_trace_up.getFloatDataArrays()[fwhm_meta_idx][next_up_peak_idx]);
+              }
+              // Update the m/z mean of the current trace as we added a new peak
+              updateIterativeWeightedMeanMZ(next_up_peak_mz, next_up_peak_int, centroid_mz, prev_counter, prev_denom);
+              gathered_idx.emplace_back(trace_up_idx + 1, next_up_peak_idx);
 
-                // Update the m/z variance dynamically
-                if (reestimate_mt_sd_)           //  && (up_hitting_peak+1 > min_flank_scans))
+              // Update the m/z variance dynamically
+              if (reestimate_mt_sd_)           //  && (up_hitting_peak+1 > min_flank_scans))
+              {
+                // if (ftl_t > min_fwhm_scans)
                 {
-                  // if (ftl_t > min_fwhm_scans)
-                  {
-                    updateWeightedSDEstimateRobust(next_peak, centroid_mz, ftl_sd, intensity_so_far);
-                  }
+                  updateWeightedSDEstimateRobust(next_peak, centroid_mz, ftl_sd, intensity_so_far);
                 }
-
-                ++up_hitting_peak;
-                conseq_missed_peak_up = 0;
-
               }
-              else
-              {
-                ++conseq_missed_peak_up;
-              }
-
-            }
 
-            ++trace_up_idx;
-            ++up_scan_counter;
+              ++up_hitting_peak;
+              conseq_missed_peak_up = 0;
 
-            if (trace_termination_criterion_ == "outlier")
-            {
-              if (conseq_missed_peak_up > max_consecutive_missing)
-              {
-                toggle_up = false;
-              }
             }
-            else if (trace_termination_criterion_ == "sample_rate")
+            else
             {
-              current_sample_rate = (double)(down_hitting_peak + up_hitting_peak + 1) / (double)(down_scan_counter + up_scan_counter + 1);
-
-              if (up_scan_counter > min_scans_to_consider && current_sample_rate < min_sample_rate_)
-              {
-                // std::cout << "stopping up" << std::endl;
-                toggle_up = false;
-              }
+              ++conseq_missed_peak_up;
             }
 
-
           }
 
-        }
-
-        // std::cout << "current sr: " << current_sample_rate << std::endl;
-        double num_scans(down_scan_counter + up_scan_counter + 1 - conseq_missed_peak_down - conseq_missed_peak_up);
-
-        double mt_quality((double)current_trace.size() / (double)num_scans);
-        // std::cout << "mt quality: " << mt_quality << std::endl;
-        double rt_range(std::fabs(current_trace.rbegin()->getRT() - current_trace.begin()->getRT()));
-
-        // *********************************************************** //
-        // Step 2.3 check if minimum length and quality of mass trace criteria are met
-        // *********************************************************** //
-        bool max_trace_criteria = (max_trace_length_ < 0.0 || rt_range < max_trace_length_);
-        if (rt_range >= min_trace_length_ && max_trace_criteria && mt_quality >= min_sample_rate_)
-        {
-          // std::cout << "T" << trace_number << "\t" << mt_quality << std::endl;
+          ++trace_up_idx;
+          ++up_scan_counter;
 
-          // mark all peaks as visited
-          for (Size i = 0; i < gathered_idx.size(); ++i)
+          if (trace_termination_criterion_ == "outlier")
           {
-            peak_visited[spec_offsets[gathered_idx[i].first] +  gathered_idx[i].second] = true;
+            if (conseq_missed_peak_up > max_consecutive_missing)
+            {
+              toggle_up = false;
+            }
           }
-
-          // create new MassTrace object and store collected peaks from list current_trace
-          MassTrace new_trace(current_trace);
-          new_trace.updateWeightedMeanRT();
-          new_trace.updateWeightedMeanMZ();
-          if (!fwhms_mz.empty())
+          else if (trace_termination_criterion_ == "sample_rate")
           {
-            new_trace.fwhm_mz_avg = Math::median(fwhms_mz.begin(), fwhms_mz.end());
-          }
-          new_trace.setQuantMethod(quant_method_);
-          //new_trace.setCentroidSD(ftl_sd);
-          new_trace.updateWeightedMZsd();
-          new_trace.setLabel("T" + String(trace_number));
-          ++trace_number;
+            current_sample_rate = (double)(down_hitting_peak + up_hitting_peak + 1) / (double)(down_scan_counter + up_scan_counter + 1);
 
-          found_masstraces.push_back(new_trace);
+            if (up_scan_counter > min_scans_to_consider && current_sample_rate < min_sample_rate_)
+            {
+              // std::cout << "stopping up" << std::endl;
+              toggle_up = false;
+            }
+          }
 
-          peaks_detected += new_trace.getSize();
-          this->setProgress(peaks_detected);
 
-          // check if we already reached the (optional) maximum number of traces
-          if (max_traces > 0 && found_masstraces.size() == max_traces)
-          {
-            break;
-          }
         }
+
       }
 
-      this->endProgress();
+      // std::cout << "current sr: " << current_sample_rate << std::endl;
+      double num_scans(down_scan_counter + up_scan_counter + 1 - conseq_missed_peak_down - conseq_missed_peak_up);
+
+      double mt_quality((double)current_trace.size() / (double)num_scans);
+      // std::cout << "mt quality: " << mt_quality << std::endl;
+      double rt_range(std::fabs(current_trace.rbegin()->getRT() - current_trace.begin()->getRT()));
 
+      // *********************************************************** //
+      // Step 2.3 check if minimum length and quality of mass trace criteria are met
+      // *********************************************************** //
+      bool max_trace_criteria = (max_trace_length_ < 0.0 || rt_range < max_trace_length_);
+      return rt_range >= min_trace_length_ && max_trace_criteria && mt_quality >= min_sample_rate_;
     }
 
     void MassTraceDetection::updateMembers_()
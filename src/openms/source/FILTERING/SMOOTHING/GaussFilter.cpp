@@ -39,6 +39,10 @@
 
 #include <cmath>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace OpenMS
 {
 
@@ -168,18 +172,31 @@ namespace OpenMS
 
   void GaussFilter::filterExperiment(PeakMap & map)
   {
+    if (param_.getValue("use_ppm_tolerance").toBool() && !map.getChromatograms().empty())
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
+        "GaussFilter: Cannot use ppm tolerance on chromatograms");
+    }
+
+    // spectra and chromatograms are smoothed independently (the filter itself is not modified)
     Size progress = 0;
     startProgress(0, map.size() + map.getChromatograms().size(), "smoothing data");
-    for (Size i = 0; i < map.size(); ++i)
+#pragma omp parallel for schedule(dynamic)
+    for (SignedSize i = 0; i < (SignedSize)map.size(); ++i)
     {
       filter(map[i]);
-      setProgress(++progress);
+#pragma omp atomic
+      ++progress;
+      IF_MASTERTHREAD setProgress(progress);
     }
 
-    for (Size i = 0; i < map.getChromatograms().size(); ++i)
+#pragma omp parallel for schedule(dynamic)
+    for (SignedSize i = 0; i < (SignedSize)map.getChromatograms().size(); ++i)
     {
       filter(map.getChromatogram(i));
-      setProgress(++progress);
+#pragma omp atomic
+      ++progress;
+      IF_MASTERTHREAD setProgress(progress);
     }
     endProgress();
   }
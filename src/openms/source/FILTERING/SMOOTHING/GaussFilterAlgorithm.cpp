@@ -34,6 +34,8 @@
 
 #include <OpenMS/FILTERING/SMOOTHING/GaussFilterAlgorithm.h>
 
+#include <algorithm>
+
 namespace OpenMS
 {
 
@@ -57,13 +59,12 @@ namespace OpenMS
     use_ppm_tolerance_ = use_ppm_tolerance;
     ppm_tolerance_ = ppm_tolerance;
     sigma_ = gaussian_width / 8.0;
-    Size number_of_points_right = (Size)(ceil(4 * sigma_ / spacing_)) + 1;
+    Size number_of_points_right = numberOfCoefficients_(sigma_);
     coeffs_.resize(number_of_points_right);
-    coeffs_[0] = 1.0 / (sigma_ * sqrt(2.0 * Constants::PI));
 
-    for (Size i = 1; i < number_of_points_right; i++)
+    for (Size i = 0; i < number_of_points_right; i++)
     {
-      coeffs_[i] = 1.0 / (sigma_ * sqrt(2.0 * Constants::PI)) * exp(-((i * spacing_) * (i * spacing_)) / (2 * sigma_ * sigma_));
+      coeffs_[i] = coefficient_(sigma_, i);
     }
 #ifdef DEBUG_FILTERING
     std::cout << "Coeffs: " << std::endl;
@@ -75,4 +76,74 @@ namespace OpenMS
 
   }
 
+  void GaussFilterAlgorithm::filterUniform_(const std::vector<double>& x, const std::vector<double>& y, double h, std::vector<double>& smoothed) const
+  {
+    const Size n = x.size();
+    const Size middle = coeffs_.size();
+    const double window = middle * spacing_;
+    const auto coeff = [this](Size i) { return coeffs_[i]; };
+
+    // largest possible number of neighbors on each side within the window
+    const Size max_k = std::min(n - 1, (Size)(window / h * (1.0 + 1e-6)) + 1);
+
+    // kernel interpolated at multiples of the data spacing (as twice the value, since inner points are shared by two trapezoids)
+    std::vector<double> kernel(max_k + 1);
+    std::vector<double> kernel_sum(max_k + 1); // kernel_sum[k] = sum of kernel[1..k]
+    for (Size k = 0; k <= max_k; ++k)
+    {
+      const double distance_in_gaussian = k * h;
+      kernel[k] = distance_in_gaussian / spacing_ < middle ? 2 * interpolateKernel_(distance_in_gaussian, coeff, middle) : 2 * coeffs_.back();
+      kernel_sum[k] = k == 0 ? 0.0 : kernel_sum[k - 1] + kernel[k];
+    }
+    // symmetric kernel, centered at index max_k
+    std::vector<double> full_kernel(2 * max_k + 1);
+    for (Size k = 0; k <= max_k; ++k)
+    {
+      full_kernel[max_k - k] = kernel[k];
+      full_kernel[max_k + k] = kernel[k];
+    }
+
+    smoothed.resize(n);
+    for (Size i = 0; i < n; ++i)
+    {
+      // number of neighbors integrated on each side (same criteria as in integrate_())
+      const double start_pos = ((x[i] - window) > x[0]) ? (x[i] - window) : x[0];
+      const double end_pos = ((x[i] + window) < x[n - 1]) ? (x[i] + window) : x[n - 1];
+      Size nl = std::min(i, max_k);
+      while (nl > 0 && !(x[i - nl] > start_pos)) --nl;
+      Size nr = std::min(n - 1 - i, max_k);
+      while (nr > 0 && !(x[i + nr] < end_pos)) --nr;
+
+      const double* w = &full_kernel[max_k - nl];
+      const double* yy = &y[i - nl];
+      const Size len = nl + nr + 1;
+      double v = 0.;
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd reduction(+: v)
+#endif
+      for (Size j = 0; j < len; ++j)
+      {
+        v += w[j] * yy[j];
+      }
+      double norm = kernel[0] + kernel_sum[nl] + kernel_sum[nr];
+
+      // the outermost points and the center (if at most one side is integrated) only belong to a single trapezoid
+      const double center_weight = kernel[0] / 2 * (2 - (nl > 0) - (nr > 0));
+      v -= center_weight * y[i];
+      norm -= center_weight;
+      if (nl > 0)
+      {
+        v -= kernel[nl] / 2 * y[i - nl];
+        norm -= kernel[nl] / 2;
+      }
+      if (nr > 0)
+      {
+        v -= kernel[nr] / 2 * y[i + nr];
+        norm -= kernel[nr] / 2;
+      }
+
+      smoothed[i] = v > 0 ? v / norm : 0.0;
+    }
+  }
+
 }
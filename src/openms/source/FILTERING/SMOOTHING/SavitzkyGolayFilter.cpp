@@ -38,6 +38,10 @@
 #include <Eigen/Core>
 #include <Eigen/SVD>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace OpenMS
 {
   SavitzkyGolayFilter::SavitzkyGolayFilter() :
@@ -105,4 +109,77 @@ namespace OpenMS
       }
     }
   }
+
+  void SavitzkyGolayFilter::smooth_(const std::vector<double>& in, std::vector<double>& out) const
+  {
+    const Size n = in.size();
+    const Size mid = frame_size_ / 2;
+    out.assign(n, 0.0);
+
+    // compute the transient on
+    for (Size i = 0; i <= mid; ++i)
+    {
+      double help = 0;
+      for (Size j = 0; j < frame_size_; ++j)
+      {
+        help += in[j] * coeffs_[(i + 1) * frame_size_ - 1 - j];
+      }
+      out[i] = help;
+    }
+
+    // compute the steady state output: the coefficients are applied one after the other to a block of
+    // consecutive points (vectorizable; same summation order per point as the plain dot product)
+    const Size block_size = 512;
+    const double* coeffs = &coeffs_[mid * frame_size_];
+    for (Size block_start = mid + 1; block_start + mid < n; block_start += block_size)
+    {
+      const Size block_end = std::min(block_start + block_size, n - mid);
+      double* dst = &out[block_start];
+      for (Size j = 0; j < frame_size_; ++j)
+      {
+        const double c = coeffs[j];
+        const double* src = &in[block_start - mid + j];
+        for (Size k = 0; k < block_end - block_start; ++k)
+        {
+          dst[k] += src[k] * c;
+        }
+      }
+    }
+
+    // compute the transient off
+    for (Size i = 0; i < mid; ++i)
+    {
+      const Size p = n - 1 - i;
+      double help = 0;
+      for (Size j = 0; j < frame_size_; ++j)
+      {
+        help += in[p - (frame_size_ - i - 1) + j] * coeffs_[i * frame_size_ + j];
+      }
+      out[p] = help;
+    }
+  }
+
+  void SavitzkyGolayFilter::filterExperiment(PeakMap & map)
+  {
+    // the filter is not modified, so spectra and chromatograms can be processed independently
+    Size progress = 0;
+    startProgress(0, map.size() + map.getChromatograms().size(), "smoothing data");
+#pragma omp parallel for schedule(dynamic)
+    for (SignedSize i = 0; i < (SignedSize)map.size(); ++i)
+    {
+      filter(map[i]);
+#pragma omp atomic
+      ++progress;
+      IF_MASTERTHREAD setProgress(progress);
+    }
+#pragma omp parallel for schedule(dynamic)
+    for (SignedSize i = 0; i < (SignedSize)map.getChromatograms().size(); ++i)
+    {
+      filter(map.getChromatogram(i));
+#pragma omp atomic
+      ++progress;
+      IF_MASTERTHREAD setProgress(progress);
+    }
+    endProgress();
+  }
 }
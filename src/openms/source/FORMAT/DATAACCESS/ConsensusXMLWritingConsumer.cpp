@@ -0,0 +1,139 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/FORMAT/DATAACCESS/ConsensusXMLWritingConsumer.h>
+
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/CONCEPT/LogStream.h>
+
+namespace OpenMS
+{
+
+  ConsensusXMLWritingConsumer::ConsensusXMLWritingConsumer(const String& filename) :
+    Internal::ConsensusXMLHandler(ConsensusMap(), filename),
+    started_writing_(false),
+    closed_(false),
+    features_written_(0)
+  {
+    // the handler writes the document from this map
+    cconsensus_map_ = &header_;
+
+    // open file in binary mode to avoid any line ending conversions
+    ofs_.open(filename.c_str(), std::ios::out | std::ios::binary);
+    if (!ofs_)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+    ofs_.precision(writtenDigits(double()));
+  }
+
+  ConsensusXMLWritingConsumer::~ConsensusXMLWritingConsumer()
+  {
+    // exceptions must not leave the destructor; call close() to get them
+    try
+    {
+      close();
+    }
+    catch (std::exception& e)
+    {
+      OPENMS_LOG_ERROR << "ConsensusXMLWritingConsumer: the file could not be closed: " << e.what() << std::endl;
+    }
+  }
+
+  void ConsensusXMLWritingConsumer::setHeader(const ConsensusMap& header)
+  {
+    if (started_writing_)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+          "Cannot set the header after writing has started.");
+    }
+    header_.clear(true);
+    header_.MetaInfoInterface::operator=(header);
+    header_.DocumentIdentifier::operator=(header);
+    header_.setUniqueId(header.getUniqueId());
+    header_.setExperimentType(header.getExperimentType());
+    header_.setColumnHeaders(header.getColumnHeaders());
+    header_.getProteinIdentifications() = header.getProteinIdentifications();
+    header_.getUnassignedPeptideIdentifications() = header.getUnassignedPeptideIdentifications();
+    header_.getDataProcessing() = header.getDataProcessing();
+  }
+
+  void ConsensusXMLWritingConsumer::consume(const ConsensusFeature& feature)
+  {
+    if (closed_)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+          "Cannot write consensus features after the file was closed.");
+    }
+    if (!started_writing_)
+    {
+      // this is the first data to be written -> start writing the header
+      writeHeader_(ofs_);
+      started_writing_ = true;
+    }
+    writeConsensusElement_(ofs_, feature);
+    ++features_written_;
+  }
+
+  void ConsensusXMLWritingConsumer::consume(const ConsensusMap& map)
+  {
+    for (const ConsensusFeature& feature : map)
+    {
+      consume(feature);
+    }
+  }
+
+  void ConsensusXMLWritingConsumer::close()
+  {
+    if (closed_)
+    {
+      return;
+    }
+    // an empty document still needs a header
+    if (!started_writing_)
+    {
+      writeHeader_(ofs_);
+      started_writing_ = true;
+    }
+    writeFooter_(ofs_);
+    ofs_.close();
+    closed_ = true;
+  }
+
+  Size ConsensusXMLWritingConsumer::getNrFeaturesWritten() const
+  {
+    return features_written_;
+  }
+
+} // namespace OpenMS
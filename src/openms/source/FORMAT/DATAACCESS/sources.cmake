@@ -3,6 +3,7 @@ set(directory source/FORMAT/DATAACCESS)
 
 ### list all filenames of the directory here
 set(sources_list
+  ConsensusXMLWritingConsumer.cpp
   CsiFingerIdMzTabWriter.cpp
   MSDataWritingConsumer.cpp
   MSDataTransformingConsumer.cpp
@@ -40,8 +40,49 @@
 #include <OpenMS/METADATA/ProteinIdentification.h>
 #include <OpenMS/METADATA/PeptideIdentification.h>
 
+#include <algorithm>
+#include <vector>
+
 namespace OpenMS
 {
+  namespace
+  {
+    /// The most frequent charge state of @p handles. Tie breaking prefers smaller (absolute) charges.
+    Int mostFrequentCharge(const ConsensusFeature::HandleSetType& handles)
+    {
+      // occurrences per charge state; there are only a few different charges, so a linear search is fine
+      std::vector<std::pair<Int, UInt> > charge_occ;
+      Int charge_most_frequent = 0;
+      UInt charge_most_frequent_occ = 0;
+
+      for (const FeatureHandle& handle : handles)
+      {
+        const Int it_charge = handle.getCharge();
+        auto occ_it = std::find_if(charge_occ.begin(), charge_occ.end(),
+                                   [it_charge](const std::pair<Int, UInt>& occ) { return occ.first == it_charge; });
+        if (occ_it == charge_occ.end())
+        {
+          charge_occ.emplace_back(it_charge, 0);
+          occ_it = charge_occ.end() - 1;
+        }
+        const UInt it_charge_occ = ++occ_it->second;
+        if (it_charge_occ > charge_most_frequent_occ)
+        {
+          charge_most_frequent_occ = it_charge_occ;
+          charge_most_frequent = it_charge;
+        }
+        else
+        {
+          if (it_charge_occ >= charge_most_frequent_occ && abs(it_charge) < abs(charge_most_frequent))
+          {
+            charge_most_frequent = it_charge;
+          }
+        }
+      }
+      return charge_most_frequent;
+    }
+  }
+
   ConsensusFeature::ConsensusFeature() :
     BaseFeature(), handles_(), ratios_()
   {
@@ -68,13 +109,14 @@ namespace OpenMS
 
   void ConsensusFeature::insert(const ConsensusFeature& cf)
   {
-    handles_.insert(cf.handles_.begin(), cf.handles_.end());
+    // the handles of 'cf' are sorted and unique already, so they can be merged in linear time
+    handles_.insert(boost::container::ordered_unique_range, cf.handles_.begin(), cf.handles_.end());
     peptides_.insert(peptides_.end(), cf.getPeptideIdentifications().begin(), cf.getPeptideIdentifications().end());
   }
 
   void ConsensusFeature::insert(ConsensusFeature&& cf)
   {
-    handles_.insert(make_move_iterator(cf.handles_.begin()), make_move_iterator(cf.handles_.end()));
+    handles_.insert(boost::container::ordered_unique_range, std::make_move_iterator(cf.handles_.begin()), std::make_move_iterator(cf.handles_.end()));
     peptides_.insert(peptides_.end(), make_move_iterator(cf.getPeptideIdentifications().begin()), make_move_iterator(cf.getPeptideIdentifications().end()));
   }
 
@@ -98,6 +140,7 @@ namespace OpenMS
 
   void ConsensusFeature::insert(const HandleSetType& handle_set)
   {
+    handles_.reserve(handles_.size() + handle_set.size());
     for (auto& handle : handle_set)
     {
       insert(handle);
@@ -106,6 +149,7 @@ namespace OpenMS
 
   void ConsensusFeature::insert(HandleSetType&& handle_set)
   {
+    handles_.reserve(handles_.size() + handle_set.size());
     for (auto& handle : handle_set)
     {
       insert(std::move(handle));
@@ -141,12 +185,7 @@ namespace OpenMS
 
   std::vector<FeatureHandle> ConsensusFeature::getFeatureList() const
   {
-    std::vector<FeatureHandle> tmp;
-    for (ConsensusFeature::HandleSetType::const_iterator it = handles_.begin(); it != handles_.end(); ++it)
-    {
-      tmp.push_back(*it);
-    }
-    return tmp;
+    return std::vector<FeatureHandle>(handles_.begin(), handles_.end());
   }
 
   DRange<2> ConsensusFeature::getPositionRange() const
@@ -200,37 +239,19 @@ namespace OpenMS
     double mz = 0.0;
     double intensity = 0.0;
 
-    // The most frequent charge state wins.  Tie breaking prefers smaller charge.
-    std::map<Int, UInt> charge_occ;
-    Int charge_most_frequent = 0;
-    UInt charge_most_frequent_occ = 0;
-
-    for (ConsensusFeature::HandleSetType::const_iterator it = handles_.begin(); it != handles_.end(); ++it)
+    for (const FeatureHandle& handle : handles_)
     {
-      rt += it->getRT();
-      mz += it->getMZ();
-      intensity += it->getIntensity();
-      const Int it_charge = it->getCharge();
-      const UInt it_charge_occ = ++charge_occ[it_charge];
-      if (it_charge_occ > charge_most_frequent_occ)
-      {
-        charge_most_frequent_occ = it_charge_occ;
-        charge_most_frequent = it_charge;
-      }
-      else
-      {
-        if (it_charge_occ >= charge_most_frequent_occ && abs(it_charge) < abs(charge_most_frequent))
-        {
-          charge_most_frequent = it_charge;
-        }
-      }
+      rt += handle.getRT();
+      mz += handle.getMZ();
+      intensity += handle.getIntensity();
     }
 
     // compute the average position and intensity
     setRT(rt / size());
     setMZ(mz / size());
     setIntensity(intensity / size());
-    setCharge(charge_most_frequent);
+    // The most frequent charge state wins.  Tie breaking prefers smaller charge.
+    setCharge(mostFrequentCharge(handles_));
     return;
   }
 
@@ -241,40 +262,22 @@ namespace OpenMS
     double mz = std::numeric_limits<double>::max();
     double intensity = 0.0;
 
-    // The most frequent charge state wins.  Tie breaking prefers smaller charge.
-    std::map<Int, UInt> charge_occ;
-    Int charge_most_frequent = 0;
-    UInt charge_most_frequent_occ = 0;
-
-    for (ConsensusFeature::HandleSetType::const_iterator it = handles_.begin(); it != handles_.end(); ++it)
+    for (const FeatureHandle& handle : handles_)
     {
-      rt += it->getRT();
-      if (it->getMZ() < mz)
-      {
-        mz = it->getMZ();
-      }
-      intensity += it->getIntensity();
-      const Int it_charge = it->getCharge();
-      const UInt it_charge_occ = ++charge_occ[it_charge];
-      if (it_charge_occ > charge_most_frequent_occ)
+      rt += handle.getRT();
+      if (handle.getMZ() < mz)
       {
-        charge_most_frequent_occ = it_charge_occ;
-        charge_most_frequent = it_charge;
-      }
-      else
-      {
-        if (it_charge_occ >= charge_most_frequent_occ && abs(it_charge) < abs(charge_most_frequent))
-        {
-          charge_most_frequent = it_charge;
-        }
+        mz = handle.getMZ();
       }
+      intensity += handle.getIntensity();
     }
 
     // compute the position and intensity
     setRT(rt / size());
     setMZ(mz);
     setIntensity(intensity / size());
-    setCharge(charge_most_frequent);
+    // The most frequent charge state wins.  Tie breaking prefers smaller charge.
+    setCharge(mostFrequentCharge(handles_));
     return;
   }
 
@@ -267,12 +267,13 @@ namespace OpenMS
 
       // update map indices
       ConsensusFeature::HandleSetType new_handles;
-      // std::set only provides const iterators, so we copy
+      new_handles.reserve(cf.size());
+      // map indices are part of the sort key of the handles, so we copy
       for (auto handle : cf) // OMS_CODING_TEST_EXCLUDE
       {
-        //since we only add a constant to the map_index, the set order will not change.
+        //since we only add a constant to the map_index, the set order will not change (handles are appended).
         handle.setMapIndex(lhs_map_size + handle.getMapIndex());
-        new_handles.insert(handle);
+        new_handles.insert(new_handles.end(), handle);
       }
       cf.setFeatures(std::move(new_handles));
       new_handles.clear();
@@ -0,0 +1,121 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Timo Sachsenberg $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/KERNEL/FlatPeakIndex.h>
+
+#include <OpenMS/KERNEL/MSExperiment.h>
+
+namespace OpenMS
+{
+
+  FlatPeakIndex::FlatPeakIndex(const MSExperiment& exp, bool use_buckets)
+  {
+    build(exp, use_buckets);
+  }
+
+  void FlatPeakIndex::clear()
+  {
+    scan_offsets_.clear();
+    mz_.clear();
+    intensity_.clear();
+    bucket_offsets_.clear();
+    bucket_first_.clear();
+    bucket_min_mz_.clear();
+    bucket_inv_width_.clear();
+  }
+
+  void FlatPeakIndex::build(const MSExperiment& exp, bool use_buckets)
+  {
+    clear();
+
+    Size total_peaks(0);
+    for (const auto& spec : exp)
+    {
+      total_peaks += spec.size();
+    }
+
+    scan_offsets_.reserve(exp.size() + 1);
+    mz_.reserve(total_peaks);
+    intensity_.reserve(total_peaks);
+    scan_offsets_.push_back(0);
+    for (const auto& spec : exp)
+    {
+      for (const auto& p : spec)
+      {
+        mz_.push_back(p.getMZ());
+        intensity_.push_back(p.getIntensity());
+      }
+      scan_offsets_.push_back(mz_.size());
+    }
+
+    if (!use_buckets) return;
+
+    // one bucket per peak; spectra with very few peaks do not benefit from a
+    // bucket table and only get the sentinel entry (i.e. zero buckets)
+    const Size min_peaks_for_buckets = 8;
+    bucket_offsets_.reserve(exp.size() + 1);
+    bucket_min_mz_.assign(exp.size(), 0.0);
+    bucket_inv_width_.assign(exp.size(), 0.0);
+    bucket_first_.reserve(total_peaks + exp.size());
+    bucket_offsets_.push_back(0);
+    for (Size scan = 0; scan < exp.size(); ++scan)
+    {
+      const Size n = getSpectrumSize(scan);
+      const double* spec_mz = mz_.data() + scan_offsets_[scan];
+      Size nr_buckets = 0;
+      if (n >= min_peaks_for_buckets && spec_mz[n - 1] > spec_mz[0])
+      {
+        nr_buckets = n;
+        bucket_min_mz_[scan] = spec_mz[0];
+        bucket_inv_width_[scan] = (double)nr_buckets / (spec_mz[n - 1] - spec_mz[0]);
+      }
+
+      // first[b] is the first peak whose bucket is not smaller than b; since
+      // bucketOf_ is monotonic, the lower bound of any m/z in bucket b lies
+      // within [first[b], first[b + 1]]
+      Size i = 0;
+      for (Size b = 0; b < nr_buckets; ++b)
+      {
+        while (i < n && bucketOf_(spec_mz[i], bucket_min_mz_[scan], bucket_inv_width_[scan], nr_buckets) < b)
+        {
+          ++i;
+        }
+        bucket_first_.push_back((UInt32)i);
+      }
+      bucket_first_.push_back((UInt32)n);
+      bucket_offsets_.push_back(bucket_first_.size());
+    }
+  }
+
+} // namespace OpenMS
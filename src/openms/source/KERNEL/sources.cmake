@@ -13,6 +13,7 @@ DPeak.cpp
 Feature.cpp
 FeatureHandle.cpp
 FeatureMap.cpp
+FlatPeakIndex.cpp
 MassTrace.cpp
 MobilityPeak1D.cpp
 MobilityPeak2D.cpp
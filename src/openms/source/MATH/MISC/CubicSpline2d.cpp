@@ -105,6 +105,32 @@ namespace OpenMS
     return ((d_[i] * xx + c_[i]) * xx + b_[i]) * xx + a_[i];
   }
 
+  void CubicSpline2d::eval(const double* begin, const double* end, double* result) const
+  {
+    if (begin == end)
+    {
+      return;
+    }
+    if (*begin < x_.front() || *(end - 1) > x_.back())
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Argument out of range of spline interpolation.");
+    }
+
+    // index of closest node left of (or exactly at) x, but at most the start of the last interval
+    const size_t last = x_.size() - 1;
+    size_t i = 0;
+    for (; begin != end; ++begin, ++result)
+    {
+      const double x = *begin;
+      while (i + 1 < last && x_[i + 1] <= x)
+      {
+        ++i;
+      }
+      const double xx = x - x_[i];
+      *result = ((d_[i] * xx + c_[i]) * xx + b_[i]) * xx + a_[i];
+    }
+  }
+
   double CubicSpline2d::derivative(const double x) const
   {
     return derivatives(x, 1);
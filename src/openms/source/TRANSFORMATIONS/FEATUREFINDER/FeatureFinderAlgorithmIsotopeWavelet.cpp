@@ -36,6 +36,12 @@
 
 #include <OpenMS/TRANSFORMATIONS/FEATUREFINDER/IsotopeWaveletTransform.h>
 
+#include <memory>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace OpenMS
 {
   FeatureFinderAlgorithmIsotopeWavelet::FeatureFinderAlgorithmIsotopeWavelet()
@@ -178,74 +184,98 @@ namespace OpenMS
     this->ff_->startProgress(0, 2 * this->map_->size() * max_charge_, "analyzing spectra");
 
     IsotopeWaveletTransform<PeakType>* iwt = new IsotopeWaveletTransform<PeakType>(min_mz, max_mz, max_charge_, max_size, hr_data_, intensity_type_);
-    for (UInt i = 0; i < this->map_->size(); ++i)
-    {
-      const MSSpectrum& c_ref((*this->map_)[i]);
 
-#ifdef OPENMS_DEBUG_ISOTOPE_WAVELET
-      std::cout << ::std::fixed << ::std::setprecision(6) << "Spectrum " << i + 1 << " (" << (*this->map_)[i].getRT() << ") of " << this->map_->size() << " ... ";
-      std::cout.flush();
+    // The transforms are the expensive part and independent of each other, so
+    // they are computed in parallel for a block of scans and all charge states.
+    // Charge recognition and the sweep line need the scans in order and are
+    // applied serially afterwards (i.e. the result is the same as before).
+#ifdef _OPENMP
+    const Size block_size = 2 * std::max(1, omp_get_max_threads());
+#else
+    const Size block_size = 1;
 #endif
+    const Size n_scans = this->map_->size();
+    for (Size block_start = 0; block_start < n_scans; block_start += block_size)
+    {
+      const Size n_block = std::min(block_size, n_scans - block_start);
 
-      if (c_ref.size() <= 1)                 //unable to do transform anything
+      // spectra to transform (the interpolated ones for high-resolution data):
+      std::vector<std::unique_ptr<MSSpectrum> > hr_specs(n_block);
+      if (hr_data_)
       {
-#ifdef OPENMS_DEBUG_ISOTOPE_WAVELET
-        std::cout << "scan empty or consisting of a single data point. Skipping." << std::endl;
-#endif
-        this->ff_->setProgress(progress_counter_ += 2);
-        continue;
+#pragma omp parallel for schedule(dynamic, 1)
+        for (SignedSize k = 0; k < SignedSize(n_block); ++k)
+        {
+          if ((*this->map_)[block_start + k].size() > 1)
+          {
+            hr_specs[k].reset(createHRData(UInt(block_start + k)));
+          }
+        }
       }
+      auto getScan = [&](Size k) -> const MSSpectrum&
+      {
+        return hr_data_ ? *hr_specs[k] : (*this->map_)[block_start + k];
+      };
 
-      if (!hr_data_)                   //LowRes data
+      std::vector<std::vector<MSSpectrum> > transforms(n_block);
+      for (Size k = 0; k < n_block; ++k)
       {
-        iwt->initializeScan((*this->map_)[i]);
-        for (UInt c = 0; c < max_charge_; ++c)
+        if ((*this->map_)[block_start + k].size() > 1)
+        {
+          transforms[k].assign(max_charge_, getScan(k));
+        }
+      }
+      const SignedSize n_tasks = SignedSize(n_block * max_charge_);
+#pragma omp parallel for schedule(dynamic, 1)
+      for (SignedSize t = 0; t < n_tasks; ++t)
+      {
+        const Size k = Size(t) / max_charge_;
+        const UInt c = UInt(Size(t) % max_charge_);
+        if (!transforms[k].empty())
         {
-          MSSpectrum c_trans(c_ref);
+          iwt->computeTransform(transforms[k][c], getScan(k), c);
+        }
+      }
 
-          iwt->getTransform(c_trans, c_ref, c);
+      for (Size k = 0; k < n_block; ++k)
+      {
+        const UInt i = UInt(block_start + k);
+        const MSSpectrum& c_ref((*this->map_)[i]);
 
 #ifdef OPENMS_DEBUG_ISOTOPE_WAVELET
-          std::stringstream stream;
-          stream << "cpu_lowres_" << c_ref.getRT() << "_" << c + 1 << ".trans\0";
-          std::ofstream ofile(stream.str().c_str());
-          for (UInt k = 0; k < c_ref.size(); ++k)
-          {
-            ofile << ::std::setprecision(8) << std::fixed << c_trans[k].getMZ() << "\t" << c_trans[k].getIntensity() << "\t" << c_ref[k].getIntensity() << std::endl;
-          }
-          ofile.close();
+        std::cout << ::std::fixed << ::std::setprecision(6) << "Spectrum " << i + 1 << " (" << (*this->map_)[i].getRT() << ") of " << this->map_->size() << " ... ";
+        std::cout.flush();
 #endif
 
+        if (c_ref.size() <= 1)                 //unable to do transform anything
+        {
 #ifdef OPENMS_DEBUG_ISOTOPE_WAVELET
-          std::cout << "transform O.K. ... "; std::cout.flush();
+          std::cout << "scan empty or consisting of a single data point. Skipping." << std::endl;
 #endif
-          this->ff_->setProgress(++progress_counter_);
-
-          iwt->identifyCharge(c_trans, c_ref, i, c, intensity_threshold_, check_PPMs_);
+          this->ff_->setProgress(progress_counter_ += 2);
+          continue;
+        }
 
-#ifdef OPENMS_DEBUG_ISOTOPE_WAVELET
-          std::cout << "charge recognition O.K. ... "; std::cout.flush();
-#endif
-          this->ff_->setProgress(++progress_counter_);
+        const MSSpectrum& c_scan = getScan(k);
+        if (!hr_data_)                   //LowRes data
+        {
+          iwt->initializeScan(c_scan);
         }
-      }
-      else                   //HighRes data
-      {
         for (UInt c = 0; c < max_charge_; ++c)
         {
-          MSSpectrum* new_spec = createHRData(i);
-          iwt->initializeScan(*new_spec, c);
-          MSSpectrum c_trans(*new_spec);
-
-          iwt->getTransformHighRes(c_trans, *new_spec, c);
+          if (hr_data_)                   //HighRes data
+          {
+            iwt->initializeScan(c_scan, c);
+          }
+          const MSSpectrum& c_trans = transforms[k][c];
 
 #ifdef OPENMS_DEBUG_ISOTOPE_WAVELET
           std::stringstream stream;
-          stream << "cpu_highres_" << new_spec->getRT() << "_" << c + 1 << ".trans\0";
+          stream << (hr_data_ ? "cpu_highres_" : "cpu_lowres_") << c_scan.getRT() << "_" << c + 1 << ".trans\0";
           std::ofstream ofile(stream.str().c_str());
-          for (UInt k = 0; k < new_spec->size(); ++k)
+          for (UInt j = 0; j < c_scan.size(); ++j)
           {
-            ofile << ::std::setprecision(8) << std::fixed << c_trans[k].getMZ() << "\t" << c_trans[k].getIntensity() << "\t" << (*new_spec)[k].getIntensity() << std::endl;
+            ofile << ::std::setprecision(8) << std::fixed << c_trans[j].getMZ() << "\t" << c_trans[j].getIntensity() << "\t" << c_scan[j].getIntensity() << std::endl;
           }
           ofile.close();
 #endif
@@ -255,24 +285,23 @@ namespace OpenMS
 #endif
           this->ff_->setProgress(++progress_counter_);
 
-          iwt->identifyCharge(c_trans, *new_spec, i, c, intensity_threshold_, check_PPMs_);
+          iwt->identifyCharge(c_trans, c_scan, i, c, intensity_threshold_, check_PPMs_);
 
 #ifdef OPENMS_DEBUG_ISOTOPE_WAVELET
           std::cout << "charge recognition O.K. ... "; std::cout.flush();
 #endif
           this->ff_->setProgress(++progress_counter_);
-
-          delete (new_spec); new_spec = nullptr;
         }
-      }
+        transforms[k].clear();
+        hr_specs[k].reset();
 
-
-      iwt->updateBoxStates(*this->map_, i, RT_interleave_, real_RT_votes_cutoff_);
+        iwt->updateBoxStates(*this->map_, i, RT_interleave_, real_RT_votes_cutoff_);
 #ifdef OPENMS_DEBUG_ISOTOPE_WAVELET
-      std::cout << "updated box states." << std::endl;
+        std::cout << "updated box states." << std::endl;
 #endif
 
-      std::cout.flush();
+        std::cout.flush();
+      }
     }
 
     this->ff_->endProgress();
@@ -211,6 +211,8 @@ namespace OpenMS
 
     //copy the input map
     map_ = *(FeatureFinderAlgorithm::map_);
+    //flat m/z index for the nearest-peak lookups (peaks of map_ are not modified below)
+    mz_index_.build(map_);
 
     //flag for user-specified seed mode
     bool user_seeds = (!seeds_.empty());
@@ -343,23 +345,21 @@ namespace OpenMS
           bool is_max_peak = true; // checking the maximum intensity peaks -> use them later as feature seeds.
           for (Size i = 1; i <= min_spectra_; ++i)
           {
-            SpectrumType& next_spectrum = map_[s + i];
-            if (!next_spectrum.empty()) // There are peaks in the spectrum
+            if (mz_index_.getSpectrumSize(s + i) > 0) // There are peaks in the spectrum
             {
-              Size spec_index = next_spectrum.findNearest(pos);
-              double position_score = positionScore_(pos, next_spectrum[spec_index].getMZ(), trace_tolerance_);
-              if (position_score > 0 && next_spectrum[spec_index].getIntensity() > intensity) is_max_peak = false;
+              Size spec_index = mz_index_.findNearest(s + i, pos);
+              double position_score = positionScore_(pos, mz_index_.getMZ(s + i, spec_index), trace_tolerance_);
+              if (position_score > 0 && mz_index_.getIntensity(s + i, spec_index) > intensity) is_max_peak = false;
               trace_score += position_score;
             }
           }
           for (Size i = 1; i <= min_spectra_; ++i)
           {
-            SpectrumType& next_spectrum = map_[s - i];
-            if (!next_spectrum.empty()) // There are peaks in the spectrum
+            if (mz_index_.getSpectrumSize(s - i) > 0) // There are peaks in the spectrum
             {
-              Size spec_index = next_spectrum.findNearest(pos);
-              double position_score = positionScore_(pos, next_spectrum[spec_index].getMZ(), trace_tolerance_);
-              if (position_score > 0 && next_spectrum[spec_index].getIntensity() > intensity)
+              Size spec_index = mz_index_.findNearest(s - i, pos);
+              double position_score = positionScore_(pos, mz_index_.getMZ(s - i, spec_index), trace_tolerance_);
+              if (position_score > 0 && mz_index_.getIntensity(s - i, spec_index) > intensity)
               {
                 is_max_peak = false;
               }
@@ -490,7 +490,7 @@ namespace OpenMS
           //determine highest peak in isotope distribution
           Size max_isotope = std::max_element(isotopes.intensity.begin(), isotopes.intensity.end()) - isotopes.intensity.begin();
           //Look up expected isotopic peaks (in the current spectrum or adjacent spectra)
-          Size peak_index = spectrum.findNearest(mz - ((double)(isotopes.size() + 1) / c));
+          Size peak_index = mz_index_.findNearest(s, mz - ((double)(isotopes.size() + 1) / c));
           IsotopePattern pattern(isotopes.size());
 
           for (Size i = 0; i < isotopes.size(); ++i)
@@ -608,22 +608,42 @@ namespace OpenMS
       //------------------------------------------------------------------
 
       // We do not want to store features whose seeds lie within other
-      // features with higher intensity. We thus store this information in
-      // the map seeds_in_features which contains for each seed i a vector
-      // of other seeds that are contained in the corresponding feature i.
+      // features with higher intensity. We thus store for each feature the
+      // other seeds that are contained in it.
       //
-      // The features are stored in an temporary feature map until it is
-      // decided whether they are contained within a seed of higher
-      // intensity.
-      std::map<Size, std::vector<Size>> seeds_in_features;
-      typedef std::map<Size, Feature> FeatureMapType;
-      FeatureMapType tmp_feature_map;
-      int gl_progress = 0;
+      // The features are collected in per-thread buffers (no locking) until
+      // it is decided whether they are contained within a seed of higher
+      // intensity. Aborted seeds are recorded there as well and reported
+      // after the parallel section.
+      struct SeedFeature
+      {
+        Size seed;
+        Feature feature;
+        std::vector<Size> contained_seeds;
+      };
+      struct SeedResults
+      {
+        std::vector<SeedFeature> features;
+        std::vector<std::pair<Size, String> > aborts;
+      };
+#ifdef _OPENMP
+      std::vector<SeedResults> thread_results(omp_get_max_threads());
+#else
+      std::vector<SeedResults> thread_results(1);
+#endif
+      Size gl_progress = 0;
       ff_->startProgress(0, seeds.size(), String("Extending seeds for charge ") + String(c));
 
-#pragma omp parallel for
+      // seeds are sorted by decreasing intensity: the most intense (and usually most expensive) seeds are handed out first
+#pragma omp parallel for schedule(dynamic, 1)
       for (SignedSize i = 0; i < (SignedSize)seeds.size(); ++i)
       {
+#ifdef _OPENMP
+        SeedResults& results = thread_results[omp_get_thread_num()];
+#else
+        SeedResults& results = thread_results[0];
+#endif
+
         //------------------------------------------------------------------
         // Step 3.3.1:
         // Extend all mass traces
@@ -632,9 +652,11 @@ namespace OpenMS
         const SpectrumType& spectrum = map_[seeds[i].spectrum];
         const PeakType& peak = spectrum[seeds[i].peak];
 
+#pragma omp atomic
+        ++gl_progress;
         IF_MASTERTHREAD
         {
-          ff_->setProgress(gl_progress++);
+          ff_->setProgress(gl_progress);
 
           if (debug_)
           {
@@ -653,7 +675,7 @@ namespace OpenMS
 
         if (isotope_fit_quality < min_isotope_fit_)
         {
-          abort_(seeds[i], "Could not find good enough isotope pattern containing the seed");
+          results.aborts.emplace_back(i, "Could not find good enough isotope pattern containing the seed");
           continue;
         }
         //extend the convex hull in RT dimension (starting from the trace peaks)
@@ -666,7 +688,7 @@ namespace OpenMS
 
         if (!traces.isValid(seed_mz, trace_tolerance_))
         {
-          abort_(seeds[i], "Could not extend seed");
+          results.aborts.emplace_back(i, "Could not extend seed");
           continue;
         }
 
@@ -677,10 +699,8 @@ namespace OpenMS
         Int plot_nr = -1;
 
 
-#pragma omp critical(FeatureFinderAlgorithmPicked_PLOTNR)
-        {
-          plot_nr = ++plot_nr_global;
-        }
+#pragma omp atomic capture
+        plot_nr = ++plot_nr_global;
 
         //------------------------------------------------------------------
 
@@ -751,7 +771,7 @@ namespace OpenMS
         //validity output
         if (!feature_ok)
         {
-          abort_(seeds[i], error_msg);
+          results.aborts.emplace_back(i, error_msg);
           continue;
         }
         traces = new_traces;
@@ -824,13 +844,9 @@ namespace OpenMS
           f.getConvexHulls().push_back(traces[j].getConvexhull());
         }
 
-#pragma omp critical(FeatureFinderAlgorithmPicked_TMPFEATUREMAP)
-        {
-          tmp_feature_map[i] = f;
-        }
-
         //----------------------------------------------------------------
         //Remember all seeds that lie inside the convex hull of the new feature
+        std::vector<Size> contained_seeds;
         DBoundingBox<2> bb = f.getConvexHull().getBoundingBox();
         for (Size j = i + 1; j < seeds.size(); ++j)
         {
@@ -838,44 +854,49 @@ namespace OpenMS
           double mz = map_[seeds[j].spectrum][seeds[j].peak].getMZ();
           if (bb.encloses(rt, mz) && f.encloses(rt, mz))
           {
-#pragma omp critical(FeatureFinderAlgorithmPicked_SEEDSINFEATURES)
-            {
-              seeds_in_features[i].push_back(j);
-            }
+            contained_seeds.push_back(j);
           }
         }
+        results.features.push_back(SeedFeature{(Size)i, std::move(f), std::move(contained_seeds)});
       } //end of OPENMP over seeds
 
+      // merge the per-thread results in seed order (i.e. by decreasing seed intensity)
+      std::vector<std::pair<Size, String> > aborts;
+      std::vector<SeedFeature*> seed_features;
+      for (SeedResults& results : thread_results)
+      {
+        std::move(results.aborts.begin(), results.aborts.end(), std::back_inserter(aborts));
+        for (SeedFeature& sf : results.features)
+        {
+          seed_features.push_back(&sf);
+        }
+      }
+      std::sort(aborts.begin(), aborts.end(), [](const std::pair<Size, String>& a, const std::pair<Size, String>& b) { return a.first < b.first; });
+      for (const auto& a : aborts)
+      {
+        abort_(seeds[a.first], a.second);
+      }
+      std::sort(seed_features.begin(), seed_features.end(), [](const SeedFeature* a, const SeedFeature* b) { return a->seed < b->seed; });
+
       // Here we have to evaluate which seeds are already contained in
       // features of seeds with higher intensities. Only if the seed is not
       // used in any feature with higher intensity, we can add it to the
       // features_ list.
-      std::vector<Size> seeds_contained;
-      for (auto& f : tmp_feature_map)
+      std::vector<bool> seed_contained(seeds.size(), false);
+      for (SeedFeature* sf : seed_features)
       {
-        Size seed_nr = f.first;
-        bool is_used = false;
-        for (Size i : seeds_contained)
-        {
-          if (seed_nr == i)
-          {
-            is_used = true;
-            break;
-          }
-        }
-        if (!is_used)
+        if (!seed_contained[sf->seed])
         {
           ++feature_candidates;
 
           //re-set label
-          f.second.setMetaValue(3, feature_nr_global);
+          sf->feature.setMetaValue(3, feature_nr_global);
           ++feature_nr_global;
-          features_->push_back(f.second);
+          features_->push_back(std::move(sf->feature));
 
-          std::vector<Size> curr_seed = seeds_in_features[seed_nr];
-          for (Size k : curr_seed)
+          for (Size k : sf->contained_seeds)
           {
-            seeds_contained.push_back(k);
+            seed_contained[k] = true;
           }
         }
       }
@@ -1392,7 +1413,7 @@ namespace OpenMS
         SignedSize peak_index = -1;
         if (!map_[spectrum_index].empty())
         {
-          peak_index = map_[spectrum_index].findNearest(map_[starting_peak.spectrum][starting_peak.peak].getMZ());
+          peak_index = mz_index_.findNearest(spectrum_index, map_[starting_peak.spectrum][starting_peak.peak].getMZ());
         }
 
         if (peak_index < 0 ||
@@ -1490,7 +1511,7 @@ namespace OpenMS
 
       if (!map_[spectrum_index].empty())
       {
-        peak_index = map_[spectrum_index].findNearest(mz);
+        peak_index = mz_index_.findNearest(spectrum_index, mz);
       }
 
       // check if the peak is "missing"
@@ -1602,7 +1623,7 @@ namespace OpenMS
     if (spectrum_index != 0 && !map_[spectrum_index - 1].empty())
     {
       const SpectrumType& spectrum_before = map_[spectrum_index - 1];
-      Size index_before = spectrum_before.findNearest(pos);
+      Size index_before = mz_index_.findNearest(spectrum_index - 1, pos);
       double mz_score = positionScore_(pos, spectrum_before[index_before].getMZ(), pattern_tolerance_);
       if (mz_score != 0.0)
       {
@@ -1623,7 +1644,7 @@ namespace OpenMS
     if (spectrum_index != map_.size() - 1 && !map_[spectrum_index + 1].empty())
     {
       const SpectrumType& spectrum_after = map_[spectrum_index + 1];
-      Size index_after = spectrum_after.findNearest(pos);
+      Size index_after = mz_index_.findNearest(spectrum_index + 1, pos);
       double mz_score = positionScore_(pos, spectrum_after[index_after].getMZ(), pattern_tolerance_);
       if (mz_score != 0.0)
       {
@@ -40,6 +40,7 @@
 
 #include <OpenMS/CONCEPT/LogStream.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/ChromatogramExtractor.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/DataAccessHelper.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SimpleOpenMSSpectraAccessFactory.h>
 #include <OpenMS/ANALYSIS/SVM/SimpleSVM.h>
 #include <OpenMS/ANALYSIS/MAPMATCHING/MapAlignmentAlgorithmIdentification.h>
@@ -54,6 +55,7 @@
 #include <fstream>
 #include <algorithm>
 #include <random>
+#include <exception>
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -304,8 +306,15 @@ namespace OpenMS
     feat_finder_.setParameters(params);
     feat_finder_.setLogType(ProgressLogger::NONE);
     feat_finder_.setStrictFlag(false);
+    // the MS1 data is only read from here on: share one copy between
+    // chromatogram extraction, MS1 Swath scores and all worker threads
+    // ("ms_data_" is reset after feature detection anyway):
+    boost::shared_ptr<PeakMap> shared = boost::make_shared<PeakMap>(std::move(ms_data_));
+    ms_data_.reset();
+    OpenSwath::SpectrumAccessPtr spec_temp =
+        SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(shared);
     // to use MS1 Swath scores:
-    feat_finder_.setMS1Map(SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(boost::make_shared<MSExperiment>(ms_data_)));
+    feat_finder_.setMS1Map(spec_temp);
 
     double rt_uncertainty(0);
     bool with_external_ids = !peptides_ext.empty();
@@ -449,9 +458,6 @@ namespace OpenMS
     }
     n_external_peps_ = peptide_map_.size() - n_internal_peps_;
 
-    boost::shared_ptr<PeakMap> shared = boost::make_shared<PeakMap>(ms_data_);
-    OpenSwath::SpectrumAccessPtr spec_temp =
-        SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(shared);
     auto chunks = chunk_(peptide_map_.begin(), peptide_map_.end(), batch_size_);
 
     PeptideRefRTMap ref_rt_map;
@@ -472,60 +478,88 @@ namespace OpenMS
     //-------------------------------------------------------------
     //Note: progress only works in non-debug when no logs come in-between
     getProgressLogger().startProgress(0, chunks.size(), "Creating assay library and extracting chromatograms");
+    // chunks are processed in waves of (at most) one chunk per thread:
+    // assay generation updates shared state (peptide map, isotope
+    // probabilities, RT map) and stays serial, while chromatogram extraction
+    // and OpenSWATH scoring of the chunks in a wave run concurrently
+#ifdef _OPENMP
+    const Size wave_size = std::max(1, omp_get_max_threads());
+#else
+    const Size wave_size = 1;
+#endif
+    // suppress status output from OpenSWATH, unless in debug mode:
+    if (debug_level_ < 1)
+    {
+      OpenMS_Log_info.remove(cout);
+    }
     Size chunk_count = 0;
-    for (auto& chunk : chunks)
+    while (chunk_count < chunks.size())
     {
-      //TODO since ref_rt_map is only used after chunking, we could create
-      // maps per chunk and merge them in the end. Would help in parallelizing as well.
-      createAssayLibrary_(chunk.first, chunk.second, ref_rt_map);
-      OPENMS_LOG_DEBUG << "#Transitions: " << library_.getTransitions().size() << endl;
-
-      ChromatogramExtractor extractor;
-      // extractor.setLogType(ProgressLogger::NONE);
+      const Size n_wave = std::min(wave_size, chunks.size() - chunk_count);
+      vector<TargetedExperiment> libraries(n_wave);
+      for (Size i = 0; i < n_wave; ++i)
       {
-        vector<OpenSwath::ChromatogramPtr> chrom_temp;
-        vector<ChromatogramExtractor::ExtractionCoordinates> coords;
-        // take entries in library_ and put to chrom_temp and coords
-        extractor.prepare_coordinates(chrom_temp, coords, library_,
-                                      numeric_limits<double>::quiet_NaN(), false);
-
-
-        extractor.extractChromatograms(spec_temp, chrom_temp, coords, mz_window_,
-                                       mz_window_ppm_, "tophat");
-        extractor.return_chromatogram(chrom_temp, coords, library_, (*shared)[0],
-                                      chrom_data_.getChromatograms(), false);
+        auto& chunk = chunks[chunk_count + i];
+        createAssayLibrary_(chunk.first, chunk.second, ref_rt_map);
+        libraries[i] = std::move(library_);
+        library_.clear(true);
       }
 
-      OPENMS_LOG_DEBUG << "Extracted " << chrom_data_.getNrChromatograms()
-                       << " chromatogram(s)." << endl;
-
-      OPENMS_LOG_DEBUG << "Detecting chromatographic peaks..." << endl;
-      // suppress status output from OpenSWATH, unless in debug mode:
-      if (debug_level_ < 1)
+      vector<FeatureMap> chunk_features(n_wave);
+      vector<std::exception_ptr> errors(n_wave);
+#pragma omp parallel for schedule(dynamic, 1)
+      for (SignedSize i = 0; i < SignedSize(n_wave); ++i)
       {
-        OpenMS_Log_info.remove(cout);
+        try
+        {
+          detectChunkFeatures_(libraries[i], spec_temp, (*shared)[0],
+                               chunk_features[i]);
+        }
+        catch (...)
+        {
+          errors[i] = std::current_exception();
+        }
+        libraries[i].clear(true); // free up memory as early as possible
+      }
+      for (const std::exception_ptr& error : errors)
+      {
+        if (error)
+        {
+          if (debug_level_ < 1)
+          {
+            OpenMS_Log_info.insert(cout); // revert logging change
+          }
+          std::rethrow_exception(error);
+        }
       }
-      feat_finder_.pickExperiment(chrom_data_, features, library_,
-                                  TransformationDescription(), ms_data_);
-      if (debug_level_ < 1)
+
+      // collect the results in chunk order (as in serial processing); the
+      // chunk maps only contain empty ProteinIdentification runs with
+      // colliding identifiers, which are dropped - the "real" proteins are
+      // added later:
+      for (FeatureMap& chunk_feat : chunk_features)
       {
-        OpenMS_Log_info.insert(cout); // revert logging change
+        features.reserve(features.size() + chunk_feat.size());
+        for (Feature& feat : chunk_feat)
+        {
+          features.push_back(std::move(feat));
+        }
       }
-      chrom_data_.clear(true);
-      library_.clear(true);
-      // since chrom_data_ here is just a container for the chromatograms and identifications will be empty,
-      // pickExperiment above will only add empty ProteinIdentification runs with colliding identifiers.
-      // Usually we could sanitize the identifiers or merge the runs, but since they are empty and we add the
-      // "real" proteins later -> just clear them
-      features.getProteinIdentifications().clear();
-      getProgressLogger().setProgress(++chunk_count);
+      chunk_count += n_wave;
+      getProgressLogger().setProgress(chunk_count);
+    }
+    if (debug_level_ < 1)
+    {
+      OpenMS_Log_info.insert(cout); // revert logging change
     }
     getProgressLogger().endProgress();
 
     OPENMS_LOG_INFO << "Found " << features.size() << " feature candidates in total."
                     << endl;
 
-    ms_data_.reset(); // not needed anymore, free up the memory
+    shared.reset(); // not needed anymore, free up the memory
+    spec_temp.reset();
+    feat_finder_.setMS1Map(OpenSwath::SpectrumAccessPtr());
     // complete feature annotation:
     annotateFeatures_(features, ref_rt_map);
 
@@ -646,6 +680,56 @@ namespace OpenMS
 
   }
 
+  void FeatureFinderIdentificationAlgorithm::detectChunkFeatures_(
+    const TargetedExperiment& library,
+    const OpenSwath::SpectrumAccessPtr& ms1_map,
+    const MSSpectrum& chrom_template,
+    FeatureMap& chunk_features) const
+  {
+    OPENMS_LOG_DEBUG << "#Transitions: " << library.getTransitions().size() << endl;
+
+    PeakMap chrom_data;
+    ChromatogramExtractor extractor;
+    {
+      vector<OpenSwath::ChromatogramPtr> chrom_temp;
+      vector<ChromatogramExtractor::ExtractionCoordinates> coords;
+      // take entries in library and put to chrom_temp and coords
+      extractor.prepare_coordinates(chrom_temp, coords, library,
+                                    numeric_limits<double>::quiet_NaN(), false);
+
+      extractor.extractChromatograms(ms1_map, chrom_temp, coords, mz_window_,
+                                     mz_window_ppm_, "tophat");
+      extractor.return_chromatogram(chrom_temp, coords, library, chrom_template,
+                                    chrom_data.getChromatograms(), false);
+    }
+
+    OPENMS_LOG_DEBUG << "Extracted " << chrom_data.getNrChromatograms()
+                     << " chromatogram(s)." << endl;
+
+    OPENMS_LOG_DEBUG << "Detecting chromatographic peaks..." << endl;
+    // the scoring class keeps per-assay state, so every chunk gets its own
+    // instance (configured like "feat_finder_"); the MS1 data is shared:
+    MRMFeatureFinderScoring feat_finder;
+    feat_finder.setParameters(feat_finder_.getParameters());
+    feat_finder.setLogType(ProgressLogger::NONE);
+    feat_finder.setStrictFlag(false);
+    // to use MS1 Swath scores:
+    feat_finder.setMS1Map(ms1_map);
+
+    OpenSwath::LightTargetedExperiment transition_exp;
+    OpenSwathDataAccessHelper::convertTargetedExp(library, transition_exp);
+    boost::shared_ptr<PeakMap> sh_chrom_data =
+      boost::make_shared<PeakMap>(std::move(chrom_data));
+    OpenSwath::SwathMap swath_map;
+    swath_map.sptr = ms1_map;
+    std::vector<OpenSwath::SwathMap> swath_maps(1, swath_map);
+    MRMFeatureFinderScoring::TransitionGroupMapType transition_group_map;
+    feat_finder.pickExperiment(
+      SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(sh_chrom_data),
+      chunk_features, transition_exp, TransformationDescription(), swath_maps,
+      transition_group_map);
+  }
+
   void FeatureFinderIdentificationAlgorithm::runOnCandidates(FeatureMap & features)
   {
     if ((svm_n_samples_ > 0) && (svm_n_samples_ < 2 * svm_n_parts_))
@@ -41,7 +41,13 @@
 #include <OpenMS/MATH/STATISTICS/StatisticFunctions.h>
 #include <OpenMS/COMPARISON/CLUSTERING/GridBasedClustering.h>
 
-#include<QDir>
+#include <QDir>
+
+#include <exception>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 using namespace std;
 
@@ -174,17 +180,39 @@ namespace OpenMS
     unsigned progress = 0;
     startProgress(0, filter_results.size(), "clustering filtered LC-MS data");
       
-    std::vector<std::map<int, GridBasedCluster> > cluster_results;
+    std::vector<std::map<int, GridBasedCluster> > cluster_results(filter_results.size());
 
     // loop over patterns i.e. cluster each of the corresponding filter results
-    for (unsigned i = 0; i < filter_results.size(); ++i)
+    // (The filter results of different patterns are independent, hence they are clustered in parallel.)
+    std::vector<std::exception_ptr> errors(filter_results.size());
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (SignedSize i = 0; i < (SignedSize) filter_results.size(); ++i)
     {
-      setProgress(++progress);
-        
-      GridBasedClustering<MultiplexDistance> clustering(MultiplexDistance(rt_scaling_), filter_results[i].getMZ(), filter_results[i].getRT(), grid_spacing_mz_, grid_spacing_rt_);
-      clustering.cluster();
-      //clustering.extendClustersY();
-      cluster_results.push_back(clustering.getResults());
+      try
+      {
+        GridBasedClustering<MultiplexDistance> clustering(MultiplexDistance(rt_scaling_), filter_results[i].getMZ(), filter_results[i].getRT(), grid_spacing_mz_, grid_spacing_rt_);
+        clustering.cluster();
+        //clustering.extendClustersY();
+        cluster_results[i] = clustering.getResults();
+      }
+      catch (...)
+      {
+        errors[i] = std::current_exception();
+      }
+
+      #pragma omp atomic
+      ++progress;
+      IF_MASTERTHREAD
+      {
+        setProgress(progress);
+      }
+    }
+    for (const std::exception_ptr& error : errors)
+    {
+      if (error)
+      {
+        std::rethrow_exception(error);
+      }
     }
 
     endProgress();
@@ -99,6 +99,8 @@ namespace OpenMS
     // reset both the white MS experiment and the corresponding mapping to the complete i.e. original MS experiment
     exp_centroided_white_.clear(true);
     exp_centroided_mapping_.clear();
+    exp_centroided_white_.reserve(exp_centroided_.size());
+    exp_centroided_mapping_.reserve(exp_centroided_.size());
     
     // loop over spectra
     for (const auto &it_rt : exp_centroided_)
@@ -106,21 +108,21 @@ namespace OpenMS
       MSSpectrum spectrum_picked_white;
       spectrum_picked_white.setRT(it_rt.getRT());
       
-      std::map<int, int> mapping_spectrum;
-      int count = 0;
+      const std::vector<int>& blacklist_spectrum = blacklist_[&it_rt - &exp_centroided_[0]];
+      std::vector<int> mapping_spectrum;
+      mapping_spectrum.reserve(it_rt.size());
+      spectrum_picked_white.reserve(it_rt.size());
       // loop over m/z
       for (const auto &it_mz : it_rt)
       {
-        if (blacklist_[&it_rt - &exp_centroided_[0]][&it_mz - &it_rt[0]] == -1)
+        if (blacklist_spectrum[&it_mz - &it_rt[0]] == -1)
         {
           spectrum_picked_white.push_back(it_mz);
-          
-          mapping_spectrum[count] = &it_mz - &it_rt[0];
-          ++count;
+          mapping_spectrum.push_back(&it_mz - &it_rt[0]);
         }
       }
-      exp_centroided_white_.addSpectrum(spectrum_picked_white);
-      exp_centroided_mapping_.push_back(mapping_spectrum);
+      exp_centroided_white_.addSpectrum(std::move(spectrum_picked_white));
+      exp_centroided_mapping_.push_back(std::move(mapping_spectrum));
     }
     exp_centroided_white_.updateRanges();
   }
@@ -202,7 +204,7 @@ namespace OpenMS
             // Note that as primary peaks, satellite peaks are also restricted by the blacklist.
             // The peak can either be pure white i.e. untouched, or have been seen earlier as part of the same mass trace.
             size_t rt_idx = it_rt - it_rt_begin;
-            size_t mz_idx = exp_centroided_mapping_.at(it_rt - it_rt_begin).at(i);
+            size_t mz_idx = exp_centroided_mapping_[rt_idx][i];
             
             // Check that the peak has not been blacklisted and is not already in the satellite set.
             if (((blacklist_[rt_idx][mz_idx] == -1) || (blacklist_[rt_idx][mz_idx] == static_cast<int>(mz_shift_idx))) && (!(peak.checkSatellite(rt_idx, mz_idx))))
@@ -399,6 +401,31 @@ namespace OpenMS
     
   }
   
+  std::pair<double, double> MultiplexFiltering::getBlacklistRange_(double mz, const MultiplexIsotopicPeakPattern& pattern) const
+  {
+    // same absolute m/z tolerance as in filterPeakPositions_() and blacklistPeak_()
+    double mz_tolerance;
+    if (mz_tolerance_unit_in_ppm_)
+    {
+      mz_tolerance = mz * mz_tolerance_ * 1e-6;
+    }
+    else
+    {
+      mz_tolerance = mz_tolerance_;
+    }
+
+    // The peak itself (shift zero) is part of the range, too.
+    double shift_min = 0;
+    double shift_max = 0;
+    for (size_t i = 0; i < pattern.getMZShiftCount(); ++i)
+    {
+      shift_min = std::min(shift_min, pattern.getMZShiftAt(i));
+      shift_max = std::max(shift_max, pattern.getMZShiftAt(i));
+    }
+
+    return std::make_pair(mz + shift_min - mz_tolerance, mz + shift_max + mz_tolerance);
+  }
+
   MSExperiment MultiplexFiltering::getBlacklist()
   {
     MSExperiment exp_blacklist;
@@ -425,28 +452,28 @@ namespace OpenMS
     return exp_blacklist;
   }
   
-  bool MultiplexFiltering::filterAveragineModel_(const MultiplexIsotopicPeakPattern& pattern, const MultiplexFilteredPeak& peak) const
+  IsotopeDistribution MultiplexFiltering::getAveragineDistribution_(double mass) const
   {
-    // construct averagine distribution
-    double mass = peak.getMZ() * pattern.getCharge();
     CoarseIsotopePatternGenerator solver(isotopes_per_peptide_max_);
-    IsotopeDistribution distribution;
     if (averagine_type_ == "peptide")
     {
-      distribution = solver.estimateFromPeptideWeight(mass);
+      return solver.estimateFromPeptideWeight(mass);
     }
     else if (averagine_type_ == "RNA")
     {
-      distribution = solver.estimateFromRNAWeight(mass);
+      return solver.estimateFromRNAWeight(mass);
     }
     else if (averagine_type_ == "DNA")
     {
-      distribution = solver.estimateFromDNAWeight(mass);
-    }
-    else
-    {
-      throw Exception::InvalidParameter(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Invalid averagine type.");
+      return solver.estimateFromDNAWeight(mass);
     }
+    throw Exception::InvalidParameter(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Invalid averagine type.");
+  }
+
+  bool MultiplexFiltering::filterAveragineModel_(const MultiplexIsotopicPeakPattern& pattern, const MultiplexFilteredPeak& peak) const
+  {
+    // construct averagine distribution
+    IsotopeDistribution distribution = getAveragineDistribution_(peak.getMZ() * pattern.getCharge());
     
     // loop over peptides
     for (size_t peptide = 0; peptide < pattern.getMassShiftCount(); ++peptide)
@@ -39,6 +39,9 @@
 #include <OpenMS/TRANSFORMATIONS/FEATUREFINDER/MultiplexFilteringCentroided.h>
 #include <OpenMS/MATH/STATISTICS/StatisticFunctions.h>
 
+#include <exception>
+#include <limits>
+
 #ifdef _OPENMP
 #include <omp.h>
 #endif
@@ -69,11 +72,15 @@ namespace OpenMS
     unsigned int start = clock();
 #endif
 
+    // candidate peaks of the current spectrum (kept between spectra to reuse their memory)
+    std::vector<MultiplexFilteredPeak> candidates;
+    std::vector<char> passed;
+
     // loop over all patterns
     for (unsigned pattern_idx = 0; pattern_idx < patterns_.size(); ++pattern_idx)
     {
       // current pattern
-      MultiplexIsotopicPeakPattern pattern = patterns_[pattern_idx];
+      const MultiplexIsotopicPeakPattern& pattern = patterns_[pattern_idx];
       
       // data structure storing peaks which pass all filters for this pattern
       MultiplexFilteredMSExperiment result;
@@ -99,39 +106,68 @@ namespace OpenMS
         MSExperiment::ConstIterator it_rt_band_begin = exp_centroided_white_.RTBegin(rt - rt_band_/2);
         MSExperiment::ConstIterator it_rt_band_end = exp_centroided_white_.RTEnd(rt + rt_band_/2);
         
-        // loop over m/z
-        //for (MSSpectrum::ConstIterator it_mz = it_rt.begin(); it_mz != it_rt.end(); ++it_mz)
-        #pragma omp parallel for
-        for (SignedSize s = 0; s < (SignedSize) it_rt.size(); s++)
+        // apply all filters to a peak
+        auto filterPeak = [&](MultiplexFilteredPeak& peak)
+        {
+          return filterPeakPositions_(peak.getMZ(), exp_centroided_white_.begin(), it_rt_band_begin, it_rt_band_end, pattern, peak) &&
+                 filterAveragineModel_(pattern, peak) &&
+                 filterPeptideCorrelation_(pattern, peak);
+        };
+
+        const SignedSize n_peaks = it_rt.size();
+        candidates.clear();
+        for (SignedSize s = 0; s < n_peaks; ++s)
+        {
+          candidates.emplace_back(it_rt[s].getMZ(), rt, exp_centroided_mapping_[idx_rt][s], idx_rt);
+        }
+        passed.assign(n_peaks, 0);
+
+        // Filter all peaks of the spectrum in parallel (with the blacklist as it is before this spectrum).
+        std::exception_ptr error;
+        SignedSize error_idx = n_peaks;
+        #pragma omp parallel for schedule(dynamic, 16)
+        for (SignedSize s = 0; s < n_peaks; ++s)
         {
-          auto& it_mz = it_rt[s];
-          double mz = it_mz.getMZ();
-          MultiplexFilteredPeak peak(mz, rt, exp_centroided_mapping_[idx_rt][s], idx_rt);
-          
-          if (!(filterPeakPositions_(mz, exp_centroided_white_.begin(), it_rt_band_begin, it_rt_band_end, pattern, peak)))
+          try
           {
-            continue;
+            passed[s] = filterPeak(candidates[s]);
           }
-          
-          if (!(filterAveragineModel_(pattern, peak)))
+          catch (...)
           {
-            continue;
+            #pragma omp critical (MultiplexFilteringCentroided_error)
+            if (s < error_idx)
+            {
+              error_idx = s;
+              error = std::current_exception();
+            }
           }
+        }
+        if (error)
+        {
+          std::rethrow_exception(error);
+        }
 
-          if (!(filterPeptideCorrelation_(pattern, peak)))
+        // Accept peaks in m/z order. A peak which might depend on blacklist entries set by an
+        // earlier peak of this spectrum is filtered again, so the result is the same as for
+        // filtering the peaks one after the other.
+        double blacklisted_up_to = -std::numeric_limits<double>::max();
+        for (SignedSize s = 0; s < n_peaks; ++s)
+        {
+          if (getBlacklistRange_(candidates[s].getMZ(), pattern).first <= blacklisted_up_to)
           {
-            continue;
+            candidates[s] = MultiplexFilteredPeak(it_rt[s].getMZ(), rt, exp_centroided_mapping_[idx_rt][s], idx_rt);
+            passed[s] = filterPeak(candidates[s]);
           }
-          
-          /**
-           * All filters passed.
-           */
 
-          #pragma omp critical
+          if (passed[s])
           {
-            result.addPeak(peak);
-            blacklistPeak_(peak, pattern_idx);
-          };
+            /**
+             * All filters passed.
+             */
+            result.addPeak(candidates[s]);
+            blacklistPeak_(candidates[s], pattern_idx);
+            blacklisted_up_to = std::max(blacklisted_up_to, getBlacklistRange_(candidates[s].getMZ(), pattern).second);
+          }
         }
       }
       
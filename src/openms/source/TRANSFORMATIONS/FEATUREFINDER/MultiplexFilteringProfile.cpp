@@ -40,8 +40,14 @@
 #include <OpenMS/TRANSFORMATIONS/FEATUREFINDER/MultiplexFilteringProfile.h>
 #include <OpenMS/MATH/STATISTICS/StatisticFunctions.h>
 
+#include <exception>
+#include <limits>
 #include <sstream>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 //#define DEBUG
 
 using namespace std;
@@ -132,18 +138,29 @@ namespace OpenMS
 #endif
     
     // construct navigators for all spline spectra
+    // (Navigators remember their last position, hence each thread gets its own set.)
     std::vector<SplineInterpolatedPeaks::Navigator> navigators;
     for (SplineInterpolatedPeaks& spl : exp_spline_profile_)
     {
       SplineInterpolatedPeaks::Navigator nav = spl.getNavigator();
       navigators.push_back(nav);
     }
+#ifdef _OPENMP
+    std::vector<std::vector<SplineInterpolatedPeaks::Navigator> > thread_navigators(omp_get_max_threads(), navigators);
+#else
+    std::vector<std::vector<SplineInterpolatedPeaks::Navigator> > thread_navigators(1, navigators);
+#endif
+    navigators.clear();
+
+    // candidate peaks of the current spectrum (kept between spectra to reuse their memory)
+    std::vector<MultiplexFilteredPeak> candidates;
+    std::vector<char> passed;
     
     // loop over all patterns
     for (unsigned pattern_idx = 0; pattern_idx < patterns_.size(); ++pattern_idx)
     {
       // current pattern
-      MultiplexIsotopicPeakPattern pattern = patterns_[pattern_idx];
+      const MultiplexIsotopicPeakPattern& pattern = patterns_[pattern_idx];
       
       // data structure storing peaks which pass all filters
       MultiplexFilteredMSExperiment result;
@@ -171,26 +188,25 @@ namespace OpenMS
         MSExperiment::ConstIterator it_rt_picked_band_begin = exp_centroided_white_.RTBegin(rt - rt_band_/2);
         MSExperiment::ConstIterator it_rt_picked_band_end = exp_centroided_white_.RTEnd(rt + rt_band_/2);
         
-        // loop over mz
-        #pragma omp parallel for
-        for (SignedSize s = 0; s < (SignedSize) it_rt.size(); s++)
+        // apply all filters to a peak (and add the spline-interpolated satellites which pass)
+        auto filterPeak = [&](MultiplexFilteredPeak& peak, std::vector<SplineInterpolatedPeaks::Navigator>& navigators)
         {
-          double mz = it_rt[s].getMZ();
-          MultiplexFilteredPeak peak(mz, rt, exp_centroided_mapping_[idx_rt][s], idx_rt);
-          
-          if (!(filterPeakPositions_(mz, exp_centroided_white_.begin(), it_rt_picked_band_begin, it_rt_picked_band_end, pattern, peak)))
+          if (!(filterPeakPositions_(peak.getMZ(), exp_centroided_white_.begin(), it_rt_picked_band_begin, it_rt_picked_band_end, pattern, peak)))
           {
-            continue;
+            return false;
           }
           
-          size_t mz_idx = exp_centroided_mapping_[idx_rt][s];
+          size_t mz_idx = peak.getMZidx();
           double peak_min = boundaries_[idx_rt][mz_idx].mz_min;
           double peak_max = boundaries_[idx_rt][mz_idx].mz_max;
           
           //double rt_peak = peak.getRT();
           double mz_peak = peak.getMZ();
 
-          std::multimap<size_t, MultiplexSatelliteCentroided > satellites = peak.getSatellites();
+          // Note that the peptide(s) are very close in mass. We therefore calculate the averagine distribution only once (for the lightest peptide).
+          IsotopeDistribution distribution = getAveragineDistribution_(mz_peak * pattern.getCharge());
+
+          const std::multimap<size_t, MultiplexSatelliteCentroided >& satellites = peak.getSatellites();
           
           // Arrangement of peaks looks promising. Now scan through the spline fitted profile data around the peak i.e. from peak boundary to peak boundary.
           for (double mz_profile = peak_min; mz_profile < peak_max; mz_profile = navigators[idx_rt].getNextPos(mz_profile))
@@ -223,7 +239,7 @@ namespace OpenMS
               satellites_profile.insert(std::make_pair(satellite_it.first, MultiplexSatelliteProfile(rt_satellite, mz, intensity)));
             }
             
-            if (!(filterAveragineModel_(pattern, peak, satellites_profile)))
+            if (!(filterAveragineModel_(pattern, distribution, satellites_profile)))
             {
               continue;
             }
@@ -246,15 +262,65 @@ namespace OpenMS
           }
           
           // If some satellite data points passed all filters, we can add the peak to the filter result.
-          if (peak.sizeProfile() > 0)
+          return peak.sizeProfile() > 0;
+        };
+
+        const SignedSize n_peaks = it_rt.size();
+        candidates.clear();
+        for (SignedSize s = 0; s < n_peaks; ++s)
+        {
+          candidates.emplace_back(it_rt[s].getMZ(), rt, exp_centroided_mapping_[idx_rt][s], idx_rt);
+        }
+        passed.assign(n_peaks, 0);
+
+        // Filter all peaks of the spectrum in parallel (with the blacklist as it is before this spectrum).
+        std::exception_ptr error;
+        SignedSize error_idx = n_peaks;
+        #pragma omp parallel for schedule(dynamic, 16)
+        for (SignedSize s = 0; s < n_peaks; ++s)
+        {
+#ifdef _OPENMP
+          std::vector<SplineInterpolatedPeaks::Navigator>& navigators = thread_navigators[omp_get_thread_num()];
+#else
+          std::vector<SplineInterpolatedPeaks::Navigator>& navigators = thread_navigators[0];
+#endif
+          try
+          {
+            passed[s] = filterPeak(candidates[s], navigators);
+          }
+          catch (...)
           {
-            #pragma omp critical
+            #pragma omp critical (MultiplexFilteringProfile_error)
+            if (s < error_idx)
             {
-              result.addPeak(peak);
-              blacklistPeak_(peak, pattern_idx);
-            };
+              error_idx = s;
+              error = std::current_exception();
+            }
+          }
+        }
+        if (error)
+        {
+          std::rethrow_exception(error);
+        }
+
+        // Accept peaks in m/z order. A peak which might depend on blacklist entries set by an
+        // earlier peak of this spectrum is filtered again, so the result is the same as for
+        // filtering the peaks one after the other.
+        double blacklisted_up_to = -std::numeric_limits<double>::max();
+        for (SignedSize s = 0; s < n_peaks; ++s)
+        {
+          if (getBlacklistRange_(candidates[s].getMZ(), pattern).first <= blacklisted_up_to)
+          {
+            candidates[s] = MultiplexFilteredPeak(it_rt[s].getMZ(), rt, exp_centroided_mapping_[idx_rt][s], idx_rt);
+            passed[s] = filterPeak(candidates[s], thread_navigators[0]);
+          }
+
+          if (passed[s])
+          {
+            result.addPeak(candidates[s]);
+            blacklistPeak_(candidates[s], pattern_idx);
+            blacklisted_up_to = std::max(blacklisted_up_to, getBlacklistRange_(candidates[s].getMZ(), pattern).second);
           }
-          
         }
         
       }
@@ -267,7 +333,7 @@ namespace OpenMS
 #endif
       
       // add results of this pattern to list
-      filter_results.push_back(result);
+      filter_results.push_back(std::move(result));
     }
     
 #ifdef DEBUG
@@ -285,30 +351,8 @@ namespace OpenMS
     return boundaries_;
   }
 
-  bool MultiplexFilteringProfile::filterAveragineModel_(const MultiplexIsotopicPeakPattern& pattern, const MultiplexFilteredPeak& peak, const std::multimap<size_t, MultiplexSatelliteProfile >& satellites_profile) const
+  bool MultiplexFilteringProfile::filterAveragineModel_(const MultiplexIsotopicPeakPattern& pattern, const IsotopeDistribution& distribution, const std::multimap<size_t, MultiplexSatelliteProfile >& satellites_profile) const
   {
-    // construct averagine distribution
-    // Note that the peptide(s) are very close in mass. We therefore calculate the averagine distribution only once (for the lightest peptide).
-    double mass = peak.getMZ() * pattern.getCharge();
-    CoarseIsotopePatternGenerator solver(isotopes_per_peptide_max_);
-    IsotopeDistribution distribution;
-    if (averagine_type_ == "peptide")
-    {
-      distribution = solver.estimateFromPeptideWeight(mass);
-    }
-    else if (averagine_type_ == "RNA")
-    {
-      distribution = solver.estimateFromRNAWeight(mass);
-    }
-    else if (averagine_type_ == "DNA")
-    {
-      distribution = solver.estimateFromDNAWeight(mass);
-    }
-    else
-    {
-      throw Exception::InvalidParameter(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Invalid averagine type.");
-    }   
-    
     // loop over peptides
     for (size_t peptide = 0; peptide < pattern.getMassShiftCount(); ++peptide)
     {
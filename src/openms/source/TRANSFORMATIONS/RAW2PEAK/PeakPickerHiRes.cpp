@@ -42,6 +42,12 @@
 #include <OpenMS/MATH/MISC/CubicSpline2d.h>
 #include <OpenMS/KERNEL/SpectrumHelper.h>
 
+#include <exception>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 
 using namespace std;
 
@@ -460,6 +466,93 @@ namespace OpenMS
     uint32_t total{0};  ///< overall number of spectra
   };
 
+  namespace
+  {
+    /**
+      @brief Calls @p f(i) for all i in [0, n), in parallel if OpenMP is available.
+
+      Exceptions cannot leave an OpenMP region, therefore they are caught per
+      iteration and the one thrown for the smallest index is rethrown after
+      all iterations have finished (i.e. the same one a serial loop would throw).
+    */
+    template <typename FunctionType>
+    void parallelForOrdered_(SignedSize n, FunctionType f)
+    {
+      std::exception_ptr error;
+      SignedSize error_idx = n;
+#pragma omp parallel for schedule(dynamic, 1)
+      for (SignedSize i = 0; i < n; ++i)
+      {
+        try
+        {
+          f(i);
+        }
+        catch (...)
+        {
+#pragma omp critical (PeakPickerHiRes_error)
+          {
+            if (i < error_idx)
+            {
+              error_idx = i;
+              error = std::current_exception();
+            }
+          }
+        }
+      }
+      if (error)
+      {
+        std::rethrow_exception(error);
+      }
+    }
+  }
+
+  bool PeakPickerHiRes::isPickable_(const MSSpectrum& input, const bool check_spectrum_type, const bool query_data) const
+  {
+    // auto mode
+    if (ms_levels_.empty())
+    {
+      SpectrumSettings::SpectrumType spectrum_type = input.getType(query_data); // uses meta-info and inspects data if requested
+      return spectrum_type != SpectrumSettings::CENTROID;
+    }
+    // manual mode
+    if (!ListUtils::contains(ms_levels_, input.getMSLevel()))
+    {
+      return false;
+    }
+    if (check_spectrum_type && input.getType(query_data) == SpectrumSettings::CENTROID)
+    {
+      throw OpenMS::Exception::IllegalArgument(__FILE__, __LINE__, __FUNCTION__, "Error: Centroided data provided but profile spectra expected.");
+    }
+    return true;
+  }
+
+  bool PeakPickerHiRes::pickOrCopy(const MSSpectrum& input, MSSpectrum& output, std::vector<PeakBoundary>& boundaries, const bool check_spectrum_type, const bool query_data) const
+  {
+    boundaries.clear();
+    if (!isPickable_(input, check_spectrum_type, query_data))
+    {
+      output = input;
+      return false;
+    }
+
+    pick(input, output, boundaries);
+    return true;
+  }
+
+  bool PeakPickerHiRes::pickInPlace(MSSpectrum& spectrum, std::vector<PeakBoundary>& boundaries, const bool check_spectrum_type, const bool query_data) const
+  {
+    boundaries.clear();
+    if (!isPickable_(spectrum, check_spectrum_type, query_data))
+    {
+      return false;
+    }
+
+    MSSpectrum picked;
+    pick(spectrum, picked, boundaries);
+    spectrum = std::move(picked);
+    return true;
+  }
+
   void PeakPickerHiRes::pickExperiment(const PeakMap& input,
                                        PeakMap& output, 
                                        std::vector<std::vector<PeakBoundary> >& boundaries_spec, 
@@ -478,63 +571,42 @@ namespace OpenMS
     Size progress = 0;
     startProgress(0, input.size() + input.getChromatograms().size(), "picking peaks");
 
+    // spectra are picked independently of each other; boundaries and statistics are collected in scan order afterwards
+    std::vector<std::vector<PeakBoundary> > boundaries_per_scan(input.size());
+    std::vector<char> was_picked(input.size(), 0);
+    parallelForOrdered_(input.size(), [&](SignedSize scan_idx)
+    {
+      was_picked[scan_idx] = pickOrCopy(input[scan_idx], output[scan_idx], boundaries_per_scan[scan_idx], check_spectrum_type);
+#pragma omp atomic
+      ++progress;
+      IF_MASTERTHREAD setProgress(progress);
+    });
+
     // MSLevel -> stats
     map<int, SpectraPickInfo> pick_info;
-
-    if (input.getNrSpectra() > 0)
+    for (Size scan_idx = 0; scan_idx != input.size(); ++scan_idx)
     {
-      for (Size scan_idx = 0; scan_idx != input.size(); ++scan_idx)
+      if (was_picked[scan_idx])
       {
-        bool was_picked{false};
-        // auto mode
-        if (ms_levels_.empty()) 
-        {
-          SpectrumSettings::SpectrumType spectrum_type = input[scan_idx].getType(true); // uses meta-info and inspects data if needed
-          if (spectrum_type == SpectrumSettings::CENTROID)
-          {
-            output[scan_idx] = input[scan_idx];
-          }
-          else
-          {
-            std::vector<PeakBoundary> boundaries_s; // peak boundaries of a single spectrum
-            pick(input[scan_idx], output[scan_idx], boundaries_s);
-            was_picked = true;
-            boundaries_spec.push_back(std::move(boundaries_s));
-          }
-        }
-        // manual mode
-        else if (!ListUtils::contains(ms_levels_, input[scan_idx].getMSLevel())) 
-        {
-          output[scan_idx] = input[scan_idx];
-        }
-        else
-        {
-          std::vector<PeakBoundary> boundaries_s; // peak boundaries of a single spectrum
-          SpectrumSettings::SpectrumType spectrum_type = input[scan_idx].getType(true); // uses meta-info and inspects data if needed
-          if (spectrum_type == SpectrumSettings::CENTROID && check_spectrum_type)
-          {
-            throw OpenMS::Exception::IllegalArgument(__FILE__, __LINE__, __FUNCTION__, "Error: Centroided data provided but profile spectra expected.");
-          }
-
-          pick(input[scan_idx], output[scan_idx], boundaries_s);
-          was_picked = true;
-          boundaries_spec.push_back(std::move(boundaries_s));
-        }
-        pick_info[input[scan_idx].getMSLevel()].picked += was_picked;
-        ++pick_info[input[scan_idx].getMSLevel()].total;
-        setProgress(++progress);
+        boundaries_spec.push_back(std::move(boundaries_per_scan[scan_idx]));
       }
+      pick_info[input[scan_idx].getMSLevel()].picked += was_picked[scan_idx];
+      ++pick_info[input[scan_idx].getMSLevel()].total;
     }
 
-
-    for (Size i = 0; i < input.getChromatograms().size(); ++i)
+    std::vector<MSChromatogram> chromatograms(input.getChromatograms().size());
+    std::vector<std::vector<PeakBoundary> > boundaries_per_chrom(chromatograms.size());
+    parallelForOrdered_(chromatograms.size(), [&](SignedSize i)
     {
-      MSChromatogram chromatogram;
-      std::vector<PeakBoundary> boundaries_c; // peak boundaries of a single chromatogram
-      pick(input.getChromatograms()[i], chromatogram, boundaries_c);
-      output.addChromatogram(chromatogram);
-      boundaries_chrom.push_back(boundaries_c);
-      setProgress(++progress);
+      pick(input.getChromatograms()[i], chromatograms[i], boundaries_per_chrom[i]);
+#pragma omp atomic
+      ++progress;
+      IF_MASTERTHREAD setProgress(progress);
+    });
+    output.setChromatograms(std::move(chromatograms));
+    for (auto& boundaries_c : boundaries_per_chrom)
+    {
+      boundaries_chrom.push_back(std::move(boundaries_c));
     }
     endProgress();
 
@@ -561,54 +633,36 @@ namespace OpenMS
     // resize output with respect to input
     output.resize(input.size());
 
-    if (input.getNrSpectra() > 0)
+    // reading from disc is not thread-safe: load a batch of spectra serially, then pick the batch in parallel
+#ifdef _OPENMP
+    const Size batch_size = 64 * omp_get_max_threads();
+#else
+    const Size batch_size = 64;
+#endif
+    for (Size batch_start = 0; batch_start < input.size(); batch_start += batch_size)
     {
-      for (Size scan_idx = 0; scan_idx != input.size(); ++scan_idx)
+      // spectra are read directly into their output slot and picked (or kept) there
+      const Size batch_end = std::min(batch_start + batch_size, (Size)input.size());
+      for (Size scan_idx = batch_start; scan_idx != batch_end; ++scan_idx)
       {
-        if (ms_levels_.empty()) //auto mode
-        {
-          MSSpectrum s = input[scan_idx];
-          s.sortByPosition();
-
-          // determine type of spectral data (profile or centroided)
-          SpectrumSettings::SpectrumType spectrumType = s.getType();
-          if (spectrumType == SpectrumSettings::CENTROID)
-          {
-            output[scan_idx] = input[scan_idx];
-          }
-          else
-          {
-            pick(s, output[scan_idx]);
-          }
-        }
-        else if (!ListUtils::contains(ms_levels_, input[scan_idx].getMSLevel())) // manual mode
-        {
-          output[scan_idx] = input[scan_idx];
-        }
-        else
-        {
-          MSSpectrum s = input[scan_idx];
-          s.sortByPosition();
-
-          // determine type of spectral data (profile or centroided)
-          SpectrumSettings::SpectrumType spectrum_type = s.getType();
-
-          if (spectrum_type == SpectrumSettings::CENTROID && check_spectrum_type)
-          {
-            throw OpenMS::Exception::IllegalArgument(__FILE__, __LINE__, __FUNCTION__, "Error: Centroided data provided but profile spectra expected.");
-          }
-
-          pick(s, output[scan_idx]);
-        }
-        setProgress(++progress);
+        output[scan_idx] = input[scan_idx];
       }
+      parallelForOrdered_(batch_end - batch_start, [&](SignedSize i)
+      {
+        MSSpectrum& s = output[batch_start + i];
+        s.sortByPosition();
+        std::vector<PeakBoundary> boundaries_s;
+        pickInPlace(s, boundaries_s, check_spectrum_type, false);
+      });
+      progress += batch_end - batch_start;
+      setProgress(progress);
     }
 
     for (Size i = 0; i < input.getNrChromatograms(); ++i)
     {
       MSChromatogram chromatogram;
       pick(input.getChromatogram(i), chromatogram);
-      output.addChromatogram(chromatogram);
+      output.addChromatogram(std::move(chromatogram));
       setProgress(++progress);
     }
     endProgress();
@@ -0,0 +1,165 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Timo Sachsenberg $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/TRANSFORMATIONS/RAW2PEAK/PeakPickerHiResConsumer.h>
+
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/CONCEPT/LogStream.h>
+#include <OpenMS/KERNEL/MSChromatogram.h>
+#include <OpenMS/KERNEL/MSSpectrum.h>
+
+#include <exception>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace OpenMS
+{
+
+  PeakPickerHiResConsumer::PeakPickerHiResConsumer(const PeakPickerHiRes& pp, Interfaces::IMSDataConsumer* next, bool check_spectrum_type, Size batch_size) :
+    pp_(pp),
+    next_(next),
+    check_spectrum_type_(check_spectrum_type),
+    batch_size_(batch_size),
+    nr_picked_(0)
+  {
+    if (next_ == nullptr)
+    {
+      throw Exception::MissingInformation(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "PeakPickerHiResConsumer requires a consumer to forward the picked data to.");
+    }
+    if (batch_size_ == 0)
+    {
+#ifdef _OPENMP
+      batch_size_ = 64 * omp_get_max_threads();
+#else
+      batch_size_ = 64;
+#endif
+    }
+    buffer_.reserve(batch_size_);
+  }
+
+  PeakPickerHiResConsumer::~PeakPickerHiResConsumer()
+  {
+    try
+    {
+      flush();
+    }
+    catch (std::exception& e)
+    {
+      OPENMS_LOG_ERROR << "PeakPickerHiResConsumer: " << buffer_.size() << " spectra could not be processed: " << e.what() << std::endl;
+    }
+  }
+
+  void PeakPickerHiResConsumer::setExperimentalSettings(const ExperimentalSettings& settings)
+  {
+    next_->setExperimentalSettings(settings);
+  }
+
+  void PeakPickerHiResConsumer::setExpectedSize(Size expected_spectra, Size expected_chromatograms)
+  {
+    next_->setExpectedSize(expected_spectra, expected_chromatograms);
+  }
+
+  void PeakPickerHiResConsumer::consumeSpectrum(SpectrumType& s)
+  {
+    buffer_.push_back(std::move(s));
+    if (buffer_.size() >= batch_size_)
+    {
+      flush();
+    }
+  }
+
+  void PeakPickerHiResConsumer::consumeChromatogram(ChromatogramType& c)
+  {
+    flush();
+    ChromatogramType c_out;
+    pp_.pick(c, c_out);
+    next_->consumeChromatogram(c_out);
+  }
+
+  void PeakPickerHiResConsumer::flush()
+  {
+    if (buffer_.empty())
+    {
+      return;
+    }
+
+    std::exception_ptr error;
+    SignedSize error_idx = buffer_.size();
+    Size nr_picked = 0;
+#pragma omp parallel for schedule(dynamic, 1) reduction(+: nr_picked)
+    for (SignedSize i = 0; i < (SignedSize)buffer_.size(); ++i)
+    {
+      try
+      {
+        std::vector<PeakPickerHiRes::PeakBoundary> boundaries;
+        nr_picked += pp_.pickInPlace(buffer_[i], boundaries, check_spectrum_type_);
+      }
+      catch (...)
+      {
+#pragma omp critical (PeakPickerHiResConsumer_error)
+        {
+          if (i < error_idx)
+          {
+            error_idx = i;
+            error = std::current_exception();
+          }
+        }
+      }
+    }
+    if (error)
+    {
+      buffer_.clear();
+      std::rethrow_exception(error);
+    }
+    nr_picked_ += nr_picked;
+
+    // spectra were picked in place; empty the buffer before forwarding in case the next consumer throws
+    std::vector<SpectrumType> picked;
+    picked.swap(buffer_);
+    buffer_.reserve(batch_size_);
+    for (SpectrumType& s : picked)
+    {
+      next_->consumeSpectrum(s);
+    }
+  }
+
+  Size PeakPickerHiResConsumer::getNrPickedSpectra() const
+  {
+    return nr_picked_;
+  }
+
+} // namespace OpenMS
+
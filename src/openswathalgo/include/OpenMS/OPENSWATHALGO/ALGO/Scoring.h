@@ -137,6 +137,25 @@ public:
     OPENSWATHALGO_DLLAPI XCorrArrayType calculateCrossCorrelation(const std::vector<double>& data1,
                                                                   const std::vector<double>& data2, const int maxdelay, const int lag);
 
+    /**
+      @brief Calculate only the highest apex of the crosscorrelation of two already normalized arrays
+
+      Equivalent to xcorrArrayGetMaxPeak(normalizedCrossCorrelationPost(...)) but
+      without materializing the (lag, correlation) array. This is the fast path for
+      scores that only need the delay and height of the apex.
+
+      @param normalized_data1 First standardized array of length @p datasize
+      @param normalized_data2 Second standardized array of length @p datasize
+      @param datasize Number of elements in both arrays
+      @param maxdelay Maximal (absolute) delay to consider
+      @param lag Step size between two delays
+      @param sxy Scratch buffer (reused between calls to avoid allocations)
+
+      @return (delay, correlation) of the first maximal entry
+    */
+    OPENSWATHALGO_DLLAPI XCorrEntry normalizedCrossCorrelationMaxPeak(const double* normalized_data1, const double* normalized_data2,
+                                                                      const int datasize, const int maxdelay, const int lag, std::vector<double>& sxy);
+
     /// Find best peak in an cross-correlation (highest apex)
     OPENSWATHALGO_DLLAPI XCorrArrayType::const_iterator xcorrArrayGetMaxPeak(const XCorrArrayType & array);
 
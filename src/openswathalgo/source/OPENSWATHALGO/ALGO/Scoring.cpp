@@ -178,31 +178,89 @@ namespace OpenSwath::Scoring
       return result;
     }
 
+    /// Accumulate the (unnormalized) cross-correlation of @p data1 and @p data2 for all
+    /// delays -maxdelay, -maxdelay + lag, ..., maxdelay into @p sxy.
+    ///
+    /// The loops are swapped compared to the textbook formulation: the outer loop runs
+    /// over the data points and the inner loop over the delays, restricted to those
+    /// delays for which the partner index is in range. Each delay thus owns its own
+    /// accumulator which is summed in exactly the same order as before (bit-identical
+    /// results) while the inner loop has no branches and can be auto-vectorized.
+    static void crossCorrelationSums_(const double* data1, const double* data2, const int datasize,
+                                      const int maxdelay, const int lag, std::vector<double>& sxy)
+    {
+      const int nr_delays = 2 * maxdelay / lag + 1;
+      sxy.assign(nr_delays, 0.0);
+      double* s = sxy.data();
+      for (int i = 0; i < datasize; ++i)
+      {
+        // delay -maxdelay + k * lag is valid iff 0 <= i - maxdelay + k * lag < datasize
+        const int lower = maxdelay - i;
+        const int k_begin = lower > 0 ? (lower + lag - 1) / lag : 0;
+        const int k_end = std::min(nr_delays, (datasize - 1 + maxdelay - i) / lag + 1);
+        const double a = data1[i];
+        const int offset = i - maxdelay;
+        if (lag == 1)
+        {
+          for (int k = k_begin; k < k_end; ++k)
+          {
+            s[k] += a * data2[offset + k];
+          }
+        }
+        else
+        {
+          for (int k = k_begin; k < k_end; ++k)
+          {
+            s[k] += a * data2[offset + k * lag];
+          }
+        }
+      }
+    }
+
     XCorrArrayType calculateCrossCorrelation(const std::vector<double>& data1,
                                              const std::vector<double>& data2, const int maxdelay, const int lag)
     {
       OPENSWATH_PRECONDITION(data1.size() == data2.size(), "Both data vectors need to have the same length");
+      OPENSWATH_PRECONDITION(lag > 0, "Lag needs to be positive");
 
       XCorrArrayType result;
-      result.data.reserve( (size_t)std::ceil((2*maxdelay + 1) / lag));
-      int datasize = static_cast<int>(data1.size());
-      int i, j, delay;
+      if (maxdelay < 0)
+      {
+        return result;
+      }
+
+      std::vector<double> sxy;
+      crossCorrelationSums_(data1.data(), data2.data(), static_cast<int>(data1.size()), maxdelay, lag, sxy);
 
-      for (delay = -maxdelay; delay <= maxdelay; delay = delay + lag)
+      result.data.reserve(sxy.size());
+      int delay = -maxdelay;
+      for (std::size_t k = 0; k < sxy.size(); ++k, delay += lag)
       {
-        double sxy = 0;
-        for (i = 0; i < datasize; ++i)
+        result.data.push_back(std::make_pair(delay, sxy[k]));
+      }
+      return result;
+    }
+
+    XCorrEntry normalizedCrossCorrelationMaxPeak(const double* normalized_data1, const double* normalized_data2,
+                                                 const int datasize, const int maxdelay, const int lag, std::vector<double>& sxy)
+    {
+      OPENSWATH_PRECONDITION(maxdelay >= 0 && lag > 0, "Need a non-negative maximal delay and a positive lag");
+
+      crossCorrelationSums_(normalized_data1, normalized_data2, datasize, maxdelay, lag, sxy);
+
+      // same semantics as xcorrArrayGetMaxPeak(normalizedCrossCorrelationPost(...)):
+      // first (lowest delay) occurrence of the maximum wins
+      XCorrEntry max_peak(-maxdelay, sxy[0] / datasize);
+      int delay = -maxdelay;
+      for (std::size_t k = 0; k < sxy.size(); ++k, delay += lag)
+      {
+        const double value = sxy[k] / datasize;
+        if (value > max_peak.second)
         {
-          j = i + delay;
-          if (j < 0 || j >= datasize)
-          {
-            continue;
-          }
-          sxy += (data1[i]) * (data2[j]);
+          max_peak = std::make_pair(delay, value);
         }
-        result.data.push_back(std::make_pair(delay, sxy));
       }
-      return result;
+      return max_peak;
     }
 
     XCorrArrayType calcxcorr_legacy_mquest_(std::vector<double>& data1,
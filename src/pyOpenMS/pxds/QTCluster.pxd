@@ -32,3 +32,4 @@ cdef extern from "<OpenMS/DATASTRUCTURES/QTCluster.h>" namespace "OpenMS":
         void finalizeCluster() nogil except + # wrap-doc:Has to be called after adding elements (after calling QTCluster::add one or multiple times)
         # NAMESPACE # # POINTER # OpenMSBoost::unordered_map[ Size, libcpp_vector[ GridFeature * ] ] getAllNeighbors() nogil except +
         # NeighborMap getNeighbors() nogil except +
+        # POINTER # void reselectNeighbors(libcpp_unordered_set[ GridFeature * ] & used) nogil except +
@@ -71,6 +71,7 @@ set(datastructures_executables_list
   ParamValue_test
   QTCluster_test
   RangeManager_test
+  StaticKDTree_test
   StringListUtils_test
   StringUtils_test
   String_test
@@ -151,6 +152,7 @@ set(kernel_executables_list
   DPeak_test
   FeatureMap_test
   Feature_test
+  FlatPeakIndex_test
   MassTrace_test
   Mobilogram_test
   MobilityPeak1D_test
@@ -270,12 +272,14 @@ set(format_executables_list
   XTandemXMLFile_test
   ZlibCompression_test
   # DATAACCESS
+  ConsensusXMLWritingConsumer_test
   MSDataCachedConsumer_test
   MSDataTransformingConsumer_test
   MSDataChainingConsumer_test
   MSDataStoringConsumer_test
   MSDataAggregatingConsumer_test
   SpectrumAccessQuadMZTransforming_test
+  SpectrumAccessStrided_test
   SpectrumAccessSqMass_test
   SiriusFragmentAnnotation_test
 )
@@ -625,6 +629,7 @@ set(transformations_executables_list
   OptimizePick_test
   PeakPickerCWT_test
   PeakPickerHiRes_test
+  PeakPickerHiResConsumer_test
   PeakPickerIterative_test
   PeakPickerMaxima_test
   PeakPickerSH_test
@@ -674,6 +679,8 @@ if(NOT DISABLE_OPENSWATH)
     MRMRTNormalizer_test
     TransitionTSVFile_test
     TransitionPQPFile_test
+    SwathWindowLibrary_test
+    OpenSwathWorkflow_test
     ChromatogramExtractor_test
     ChromatogramExtractorAlgorithm_test
     OpenSwathHelper_test
@@ -432,6 +432,51 @@ START_SECTION((void insert(const ConsensusFeature& cf)))
   TEST_EQUAL(it->getIntensity(),200)
   ++it;
   TEST_EQUAL(it==cons_t.end(), true)
+
+  // interleaved handles are merged in order, handles already contained are skipped
+  ConsensusFeature cons2;
+  FeatureHandle h3(3,tmp_feature);
+  h3.setUniqueId(1);
+  cons2.insert(h3);
+  cons2.insert(h1);
+  cons_t.insert(cons2);
+  TEST_EQUAL(cons_t.size(), 3)
+  it = cons_t.begin();
+  TEST_EQUAL(it->getMapIndex(),2)
+  ++it;
+  TEST_EQUAL(it->getMapIndex(),3)
+  ++it;
+  TEST_EQUAL(it->getMapIndex(),4)
+END_SECTION
+
+START_SECTION([EXTRA](many feature handles))
+  // several handles, inserted in reverse order
+  ConsensusFeature cons;
+  for (UInt64 i = 0; i < 100; ++i)
+  {
+    FeatureHandle h(99 - i, tmp_feature);
+    h.setUniqueId(i);
+    cons.insert(h);
+  }
+  TEST_EQUAL(cons.size(), 100)
+  UInt64 map_index = 0;
+  bool sorted = true;
+  for (ConsensusFeature::const_iterator it = cons.begin(); it != cons.end(); ++it, ++map_index)
+  {
+    sorted &= (it->getMapIndex() == map_index);
+  }
+  TEST_EQUAL(sorted, true)
+  FeatureHandle duplicate(50, tmp_feature);
+  duplicate.setUniqueId(49);
+  TEST_EXCEPTION(Exception::InvalidValue, cons.insert(duplicate))
+  TEST_EQUAL(cons.size(), 100)
+
+  // copies and moves keep all handles
+  ConsensusFeature cons_copy(cons);
+  TEST_EQUAL(cons_copy.size(), 100)
+  ConsensusFeature cons_moved(std::move(cons_copy));
+  TEST_EQUAL(cons_moved.size(), 100)
+  TEST_EQUAL(cons_moved.getFeatureList()[42].getMapIndex(), 42)
 END_SECTION
 
 START_SECTION((void insert(const FeatureHandle &handle)))
@@ -488,6 +533,18 @@ START_SECTION((void computeConsensus()))
   TEST_REAL_SIMILAR(cons.getIntensity(),300.0)
   TEST_REAL_SIMILAR(cons.getRT(),2.0)
   TEST_REAL_SIMILAR(cons.getMZ(),3.0)
+
+  // the most frequent charge wins, ties prefer smaller absolute charges
+  ConsensusFeature charges;
+  Int charge_values[] = {3, -2, 3, 2, -2};
+  for (UInt64 i = 0; i < 5; ++i)
+  {
+    FeatureHandle h(i, tmp_feature);
+    h.setCharge(charge_values[i]);
+    charges.insert(h);
+  }
+  charges.computeConsensus();
+  TEST_EQUAL(charges.getCharge(), -2)
 END_SECTION
 
 START_SECTION((void computeMonoisotopicConsensus()))
@@ -0,0 +1,169 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/FORMAT/DATAACCESS/ConsensusXMLWritingConsumer.h>
+#include <OpenMS/FORMAT/ConsensusXMLFile.h>
+///////////////////////////
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(ConsensusXMLWritingConsumer, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+ConsensusXMLWritingConsumer* ptr = nullptr;
+ConsensusXMLWritingConsumer* null_ptr = nullptr;
+START_SECTION((explicit ConsensusXMLWritingConsumer(const String& filename)))
+{
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  ptr = new ConsensusXMLWritingConsumer(tmp_filename);
+  TEST_NOT_EQUAL(ptr, null_ptr)
+}
+END_SECTION
+
+START_SECTION((~ConsensusXMLWritingConsumer()))
+{
+  delete ptr;
+}
+END_SECTION
+
+ConsensusMap map;
+ConsensusXMLFile().load(OPENMS_GET_TEST_DATA_PATH("ConsensusXMLFile_1.consensusXML"), map);
+
+START_SECTION((void setHeader(const ConsensusMap& header)))
+{
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  ConsensusXMLWritingConsumer consumer(tmp_filename);
+  consumer.setHeader(map);
+  consumer.consume(map[0]);
+  TEST_EXCEPTION(Exception::IllegalArgument, consumer.setHeader(map))
+}
+END_SECTION
+
+START_SECTION((void consume(const ConsensusFeature& feature)))
+{
+  // writing the features one by one gives the same file as storing the whole map
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  {
+    ConsensusXMLWritingConsumer consumer(tmp_filename);
+    consumer.setHeader(map);
+    for (Size i = 0; i < map.size(); ++i)
+    {
+      consumer.consume(map[i]);
+    }
+    consumer.close();
+    TEST_EQUAL(consumer.getNrFeaturesWritten(), map.size())
+  }
+  WHITELIST("?xml-stylesheet")
+  TEST_FILE_SIMILAR(OPENMS_GET_TEST_DATA_PATH("ConsensusXMLFile_1.consensusXML"), tmp_filename)
+}
+END_SECTION
+
+START_SECTION((void consume(const ConsensusMap& map)))
+{
+  // consume two batches; the header comes from setHeader only
+  ConsensusMap first = map, second = map;
+  first.resize(1);
+  second.erase(second.begin());
+  second.getColumnHeaders().clear();
+
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  ConsensusXMLWritingConsumer consumer(tmp_filename);
+  consumer.setHeader(map);
+  consumer.consume(first);
+  consumer.consume(second);
+  consumer.close();
+  TEST_EQUAL(consumer.getNrFeaturesWritten(), map.size())
+
+  ConsensusMap loaded;
+  ConsensusXMLFile().load(tmp_filename, loaded);
+  TEST_EQUAL(loaded.size(), map.size())
+  TEST_EQUAL(loaded.getColumnHeaders().size(), map.getColumnHeaders().size())
+  TEST_EQUAL(loaded.getProteinIdentifications().size(), map.getProteinIdentifications().size())
+  ABORT_IF(loaded.size() != map.size())
+  for (Size i = 0; i < map.size(); ++i)
+  {
+    TEST_EQUAL(loaded[i].getUniqueId(), map[i].getUniqueId())
+    TEST_REAL_SIMILAR(loaded[i].getRT(), map[i].getRT())
+    TEST_REAL_SIMILAR(loaded[i].getMZ(), map[i].getMZ())
+    TEST_EQUAL(loaded[i].size(), map[i].size())
+    TEST_EQUAL(loaded[i].getPeptideIdentifications().size(), map[i].getPeptideIdentifications().size())
+  }
+}
+END_SECTION
+
+START_SECTION((void close()))
+{
+  // an empty document is still valid
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  ConsensusXMLWritingConsumer consumer(tmp_filename);
+  consumer.setHeader(map);
+  consumer.close();
+  consumer.close(); // no-op
+  TEST_EXCEPTION(Exception::IllegalArgument, consumer.consume(map[0]))
+
+  ConsensusMap loaded;
+  ConsensusXMLFile().load(tmp_filename, loaded);
+  TEST_EQUAL(loaded.size(), 0)
+  TEST_EQUAL(loaded.getColumnHeaders().size(), map.getColumnHeaders().size())
+  TEST_EQUAL(ConsensusXMLFile().isValid(tmp_filename, std::cerr), true)
+}
+END_SECTION
+
+START_SECTION((Size getNrFeaturesWritten() const))
+{
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  ConsensusXMLWritingConsumer consumer(tmp_filename);
+  TEST_EQUAL(consumer.getNrFeaturesWritten(), 0)
+  consumer.setHeader(map);
+  consumer.consume(map);
+  TEST_EQUAL(consumer.getNrFeaturesWritten(), map.size())
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
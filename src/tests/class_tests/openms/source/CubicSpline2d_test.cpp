@@ -37,6 +37,8 @@
 
 #include <OpenMS/MATH/MISC/CubicSpline2d.h>
 
+#include <algorithm>
+
 using namespace OpenMS;
 
 START_TEST(CubicSpline2d, "$Id$")
@@ -137,6 +139,32 @@ START_SECTION(double eval(double x))
   }
 END_SECTION
 
+START_SECTION(void eval(const double* begin, const double* end, double* result) const)
+  // sorted positions, including the nodes and both ends of the range
+  std::vector<double> xx;
+  for (Size i = 0; i < (n+6); ++i)
+  {
+    xx.push_back(x_min + (double)i/(n+5)*(x_max-x_min));
+  }
+  xx.insert(xx.end(), x.begin(), x.end());
+  std::sort(xx.begin(), xx.end());
+  std::vector<double> result(xx.size());
+  sp5.eval(&xx.front(), &xx.front() + xx.size(), &result.front());
+  for (Size i = 0; i < xx.size(); ++i)
+  {
+    TEST_EQUAL(result[i], sp5.eval(xx[i]));
+  }
+  // in place
+  std::vector<double> in_place(xx);
+  sp5.eval(&in_place.front(), &in_place.front() + in_place.size(), &in_place.front());
+  TEST_EQUAL(in_place == result, true);
+  // nothing to do
+  sp5.eval(&xx.front(), &xx.front(), &result.front());
+  // out of range
+  xx.push_back(x_max + 1.0);
+  TEST_EXCEPTION(Exception::IllegalArgument, sp5.eval(&xx.front(), &xx.front() + xx.size(), &result.front()));
+END_SECTION
+
 START_SECTION(double derivatives(double x, unsigned order))
   // near border of spline range
   TEST_REAL_SIMILAR(sp1.derivatives(486.785,1), 39270152.2996247)
@@ -511,6 +511,140 @@ START_SECTION ( void dia_by_ion_score(SpectrumType spectrum, AASequence &sequenc
 }
 END_SECTION
 
+START_SECTION(void prepareAssayCache(const OpenSwath::LightTargetedExperiment& assays))
+{
+  OpenSwath::SpectrumPtr sptr = prepareSpectrum();
+  MockMRMFeature * imrmfeature_test = new MockMRMFeature();
+  getMRMFeatureTest(imrmfeature_test);
+
+  OpenSwath::LightTargetedExperiment assays;
+  OpenSwath::LightCompound pep;
+  pep.id = "pep1";
+  pep.sequence = "SYVAWDR";
+  pep.charge = 2;
+  assays.compounds.push_back(pep);
+  OpenSwath::LightCompound metabolite;
+  metabolite.id = "met1";
+  metabolite.compound_name = "unknown";
+  metabolite.charge = 1;
+  assays.compounds.push_back(metabolite);
+  OpenSwath::LightTransition tr1 = mock_tr1, tr2 = mock_tr2;
+  tr1.peptide_ref = "pep1";
+  tr2.peptide_ref = "pep1";
+  assays.transitions.push_back(tr1);
+  assays.transitions.push_back(tr2);
+
+  DIAScoring diascoring;
+  diascoring.setParameters(p_dia);
+  TEST_EQUAL(diascoring.getAssayCacheEntry("pep1") == nullptr, true)
+
+  double isotope_corr = 0, isotope_overlap = 0;
+  diascoring.dia_isotope_scores(assays.transitions, sptr, imrmfeature_test, isotope_corr, isotope_overlap);
+
+  diascoring.prepareAssayCache(assays);
+  const DIAScoring::AssayCacheEntry* entry = diascoring.getAssayCacheEntry("pep1");
+  TEST_EQUAL(entry == nullptr, false)
+  TEST_EQUAL(entry->bseries.size(), 5)
+  TEST_EQUAL(entry->yseries.size(), 6)
+  TEST_REAL_SIMILAR(entry->bseries[0], 251.10323)
+  TEST_REAL_SIMILAR(entry->yseries[0], 175.11955)
+  TEST_EQUAL(entry->precursor_isotopes.size(), 5)
+  TEST_REAL_SIMILAR(*std::max_element(entry->precursor_isotopes.begin(), entry->precursor_isotopes.end()), 1.0)
+  entry = diascoring.getAssayCacheEntry("met1");
+  TEST_EQUAL(entry == nullptr, false)
+  TEST_EQUAL(entry->precursor_isotopes.empty(), true) // no formula, averagine model is used
+
+  // cached patterns give the same scores
+  double isotope_corr_cached = 0, isotope_overlap_cached = 0;
+  diascoring.dia_isotope_scores(assays.transitions, sptr, imrmfeature_test, isotope_corr_cached, isotope_overlap_cached);
+  TEST_EQUAL(isotope_corr_cached, isotope_corr)
+  TEST_EQUAL(isotope_overlap_cached, isotope_overlap)
+  TEST_REAL_SIMILAR(isotope_corr, 0.995335798317618 * 0.7 + 0.959692139694113 * 0.3)
+
+  double ms1_corr = 0, ms1_overlap = 0;
+  diascoring.dia_ms1_isotope_scores_averagine(500.0, sptr, ms1_corr, ms1_overlap, 1);
+  TEST_REAL_SIMILAR(ms1_corr, 0.959692139694113)
+  TEST_REAL_SIMILAR(ms1_overlap, 240/74.0)
+
+  // a new library replaces the cached data, even for known compound ids
+  OpenSwath::LightTargetedExperiment assays_new;
+  pep.sequence = "SYVAW";
+  assays_new.compounds.push_back(pep);
+  assays_new.transitions.push_back(tr1);
+  diascoring.prepareAssayCache(assays_new);
+  entry = diascoring.getAssayCacheEntry("pep1");
+  TEST_EQUAL(entry == nullptr, false)
+  TEST_EQUAL(entry->bseries.size(), 3)
+  TEST_EQUAL(entry->yseries.size(), 4)
+  TEST_EQUAL(diascoring.getAssayCacheEntry("met1") == nullptr, true)
+
+  // changing the parameters invalidates the cache
+  diascoring.setParameters(p_dia_large);
+  TEST_EQUAL(diascoring.getAssayCacheEntry("pep1") == nullptr, true)
+  delete imrmfeature_test;
+}
+END_SECTION
+
+START_SECTION(void clearAssayCache())
+{
+  OpenSwath::LightTargetedExperiment assays;
+  OpenSwath::LightCompound pep;
+  pep.id = "pep1";
+  pep.sequence = "SYVAWDR";
+  pep.charge = 2;
+  assays.compounds.push_back(pep);
+
+  DIAScoring diascoring;
+  diascoring.setParameters(p_dia);
+  diascoring.prepareAssayCache(assays);
+  TEST_EQUAL(diascoring.getAssayCacheEntry("pep1") == nullptr, false)
+  diascoring.clearAssayCache();
+  TEST_EQUAL(diascoring.getAssayCacheEntry("pep1") == nullptr, true)
+}
+END_SECTION
+
+START_SECTION(const AssayCacheEntry* getAssayCacheEntry(const std::string& compound_id) const)
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION(void dia_by_ion_score(SpectrumPtrType spectrum, const std::vector<double>& bseries, const std::vector<double>& yseries, double& bseries_score, double& yseries_score) const)
+{
+  OpenSwath::SpectrumPtr sptr = (OpenSwath::SpectrumPtr)(new OpenSwath::Spectrum);
+  OpenSwath::BinaryDataArrayPtr data1 = (OpenSwath::BinaryDataArrayPtr)(new OpenSwath::BinaryDataArray);
+  OpenSwath::BinaryDataArrayPtr data2 = (OpenSwath::BinaryDataArrayPtr)(new OpenSwath::BinaryDataArray);
+  data1->data = {350.17164, 421.20875, 547.26291};
+  data2->data = std::vector<double>(3, 100);
+  sptr->setMZArray(data1);
+  sptr->setIntensityArray(data2);
+
+  DIAScoring diascoring;
+  diascoring.setParameters(p_dia);
+  std::vector<double> bseries = {251.10323, 350.17164, 421.20875};
+  std::vector<double> yseries = {175.11955, 547.26291};
+  double bseries_score = 0, yseries_score = 0;
+  diascoring.dia_by_ion_score(sptr, bseries, yseries, bseries_score, yseries_score);
+  TEST_REAL_SIMILAR(bseries_score, 2)
+  TEST_REAL_SIMILAR(yseries_score, 1)
+}
+END_SECTION
+
+START_SECTION(void dia_ms1_isotope_scores(double precursor_mz, SpectrumPtrType spectrum, double& isotope_corr, double& isotope_overlap, int charge_state, const std::vector<double>& theoretical_isotopes) const)
+{
+  OpenSwath::SpectrumPtr sptr = prepareSpectrum();
+  DIAScoring diascoring;
+  diascoring.setParameters(p_dia);
+
+  // same theoretical pattern as the averagine model at m/z 499 (see above)
+  std::vector<double> theo = {0.755900817146293, 0.201673974754608, 0.0367726851778834, 0.00502869795238462, 0.000564836713740715};
+  double isotope_corr = 0, isotope_overlap = 0;
+  diascoring.dia_ms1_isotope_scores(499.0, sptr, isotope_corr, isotope_overlap, 1, theo);
+  TEST_REAL_SIMILAR(isotope_corr, 0.995485552148335)
+  TEST_REAL_SIMILAR(isotope_overlap, 0.0)
+}
+END_SECTION
+
 START_SECTION( void score_with_isotopes(SpectrumType spectrum, const std::vector< TransitionType > &transitions, double &dotprod, double &manhattan))
 {
   OpenSwath::LightTransition mock_tr1;
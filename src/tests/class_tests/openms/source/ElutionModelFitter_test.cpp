@@ -70,7 +70,14 @@ START_SECTION((void fitElutionModels(FeatureMap& features)))
 
   FeatureMap features;
   // test if exception is thrown on empty featuremap
-  TEST_EXCEPTION(Exception::MissingInformation, emf.fitElutionModels(features));  
+  TEST_EXCEPTION(Exception::MissingInformation, emf.fitElutionModels(features));
+
+  // input is checked before any model is fitted:
+  FeatureXMLFile().load(OPENMS_GET_TEST_DATA_PATH("ElutionModelFitter_test.featureXML"), features);
+  ABORT_IF(features.size() != 25);
+  features[20].getSubordinates().clear();
+  TEST_EXCEPTION(Exception::MissingInformation, emf.fitElutionModels(features));
+  TEST_EQUAL(features[0].metaValueExists("model_status"), false);
 
   FeatureXMLFile().load(OPENMS_GET_TEST_DATA_PATH("ElutionModelFitter_test.featureXML"), features);
   ABORT_IF(features.size() != 25);
@@ -78,6 +78,91 @@ START_SECTION((virtual void group(const std::vector<ConsensusMap>& maps, Consens
   NOT_TESTABLE;
 END_SECTION
 
+START_SECTION((void groupOutOfCore(Size num_maps, std::vector<double> mz_values, double max_intensity, Size batch_size, const MapRangeLoader& load_range, const ConsensusConsumer& consume)))
+{
+  // three maps with well separated groups of corresponding features
+  vector<FeatureMap> maps(3);
+  vector<double> mz_values;
+  double max_intensity = 0.0;
+  for (Size k = 0; k < maps.size(); ++k)
+  {
+    for (Size i = 0; i < 20; ++i)
+    {
+      if (i % 5 == k) continue; // some features are missing in some maps
+      Feature f;
+      f.setMZ(300.0 + 25.0 * i + 0.001 * k);
+      f.setRT(100.0 + 10.0 * i + k);
+      f.setIntensity(1000.0 * (i + 1));
+      f.setCharge(2);
+      f.setUniqueId(100 * k + i);
+      maps[k].push_back(f);
+      mz_values.push_back(f.getMZ());
+      max_intensity = max(max_intensity, double(f.getIntensity()));
+    }
+    maps[k].updateRanges();
+  }
+
+  FeatureGroupingAlgorithmKD algo;
+  Param p = algo.getParameters();
+  p.setValue("warp:enabled", "false");
+  p.setValue("nr_partitions", 10);
+  algo.setParameters(p);
+  algo.setLogType(ProgressLogger::NONE);
+
+  ConsensusMap in_memory;
+  algo.group(maps, in_memory);
+
+  Size nr_loads = 0;
+  auto load_range = [&](double mz_min, double mz_max, vector<FeatureMap>& batch_maps)
+  {
+    ++nr_loads;
+    batch_maps.resize(maps.size());
+    for (Size k = 0; k < maps.size(); ++k)
+    {
+      for (const Feature& f : maps[k])
+      {
+        if (f.getMZ() >= mz_min && f.getMZ() < mz_max) batch_maps[k].push_back(f);
+      }
+    }
+  };
+  ConsensusMap out_of_core;
+  Size nr_batches = 0;
+  auto consume = [&](ConsensusMap& batch)
+  {
+    ++nr_batches;
+    for (const ConsensusFeature& cf : batch) out_of_core.push_back(cf);
+  };
+  algo.groupOutOfCore(maps.size(), mz_values, max_intensity, 10, load_range, consume);
+  TEST_EQUAL(nr_loads, nr_batches)
+  TEST_EQUAL(nr_batches > 1, true)
+
+  // same consensus features (the order differs, as it is canonical only within batches)
+  auto by_mz = [](const ConsensusFeature& a, const ConsensusFeature& b) { return a.getMZ() < b.getMZ(); };
+  in_memory.sortByMZ();
+  sort(out_of_core.begin(), out_of_core.end(), by_mz);
+  TEST_EQUAL(in_memory.size(), 20)
+  ABORT_IF(out_of_core.size() != in_memory.size())
+  for (Size i = 0; i < in_memory.size(); ++i)
+  {
+    TEST_EQUAL(out_of_core[i].size(), in_memory[i].size())
+    TEST_REAL_SIMILAR(out_of_core[i].getMZ(), in_memory[i].getMZ())
+    TEST_REAL_SIMILAR(out_of_core[i].getRT(), in_memory[i].getRT())
+    TEST_REAL_SIMILAR(out_of_core[i].getQuality(), in_memory[i].getQuality())
+  }
+
+  // a single batch
+  out_of_core.clear();
+  nr_batches = 0;
+  algo.groupOutOfCore(maps.size(), mz_values, max_intensity, 0, load_range, consume);
+  TEST_EQUAL(nr_batches, 1)
+  TEST_EQUAL(out_of_core.size(), in_memory.size())
+
+  TEST_EXCEPTION(Exception::IllegalArgument, algo.groupOutOfCore(1, mz_values, max_intensity, 0, load_range, consume))
+  auto bad_load = [](double, double, vector<FeatureMap>& batch_maps) { batch_maps.resize(1); };
+  TEST_EXCEPTION(Exception::InvalidSize, algo.groupOutOfCore(maps.size(), mz_values, max_intensity, 0, bad_load, consume))
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 
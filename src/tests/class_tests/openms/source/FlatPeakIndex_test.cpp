@@ -0,0 +1,229 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Timo Sachsenberg $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/KERNEL/FlatPeakIndex.h>
+///////////////////////////
+
+#include <OpenMS/KERNEL/MSExperiment.h>
+
+#include <random>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(FlatPeakIndex, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+// map with an empty spectrum, a small spectrum and larger spectra with
+// clustered (isotope-like) and duplicate m/z values
+PeakMap exp;
+{
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<double> mz_dist(100.0, 1000.0);
+  std::uniform_real_distribution<double> int_dist(10.0, 1000.0);
+  exp.addSpectrum(MSSpectrum());
+  MSSpectrum small;
+  small.push_back(Peak1D(200.0, 5.0f));
+  small.push_back(Peak1D(300.0, 6.0f));
+  exp.addSpectrum(small);
+  for (Size s = 0; s < 5; ++s)
+  {
+    MSSpectrum spec;
+    for (Size i = 0; i < 200; ++i)
+    {
+      double mz = mz_dist(rng);
+      spec.push_back(Peak1D(mz, int_dist(rng)));
+      spec.push_back(Peak1D(mz + 1.00335, int_dist(rng)));
+      spec.push_back(Peak1D(mz + 0.001, int_dist(rng)));
+    }
+    spec.push_back(Peak1D(500.0, 1.0f));
+    spec.push_back(Peak1D(500.0, 2.0f));
+    spec.sortByPosition();
+    exp.addSpectrum(spec);
+  }
+}
+
+FlatPeakIndex* ptr = nullptr;
+FlatPeakIndex* null_ptr = nullptr;
+START_SECTION(FlatPeakIndex())
+{
+  ptr = new FlatPeakIndex();
+  TEST_NOT_EQUAL(ptr, null_ptr)
+  TEST_EQUAL(ptr->getNrSpectra(), 0)
+  TEST_EQUAL(ptr->size(), 0)
+}
+END_SECTION
+
+START_SECTION(~FlatPeakIndex())
+{
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION(FlatPeakIndex(const MSExperiment& exp, bool use_buckets = true))
+{
+  FlatPeakIndex index(exp);
+  TEST_EQUAL(index.getNrSpectra(), exp.size())
+  TEST_EQUAL(index.size(), 2 + 5 * 602)
+}
+END_SECTION
+
+START_SECTION(void build(const MSExperiment& exp, bool use_buckets = true))
+{
+  FlatPeakIndex index;
+  index.build(exp, false);
+  TEST_EQUAL(index.getNrSpectra(), exp.size())
+  index.build(exp, true);
+  TEST_EQUAL(index.getNrSpectra(), exp.size())
+  TEST_EQUAL(index.size(), 2 + 5 * 602)
+}
+END_SECTION
+
+START_SECTION(void clear())
+{
+  FlatPeakIndex index(exp);
+  index.clear();
+  TEST_EQUAL(index.getNrSpectra(), 0)
+  TEST_EQUAL(index.size(), 0)
+}
+END_SECTION
+
+FlatPeakIndex index(exp);
+
+START_SECTION(Size getSpectrumOffset(Size scan) const)
+{
+  TEST_EQUAL(index.getSpectrumOffset(0), 0)
+  TEST_EQUAL(index.getSpectrumOffset(1), 0)
+  TEST_EQUAL(index.getSpectrumOffset(2), 2)
+  TEST_EQUAL(index.getSpectrumOffset(3), 604)
+}
+END_SECTION
+
+START_SECTION(Size getSpectrumSize(Size scan) const)
+{
+  TEST_EQUAL(index.getSpectrumSize(0), 0)
+  TEST_EQUAL(index.getSpectrumSize(1), 2)
+  TEST_EQUAL(index.getSpectrumSize(2), 602)
+}
+END_SECTION
+
+START_SECTION(double getMZ(Size scan, Size peak) const)
+{
+  TEST_REAL_SIMILAR(index.getMZ(1, 1), 300.0)
+  TEST_REAL_SIMILAR(index.getMZ(4, 17), exp[4][17].getMZ())
+}
+END_SECTION
+
+START_SECTION(float getIntensity(Size scan, Size peak) const)
+{
+  TEST_REAL_SIMILAR(index.getIntensity(1, 1), 6.0)
+  TEST_REAL_SIMILAR(index.getIntensity(4, 17), exp[4][17].getIntensity())
+}
+END_SECTION
+
+START_SECTION(Size lowerBound(Size scan, double mz) const)
+{
+  TEST_EQUAL(index.lowerBound(0, 100.0), 0)
+  TEST_EQUAL(index.lowerBound(1, 100.0), 0)
+  TEST_EQUAL(index.lowerBound(1, 200.0), 0)
+  TEST_EQUAL(index.lowerBound(1, 250.0), 1)
+  TEST_EQUAL(index.lowerBound(1, 350.0), 2)
+  for (Size s = 2; s < exp.size(); ++s)
+  {
+    Size mismatches = 0;
+    for (double mz = 50.0; mz < 1050.0; mz += 0.0731)
+    {
+      if (index.lowerBound(s, mz) != Size(exp[s].MZBegin(mz) - exp[s].begin())) ++mismatches;
+    }
+    TEST_EQUAL(mismatches, 0)
+  }
+}
+END_SECTION
+
+START_SECTION(Size findNearest(Size scan, double mz) const)
+{
+  TEST_EXCEPTION(Exception::Precondition, index.findNearest(0, 100.0))
+  TEST_EQUAL(index.findNearest(1, 100.0), 0)
+  TEST_EQUAL(index.findNearest(1, 250.0), 0) // ties go to the left peak
+  TEST_EQUAL(index.findNearest(1, 251.0), 1)
+  TEST_EQUAL(index.findNearest(1, 400.0), 1)
+
+  FlatPeakIndex no_buckets(exp, false);
+  for (Size s = 1; s < exp.size(); ++s)
+  {
+    Size mismatches = 0;
+    for (double mz = 50.0; mz < 1050.0; mz += 0.0731)
+    {
+      Size expected = exp[s].findNearest(mz);
+      if (index.findNearest(s, mz) != expected) ++mismatches;
+      if (no_buckets.findNearest(s, mz) != expected) ++mismatches;
+    }
+    // exact peak positions
+    for (Size p = 0; p < exp[s].size(); ++p)
+    {
+      double mz = exp[s][p].getMZ();
+      if (index.findNearest(s, mz) != exp[s].findNearest(mz)) ++mismatches;
+    }
+    TEST_EQUAL(mismatches, 0)
+  }
+}
+END_SECTION
+
+START_SECTION(Int findNearest(Size scan, double mz, double tolerance) const)
+{
+  TEST_EQUAL(index.findNearest(0, 100.0, 1.0), -1)
+  TEST_EQUAL(index.findNearest(1, 199.5, 1.0), 0)
+  TEST_EQUAL(index.findNearest(1, 150.0, 1.0), -1)
+  TEST_EQUAL(index.findNearest(1, 301.0, 1.0), 1)
+  for (Size s = 2; s < exp.size(); ++s)
+  {
+    Size mismatches = 0;
+    for (double mz = 50.0; mz < 1050.0; mz += 0.0731)
+    {
+      if (index.findNearest(s, mz, 0.01) != exp[s].findNearest(mz, 0.01)) ++mismatches;
+    }
+    TEST_EQUAL(mismatches, 0)
+  }
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -187,6 +187,32 @@ START_SECTION((bool filter(OpenMS::Interfaces::ChromatogramPtr chromatogram)))
   TEST_REAL_SIMILAR(chromatogram->getIntensityArray()->data[8],0.000881793)
 END_SECTION 
 
+START_SECTION([EXTRA] uniform and non-uniform data give the same result)
+{
+  // a tiny jitter makes the data non-uniform, so the general integration is used instead of the uniform kernel
+  std::vector<double> mz, mz_jitter, intensities;
+  for (Size i = 0; i < 50; ++i)
+  {
+    mz.push_back(500.0 + 0.005 * i);
+    mz_jitter.push_back(500.0 + 0.005 * i + (i % 2) * 1e-9);
+    intensities.push_back(100.0 * std::exp(-0.02 * (i - 25.0) * (i - 25.0)) + (i % 3));
+  }
+
+  GaussFilterAlgorithm gauss;
+  gauss.initialize(0.05, 0.01, 10.0, false);
+  std::vector<double> mz_out(50), int_out(50), mz_jitter_out(50), int_jitter_out(50);
+  TEST_EQUAL(gauss.filter(mz.begin(), mz.end(), intensities.begin(), mz_out.begin(), int_out.begin()), true)
+  TEST_EQUAL(gauss.filter(mz_jitter.begin(), mz_jitter.end(), intensities.begin(), mz_jitter_out.begin(), int_jitter_out.begin()), true)
+
+  TOLERANCE_ABSOLUTE(1e-4)
+  for (Size i = 0; i < 50; ++i)
+  {
+    TEST_REAL_SIMILAR(mz_out[i], mz[i])
+    TEST_REAL_SIMILAR(int_out[i], int_jitter_out[i])
+  }
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
@@ -155,6 +155,18 @@ START_SECTION(void getTransform(MSSpectrum &c_trans, const MSSpectrum &c_ref, co
 	TEST_EQUAL (*spec!= map[0], true)
 END_SECTION
 
+START_SECTION(void computeTransform(MSSpectrum &c_trans, const MSSpectrum &c_ref, const UInt c) const)
+	MSSpectrum expected (map[0]), trans (map[0]);
+	iw->initializeScan (map[0]);
+	iw->getTransform (expected, map[0], 0);
+	iw->computeTransform (trans, map[0], 0);
+	ABORT_IF (trans.size() != expected.size())
+	for (Size i = 0; i < trans.size(); ++i)
+	{
+		TEST_EQUAL (trans[i].getIntensity(), expected[i].getIntensity())
+	}
+END_SECTION
+
 START_SECTION(void setSigma (const double sigma))
 	iw->setSigma (1);
 	NOT_TESTABLE
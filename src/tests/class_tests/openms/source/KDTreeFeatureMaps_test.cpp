@@ -176,7 +176,19 @@ START_SECTION((void getNeighborhood(Size index, std::vector<Size>& result_indice
 END_SECTION
 
 START_SECTION((void queryRegion(double rt_low, double rt_high, double mz_low, double mz_high, std::vector<Size>& result_indices, Size ignored_map_index = std::numeric_limits<Size>::max()) const))
-  NOT_TESTABLE;
+  vector<Size> result;
+  kd_data_1.queryRegion(900, 2100, 300, 600, result);
+  TEST_EQUAL(result.size(), 2)
+  TEST_EQUAL(result[0], 0)
+  TEST_EQUAL(result[1], 1)
+  kd_data_1.queryRegion(1000, 1000, 400, 400, result);
+  TEST_EQUAL(result.size(), 1)
+  TEST_EQUAL(result[0], 0)
+  kd_data_1.queryRegion(1500, 2100, 300, 600, result);
+  TEST_EQUAL(result.size(), 1)
+  TEST_EQUAL(result[0], 1)
+  kd_data_1.queryRegion(900, 2100, 300, 600, result, 0);
+  TEST_EQUAL(result.size(), 0)
 END_SECTION
 
 START_SECTION((void applyTransformations(const std::vector<TransformationModelLowess*>& trafos)))
@@ -483,6 +483,50 @@ END_SECTION*/
         }
     END_SECTION
 
+    BOOST_AUTO_TEST_CASE(initializeXCorrMaxPeakMatrix)
+        {
+          MockMRMFeature * imrmfeature = new MockMRMFeature();
+          MRMScoring mrmscore;
+          std::vector<std::string> native_ids;
+          fill_mock_objects(imrmfeature, native_ids);
+          static const double weights_[] = { 0.5, 0.5 };
+          std::vector<double> weights (weights_, weights_ + sizeof(weights_) / sizeof(weights_[0]) );
+          mrmscore.initializeXCorrMaxPeakMatrix(imrmfeature, native_ids);
+
+          // the full cross-correlation arrays are not stored
+          TEST_EQUAL(mrmscore.getXCorrMatrix().rows(), 0)
+
+          // same scores as with the full cross-correlation matrix
+          TEST_REAL_SIMILAR(mrmscore.calcXcorrCoelutionScore(), 1 + std::sqrt(3.0))
+          TEST_REAL_SIMILAR(mrmscore.calcXcorrCoelutionWeightedScore(weights), 1.5)
+          TEST_REAL_SIMILAR(mrmscore.calcXcorrShapeScore(), (1.0 + 0.3969832 + 1.0)/3.0)
+          TEST_REAL_SIMILAR(mrmscore.calcXcorrShapeWeightedScore(weights), 0.6984916)
+
+          MRMScoring mrmscore_full;
+          mrmscore_full.initializeXCorrMatrix(imrmfeature, native_ids);
+          delete imrmfeature;
+          TEST_EQUAL(mrmscore.calcXcorrCoelutionScore(), mrmscore_full.calcXcorrCoelutionScore())
+          TEST_EQUAL(mrmscore.calcXcorrShapeScore(), mrmscore_full.calcXcorrShapeScore())
+        }
+    END_SECTION
+
+    BOOST_AUTO_TEST_CASE(initializeXCorrContrastMaxPeakMatrix)
+        {
+          MockMRMFeature * imrmfeature = new MockMRMFeature();
+          MRMScoring mrmscore;
+          std::vector<std::string> native_ids;
+          fill_mock_objects(imrmfeature, native_ids);
+          mrmscore.initializeXCorrContrastMaxPeakMatrix(imrmfeature, native_ids, native_ids);
+          delete imrmfeature;
+
+          TEST_EQUAL(mrmscore.getXCorrContrastMatrix().rows(), 0)
+          TEST_REAL_SIMILAR(mrmscore.calcSeparateXcorrContrastCoelutionScore()[0], 1.5)
+          TEST_REAL_SIMILAR(mrmscore.calcSeparateXcorrContrastCoelutionScore()[1], 1.5)
+          TEST_REAL_SIMILAR(mrmscore.calcSeparateXcorrContrastShapeScore()[0], 0.698492)
+          TEST_REAL_SIMILAR(mrmscore.calcSeparateXcorrContrastShapeScore()[1], 0.698492)
+        }
+    END_SECTION
+
     BOOST_AUTO_TEST_CASE(calcXcorrPrecursorContrastCoelutionScore)
         {
           MockMRMFeature * imrmfeature = new MockMRMFeature();
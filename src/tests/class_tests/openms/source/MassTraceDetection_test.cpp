@@ -40,6 +40,10 @@
 #include <OpenMS/FILTERING/DATAREDUCTION/MassTraceDetection.h>
 ///////////////////////////
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using namespace OpenMS;
 using namespace std;
 
@@ -175,6 +179,33 @@ START_SECTION((void run(const PeakMap &, std::vector< MassTrace > &)))
 }
 END_SECTION
 
+START_SECTION([EXTRA] run with multiple threads gives the same result as a single thread)
+{
+#ifdef _OPENMP
+    // all three traces are close in m/z and RT, so the parallel run needs to
+    // resolve the overlapping extensions
+    int max_threads = omp_get_max_threads();
+    omp_set_num_threads(1);
+    std::vector<MassTrace> serial_mt;
+    test_mtd.run(input, serial_mt);
+
+    omp_set_num_threads(std::max(max_threads, 4));
+    std::vector<MassTrace> parallel_mt;
+    test_mtd.run(input, parallel_mt);
+    omp_set_num_threads(max_threads);
+
+    TEST_EQUAL(parallel_mt.size(), serial_mt.size())
+    for (Size i = 0; i < std::min(parallel_mt.size(), serial_mt.size()); ++i)
+    {
+        TEST_EQUAL(parallel_mt[i].getLabel(), serial_mt[i].getLabel())
+        TEST_EQUAL(parallel_mt[i].getSize(), serial_mt[i].getSize())
+        TEST_EQUAL(parallel_mt[i].getCentroidRT(), serial_mt[i].getCentroidRT())
+        TEST_EQUAL(parallel_mt[i].getCentroidMZ(), serial_mt[i].getCentroidMZ())
+    }
+#endif
+}
+END_SECTION
+
 std::vector<MassTrace> filt;
 
 //START_SECTION((void filterByPeakWidth(std::vector< MassTrace > &, std::vector< MassTrace > &)))
@@ -38,9 +38,21 @@
 #include <OpenMS/TRANSFORMATIONS/FEATUREFINDER/MultiplexFilteringProfile.h>
 #include <OpenMS/TRANSFORMATIONS/FEATUREFINDER/MultiplexFilteredMSExperiment.h>
 #include <OpenMS/FORMAT/MzMLFile.h>
+#include <OpenMS/CONCEPT/Constants.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 using namespace OpenMS;
 
+class MultiplexFilteringProfileTest : public MultiplexFilteringProfile
+{
+public:
+  using MultiplexFilteringProfile::MultiplexFilteringProfile;
+  using MultiplexFilteringProfile::getBlacklistRange_;
+};
+
 START_TEST(MultiplexFilteringProfile, "$Id$")
 
 // read data
@@ -116,4 +128,61 @@ START_SECTION(std::vector<MultiplexFilterResult> filter())
     TEST_EQUAL(results[7].size(), 0);
 END_SECTION
 
+START_SECTION([EXTRA] filter with multiple threads gives the same result as a single thread)
+{
+#ifdef _OPENMP
+    int max_threads = omp_get_max_threads();
+    omp_set_num_threads(1);
+    MultiplexFilteringProfile filtering_serial(exp, exp_picked, boundaries_exp_s, patterns, isotopes_per_peptide_min, isotopes_per_peptide_max, intensity_cutoff, rt_band, mz_tolerance, mz_tolerance_unit, peptide_similarity, averagine_similarity, averagine_similarity_scaling, averagine_type);
+    std::vector<MultiplexFilteredMSExperiment> serial_results = filtering_serial.filter();
+
+    omp_set_num_threads(std::max(max_threads, 4));
+    MultiplexFilteringProfile filtering_parallel(exp, exp_picked, boundaries_exp_s, patterns, isotopes_per_peptide_min, isotopes_per_peptide_max, intensity_cutoff, rt_band, mz_tolerance, mz_tolerance_unit, peptide_similarity, averagine_similarity, averagine_similarity_scaling, averagine_type);
+    std::vector<MultiplexFilteredMSExperiment> parallel_results = filtering_parallel.filter();
+    omp_set_num_threads(max_threads);
+
+    TEST_EQUAL(parallel_results.size(), serial_results.size())
+    for (Size i = 0; i < std::min(parallel_results.size(), serial_results.size()); ++i)
+    {
+        TEST_EQUAL(parallel_results[i].size(), serial_results[i].size())
+        for (Size j = 0; j < std::min(parallel_results[i].size(), serial_results[i].size()); ++j)
+        {
+            TEST_EQUAL(parallel_results[i].getMZ(j), serial_results[i].getMZ(j))
+            TEST_EQUAL(parallel_results[i].getRT(j), serial_results[i].getRT(j))
+            TEST_EQUAL(parallel_results[i].getPeak(j).sizeProfile(), serial_results[i].getPeak(j).sizeProfile())
+        }
+    }
+#else
+    NOT_TESTABLE
+#endif
+}
+END_SECTION
+
+START_SECTION(([EXTRA] std::pair<double, double> getBlacklistRange_(double mz, const MultiplexIsotopicPeakPattern& pattern) const))
+{
+    MultiplexFilteringProfileTest filtering_ppm(exp, exp_picked, boundaries_exp_s, patterns, isotopes_per_peptide_min, isotopes_per_peptide_max, intensity_cutoff, rt_band, mz_tolerance, true, peptide_similarity, averagine_similarity, averagine_similarity_scaling, averagine_type);
+    MultiplexFilteringProfileTest filtering_da(exp, exp_picked, boundaries_exp_s, patterns, isotopes_per_peptide_min, isotopes_per_peptide_max, intensity_cutoff, rt_band, 0.1, false, peptide_similarity, averagine_similarity, averagine_similarity_scaling, averagine_type);
+
+    // charge 2, light and Arg8 peptide with 6 isotopes each
+    MultiplexIsotopicPeakPattern pattern(2, isotopes_per_peptide_max, shifts1, 0);
+    double shift_max = (8.0443702794 + 5 * Constants::C13C12_MASSDIFF_U) / 2;
+
+    // from the peak itself (shift zero) to the last isotope of the heavy peptide, extended by the tolerance
+    std::pair<double, double> range = filtering_ppm.getBlacklistRange_(500.0, pattern);
+    TEST_REAL_SIMILAR(range.first, 500.0 - 0.02)
+    TEST_REAL_SIMILAR(range.second, 500.0 + shift_max + 0.02)
+
+    range = filtering_da.getBlacklistRange_(500.0, pattern);
+    TEST_REAL_SIMILAR(range.first, 500.0 - 0.1)
+    TEST_REAL_SIMILAR(range.second, 500.0 + shift_max + 0.1)
+
+    // every m/z shift of the pattern lies within the range
+    for (size_t i = 0; i < pattern.getMZShiftCount(); ++i)
+    {
+        TEST_EQUAL(range.first <= 500.0 + pattern.getMZShiftAt(i), true)
+        TEST_EQUAL(500.0 + pattern.getMZShiftAt(i) <= range.second, true)
+    }
+}
+END_SECTION
+
 END_TEST
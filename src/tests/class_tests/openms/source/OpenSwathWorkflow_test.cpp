@@ -0,0 +1,226 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SimpleOpenMSSpectraAccessFactory.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/OPENSWATH/OpenSwathWorkflow.h>
+///////////////////////////
+
+using namespace OpenMS;
+using namespace std;
+
+namespace
+{
+  // SWATH map with peaks at the product m/z of the library below
+  OpenSwath::SpectrumAccessPtr createSwathMap(double base_intensity)
+  {
+    boost::shared_ptr<PeakMap> exp(new PeakMap);
+    for (Size i = 0; i < 11; ++i)
+    {
+      MSSpectrum spec;
+      spec.setRT(10.0 * i);
+      spec.setMSLevel(2);
+      Peak1D p;
+      p.setMZ(500.0);
+      p.setIntensity(base_intensity + i);
+      spec.push_back(p);
+      p.setMZ(600.0);
+      p.setIntensity(50.0);
+      spec.push_back(p);
+      if (i == 3) // only one spectrum has signal at 700
+      {
+        p.setMZ(700.0);
+        p.setIntensity(20.0);
+        spec.push_back(p);
+      }
+      exp->addSpectrum(spec);
+    }
+    return SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(exp);
+  }
+
+  OpenSwath::LightTargetedExperiment createLibrary()
+  {
+    OpenSwath::LightTargetedExperiment library;
+    // (precursor m/z, product m/z): pep_a is in both (overlapping) windows,
+    // pep_b has signal in a single spectrum only and no signal at all at 800
+    std::vector<std::pair<String, std::pair<double, double> > > transitions =
+    {
+      {"pep_a", {422.0, 500.0}},
+      {"pep_b", {410.0, 600.0}},
+      {"pep_b", {410.0, 700.0}},
+      {"pep_b", {410.0, 800.0}}
+    };
+    for (Size k = 0; k < transitions.size(); ++k)
+    {
+      OpenSwath::LightTransition tr;
+      tr.transition_name = "tr_" + String(k);
+      tr.peptide_ref = transitions[k].first;
+      tr.precursor_mz = transitions[k].second.first;
+      tr.product_mz = transitions[k].second.second;
+      tr.library_intensity = 100.0;
+      library.transitions.push_back(tr);
+    }
+    for (const String& id : {"pep_a", "pep_b"})
+    {
+      OpenSwath::LightCompound c;
+      c.id = id;
+      c.sequence = "PEPTIDE";
+      c.charge = 2;
+      c.rt = 50.0;
+      library.compounds.push_back(c);
+    }
+    return library;
+  }
+}
+
+START_TEST(OpenSwathWorkflow, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+OpenSwath::LightTargetedExperiment library = createLibrary();
+
+std::vector<OpenSwath::SwathMap> swath_maps(2);
+swath_maps[0].sptr = createSwathMap(100.0);
+swath_maps[0].lower = 400.0;
+swath_maps[0].upper = 425.0;
+swath_maps[1].sptr = createSwathMap(200.0);
+swath_maps[1].lower = 420.0;
+swath_maps[1].upper = 450.0;
+
+ChromExtractParams cp;
+cp.min_upper_edge_dist = 0.0;
+cp.mz_extraction_window = 0.05;
+cp.im_extraction_window = -1;
+cp.ppm = false;
+cp.extraction_function = "tophat";
+cp.rt_extraction_window = -1;
+cp.extra_rt_extract = 0.0;
+
+START_SECTION([OpenSwathCalibrationWorkflow] void simpleExtractChromatograms_(const std::vector< OpenSwath::SwathMap > & swath_maps, const OpenSwath::LightTargetedExperiment & irt_transitions, std::vector< OpenMS::MSChromatogram > & chromatograms, const TransformationDescription& trafo, const ChromExtractParams & cp, bool sonar, bool load_into_memory))
+{
+  OpenSwathCalibrationWorkflow wf;
+  std::vector<MSChromatogram> chromatograms;
+  wf.simpleExtractChromatograms_(swath_maps, library, chromatograms, TransformationDescription(), cp, false, false);
+
+  // tr_0 from both windows (in map order), tr_1 and tr_2 from the first window, tr_3 is empty
+  TEST_EQUAL(chromatograms.size(), 4)
+  ABORT_IF(chromatograms.size() != 4)
+  TEST_EQUAL(chromatograms[0].getNativeID(), "tr_0")
+  TEST_EQUAL(chromatograms[1].getNativeID(), "tr_1")
+  TEST_EQUAL(chromatograms[2].getNativeID(), "tr_2")
+  TEST_EQUAL(chromatograms[3].getNativeID(), "tr_0")
+  TEST_EQUAL(chromatograms[0].size(), 11)
+  TEST_REAL_SIMILAR(chromatograms[0][4].getIntensity(), 104.0)
+  TEST_REAL_SIMILAR(chromatograms[3][4].getIntensity(), 204.0)
+}
+END_SECTION
+
+START_SECTION([OpenSwathCalibrationWorkflow] void extractChromatogramSubset_(const std::vector< OpenSwath::SwathMap > & swath_maps, const OpenSwath::LightTargetedExperiment & irt_transitions, std::vector< std::vector< OpenMS::MSChromatogram > > & chromatograms_per_map, const TransformationDescription& trafo, const ChromExtractParams & cp, Size spectra_stride, Size offset, bool load_into_memory))
+{
+  OpenSwathCalibrationWorkflow wf;
+  std::vector<MSChromatogram> expected;
+  wf.simpleExtractChromatograms_(swath_maps, library, expected, TransformationDescription(), cp, false, false);
+
+  for (bool load_into_memory : {false, true})
+  {
+    // subsets in the same (non-sequential) order as the incremental calibration
+    std::vector< std::vector<MSChromatogram> > chromatograms_per_map;
+    for (Size offset : {0, 2, 1})
+    {
+      wf.extractChromatogramSubset_(swath_maps, library, chromatograms_per_map, TransformationDescription(), cp, 3, offset, load_into_memory);
+    }
+    TEST_EQUAL(chromatograms_per_map.size(), 2)
+
+    std::vector<MSChromatogram> chromatograms;
+    OpenSwathCalibrationWorkflow::collectChromatograms_(chromatograms_per_map, chromatograms, false);
+    TEST_EQUAL(chromatograms.size(), expected.size())
+    ABORT_IF(chromatograms.size() != expected.size())
+    for (Size i = 0; i < chromatograms.size(); ++i)
+    {
+      TEST_EQUAL(chromatograms[i].getNativeID(), expected[i].getNativeID())
+      TEST_EQUAL(chromatograms[i].size(), expected[i].size())
+      TEST_EQUAL(chromatograms[i] == expected[i], true)
+    }
+  }
+
+  // a single subset misses the signal of tr_2 (spectrum 3), so it is skipped
+  std::vector< std::vector<MSChromatogram> > chromatograms_per_map;
+  wf.extractChromatogramSubset_(swath_maps, library, chromatograms_per_map, TransformationDescription(), cp, 3, 1, false);
+  std::vector<MSChromatogram> chromatograms;
+  OpenSwathCalibrationWorkflow::collectChromatograms_(chromatograms_per_map, chromatograms, false);
+  TEST_EQUAL(chromatograms.size(), 3)
+
+  // subsets need to come from the same maps
+  std::vector<OpenSwath::SwathMap> one_map(1, swath_maps[0]);
+  TEST_EXCEPTION(Exception::IllegalArgument, wf.extractChromatogramSubset_(one_map, library, chromatograms_per_map, TransformationDescription(), cp, 3, 0, false))
+}
+END_SECTION
+
+START_SECTION([OpenSwathCalibrationWorkflow] static void collectChromatograms_(const std::vector< std::vector< OpenMS::MSChromatogram > > & chromatograms_per_map, std::vector< OpenMS::MSChromatogram > & chromatograms, bool sonar))
+{
+  std::vector< std::vector<MSChromatogram> > chromatograms_per_map(3);
+  MSChromatogram chrom;
+  chrom.setNativeID("a");
+  chrom.push_back(ChromatogramPeak(10.0, 0.0));
+  chromatograms_per_map[0].push_back(chrom); // empty TIC
+  chrom.push_back(ChromatogramPeak(20.0, 5.0));
+  chromatograms_per_map[2].push_back(chrom);
+  chrom.setNativeID("b");
+  chromatograms_per_map[0].push_back(chrom);
+
+  std::vector<MSChromatogram> chromatograms;
+  OpenSwathCalibrationWorkflow::collectChromatograms_(chromatograms_per_map, chromatograms, false);
+  TEST_EQUAL(chromatograms.size(), 2)
+  ABORT_IF(chromatograms.size() != 2)
+  TEST_EQUAL(chromatograms[0].getNativeID(), "b")
+  TEST_EQUAL(chromatograms[1].getNativeID(), "a")
+
+  // SONAR: the same transition from different maps is added up
+  chromatograms_per_map[1].push_back(chromatograms_per_map[2][0]);
+  OpenSwathCalibrationWorkflow::collectChromatograms_(chromatograms_per_map, chromatograms, true);
+  TEST_EQUAL(chromatograms.size(), 2)
+  ABORT_IF(chromatograms.size() != 2)
+  TEST_EQUAL(chromatograms[0].getNativeID(), "a")
+  TEST_EQUAL(chromatograms[1].getNativeID(), "b")
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
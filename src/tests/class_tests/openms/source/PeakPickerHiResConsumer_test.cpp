@@ -0,0 +1,200 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Timo Sachsenberg $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/TRANSFORMATIONS/RAW2PEAK/PeakPickerHiResConsumer.h>
+///////////////////////////
+
+#include <OpenMS/FORMAT/MzMLFile.h>
+#include <OpenMS/FORMAT/DATAACCESS/MSDataStoringConsumer.h>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(PeakPickerHiResConsumer, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+PeakPickerHiRes pp;
+Param param;
+param.setValue("signal_to_noise", 1.0);
+pp.setParameters(param);
+
+MSDataStoringConsumer dummy;
+
+PeakPickerHiResConsumer* ptr = nullptr;
+PeakPickerHiResConsumer* nullPointer = nullptr;
+START_SECTION((PeakPickerHiResConsumer(const PeakPickerHiRes& pp, Interfaces::IMSDataConsumer* next, bool check_spectrum_type = true, Size batch_size = 0)))
+{
+  ptr = new PeakPickerHiResConsumer(pp, &dummy);
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EXCEPTION(Exception::MissingInformation, PeakPickerHiResConsumer(pp, nullptr))
+}
+END_SECTION
+
+START_SECTION((~PeakPickerHiResConsumer() override))
+{
+  delete ptr;
+}
+END_SECTION
+
+PeakMap input;
+MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("PeakPickerHiRes_orbitrap.mzML"), input);
+MSChromatogram chrom;
+for (Size i = 0; i < 30; ++i)
+{
+  chrom.push_back(ChromatogramPeak(i, 100.0 * std::exp(-0.1 * (i - 15.0) * (i - 15.0))));
+}
+input.addChromatogram(chrom);
+
+PeakMap expected;
+pp.pickExperiment(input, expected);
+
+START_SECTION((void consumeSpectrum(SpectrumType& s) override))
+{
+  // small batches: results are forwarded in input order regardless of batching
+  for (Size batch_size : {1, 3, 1000})
+  {
+    MSDataStoringConsumer storing;
+    PeakPickerHiResConsumer picker(pp, &storing, true, batch_size);
+    picker.setExpectedSize(input.size(), input.getChromatograms().size());
+    picker.setExperimentalSettings(input);
+    for (Size i = 0; i < input.size(); ++i)
+    {
+      MSSpectrum s = input[i];
+      picker.consumeSpectrum(s);
+    }
+    picker.flush();
+
+    const PeakMap& result = storing.getData();
+    ABORT_IF(result.size() != expected.size())
+    for (Size i = 0; i < result.size(); ++i)
+    {
+      TEST_EQUAL(result[i] == expected[i], true)
+    }
+  }
+}
+END_SECTION
+
+START_SECTION((void consumeChromatogram(ChromatogramType& c) override))
+{
+  MSDataStoringConsumer storing;
+  {
+    PeakPickerHiResConsumer picker(pp, &storing, true, 1000);
+    MSSpectrum s = input[0];
+    picker.consumeSpectrum(s);
+    TEST_EQUAL(storing.getData().size(), 0) // still buffered
+    MSChromatogram c = input.getChromatograms()[0];
+    picker.consumeChromatogram(c);
+    // spectra are forwarded before the first chromatogram
+    TEST_EQUAL(storing.getData().size(), 1)
+    TEST_EQUAL(storing.getData().getChromatograms().size(), 1)
+    TEST_EQUAL(storing.getData().getChromatograms()[0] == expected.getChromatograms()[0], true)
+  }
+}
+END_SECTION
+
+START_SECTION((void flush()))
+{
+  MSDataStoringConsumer storing;
+  {
+    PeakPickerHiResConsumer picker(pp, &storing, true, 1000);
+    for (Size i = 0; i < 2; ++i)
+    {
+      MSSpectrum s = input[i];
+      picker.consumeSpectrum(s);
+    }
+    TEST_EQUAL(storing.getData().size(), 0)
+    picker.flush();
+    TEST_EQUAL(storing.getData().size(), 2)
+    picker.flush(); // nothing left
+    TEST_EQUAL(storing.getData().size(), 2)
+
+    MSSpectrum s = input[2];
+    picker.consumeSpectrum(s);
+  } // destructor flushes the remaining spectrum
+  TEST_EQUAL(storing.getData().size(), 3)
+
+  // errors are reported by flush()
+  PeakPickerHiRes pp_ms1;
+  Param p;
+  p.setValue("ms_levels", ListUtils::create<Int>("1"));
+  pp_ms1.setParameters(p);
+  PeakPickerHiResConsumer picker(pp_ms1, &storing, true, 1000);
+  MSSpectrum centroided;
+  centroided.setMSLevel(1);
+  centroided.setType(SpectrumSettings::CENTROID);
+  picker.consumeSpectrum(centroided);
+  TEST_EXCEPTION(Exception::IllegalArgument, picker.flush())
+}
+END_SECTION
+
+START_SECTION((Size getNrPickedSpectra() const))
+{
+  MSDataStoringConsumer storing;
+  PeakPickerHiResConsumer picker(pp, &storing);
+  TEST_EQUAL(picker.getNrPickedSpectra(), 0)
+  MSSpectrum s = input[0];
+  picker.consumeSpectrum(s);
+  picker.flush();
+  TEST_EQUAL(picker.getNrPickedSpectra(), 1)
+
+  // centroided spectra are copied in auto mode
+  MSSpectrum centroided = expected[0];
+  centroided.setType(SpectrumSettings::CENTROID);
+  picker.consumeSpectrum(centroided);
+  picker.flush();
+  TEST_EQUAL(picker.getNrPickedSpectra(), 1)
+}
+END_SECTION
+
+START_SECTION((void setExperimentalSettings(const ExperimentalSettings& settings) override))
+{
+  NOT_TESTABLE // forwarded to the next consumer
+}
+END_SECTION
+
+START_SECTION((void setExpectedSize(Size expected_spectra, Size expected_chromatograms) override))
+{
+  NOT_TESTABLE // forwarded to the next consumer
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
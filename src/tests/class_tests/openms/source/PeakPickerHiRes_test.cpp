@@ -469,6 +469,79 @@ START_SECTION([EXTRA] test spectrum level selection)
 }
 END_SECTION
 
+START_SECTION(bool pickOrCopy(const MSSpectrum& input, MSSpectrum& output, std::vector<PeakBoundary>& boundaries, const bool check_spectrum_type = true, const bool query_data = true) const)
+{
+  PeakMap inSpecSelection;
+  MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("PeakPickerHiRes_spectrum_selection.mzML"), inSpecSelection);
+
+  Param pp_hires_param;
+  PeakPickerHiRes pp_spec_select;
+  pp_hires_param.setValue("ms_levels", ListUtils::create<Int>("2"));
+  pp_spec_select.setParameters(pp_hires_param);
+
+  PeakMap outMs2Only;
+  pp_spec_select.pickExperiment(inSpecSelection, outMs2Only);
+
+  // same result as the map-based method, spectrum by spectrum
+  for (Size i = 0; i < inSpecSelection.size(); ++i)
+  {
+    MSSpectrum out;
+    std::vector<PeakPickerHiRes::PeakBoundary> boundaries(1);
+    bool picked = pp_spec_select.pickOrCopy(inSpecSelection[i], out, boundaries);
+    TEST_EQUAL(picked, inSpecSelection[i].getMSLevel() == 2)
+    TEST_EQUAL(out == outMs2Only[i], true)
+    if (!picked)
+    {
+      TEST_EQUAL(boundaries.empty(), true)
+    }
+  }
+
+  // centroided input of a selected MS level
+  MSSpectrum centroided;
+  centroided.setMSLevel(2);
+  centroided.setType(SpectrumSettings::CENTROID);
+  MSSpectrum out;
+  std::vector<PeakPickerHiRes::PeakBoundary> boundaries;
+  TEST_EXCEPTION(Exception::IllegalArgument, pp_spec_select.pickOrCopy(centroided, out, boundaries))
+  TEST_EQUAL(pp_spec_select.pickOrCopy(centroided, out, boundaries, false), true)
+}
+END_SECTION
+
+START_SECTION(bool pickInPlace(MSSpectrum& spectrum, std::vector<PeakBoundary>& boundaries, const bool check_spectrum_type = true, const bool query_data = true) const)
+{
+  PeakMap inSpecSelection;
+  MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("PeakPickerHiRes_spectrum_selection.mzML"), inSpecSelection);
+
+  Param pp_hires_param;
+  PeakPickerHiRes pp_spec_select;
+  pp_hires_param.setValue("ms_levels", ListUtils::create<Int>("2"));
+  pp_spec_select.setParameters(pp_hires_param);
+
+  // same result as pickOrCopy()
+  for (Size i = 0; i < inSpecSelection.size(); ++i)
+  {
+    MSSpectrum out;
+    std::vector<PeakPickerHiRes::PeakBoundary> boundaries_copy;
+    pp_spec_select.pickOrCopy(inSpecSelection[i], out, boundaries_copy);
+
+    MSSpectrum spectrum = inSpecSelection[i];
+    std::vector<PeakPickerHiRes::PeakBoundary> boundaries(1);
+    bool picked = pp_spec_select.pickInPlace(spectrum, boundaries);
+    TEST_EQUAL(picked, inSpecSelection[i].getMSLevel() == 2)
+    TEST_EQUAL(spectrum == out, true)
+    TEST_EQUAL(boundaries.size(), boundaries_copy.size())
+  }
+
+  // centroided input of a selected MS level
+  MSSpectrum centroided;
+  centroided.setMSLevel(2);
+  centroided.setType(SpectrumSettings::CENTROID);
+  std::vector<PeakPickerHiRes::PeakBoundary> boundaries;
+  TEST_EXCEPTION(Exception::IllegalArgument, pp_spec_select.pickInPlace(centroided, boundaries))
+  TEST_EQUAL(pp_spec_select.pickInPlace(centroided, boundaries, false), true)
+}
+END_SECTION
+
 //////////////////////////////////////////////
 // check peak boundaries on simulation data //
 //////////////////////////////////////////////
@@ -42,6 +42,10 @@
 
 #include <OpenMS/KERNEL/Feature.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using namespace OpenMS;
 using namespace std;
 
@@ -293,6 +297,27 @@ START_SECTION(([EXTRA]virtual void run(const std::vector<Peak2D> & map_model, co
     TEST_REAL_SIMILAR(parameters.getValue("intercept"), -0.4)
   }
 
+  // using 1 point gives no votes -> number of points is doubled to reach "min_votes"
+  {
+    Param parameters;
+    parameters.setValue(String("scaling_bucket_size"), 0.01);
+    parameters.setValue(String("shift_bucket_size"), 0.1);
+    parameters.setValue(String("num_used_points"), 1);
+    parameters.setValue(String("min_votes"), 1); // -> same results as with two points expected
+
+    TransformationDescription transformation;
+    PoseClusteringAffineSuperimposer pcat;
+    pcat.setParameters(parameters);
+
+    pcat.run(map_model, map_scene, transformation);
+
+    TEST_STRING_EQUAL(transformation.getModelType(), "linear")
+    parameters = transformation.getModelParameters();
+    TEST_EQUAL(parameters.size(), 2)
+    TEST_REAL_SIMILAR(parameters.getValue("slope"), 1.0)
+    TEST_REAL_SIMILAR(parameters.getValue("intercept"), -0.4)
+  }
+
   // using 3 points
   {
     Param parameters;
@@ -339,6 +364,45 @@ START_SECTION(([EXTRA]virtual void run(const std::vector<Peak2D> & map_model, co
 }
 END_SECTION
 
+START_SECTION(([EXTRA] result does not depend on the number of threads))
+{
+#ifdef _OPENMP
+  // more model points than hashing blocks, scene is shifted and stretched in RT
+  std::vector<Peak2D> map_model, map_scene;
+  for (Size i = 0; i < 150; ++i)
+  {
+    Peak2D p;
+    p.setRT(10.0 + 7.3 * i);
+    p.setMZ(400.0 + 0.37 * (i % 50) + 20.0 * (i / 50));
+    p.setIntensity(100.0 + (i * 37) % 101);
+    map_model.push_back(p);
+    p.setRT(1.01 * p.getRT() + 5.0);
+    map_scene.push_back(p);
+  }
+
+  Param parameters;
+  parameters.setValue(String("scaling_bucket_size"), 0.01);
+  parameters.setValue(String("shift_bucket_size"), 0.1);
+  PoseClusteringAffineSuperimposer pcat;
+  pcat.setParameters(parameters);
+
+  int max_threads = omp_get_max_threads();
+  omp_set_num_threads(1);
+  TransformationDescription serial_trafo;
+  pcat.run(map_model, map_scene, serial_trafo);
+
+  omp_set_num_threads(std::max(max_threads, 4));
+  TransformationDescription parallel_trafo;
+  pcat.run(map_model, map_scene, parallel_trafo);
+  omp_set_num_threads(max_threads);
+
+  TEST_STRING_EQUAL(parallel_trafo.getModelType(), serial_trafo.getModelType())
+  TEST_EQUAL(parallel_trafo.getModelParameters().getValue("slope"), serial_trafo.getModelParameters().getValue("slope"))
+  TEST_EQUAL(parallel_trafo.getModelParameters().getValue("intercept"), serial_trafo.getModelParameters().getValue("intercept"))
+#endif
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
@@ -179,6 +179,34 @@ START_SECTION((void run(const std::vector<FeatureMap >& input_maps, ConsensusMap
   TEST_EQUAL(*(it) == ind4, true);
 
 
+  // m/z partitions are clustered independently, results are merged in m/z order:
+
+  Param param_partitions = param;
+  param_partitions.setValue("nr_partitions", 2);
+  finder.setParameters(param_partitions);
+  finder.run(input, result);
+  TEST_EQUAL(result.size(), 3);
+  ABORT_IF(result.size() != 3);
+
+  group1 = result[0].getFeatures();
+  group2 = result[1].getFeatures();
+  group3 = result[2].getFeatures();
+
+  it = group1.begin();
+  TEST_EQUAL(*(it) == ind1, true);
+  ++it;
+  TEST_EQUAL(*(it) == ind3, true);
+
+  it = group2.begin();
+  TEST_EQUAL(*(it) == ind4, true);
+
+  it = group3.begin();
+  TEST_EQUAL(*(it) == ind2, true);
+  ++it;
+  TEST_EQUAL(*(it) == ind5, true);
+  finder.setParameters(param);
+
+
 	// test annotation-specific matching (simple case):
 
 	param.setValue("use_identifications", "true");
@@ -229,6 +229,54 @@ START_SECTION(bool update(const QTCluster::Elements& removed))
 }
 END_SECTION
 
+START_SECTION((void reselectNeighbors(const std::unordered_set<const GridFeature*>& used)))
+{
+  GridFeature gf3(bf, 789, 1012);
+  GridFeature gf4(bf, 222, 1011);
+
+  QTCluster::BulkData data(&gf, 1000, 11.1, 0, 0, 4);
+  QTCluster cluster2(&data, false);
+  cluster2.initializeCluster();
+  cluster2.add(&gf2, 3.3);
+  cluster2.add(&gf3, 3.0);
+  cluster2.add(&gf4, 3.2);
+  cluster2.finalizeCluster();
+  TEST_EQUAL(cluster2.size(), 3)
+
+  // "gf3" is used by another cluster -> replaced by the next best feature from the same map:
+  QTCluster::Elements removed;
+  removed.push_back({789, &gf3});
+  TEST_EQUAL(cluster2.update(removed), true);
+  TEST_EQUAL(cluster2.size(), 2)
+  std::unordered_set<const GridFeature*> used;
+  used.insert(&gf3);
+  cluster2.reselectNeighbors(used);
+  TEST_EQUAL(cluster2.size(), 3)
+  QTCluster::Elements neighbors = cluster2.getAllNeighbors();
+  ABORT_IF(neighbors.size() != 2)
+  TEST_EQUAL((neighbors[0].feature == &gf2) || (neighbors[1].feature == &gf2), true)
+  TEST_EQUAL((neighbors[0].feature == &gf4) || (neighbors[1].feature == &gf4), true)
+
+  // same result as building the cluster from the remaining features:
+  QTCluster::BulkData data2(&gf, 1000, 11.1, 0, 0, 5);
+  QTCluster cluster3(&data2, false);
+  cluster3.initializeCluster();
+  cluster3.add(&gf2, 3.3);
+  cluster3.add(&gf4, 3.2);
+  cluster3.finalizeCluster();
+  TEST_REAL_SIMILAR(cluster2.getQuality(), cluster3.getQuality())
+
+  // no replacement available:
+  removed.clear();
+  removed.push_back({789, &gf2});
+  TEST_EQUAL(cluster2.update(removed), true);
+  used.insert(&gf2);
+  cluster2.reselectNeighbors(used);
+  TEST_EQUAL(cluster2.size(), 2)
+  TEST_EQUAL(cluster2.getAllNeighbors()[0].feature, &gf4)
+}
+END_SECTION
+
 QTCluster::BulkData qtc_data2(&gf, 2, 11.1, 7, 9, 3);
 
 START_SECTION((double getQuality()))
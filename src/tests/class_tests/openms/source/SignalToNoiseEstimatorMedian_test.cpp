@@ -115,6 +115,87 @@ START_SECTION([EXTRA](virtual void init(const Container& c)))
 END_SECTION
 
 
+START_SECTION([EXTRA] exact_median)
+{
+  MSSpectrum raw_data;
+  DTAFile().load(OPENMS_GET_TEST_DATA_PATH("SignalToNoiseEstimator_test.dta"), raw_data);
+
+  SignalToNoiseEstimatorMedian< MSSpectrum > sne;
+  Param p;
+  p.setValue("win_len", 40.0);
+  p.setValue("noise_for_empty_window", 2.0);
+  p.setValue("min_required_elements", 10);
+  p.setValue("exact_median", "true");
+  sne.setParameters(p);
+  sne.init(raw_data);
+
+  // compare to the lower median of each window, computed by sorting
+  for (Size i = 0; i < raw_data.size(); ++i)
+  {
+    std::vector<double> window;
+    for (const Peak1D& peak : raw_data)
+    {
+      if (peak.getMZ() >= raw_data[i].getMZ() - 20.0 && peak.getMZ() <= raw_data[i].getMZ() + 20.0)
+      {
+        window.push_back(peak.getIntensity());
+      }
+    }
+    double noise = 2.0;
+    if (window.size() >= 10)
+    {
+      std::sort(window.begin(), window.end());
+      noise = std::max(1.0, window[(window.size() + 1) / 2 - 1]);
+    }
+    TEST_REAL_SIMILAR(sne.getSignalToNoise(i), raw_data[i].getIntensity() / noise)
+  }
+  TEST_EQUAL(sne.getHistogramRightmostPercent(), 0.0)
+
+  // empty scan
+  MSSpectrum empty;
+  sne.init(empty);
+  NOT_TESTABLE
+}
+END_SECTION
+
+START_SECTION((void computeSTNBatch(const std::vector<Container>& containers, std::vector<std::vector<double> >& stn_values) const))
+{
+  MSSpectrum raw_data;
+  DTAFile().load(OPENMS_GET_TEST_DATA_PATH("SignalToNoiseEstimator_test.dta"), raw_data);
+  std::vector<MSSpectrum> spectra(5, raw_data);
+  spectra[1].resize(raw_data.size() / 2);
+  spectra[3].clear(false);
+
+  for (const String exact : {"false", "true"})
+  {
+    SignalToNoiseEstimatorMedian< MSSpectrum > sne;
+    Param p;
+    p.setValue("win_len", 40.0);
+    p.setValue("exact_median", exact);
+    sne.setParameters(p);
+
+    std::vector<std::vector<double> > stn_values;
+    sne.computeSTNBatch(spectra, stn_values);
+    ABORT_IF(stn_values.size() != spectra.size())
+    for (Size s = 0; s < spectra.size(); ++s)
+    {
+      TEST_EQUAL(stn_values[s].size(), spectra[s].size())
+      sne.init(spectra[s]);
+      for (Size i = 0; i < spectra[s].size(); ++i)
+      {
+        TEST_EQUAL(stn_values[s][i], sne.getSignalToNoise(i))
+      }
+    }
+  }
+
+  SignalToNoiseEstimatorMedian< MSSpectrum > sne;
+  Param p;
+  p.setValue("auto_mode", -1);
+  sne.setParameters(p);
+  std::vector<std::vector<double> > stn_values;
+  TEST_EXCEPTION(Exception::InvalidValue, sne.computeSTNBatch(spectra, stn_values))
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
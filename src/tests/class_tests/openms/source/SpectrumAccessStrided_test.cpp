@@ -0,0 +1,167 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SimpleOpenMSSpectraAccessFactory.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessStrided.h>
+///////////////////////////
+
+using namespace OpenMS;
+using namespace std;
+
+boost::shared_ptr<PeakMap > getData()
+{
+  boost::shared_ptr<PeakMap > exp2(new PeakMap);
+  for (Size i = 0; i < 7; ++i)
+  {
+    MSSpectrum spec;
+    spec.setRT(10.0 * i);
+    Peak1D p;
+    p.setMZ(100 + i);
+    p.setIntensity(50);
+    spec.push_back(p);
+    exp2->addSpectrum(spec);
+  }
+  return exp2;
+}
+
+START_TEST(SpectrumAccessStrided, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+SpectrumAccessStrided* ptr = nullptr;
+SpectrumAccessStrided* nullPointer = nullptr;
+
+boost::shared_ptr<PeakMap > exp(new PeakMap);
+OpenSwath::SpectrumAccessPtr expptr = SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(exp);
+OpenSwath::SpectrumAccessPtr dataptr = SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(getData());
+
+START_SECTION(SpectrumAccessStrided(OpenSwath::SpectrumAccessPtr sptr, Size stride, Size offset))
+{
+  ptr = new SpectrumAccessStrided(expptr, 3, 1);
+  TEST_NOT_EQUAL(ptr, nullPointer)
+
+  TEST_EXCEPTION(Exception::IllegalArgument, SpectrumAccessStrided(expptr, 0, 0))
+  TEST_EXCEPTION(Exception::IllegalArgument, SpectrumAccessStrided(expptr, 3, 3))
+}
+END_SECTION
+
+START_SECTION(~SpectrumAccessStrided())
+{
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION(size_t getNrSpectra() const)
+{
+  TEST_EQUAL(SpectrumAccessStrided(expptr, 3, 1).getNrSpectra(), 0)
+
+  TEST_EQUAL(SpectrumAccessStrided(dataptr, 1, 0).getNrSpectra(), 7)
+  TEST_EQUAL(SpectrumAccessStrided(dataptr, 3, 0).getNrSpectra(), 3)
+  TEST_EQUAL(SpectrumAccessStrided(dataptr, 3, 1).getNrSpectra(), 2)
+  TEST_EQUAL(SpectrumAccessStrided(dataptr, 3, 2).getNrSpectra(), 2)
+  TEST_EQUAL(SpectrumAccessStrided(dataptr, 8, 7).getNrSpectra(), 0)
+}
+END_SECTION
+
+START_SECTION(OpenSwath::SpectrumPtr getSpectrumById(int id))
+{
+  SpectrumAccessStrided strided(dataptr, 3, 1);
+  OpenSwath::SpectrumPtr spec0 = strided.getSpectrumById(0);
+  OpenSwath::SpectrumPtr spec1 = strided.getSpectrumById(1);
+  TEST_EQUAL(spec0->getMZArray()->data.size(), 1)
+  TEST_REAL_SIMILAR(spec0->getMZArray()->data[0], 101)
+  TEST_REAL_SIMILAR(spec1->getMZArray()->data[0], 104)
+}
+END_SECTION
+
+START_SECTION(OpenSwath::SpectrumMeta getSpectrumMetaById(int id) const)
+{
+  SpectrumAccessStrided strided(dataptr, 3, 1);
+  TEST_REAL_SIMILAR(strided.getSpectrumMetaById(0).RT, 10.0)
+  TEST_REAL_SIMILAR(strided.getSpectrumMetaById(1).RT, 40.0)
+}
+END_SECTION
+
+START_SECTION(std::vector<std::size_t> getSpectraByRT(double RT, double deltaRT) const)
+{
+  SpectrumAccessStrided strided(dataptr, 3, 1);
+  std::vector<std::size_t> res = strided.getSpectraByRT(40.0, 15.0);
+  TEST_EQUAL(res.size(), 1)
+  TEST_EQUAL(res[0], 1)
+
+  res = strided.getSpectraByRT(40.0, 35.0);
+  TEST_EQUAL(res.size(), 2)
+  TEST_EQUAL(res[0], 0)
+  TEST_EQUAL(res[1], 1)
+
+  // like the underlying map, the first spectrum (of the view) at or after RT - deltaRT is always reported
+  res = strided.getSpectraByRT(20.0, 5.0);
+  TEST_EQUAL(res.size(), 1)
+  TEST_EQUAL(res[0], 1)
+
+  // no window (as used for scoring)
+  res = strided.getSpectraByRT(0.0, 0.0);
+  TEST_EQUAL(res.size(), 1)
+  TEST_EQUAL(res[0], 0)
+  res = strided.getSpectraByRT(20.0, 0.0);
+  TEST_EQUAL(res.size(), 1)
+  TEST_EQUAL(res[0], 1)
+  res = strided.getSpectraByRT(40.0, 0.0);
+  TEST_EQUAL(res.size(), 1)
+  TEST_EQUAL(res[0], 1)
+
+  // no spectrum of the view after RT - deltaRT
+  TEST_EQUAL(strided.getSpectraByRT(50.0, 0.0).size(), 0)
+  TEST_EQUAL(strided.getSpectraByRT(100.0, 5.0).size(), 0)
+}
+END_SECTION
+
+START_SECTION(boost::shared_ptr<OpenSwath::ISpectrumAccess> lightClone() const)
+{
+  SpectrumAccessStrided strided(dataptr, 2, 1);
+  boost::shared_ptr<OpenSwath::ISpectrumAccess> clone_ptr = strided.lightClone();
+  TEST_EQUAL(clone_ptr->getNrSpectra(), 3)
+  TEST_REAL_SIMILAR(clone_ptr->getSpectrumById(2)->getMZArray()->data[0], 105)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
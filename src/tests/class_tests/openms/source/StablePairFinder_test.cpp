@@ -253,6 +253,40 @@ START_SECTION(([EXTRA] void run(const std::vector<ConsensusMap>& input_maps, Con
 }
 END_SECTION
 
+START_SECTION(([EXTRA] void run(const std::vector<ConsensusMap>& input_maps, ConsensusMap &result_map) - distant second-nearest neighbors))
+{
+	// the second-nearest neighbor is far outside of the tolerance windows, but
+	// still determines the quality:
+	std::vector<ConsensusMap> input(2);
+	Feature feat1, feat2, feat3;
+	feat1.setPosition(PositionType(100, 500));
+	feat1.setUniqueId(0);
+	feat2.setPosition(PositionType(101, 500.1));
+	feat2.setUniqueId(1);
+	feat3.setPosition(PositionType(200, 500));
+	feat3.setUniqueId(2);
+	input[0].push_back(ConsensusFeature(0, feat1));
+	input[1].push_back(ConsensusFeature(1, feat2));
+	input[1].push_back(ConsensusFeature(1, feat3));
+
+	StablePairFinder spf;
+	Param param = spf.getDefaults();
+	param.setValue("distance_RT:max_difference", 10.0);
+	param.setValue("distance_MZ:max_difference", 1.0);
+	param.setValue("second_nearest_gap", 2.0);
+	spf.setParameters(param);
+	ConsensusMap result;
+	spf.run(input, result);
+	TEST_EQUAL(result.size(), 2);
+	ABORT_IF(result.size() != 2);
+	// sorted by m/z:
+	TEST_EQUAL(result[0].size(), 1);
+	TEST_EQUAL(result[1].size(), 2);
+	// d(1, 2) = (0.1 + 0.1^2) / 2, d(1, 3) = (10 + 0) / 2, no second-nearest neighbor for feat2:
+	TEST_REAL_SIMILAR(result[1].getQuality(), (1.0 - 0.055) * (1.0 - 2 * 0.055 / 5.0));
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
@@ -0,0 +1,190 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: $
+// --------------------------------------------------------------------------
+
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/DATASTRUCTURES/StaticKDTree.h>
+///////////////////////////
+
+#include <algorithm>
+#include <random>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(StaticKDTree, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+typedef StaticKDTree<2, 4> Tree;
+
+// brute-force reference for range queries
+auto bruteForce = [](const vector<Tree::PointType>& points, const Tree::PointType& low, const Tree::PointType& high)
+{
+  vector<Size> result;
+  for (Size i = 0; i < points.size(); ++i)
+  {
+    if (points[i][0] >= low[0] && points[i][0] <= high[0] &&
+        points[i][1] >= low[1] && points[i][1] <= high[1])
+    {
+      result.push_back(i);
+    }
+  }
+  return result;
+};
+
+// random points on a coarse grid (to get duplicate coordinates)
+std::mt19937 rng(42);
+std::uniform_int_distribution<int> rt_dist(0, 200);
+std::uniform_int_distribution<int> mz_dist(0, 50);
+vector<Tree::PointType> points;
+for (Size i = 0; i < 1000; ++i)
+{
+  points.push_back({rt_dist(rng) * 5.0, 400.0 + mz_dist(rng) * 0.1});
+}
+
+Tree* ptr = nullptr;
+Tree* null_ptr = nullptr;
+
+START_SECTION((StaticKDTree()))
+{
+  ptr = new Tree();
+  TEST_NOT_EQUAL(ptr, null_ptr)
+  TEST_EQUAL(ptr->size(), 0)
+  TEST_EQUAL(ptr->empty(), true)
+  delete ptr;
+}
+END_SECTION
+
+Tree tree;
+
+START_SECTION((void insert(const PointType& point)))
+{
+  for (const Tree::PointType& p : points)
+  {
+    tree.insert(p);
+  }
+  TEST_EQUAL(tree.size(), points.size())
+  TEST_EQUAL(tree.empty(), false)
+  TEST_REAL_SIMILAR(tree.point(3)[0], points[3][0])
+  TEST_REAL_SIMILAR(tree.point(3)[1], points[3][1])
+}
+END_SECTION
+
+START_SECTION((void findWithinRange(const PointType& low, const PointType& high, std::vector<Size>& result) const))
+{
+  // before optimization (linear scan)
+  vector<Size> result;
+  tree.findWithinRange({100.0, 401.0}, {300.0, 402.0}, result);
+  sort(result.begin(), result.end());
+  TEST_EQUAL(result == bruteForce(points, {100.0, 401.0}, {300.0, 402.0}), true)
+
+  tree.optimize();
+  std::uniform_real_distribution<double> rt_query(-10.0, 1010.0);
+  std::uniform_real_distribution<double> mz_query(399.0, 406.0);
+  Size total = 0;
+  for (Size q = 0; q < 200; ++q)
+  {
+    Tree::PointType low = {rt_query(rng), mz_query(rng)};
+    Tree::PointType high = {low[0] + 50.0, low[1] + 0.5};
+    result.clear();
+    tree.findWithinRange(low, high, result);
+    sort(result.begin(), result.end());
+    vector<Size> expected = bruteForce(points, low, high);
+    TEST_EQUAL(result == expected, true)
+    total += expected.size();
+  }
+  TEST_NOT_EQUAL(total, 0)
+
+  // closed boxes: points on the boundary are included
+  result.clear();
+  tree.findWithinRange(points[0], points[0], result);
+  TEST_EQUAL(find(result.begin(), result.end(), 0) != result.end(), true)
+
+  // empty box
+  result.clear();
+  tree.findWithinRange({2000.0, 400.0}, {3000.0, 500.0}, result);
+  TEST_EQUAL(result.size(), 0)
+}
+END_SECTION
+
+START_SECTION((void setPoint(Size i, const PointType& point)))
+{
+  tree.setPoint(0, {2500.0, 450.0});
+  vector<Size> result;
+  tree.findWithinRange({2000.0, 400.0}, {3000.0, 500.0}, result);
+  TEST_EQUAL(result.size(), 1)
+  TEST_EQUAL(result[0], 0)
+  tree.optimize();
+  result.clear();
+  tree.findWithinRange({2000.0, 400.0}, {3000.0, 500.0}, result);
+  TEST_EQUAL(result.size(), 1)
+  TEST_EQUAL(result[0], 0)
+}
+END_SECTION
+
+START_SECTION((void optimize()))
+{
+  // points added after optimization are found as well
+  tree.insert({-100.0, 300.0});
+  vector<Size> result;
+  tree.findWithinRange({-200.0, 200.0}, {0.0, 400.0}, result);
+  sort(result.begin(), result.end());
+  TEST_EQUAL(result.size(), 1)
+  TEST_EQUAL(result.back(), points.size())
+  tree.optimize();
+  result.clear();
+  tree.findWithinRange({-200.0, 200.0}, {0.0, 400.0}, result);
+  TEST_EQUAL(result.size(), 1)
+  TEST_EQUAL(result.back(), points.size())
+}
+END_SECTION
+
+START_SECTION((void clear()))
+{
+  tree.clear();
+  TEST_EQUAL(tree.size(), 0)
+  vector<Size> result;
+  tree.findWithinRange({-1000.0, 0.0}, {5000.0, 1000.0}, result);
+  TEST_EQUAL(result.size(), 0)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -0,0 +1,255 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2022.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/OPENSWATH/SwathWindowLibrary.h>
+///////////////////////////
+
+#include <OpenMS/ANALYSIS/OPENSWATH/OpenSwathHelper.h>
+
+using namespace OpenMS;
+
+namespace
+{
+  OpenSwath::LightTargetedExperiment createLibrary()
+  {
+    OpenSwath::LightTargetedExperiment exp;
+    const std::vector<std::pair<std::string, double> > precursors = {{"pep1", 410.0}, {"pep2", 430.0}, {"pep3", 449.9}, {"pep4", 420.0}};
+    for (const auto& prec : precursors)
+    {
+      OpenSwath::LightCompound c;
+      c.id = prec.first;
+      c.protein_refs.push_back(prec.first == "pep1" ? "prot1" : "prot2");
+      exp.compounds.push_back(c);
+      for (int k = 0; k < 2; ++k)
+      {
+        OpenSwath::LightTransition tr;
+        tr.transition_name = prec.first + "_" + String(k);
+        tr.peptide_ref = prec.first;
+        tr.precursor_mz = prec.second;
+        tr.product_mz = 500.0 + k;
+        exp.transitions.push_back(tr);
+      }
+    }
+    OpenSwath::LightProtein p1, p2;
+    p1.id = "prot1";
+    p2.id = "prot2";
+    exp.proteins.push_back(p1);
+    exp.proteins.push_back(p2);
+    return exp;
+  }
+}
+
+START_TEST(SwathWindowLibrary, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+OpenSwath::LightTargetedExperiment library = createLibrary();
+
+std::vector<OpenSwath::SwathMap> swath_maps(3);
+swath_maps[0].ms1 = true;
+swath_maps[1].lower = 400;
+swath_maps[1].upper = 425;
+swath_maps[2].lower = 425;
+swath_maps[2].upper = 450;
+
+SwathWindowLibrary* ptr = nullptr;
+SwathWindowLibrary* nullPointer = nullptr;
+
+START_SECTION(explicit SwathWindowLibrary(const OpenSwath::LightTargetedExperiment& library))
+{
+  ptr = new SwathWindowLibrary(library);
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->isOnDisk(), false)
+  TEST_EQUAL(ptr->getNrWindows(), 0)
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION(explicit SwathWindowLibrary(const String& pqp_file, bool legacy_traml_id = false))
+{
+  ptr = new SwathWindowLibrary(String("library.pqp"));
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->isOnDisk(), true)
+  TEST_EQUAL(ptr->getNrWindows(), 0)
+
+  // on-disk libraries are only read when assays are retrieved
+  ptr->partition(swath_maps, 0.0);
+  TEST_EQUAL(ptr->getNrWindows(), 3)
+
+  std::vector<int> tr_win_map(library.transitions.size(), 1);
+  TEST_EXCEPTION(Exception::IllegalArgument, ptr->partition(tr_win_map, 3))
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION(void partition(const std::vector<OpenSwath::SwathMap>& swath_maps, double min_upper_edge_dist))
+{
+  SwathWindowLibrary lib(library);
+  lib.partition(swath_maps, 0.5);
+  TEST_EQUAL(lib.getNrWindows(), 3)
+
+  // MS1 map has no assays
+  OpenSwath::LightTargetedExperiment assays;
+  lib.getWindowAssays(0, assays);
+  TEST_EQUAL(assays.transitions.size(), 0)
+  TEST_EQUAL(assays.compounds.size(), 0)
+  TEST_EQUAL(assays.proteins.size(), 0)
+
+  // pep1 and pep4, library order is kept
+  lib.getWindowAssays(1, assays);
+  TEST_EQUAL(assays.transitions.size(), 4)
+  TEST_EQUAL(assays.transitions[0].transition_name, "pep1_0")
+  TEST_EQUAL(assays.transitions[3].transition_name, "pep4_1")
+  TEST_EQUAL(assays.compounds.size(), 2)
+  TEST_EQUAL(assays.compounds[0].id, "pep1")
+  TEST_EQUAL(assays.compounds[1].id, "pep4")
+  TEST_EQUAL(assays.proteins.size(), 2)
+
+  // pep3 is too close to the upper edge
+  lib.getWindowAssays(2, assays);
+  TEST_EQUAL(assays.transitions.size(), 2)
+  TEST_EQUAL(assays.compounds.size(), 1)
+  TEST_EQUAL(assays.compounds[0].id, "pep2")
+  TEST_EQUAL(assays.proteins.size(), 1)
+  TEST_EQUAL(assays.proteins[0].id, "prot2")
+
+  // same result as selecting from the full library
+  for (Size i = 1; i < swath_maps.size(); ++i)
+  {
+    OpenSwath::LightTargetedExperiment expected;
+    OpenSwathHelper::selectSwathTransitions(library, expected, 0.5, swath_maps[i].lower, swath_maps[i].upper);
+    lib.getWindowAssays(i, assays);
+    TEST_EQUAL(assays.transitions.size(), expected.transitions.size())
+    TEST_EQUAL(assays.compounds.size(), expected.compounds.size())
+    TEST_EQUAL(assays.proteins.size(), expected.proteins.size())
+    for (Size k = 0; k < expected.transitions.size(); ++k)
+    {
+      TEST_EQUAL(assays.transitions[k].transition_name, expected.transitions[k].transition_name)
+    }
+  }
+}
+END_SECTION
+
+START_SECTION(void partition(const std::vector<int>& tr_win_map, Size nr_windows))
+{
+  SwathWindowLibrary lib(library);
+  std::vector<int> tr_win_map = {1, 1, -1, -1, 2, 2, 1, 1};
+  lib.partition(tr_win_map, 3);
+  TEST_EQUAL(lib.getNrWindows(), 3)
+
+  OpenSwath::LightTargetedExperiment assays;
+  lib.getWindowAssays(1, assays);
+  TEST_EQUAL(assays.transitions.size(), 4)
+  TEST_EQUAL(assays.compounds.size(), 2)
+  lib.getWindowAssays(2, assays);
+  TEST_EQUAL(assays.transitions.size(), 2)
+  TEST_EQUAL(assays.compounds.size(), 1)
+  TEST_EQUAL(assays.compounds[0].id, "pep3")
+
+  TEST_EXCEPTION(Exception::IllegalArgument, lib.partition(std::vector<int>(3, 1), 3))
+}
+END_SECTION
+
+START_SECTION(void getWindowAssays(Size window_idx, OpenSwath::LightTargetedExperiment& assays) const)
+{
+  SwathWindowLibrary lib(library);
+  OpenSwath::LightTargetedExperiment assays;
+  TEST_EXCEPTION(Exception::IndexOverflow, lib.getWindowAssays(0, assays))
+  lib.partition(swath_maps, 0.0);
+  TEST_EXCEPTION(Exception::IndexOverflow, lib.getWindowAssays(3, assays))
+  lib.getWindowAssays(2, assays);
+  TEST_EQUAL(assays.transitions.size(), 4)
+}
+END_SECTION
+
+START_SECTION(void getAllAssays(OpenSwath::LightTargetedExperiment& assays) const)
+{
+  SwathWindowLibrary lib(library);
+  OpenSwath::LightTargetedExperiment assays;
+  lib.getAllAssays(assays);
+  TEST_EQUAL(assays.transitions.size(), library.transitions.size())
+  TEST_EQUAL(assays.compounds.size(), library.compounds.size())
+  TEST_EQUAL(assays.proteins.size(), library.proteins.size())
+}
+END_SECTION
+
+START_SECTION(Size getNrWindows() const)
+{
+  NOT_TESTABLE // see above
+}
+END_SECTION
+
+START_SECTION(Size getNrTransitions() const)
+{
+  SwathWindowLibrary lib(library);
+  TEST_EQUAL(lib.getNrTransitions(), library.transitions.size())
+
+  // counted in the PQP file, nothing else is read
+  SwathWindowLibrary disk_lib(String(OPENMS_GET_TEST_DATA_PATH("SwathWindowLibrary_test.pqp")));
+  TEST_EQUAL(disk_lib.getNrTransitions(), 44)
+}
+END_SECTION
+
+START_SECTION(bool isOnDisk() const)
+{
+  NOT_TESTABLE // see above
+}
+END_SECTION
+
+START_SECTION(void setDriftTimeTransformation(const TransformationDescription& im_trafo))
+{
+  SwathWindowLibrary lib(library);
+  lib.partition(swath_maps, 0.0);
+
+  std::vector<std::pair<double, double> > data = {{-1.0, 0.0}, {1.0, 2.0}};
+  TransformationDescription im_trafo;
+  im_trafo.setDataPoints(data);
+  im_trafo.fitModel("linear", Param());
+  lib.setDriftTimeTransformation(im_trafo);
+
+  OpenSwath::LightTargetedExperiment assays;
+  lib.getWindowAssays(1, assays);
+  TEST_REAL_SIMILAR(assays.compounds[0].drift_time, 0.0)
+  TEST_REAL_SIMILAR(library.compounds[0].drift_time, -1.0) // library itself is unchanged
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -143,6 +143,26 @@ START_SECTION((double apply(double value) const))
 }
 END_SECTION
 
+START_SECTION((void apply(const std::vector<double>& values, std::vector<double>& result) const))
+{
+	TransformationDescription td;
+	vector<double> values = {-0.5, 1000}, result;
+	td.apply(values, result);
+	TEST_EQUAL(result.size(), 2);
+	TEST_EQUAL(result[0], -0.5);
+	TEST_EQUAL(result[1], 1000);
+
+	TransformationDescription::DataPoints data;
+	data.push_back(make_pair(0.0, 1.0));
+	data.push_back(make_pair(1.0, 3.0));
+	td.setDataPoints(data);
+	td.fitModel("linear");
+	td.apply(values, values);
+	TEST_REAL_SIMILAR(values[0], 0.0);
+	TEST_REAL_SIMILAR(values[1], 2001.0);
+}
+END_SECTION
+
 START_SECTION((const String& getModelType() const))
 {
 	TransformationDescription td;
@@ -41,6 +41,7 @@
 #include <OpenMS/ANALYSIS/MAPMATCHING/TransformationModelInterpolated.h>
 
 #include <OpenMS/FORMAT/CsvFile.h>
+#include <OpenMS/DATASTRUCTURES/ListUtils.h>
 
 ///////////////////////////
 
@@ -187,6 +188,37 @@ START_SECTION(([EXTRA] TransformationModelInterpolated::evaluate() beyond the ac
 }
 END_SECTION
 
+START_SECTION((void evaluate(const std::vector<double>& values, std::vector<double>& result) const))
+{
+  // sorted values (including extrapolation on both sides) and unsorted values give the same results as single evaluation
+  vector<double> sorted = {-0.5, 0.0, 0.1, 0.25, 0.5, 0.5, 0.75, 1.0, 1.5};
+  vector<double> unsorted = {0.75, -0.5, 1.5, 0.0, 0.5};
+  for (const String& interpolation : ListUtils::create<String>("linear,cspline,akima"))
+  {
+    Param p;
+    TransformationModelInterpolated::getDefaultParameters(p);
+    p.setValue("interpolation_type", interpolation);
+    p.setValue("extrapolation_type", "four-point-linear");
+    TransformationModelInterpolated tr(dummy_data, p);
+
+    vector<double> result;
+    tr.evaluate(sorted, result);
+    TEST_EQUAL(result.size(), sorted.size())
+    for (Size i = 0; i < sorted.size(); ++i)
+    {
+      TEST_REAL_SIMILAR(result[i], tr.evaluate(sorted[i]))
+    }
+    // in place
+    result = unsorted;
+    tr.evaluate(result, result);
+    for (Size i = 0; i < unsorted.size(); ++i)
+    {
+      TEST_REAL_SIMILAR(result[i], tr.evaluate(unsorted[i]))
+    }
+  }
+}
+END_SECTION
+
 START_SECTION((static void getDefaultParameters(Param & params)))
 {
   Param p;
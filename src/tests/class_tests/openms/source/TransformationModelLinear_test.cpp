@@ -93,6 +93,36 @@ START_SECTION((virtual double evaluate(double value) const))
 }
 END_SECTION
 
+START_SECTION((void evaluate(const std::vector<double>& values, std::vector<double>& result) const))
+{
+  TransformationModelLinear lm(data, Param());
+  vector<double> values = {1.5, -0.5, 0.0, 1.0, 0.5};
+  vector<double> result;
+  lm.evaluate(values, result);
+  TEST_EQUAL(result.size(), 5);
+  TEST_REAL_SIMILAR(result[0], 4.0);
+  TEST_REAL_SIMILAR(result[1], 0.0);
+  TEST_REAL_SIMILAR(result[2], 1.0);
+  TEST_REAL_SIMILAR(result[3], 3.0);
+  TEST_REAL_SIMILAR(result[4], 2.0);
+
+  // with weighting (evaluated value by value):
+  Param params;
+  TransformationModelLinear::getDefaultParameters(params);
+  params.setValue("x_weight", "ln(x)");
+  params.setValue("y_weight", "ln(y)");
+  TransformationModel::DataPoints data_weighted;
+  data_weighted.push_back(make_pair(1.0, 2.0));
+  data_weighted.push_back(make_pair(2.0, 5.0));
+  data_weighted.push_back(make_pair(4.0, 7.0));
+  TransformationModelLinear lm_weighted(data_weighted, params);
+  values = {1.5, 3.0};
+  lm_weighted.evaluate(values, values); // in place
+  TEST_REAL_SIMILAR(values[0], lm_weighted.evaluate(1.5));
+  TEST_REAL_SIMILAR(values[1], lm_weighted.evaluate(3.0));
+}
+END_SECTION
+
 START_SECTION((void getParameters(Param & params) const))
 {  
 
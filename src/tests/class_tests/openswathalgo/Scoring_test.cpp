@@ -351,6 +351,43 @@ BOOST_AUTO_TEST_CASE(test_MRMFeatureScoring_normalizedCrossCorrelation)
 }
 END_SECTION
 
+BOOST_AUTO_TEST_CASE(test_normalizedCrossCorrelationMaxPeak)
+{
+  static const double arr1[] = {0,1,3,5,2,0};
+  static const double arr2[] = {1,3,5,2,0,0};
+  std::vector<double> data1 (arr1, arr1 + sizeof(arr1) / sizeof(arr1[0]) );
+  std::vector<double> data2 (arr2, arr2 + sizeof(arr2) / sizeof(arr2[0]) );
+  Scoring::standardize_data(data1);
+  Scoring::standardize_data(data2);
+
+  std::vector<double> buffer;
+  OpenSwath::Scoring::XCorrEntry max_peak = Scoring::normalizedCrossCorrelationMaxPeak(&data1[0], &data2[0], 6, 2, 1, buffer);
+  TEST_EQUAL (max_peak.first, -1)
+  TEST_REAL_SIMILAR (max_peak.second, 0.8215339)
+
+  // identical to the apex of the full cross-correlation array
+  for (int maxdelay = 0; maxdelay <= 7; ++maxdelay)
+  {
+    for (int lag = 1; lag <= 3; ++lag)
+    {
+      OpenSwath::Scoring::XCorrArrayType result = Scoring::normalizedCrossCorrelationPost(data1, data2, maxdelay, lag);
+      OpenSwath::Scoring::XCorrEntry full_peak = *Scoring::xcorrArrayGetMaxPeak(result);
+      max_peak = Scoring::normalizedCrossCorrelationMaxPeak(&data1[0], &data2[0], 6, maxdelay, lag, buffer);
+      TEST_EQUAL (max_peak.first, full_peak.first)
+      TEST_EQUAL (max_peak.second, full_peak.second)
+    }
+  }
+
+  // data anti-correlated everywhere: the (zero) correlation at the outermost delay wins
+  std::vector<double> data3 = data2;
+  for (auto& d : data3) d = -std::fabs(d) - 1.0;
+  std::vector<double> data4(6, 1.0);
+  max_peak = Scoring::normalizedCrossCorrelationMaxPeak(&data4[0], &data3[0], 6, 6, 1, buffer);
+  TEST_EQUAL (max_peak.first, -6)
+  TEST_REAL_SIMILAR (max_peak.second, 0.0)
+}
+END_SECTION
+
 BOOST_AUTO_TEST_CASE(test_MRMFeatureScoring_calcxcorr_legacy_mquest_)
 //START_SECTION((MRMFeatureScoring::XCorrArrayType MRMFeatureScoring::calcxcorr(std::vector<double>& data1, std::vector<double>& data2, bool normalize)))
 {
@@ -222,32 +222,7 @@ protected:
         ms_run_locations.insert(ms_run_locations.end(), ms_runs.begin(), ms_runs.end());
 
         // to save memory, remove convex hulls, subordinates:
-        for (Feature& ft : tmp)
-        {
-          String adduct;
-          String group;
-          //exception: addduct information
-          if (ft.metaValueExists(Constants::UserParam::DC_CHARGE_ADDUCTS))
-          {
-            adduct = ft.getMetaValue(Constants::UserParam::DC_CHARGE_ADDUCTS);
-          }
-          if (ft.metaValueExists(Constants::UserParam::ADDUCT_GROUP))
-          {
-            group = ft.getMetaValue(Constants::UserParam::ADDUCT_GROUP);
-          }
-          ft.getSubordinates().clear();
-          ft.getConvexHulls().clear();
-          ft.clearMetaInfo();
-          if (!adduct.empty())
-          {
-            ft.setMetaValue(Constants::UserParam::DC_CHARGE_ADDUCTS, adduct);
-          }
-          if (!group.empty())
-          {
-            ft.setMetaValue("Group", group);
-          }
-
-        }
+        reduceFeatures_(tmp);
 
         maps[i] = tmp;
         maps[i].updateRanges();
@@ -363,17 +338,52 @@ protected:
     {
       ++num_consfeat_of_size[cf.size()];
     }
+    logConsensusSizes_(num_consfeat_of_size, out_map.size());
+
+    return EXECUTION_OK;
+  }
+
+  /// Removes everything from the features of @p map that is not needed for linking (convex hulls, subordinates, meta values except adduct information)
+  static void reduceFeatures_(FeatureMap& map)
+  {
+    for (Feature& ft : map)
+    {
+      String adduct;
+      String group;
+      //exception: addduct information
+      if (ft.metaValueExists(Constants::UserParam::DC_CHARGE_ADDUCTS))
+      {
+        adduct = ft.getMetaValue(Constants::UserParam::DC_CHARGE_ADDUCTS);
+      }
+      if (ft.metaValueExists(Constants::UserParam::ADDUCT_GROUP))
+      {
+        group = ft.getMetaValue(Constants::UserParam::ADDUCT_GROUP);
+      }
+      ft.getSubordinates().clear();
+      ft.getConvexHulls().clear();
+      ft.clearMetaInfo();
+      if (!adduct.empty())
+      {
+        ft.setMetaValue(Constants::UserParam::DC_CHARGE_ADDUCTS, adduct);
+      }
+      if (!group.empty())
+      {
+        ft.setMetaValue("Group", group);
+      }
+    }
+  }
 
+  /// Logs the number of consensus features per size
+  static void logConsensusSizes_(const map<Size, UInt>& num_consfeat_of_size, Size total)
+  {
     OPENMS_LOG_INFO << "Number of consensus features:" << endl;
-    for (map<Size, UInt>::reverse_iterator i = num_consfeat_of_size.rbegin();
+    for (map<Size, UInt>::const_reverse_iterator i = num_consfeat_of_size.rbegin();
          i != num_consfeat_of_size.rend(); ++i)
     {
       OPENMS_LOG_INFO << "  of size " << setw(2) << i->first << ": " << setw(6) 
                << i->second << endl;
     }
-    OPENMS_LOG_INFO << "  total:      " << setw(6) << out_map.size() << endl;
-
-    return EXECUTION_OK;
+    OPENMS_LOG_INFO << "  total:      " << setw(6) << total << endl;
   }
 
 };
@@ -37,6 +37,7 @@
 #include <OpenMS/CONCEPT/ProgressLogger.h>
 #include <OpenMS/DATASTRUCTURES/DefaultParamHandler.h>
 #include <OpenMS/ANALYSIS/MAPMATCHING/FeatureGroupingAlgorithmKD.h>
+#include <OpenMS/FORMAT/DATAACCESS/ConsensusXMLWritingConsumer.h>
 
 #include "../topp/FeatureLinkerBase.cpp"
 
@@ -96,6 +97,17 @@ using namespace std;
  used connected components memory-wise. More stringent m/z or retention time
  tolerances might be required then.
 
+ For very large cohorts of featureXML files, whose features do not fit into
+ memory at once, the -batch_size option enables out-of-core linking: only the
+ meta data and the m/z values of all features are collected in a first pass
+ over the input files. The m/z partitions are then processed in batches of
+ (at least) the given number of features; for each batch, only the features in
+ its m/z range are read from the input files, and the resulting consensus
+ features are written to the output file immediately. The input files are read
+ once more per batch (twice, if RT warping is enabled). Consensus features are
+ linked in the same partitions as in the in-memory mode, but they are only
+ sorted within each batch, so the order in the output may differ.
+
  <B>The command line parameters of this tool are:</B>
  @verbinclude TOPP_FeatureLinkerUnlabeledKD.cli
  <B>INI file documentation of this tool:</B>
@@ -121,6 +133,8 @@ protected:
   void registerOptionsAndFlags_() override
   {
     TOPPFeatureLinkerBase::registerOptionsAndFlags_();
+    registerIntOption_("batch_size", "<number>", 0, "For featureXML input only: If larger than zero, link the features out-of-core, reading only batches of m/z partitions with at least this many features (over all input files) into memory at a time and writing the output incrementally. Not supported together with 'design'.", false, true);
+    setMinInt_("batch_size", 0);
     registerSubsection_("algorithm", "Algorithm parameters section");
   }
 
@@ -134,7 +148,147 @@ protected:
   ExitCodes main_(int, const char **) override
   {
     FeatureGroupingAlgorithmKD algo;
-    return TOPPFeatureLinkerBase::common_main_(&algo);
+    Size batch_size = getIntOption_("batch_size");
+    if (batch_size == 0)
+    {
+      return TOPPFeatureLinkerBase::common_main_(&algo);
+    }
+    return outOfCoreMain_(algo, batch_size);
+  }
+
+  /// Links featureXML files batch by batch, without loading all features at once
+  ExitCodes outOfCoreMain_(FeatureGroupingAlgorithmKD& algo, Size batch_size)
+  {
+    //-------------------------------------------------------------
+    // parameter handling
+    //-------------------------------------------------------------
+    StringList ins = getStringList_("in");
+    String out = getStringOption_("out");
+
+    for (Size i = 0; i < ins.size(); ++i)
+    {
+      if (FileHandler::getType(ins[i]) != FileTypes::FEATUREXML)
+      {
+        writeLog_("Error: Out-of-core linking ('batch_size' > 0) requires featureXML input!");
+        return ILLEGAL_PARAMETERS;
+      }
+    }
+    if (!getStringOption_("design").empty())
+    {
+      writeLog_("Error: Out-of-core linking ('batch_size' > 0) does not support an experimental design!");
+      return ILLEGAL_PARAMETERS;
+    }
+
+    Param algorithm_param = getParam_().copy("algorithm:", true);
+    writeDebug_("Used algorithm parameters", algorithm_param, 3);
+    algo.setParameters(algorithm_param);
+
+    // to save memory don't load convex hulls and subordinates
+    FeatureXMLFile f;
+    FeatureFileOptions options = f.getOptions();
+    options.setLoadSubordinates(false);
+    options.setLoadConvexHull(false);
+    f.setOptions(options);
+
+    //-------------------------------------------------------------
+    // first pass: meta data, m/z values and intensity maximum
+    //-------------------------------------------------------------
+    OPENMS_LOG_INFO << "Linking " << ins.size() << " featureXMLs (out-of-core)." << endl;
+    ConsensusMap header;
+    vector<double> mz_values;
+    double max_intensity(0.0);
+
+    Size progress = 0;
+    setLogType(ProgressLogger::CMD);
+    startProgress(0, ins.size(), "reading input (meta data)");
+    for (Size i = 0; i < ins.size(); ++i)
+    {
+      FeatureMap tmp;
+      f.load(ins[i], tmp);
+
+      StringList ms_runs;
+      tmp.getPrimaryMSRunPath(ms_runs);
+
+      // associate mzML file with map i in consensusXML
+      if (ms_runs.size() > 1 || ms_runs.empty())
+      {
+        OPENMS_LOG_WARN << "Exactly one MS run should be associated with a FeatureMap. "
+          << ms_runs.size()
+          << " provided." << endl;
+      }
+      else
+      {
+        header.getColumnHeaders()[i].filename = ms_runs.front();
+      }
+      header.getColumnHeaders()[i].size = tmp.size();
+      header.getColumnHeaders()[i].unique_id = tmp.getUniqueId();
+
+      for (const Feature& ft : tmp)
+      {
+        mz_values.push_back(ft.getMZ());
+        max_intensity = max(max_intensity, double(ft.getIntensity()));
+      }
+
+      // protein IDs and unassigned peptide IDs in the order of the input maps
+      // (as done by FeatureGroupingAlgorithm for in-memory linking)
+      header.getProteinIdentifications().insert(header.getProteinIdentifications().end(),
+        tmp.getProteinIdentifications().begin(), tmp.getProteinIdentifications().end());
+      for (const PeptideIdentification& pep_id : tmp.getUnassignedPeptideIdentifications())
+      {
+        header.getUnassignedPeptideIdentifications().push_back(pep_id);
+        header.getUnassignedPeptideIdentifications().back().setMetaValue("map_index", i);
+      }
+
+      setProgress(progress++);
+    }
+    endProgress();
+
+    header.setUniqueId();
+    // annotate output with data processing info
+    addDataProcessing_(header, getProcessingInfo_(DataProcessing::FEATURE_GROUPING));
+
+    //-------------------------------------------------------------
+    // perform grouping, reading and writing batch by batch
+    //-------------------------------------------------------------
+    auto load_range = [&](double mz_min, double mz_max, vector<FeatureMap>& maps)
+    {
+      FeatureXMLFile range_file;
+      FeatureFileOptions range_options = options;
+      range_options.setMZRange(DRange<1>(mz_min, mz_max));
+      range_file.setOptions(range_options);
+
+      maps.resize(ins.size());
+      for (Size i = 0; i < ins.size(); ++i)
+      {
+        range_file.load(ins[i], maps[i]);
+        reduceFeatures_(maps[i]);
+        maps[i].updateRanges();
+      }
+    };
+
+    ConsensusXMLWritingConsumer writer(out);
+    writer.setHeader(header);
+    map<Size, UInt> num_consfeat_of_size;
+    auto consume = [&](ConsensusMap& batch)
+    {
+      // assign unique ids
+      batch.applyMemberFunction(&UniqueIdInterface::setUniqueId);
+      // sort list of peptide identifications in each consensus feature by map index
+      batch.sortPeptideIdentificationsByMapIndex();
+      for (const ConsensusFeature& cf : batch)
+      {
+        ++num_consfeat_of_size[cf.size()];
+      }
+      writer.consume(batch);
+    };
+
+    algo.groupOutOfCore(ins.size(), std::move(mz_values), max_intensity, batch_size, load_range, consume);
+    writer.close();
+
+    // some statistics
+    logConsensusSizes_(num_consfeat_of_size, writer.getNrFeaturesWritten());
+
+    return EXECUTION_OK;
   }
 
 };
@@ -45,6 +45,7 @@
 #include <OpenMS/FORMAT/TransformationXMLFile.h>
 #include <OpenMS/FORMAT/SwathFile.h>
 #include <OpenMS/FORMAT/DATAACCESS/MSDataTransformingConsumer.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/SwathWindowLibrary.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/SwathWindowLoader.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/SwathQC.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/TransitionTSVFile.h>
@@ -76,6 +77,7 @@
 
 #include <cassert>
 #include <limits>
+#include <memory>
 
 // #define OPENSWATH_WORKFLOW_DEBUG
 
@@ -530,11 +532,13 @@ protected:
 
     registerIntOption_("batchSize", "<number>", 1000, "The batch size of chromatograms to process (0 means to only have one batch, sensible values are around 250-1000)", false, true);
     setMinInt_("batchSize", 0);
-    registerIntOption_("outer_loop_threads", "<number>", -1, "How many threads should be used for the outer loop (-1 use all threads, use 4 to analyze 4 SWATH windows in memory at once).", false, true);
+    registerIntOption_("outer_loop_threads", "<number>", -1, "How many SWATH windows may be processed at the same time (-1 use the number of threads, use 4 to keep at most 4 SWATH windows in memory at once). All threads are used within and across these windows.", false, true);
 
     registerIntOption_("ms1_isotopes", "<number>", 3, "The number of MS1 isotopes used for extraction", false, true);
     setMinInt_("ms1_isotopes", 0);
 
+    registerFlag_("stream_library", "Only for PQP input (-tr): do not keep the full assay library in memory but read the assays of each SWATH window from disk when it is processed (peak memory then scales with the largest window). Not supported with -sonar, -pasef or -matching_window_only.", true);
+
     registerSubsection_("Scoring", "Scoring parameters section");
     registerSubsection_("Library", "Library parameters section");
 
@@ -627,6 +631,11 @@ protected:
       p.setValue("NrRTBins", 10, "Number of RT bins to use to compute coverage. This option should be used to ensure that there is a complete coverage of the RT space (this should detect cases where only a part of the RT gradient is actually covered by normalization peptides)");
       p.setValue("MinPeptidesPerBin", 1, "Minimal number of peptides that are required for a bin to counted as 'covered'");
       p.setValue("MinBinsFilled", 8, "Minimal number of bins required to be covered");
+
+      p.setValue("sampling:spectra_stride", 1, "Split each SWATH map into this many interleaved subsets of spectra and extract them one at a time, stopping as soon as the RT calibration converges. A value of 1 extracts all spectra at once.", {"advanced"});
+      p.setMinInt("sampling:spectra_stride", 1);
+      p.setValue("sampling:convergence_tolerance", 0.005, "Maximal change of the RT calibration between two consecutive subsets (as fraction of the library RT range) to consider the calibration converged.", {"advanced"});
+      p.setMinFloat("sampling:convergence_tolerance", 0.0);
       return p;
     }
     else if (name == "Library")
@@ -694,6 +703,7 @@ protected:
     int batchSize = (int)getIntOption_("batchSize");
     int outer_loop_threads = (int)getIntOption_("outer_loop_threads");
     int ms1_isotopes = (int)getIntOption_("ms1_isotopes");
+    bool stream_library = getFlag_("stream_library");
     Size debug_level = (Size)getIntOption_("debug");
 
     double min_rsq = getDoubleOption_("min_rsq");
@@ -745,6 +755,16 @@ protected:
       throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
           "OSW output files can only be generated in combination with PQP input files (-tr).");
     }
+    if (stream_library && tr_type != FileTypes::PQP)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+          "Streaming the assay library (-stream_library) requires a PQP input file (-tr).");
+    }
+    if (stream_library && (sonar || pasef || getStringOption_("matching_window_only") == "true"))
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+          "Streaming the assay library (-stream_library) is not supported for SONAR, diaPASEF or PRM data.");
+    }
 
     // Check swath window input
     if (!swath_windows_file.empty())
@@ -807,9 +827,19 @@ protected:
     ///////////////////////////////////
     // Load the transitions
     ///////////////////////////////////
-    OpenSwath::LightTargetedExperiment transition_exp = loadTransitionList(tr_type, tr_file, tsv_reader_param);
-    OPENMS_LOG_INFO << "Loaded " << transition_exp.getProteins().size() << " proteins, " <<
-      transition_exp.getCompounds().size() << " compounds with " << transition_exp.getTransitions().size() << " transitions." << std::endl;
+    OpenSwath::LightTargetedExperiment transition_exp;
+    std::unique_ptr<SwathWindowLibrary> streamed_library;
+    if (stream_library)
+    {
+      streamed_library.reset(new SwathWindowLibrary(tr_file));
+      OPENMS_LOG_INFO << "Assays will be read per SWATH window from " << tr_file << std::endl;
+    }
+    else
+    {
+      transition_exp = loadTransitionList(tr_type, tr_file, tsv_reader_param);
+      OPENMS_LOG_INFO << "Loaded " << transition_exp.getProteins().size() << " proteins, " <<
+        transition_exp.getCompounds().size() << " compounds with " << transition_exp.getTransitions().size() << " transitions." << std::endl;
+    }
 
     if (tr_type == FileTypes::PQP)
     {
@@ -921,6 +951,10 @@ protected:
       {
         p.drift_time = im_trafo_inv.apply(p.drift_time);
       }
+      if (streamed_library)
+      {
+        streamed_library->setDriftTimeTransformation(im_trafo_inv);
+      }
 
     }
 
@@ -930,7 +964,8 @@ protected:
     ///////////////////////////////////
     Interfaces::IMSDataConsumer* chromatogramConsumer;
     UInt64 run_id = OpenMS::UniqueIdGenerator::getUniqueId();
-    prepareChromOutput(&chromatogramConsumer, exp_meta, transition_exp, out_chrom, run_id);
+    const Size nr_transitions = streamed_library ? streamed_library->getNrTransitions() : transition_exp.getTransitions().size();
+    prepareChromOutput(&chromatogramConsumer, exp_meta, nr_transitions, out_chrom, run_id);
 
     ///////////////////////////////////
     // Set up peakgroup file output (.tsv or .osw file)
@@ -953,8 +988,17 @@ protected:
     {
       OpenSwathWorkflow wf(use_ms1_traces, use_ms1_im, prm, pasef, outer_loop_threads);
       wf.setLogType(log_type_);
-      wf.performExtraction(swath_maps, trafo_rtnorm, cp, cp_ms1, feature_finder_param, transition_exp,
-          out_featureFile, !out.empty(), tsvwriter, oswwriter, chromatogramConsumer, batchSize, ms1_isotopes, load_into_memory);
+      if (streamed_library)
+      {
+        streamed_library->partition(swath_maps, cp.min_upper_edge_dist);
+        wf.performExtraction(swath_maps, trafo_rtnorm, cp, cp_ms1, feature_finder_param, *streamed_library,
+            out_featureFile, !out.empty(), tsvwriter, oswwriter, chromatogramConsumer, batchSize, ms1_isotopes, load_into_memory);
+      }
+      else
+      {
+        wf.performExtraction(swath_maps, trafo_rtnorm, cp, cp_ms1, feature_finder_param, transition_exp,
+            out_featureFile, !out.empty(), tsvwriter, oswwriter, chromatogramConsumer, batchSize, ms1_isotopes, load_into_memory);
+      }
     }
 
     if (!out.empty())